@@ -0,0 +1,387 @@
+﻿#include "bench.h"
+#include "core/json_stream.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QRegularExpression>
+#include <QSysInfo>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace vrd
+{
+namespace bench
+{
+	namespace
+	{
+		constexpr int64_t kMaxIterations = 1000000000;
+		constexpr double kDefaultMinTime = 0.5;
+
+		int64_t realNow() {
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+		// {zh} 当前线程的CPU时间，被测代码切到其他线程执行的部分不计入
+		// {en} CPU time of the calling thread, work the measured code hands to other threads is not counted
+		int64_t cpuNow() {
+#ifdef _WIN32
+			FILETIME creation, exit, kernel, user;
+			if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) {
+				return 0;
+			}
+			auto toNs = [](const FILETIME& time) {
+				return ((static_cast<int64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime) * 100;
+			};
+			return toNs(kernel) + toNs(user);
+#else
+			timespec ts;
+			if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+				return 0;
+			}
+			return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#endif
+		}
+
+		std::vector<Benchmark*>& registry() {
+			static std::vector<Benchmark*> benchmarks;
+			return benchmarks;
+		}
+
+		struct Options {
+			QRegularExpression filter;
+			double min_time = kDefaultMinTime;
+			QString out;
+		};
+
+		struct Result {
+			std::string name;
+			int64_t iterations = 0;
+			double real_time = 0.0;
+			double cpu_time = 0.0;
+			double items_per_second = 0.0;
+			double bytes_per_second = 0.0;
+			std::map<std::string, double> counters;
+			std::string label;
+			std::string error;
+		};
+	}
+
+	State::State(int64_t max_iterations, const std::vector<int64_t>& args)
+		: max_iterations_(max_iterations), args_(args) {
+	}
+
+	bool State::keepRunning() {
+		if (!started_) {
+			started_ = true;
+			if (error_.empty()) {
+				startTimer();
+			}
+		}
+		if (iterations_ < max_iterations_ && error_.empty()) {
+			++iterations_;
+			return true;
+		}
+		if (running_) {
+			stopTimer();
+		}
+		return false;
+	}
+
+	int64_t State::range(size_t index) const {
+		return index < args_.size() ? args_[index] : 0;
+	}
+
+	int64_t State::iterations() const {
+		return iterations_;
+	}
+
+	void State::pauseTiming() {
+		if (running_) {
+			stopTimer();
+		}
+	}
+
+	void State::resumeTiming() {
+		if (!running_) {
+			startTimer();
+		}
+	}
+
+	void State::setItemsProcessed(int64_t items) {
+		items_ = items;
+	}
+
+	void State::setBytesProcessed(int64_t bytes) {
+		bytes_ = bytes;
+	}
+
+	void State::counter(const std::string& name, double value) {
+		counters_[name] = value;
+	}
+
+	void State::setLabel(const std::string& label) {
+		label_ = label;
+	}
+
+	void State::skipWithError(const std::string& message) {
+		error_ = message;
+		if (running_) {
+			stopTimer();
+		}
+	}
+
+	void State::startTimer() {
+		running_ = true;
+		real_start_ns_ = realNow();
+		cpu_start_ns_ = cpuNow();
+	}
+
+	void State::stopTimer() {
+		running_ = false;
+		real_ns_ += realNow() - real_start_ns_;
+		cpu_ns_ += cpuNow() - cpu_start_ns_;
+	}
+
+	Benchmark::Benchmark(const std::string& name, Function&& fn)
+		: name_(name), fn_(std::move(fn)) {
+	}
+
+	Benchmark* Benchmark::arg(int64_t value) {
+		args_.push_back(value);
+		return this;
+	}
+
+	Benchmark* Benchmark::denseRange(int64_t start, int64_t end, int64_t step) {
+		for (auto value = start; value <= end; value += step) {
+			args_.push_back(value);
+		}
+		return this;
+	}
+
+	Benchmark* Benchmark::minTime(double seconds) {
+		min_time_ = seconds;
+		return this;
+	}
+
+	Benchmark* registerBenchmark(const std::string& name, Function&& fn) {
+		auto benchmark = new Benchmark(name, std::move(fn));
+		registry().push_back(benchmark);
+		return benchmark;
+	}
+
+	void useCharPointer(const volatile char* pointer) {
+		(void)pointer;
+	}
+
+	class Runner {
+	public:
+		explicit Runner(const Options& options) : options_(options) {
+		}
+
+		void run(std::vector<Result>& results) {
+			for (auto benchmark : registry()) {
+				if (benchmark->args_.empty()) {
+					runCase(*benchmark, benchmark->name_, std::vector<int64_t>(), results);
+					continue;
+				}
+				for (auto value : benchmark->args_) {
+					runCase(*benchmark, benchmark->name_ + "/" + std::to_string(value),
+						std::vector<int64_t>{ value }, results);
+				}
+			}
+		}
+
+	private:
+		/** {zh}
+		 * 先跑1次，再按上一轮耗时预估迭代次数，直到单轮运行时间达到最短运行时间
+		 */
+
+		/** {en}
+		* Start with one iteration, then predict the count from the previous round until one round
+		* runs for at least the minimum time
+		*/
+		void runCase(Benchmark& benchmark, const std::string& name, const std::vector<int64_t>& args,
+			std::vector<Result>& results) {
+			if (!options_.filter.match(QString::fromStdString(name)).hasMatch()) {
+				return;
+			}
+			auto minTime = benchmark.min_time_ > 0 ? benchmark.min_time_ : options_.min_time;
+			int64_t iterations = 1;
+			for (;;) {
+				State state(iterations, args);
+				benchmark.fn_(state);
+				auto seconds = state.real_ns_ / 1e9;
+				if (!state.error_.empty() || seconds >= minTime || iterations >= kMaxIterations) {
+					results.push_back(makeResult(name, state));
+					print(results.back());
+					return;
+				}
+				auto multiplier = minTime * 1.4 / std::max(seconds, 1e-9);
+				if (seconds / minTime <= 0.1) {
+					multiplier = std::min(multiplier, 10.0);
+				}
+				auto next = static_cast<int64_t>(iterations * multiplier);
+				iterations = std::min(std::max(next, iterations + 1), kMaxIterations);
+			}
+		}
+
+		static Result makeResult(const std::string& name, const State& state) {
+			Result result;
+			result.name = name;
+			result.iterations = state.iterations_;
+			result.label = state.label_;
+			result.error = state.error_;
+			result.counters = state.counters_;
+			if (state.iterations_ > 0) {
+				result.real_time = static_cast<double>(state.real_ns_) / state.iterations_;
+				result.cpu_time = static_cast<double>(state.cpu_ns_) / state.iterations_;
+			}
+			auto seconds = state.real_ns_ / 1e9;
+			if (seconds > 0) {
+				result.items_per_second = state.items_ / seconds;
+				result.bytes_per_second = state.bytes_ / seconds;
+			}
+			return result;
+		}
+
+		static void print(const Result& result) {
+			if (!result.error.empty()) {
+				fprintf(stderr, "%-56s ERROR: %s\n", result.name.c_str(), result.error.c_str());
+				return;
+			}
+			fprintf(stderr, "%-56s %14.1f ns %14.1f ns %12lld", result.name.c_str(), result.real_time,
+				result.cpu_time, static_cast<long long>(result.iterations));
+			if (result.items_per_second > 0) {
+				fprintf(stderr, " items/s=%.4g", result.items_per_second);
+			}
+			if (result.bytes_per_second > 0) {
+				fprintf(stderr, " bytes/s=%.4g", result.bytes_per_second);
+			}
+			for (const auto& counter : result.counters) {
+				fprintf(stderr, " %s=%.4g", counter.first.c_str(), counter.second);
+			}
+			if (!result.label.empty()) {
+				fprintf(stderr, " %s", result.label.c_str());
+			}
+			fprintf(stderr, "\n");
+		}
+
+		Options options_;
+	};
+
+	namespace
+	{
+		std::string toJson(const char* executable, const std::vector<Result>& results) {
+			std::string out;
+			JsonWriter writer(out);
+			writer.beginObject().key("context").beginObject()
+				.key("date").value(QDateTime::currentDateTime().toString(Qt::ISODate))
+				.key("host_name").value(QSysInfo::machineHostName())
+				.key("executable").value(executable)
+				.key("num_cpus").value(static_cast<int>(std::thread::hardware_concurrency()))
+#ifdef NDEBUG
+				.key("library_build_type").value("release")
+#else
+				.key("library_build_type").value("debug")
+#endif
+				.key("qt_version").value(qVersion())
+				.endObject();
+
+			writer.key("benchmarks").beginArray();
+			for (const auto& result : results) {
+				writer.beginObject()
+					.key("name").value(result.name)
+					.key("run_name").value(result.name)
+					.key("run_type").value("iteration");
+				if (!result.error.empty()) {
+					writer.key("error_occurred").value(true)
+						.key("error_message").value(result.error)
+						.endObject();
+					continue;
+				}
+				writer.key("iterations").value(result.iterations)
+					.key("real_time").value(result.real_time)
+					.key("cpu_time").value(result.cpu_time)
+					.key("time_unit").value("ns");
+				if (result.items_per_second > 0) {
+					writer.key("items_per_second").value(result.items_per_second);
+				}
+				if (result.bytes_per_second > 0) {
+					writer.key("bytes_per_second").value(result.bytes_per_second);
+				}
+				for (const auto& counter : result.counters) {
+					writer.key(counter.first.c_str()).value(counter.second);
+				}
+				if (!result.label.empty()) {
+					writer.key("label").value(result.label);
+				}
+				writer.endObject();
+			}
+			writer.endArray().endObject();
+			out.push_back('\n');
+			return out;
+		}
+
+		bool parseOptions(int argc, char* argv[], Options& options) {
+			for (int i = 1; i < argc; ++i) {
+				std::string arg = argv[i];
+				auto value = [&arg](const char* prefix) {
+					return arg.substr(strlen(prefix));
+				};
+				if (arg.compare(0, 9, "--filter=") == 0) {
+					options.filter.setPattern(QString::fromStdString(value("--filter=")));
+					if (!options.filter.isValid()) {
+						fprintf(stderr, "invalid filter: %s\n", argv[i]);
+						return false;
+					}
+				}
+				else if (arg.compare(0, 11, "--min-time=") == 0) {
+					options.min_time = std::max(atof(value("--min-time=").c_str()), 0.0);
+				}
+				else if (arg.compare(0, 6, "--out=") == 0) {
+					options.out = QString::fromStdString(value("--out="));
+				}
+				else if (arg.compare(0, 1, "-") == 0) {
+					fprintf(stderr, "unknown option: %s\n"
+						"usage: %s [--filter=regex] [--min-time=seconds] [--out=file.json]\n", argv[i], argv[0]);
+					return false;
+				}
+			}
+			return true;
+		}
+	}
+
+	int runBenchmarks(int argc, char* argv[]) {
+		Options options;
+		if (!parseOptions(argc, argv, options)) {
+			return 2;
+		}
+		std::vector<Result> results;
+		Runner(options).run(results);
+
+		auto json = toJson(argc > 0 ? argv[0] : "", results);
+		if (options.out.isEmpty()) {
+			fwrite(json.data(), 1, json.size(), stdout);
+			return 0;
+		}
+		QFile file(options.out);
+		if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)
+			|| file.write(json.data(), static_cast<qint64>(json.size())) != static_cast<qint64>(json.size())) {
+			fprintf(stderr, "failed to write %s\n", qPrintable(options.out));
+			return 1;
+		}
+		return 0;
+	}
+}
+}
@@ -0,0 +1,128 @@
+﻿#ifndef VRD_BENCH_H
+#define VRD_BENCH_H
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace vrd
+{
+namespace bench
+{
+	/** {zh}
+	 * 单个基准用例的运行状态，接口与 Google Benchmark 的 State 对应：
+	 * while (state.keepRunning()) { ... } 包住被测代码，迭代次数由运行器按最短运行时间自动确定
+	 */
+
+	/** {en}
+	* Run state of one benchmark case, mirroring Google Benchmark's State:
+	* wrap the measured code in while (state.keepRunning()) { ... }, the runner picks the iteration count
+	* so the case runs for at least the minimum time
+	*/
+	class State {
+	public:
+		State(int64_t max_iterations, const std::vector<int64_t>& args);
+
+		bool keepRunning();
+		int64_t range(size_t index = 0) const;
+		int64_t iterations() const;
+
+		// {zh} 暂停计时，用于排除每次迭代的准备工作
+		// {en} Pause timing to exclude per-iteration setup
+		void pauseTiming();
+		void resumeTiming();
+
+		void setItemsProcessed(int64_t items);
+		void setBytesProcessed(int64_t bytes);
+		void counter(const std::string& name, double value);
+		void setLabel(const std::string& label);
+		void skipWithError(const std::string& message);
+
+	private:
+		friend class Runner;
+		void startTimer();
+		void stopTimer();
+
+		int64_t max_iterations_;
+		int64_t iterations_ = 0;
+		std::vector<int64_t> args_;
+		bool started_ = false;
+		bool running_ = false;
+		int64_t real_start_ns_ = 0;
+		int64_t cpu_start_ns_ = 0;
+		int64_t real_ns_ = 0;
+		int64_t cpu_ns_ = 0;
+		int64_t items_ = 0;
+		int64_t bytes_ = 0;
+		std::map<std::string, double> counters_;
+		std::string label_;
+		std::string error_;
+	};
+
+	using Function = std::function<void(State&)>;
+
+	class Benchmark {
+	public:
+		Benchmark(const std::string& name, Function&& fn);
+
+		// {zh} 每个参数生成一个用例，名称追加 "/参数"
+		// {en} Each argument makes one case, named with a "/argument" suffix
+		Benchmark* arg(int64_t value);
+		Benchmark* denseRange(int64_t start, int64_t end, int64_t step = 1);
+		// {zh} 界面类用例单次较慢，可单独放宽最短运行时间
+		// {en} UI cases are slow per iteration, so they may relax the minimum run time
+		Benchmark* minTime(double seconds);
+
+	private:
+		friend class Runner;
+		std::string name_;
+		Function fn_;
+		std::vector<int64_t> args_;
+		double min_time_ = 0.0;
+	};
+
+	Benchmark* registerBenchmark(const std::string& name, Function&& fn);
+
+	/** {zh}
+	 * 运行所有已注册用例，结果输出为 Google Benchmark 格式的 JSON
+	 * 参数: --filter=正则 --min-time=秒 --out=JSON文件，未指定 --out 时 JSON 写到标准输出
+	 */
+
+	/** {en}
+	* Run every registered case and emit the results as Google Benchmark compatible JSON
+	* Arguments: --filter=regex --min-time=seconds --out=JSON file, JSON goes to stdout without --out
+	*/
+	int runBenchmarks(int argc, char* argv[]);
+
+	void useCharPointer(const volatile char* pointer);
+
+	// {zh} 阻止编译器把只为计时而计算的结果优化掉
+	// {en} Keep the compiler from optimizing away results computed only for timing
+	template <class T>
+	inline void doNotOptimize(const T& value) {
+#if defined(_MSC_VER)
+		useCharPointer(&reinterpret_cast<const volatile char&>(value));
+		_ReadWriteBarrier();
+#else
+		asm volatile("" : : "r,m"(value) : "memory");
+#endif
+	}
+}
+}
+
+#define VRD_BENCH_CONCAT_(a, b) a##b
+#define VRD_BENCH_CONCAT(a, b) VRD_BENCH_CONCAT_(a, b)
+
+// {zh} 在静态初始化时注册用例，可链式调用 ->arg(n)
+// {en} Register a case during static initialization, ->arg(n) may be chained
+#define VRD_BENCHMARK(name, fn) \
+	static ::vrd::bench::Benchmark* VRD_BENCH_CONCAT(vrd_benchmark_, __LINE__) = \
+		::vrd::bench::registerBenchmark(name, fn)
+
+#endif // VRD_BENCH_H
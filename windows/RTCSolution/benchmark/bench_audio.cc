@@ -0,0 +1,107 @@
+﻿#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark/bench.h"
+#include "core/audio_level_meter.h"
+#include "fake_audio_frame.h"
+
+namespace
+{
+	using vrd::bench::State;
+	using vrd::fake::FakeAudioFrame;
+
+	const int kSampleRate = 48000;
+	const size_t kFrameSamples = kSampleRate / 100;
+	// {zh} 每5帧（50ms）做一次分析，与默认间隔一致
+	// {en} One analysis pass per 5 frames (50 ms), matching the default interval
+	const int kFramesPerPass = 5;
+
+	struct ReleaseFrame {
+		void operator()(FakeAudioFrame* frame) const {
+			frame->release();
+		}
+	};
+	typedef std::unique_ptr<FakeAudioFrame, ReleaseFrame> FramePtr;
+
+	FramePtr makeFrame(std::vector<int16_t>& samples, bool speaking, uint32_t seed) {
+		samples.resize(kFrameSamples);
+		FakeAudioFrame::synthesize(samples.data(), samples.size(), kSampleRate, 0, speaking, seed);
+		bytertc::AudioFrameBuilder builder;
+		builder.sample_rate = bytertc::kAudioSampleRate48000;
+		builder.channel = bytertc::kAudioChannelMono;
+		builder.data = reinterpret_cast<uint8_t*>(samples.data());
+		builder.data_size = static_cast<int64_t>(samples.size() * sizeof(int16_t));
+		builder.deep_copy = false;
+		return FramePtr(FakeAudioFrame::build(builder));
+	}
+
+	int64_t nowMs() {
+		return std::chrono::duration_cast<std::chrono::milliseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	void measure10ms(State& state) {
+		std::vector<int16_t> samples(kFrameSamples);
+		FakeAudioFrame::synthesize(samples.data(), samples.size(), kSampleRate, 0, true, 1);
+		while (state.keepRunning()) {
+			vrd::AudioLevelMeter::Measure result;
+			vrd::AudioLevelMeter::measure(samples.data(), samples.size(), result);
+			vrd::bench::doNotOptimize(result);
+		}
+		state.setItemsProcessed(state.iterations() * static_cast<int64_t>(kFrameSamples));
+	}
+
+	/** {zh}
+	 * 模拟SDK音频线程向未启动的电平表投递 N 路远端10ms帧（一半说话），每5轮做一次分析
+	 * 每次迭代为一轮，即每路一帧，items 为帧数
+	 */
+
+	/** {en}
+	* Simulates the SDK audio thread feeding 10 ms frames of N remote streams (half speaking) into a meter that is
+	* not started, with an analysis pass every 5 rounds
+	* Each iteration is one round of one frame per stream, items are frames
+	*/
+	void tapStreams(State& state) {
+		auto count = static_cast<int>(state.range(0));
+		std::vector<std::vector<int16_t>> samples(count);
+		std::vector<FramePtr> frames;
+		std::vector<std::string> user_ids(count);
+		std::vector<bytertc::RemoteStreamKey> keys(count);
+		for (int i = 0; i < count; ++i) {
+			frames.push_back(makeFrame(samples[i], (i % 2) == 0, static_cast<uint32_t>(i + 1)));
+			user_ids[i] = "bench_user_" + std::to_string(i);
+			keys[i].room_id = "call_123456";
+			keys[i].user_id = user_ids[i].c_str();
+			keys[i].stream_index = bytertc::kStreamIndexMain;
+		}
+
+		vrd::AudioLevelMeter meter;
+		std::vector<AudioVolumeInfoWrap> local;
+		std::vector<AudioVolumeInfoWrap> remote;
+		int64_t published = 0;
+		int round = 0;
+		while (state.keepRunning()) {
+			for (int i = 0; i < count; ++i) {
+				meter.onRemoteUserAudioFrame(keys[i], *frames[i]);
+			}
+			if (++round == kFramesPerPass) {
+				round = 0;
+				if (meter.process(nowMs(), local, remote)) {
+					++published;
+				}
+			}
+		}
+		if (meter.droppedFrames() != 0 && count <= vrd::AudioLevelMeter::kMaxRemoteStreams) {
+			state.skipWithError("frames were dropped below the stream limit");
+			return;
+		}
+		state.setItemsProcessed(state.iterations() * count);
+		state.counter("published", static_cast<double>(published));
+		state.counter("dropped_frames", static_cast<double>(meter.droppedFrames()));
+	}
+}
+
+VRD_BENCHMARK("AudioLevelMeter/measure_10ms", measure10ms);
+VRD_BENCHMARK("AudioLevelMeter/tap_streams", tapStreams)->arg(1)->arg(16)->arg(32);
@@ -0,0 +1,286 @@
+﻿#include <QCoreApplication>
+#include <QEventLoop>
+#include <QMap>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QUrl>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark/bench.h"
+#include "core/Util.h"
+#include "core/http/http.h"
+#include "core/rtc_engine_wrap.h"
+#include "core/subscription_set.h"
+#include "fake_rtc_video.h"
+#include "feature/data_mgr.h"
+
+namespace
+{
+	using vrd::bench::State;
+
+	/** {zh}
+	 * 同一线程投递一批 ForwardEvent 再统一分发，测量投递加分发的单个事件开销
+	 */
+
+	/** {en}
+	* Post a batch of ForwardEvents on one thread and dispatch them together, measuring post plus dispatch per event
+	*/
+	void forwardEventSameThread(State& state) {
+		auto batch = state.range(0);
+		auto& wrap = RtcEngineWrap::instance();
+		int64_t executed = 0;
+		while (state.keepRunning()) {
+			for (int64_t i = 0; i < batch; ++i) {
+				ForwardEvent::PostEvent(&wrap, [&executed] { ++executed; });
+			}
+			QCoreApplication::sendPostedEvents(&wrap, QEvent::User);
+		}
+		if (executed != state.iterations() * batch) {
+			state.skipWithError("not every posted event was dispatched");
+		}
+		state.setItemsProcessed(state.iterations() * batch);
+	}
+
+	/** {zh}
+	 * 模拟SDK线程投递、主线程分发，与SDK回调进入 RtcEngineWrap 的路径一致
+	 */
+
+	/** {en}
+	* An SDK-like thread posts while the main thread dispatches, the same path SDK callbacks take into RtcEngineWrap
+	*/
+	void forwardEventCrossThread(State& state) {
+		auto batch = state.range(0);
+		auto& wrap = RtcEngineWrap::instance();
+		std::mutex mutex;
+		std::condition_variable cv;
+		int64_t requested = 0;
+		bool quit = false;
+		int64_t executed = 0;
+		std::thread producer([&] {
+			int64_t posted = 0;
+			for (;;) {
+				std::unique_lock<std::mutex> lock(mutex);
+				cv.wait(lock, [&] { return quit || requested > posted; });
+				if (quit) {
+					return;
+				}
+				auto target = requested;
+				lock.unlock();
+				for (; posted < target; ++posted) {
+					ForwardEvent::PostEvent(&wrap, [&executed] { ++executed; });
+				}
+			}
+		});
+
+		int64_t expected = 0;
+		while (state.keepRunning()) {
+			expected += batch;
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				requested = expected;
+			}
+			cv.notify_one();
+			while (executed < expected) {
+				QCoreApplication::sendPostedEvents(&wrap, QEvent::User);
+			}
+		}
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			quit = true;
+		}
+		cv.notify_one();
+		producer.join();
+		state.setItemsProcessed(state.iterations() * batch);
+	}
+
+	/** {zh}
+	 * 保持固定数量的未释放块，每次迭代释放最早的块再申请同尺寸的新块
+	 */
+
+	/** {en}
+	* Keep a fixed number of blocks outstanding, each iteration frees the oldest and allocates a new one of the same size
+	*/
+	void memoryPoolChurn(State& state) {
+		constexpr int kOutstanding = 8;
+		auto size = static_cast<unsigned int>(state.range(0));
+		util::SimpleMemoryPool pool;
+		std::deque<unsigned char*> blocks;
+		for (int i = 0; i < kOutstanding; ++i) {
+			blocks.push_back(pool.Malloc(size));
+		}
+		while (state.keepRunning()) {
+			pool.Free(blocks.front());
+			blocks.pop_front();
+			blocks.push_back(pool.Malloc(size));
+		}
+		for (auto block : blocks) {
+			pool.Free(block);
+		}
+		state.setBytesProcessed(state.iterations() * size);
+	}
+
+	// {zh} 多种尺寸交替申请，空闲链表需要按尺寸查找
+	// {en} Alternating sizes, so the free list has to be searched by size
+	void memoryPoolChurnMixed(State& state) {
+		const unsigned int sizes[] = { 320 * 180 * 3 / 2, 640 * 360 * 3 / 2, 1280 * 720 * 3 / 2, 4096 };
+		constexpr int kSizes = sizeof(sizes) / sizeof(sizes[0]);
+		auto outstanding = static_cast<int>(state.range(0));
+		util::SimpleMemoryPool pool;
+		std::deque<unsigned char*> blocks;
+		for (int i = 0; i < outstanding; ++i) {
+			blocks.push_back(pool.Malloc(sizes[i % kSizes]));
+		}
+		int64_t next = outstanding;
+		int64_t bytes = 0;
+		while (state.keepRunning()) {
+			auto size = sizes[next++ % kSizes];
+			pool.Free(blocks.front());
+			blocks.pop_front();
+			blocks.push_back(pool.Malloc(size));
+			bytes += size;
+		}
+		for (auto block : blocks) {
+			pool.Free(block);
+		}
+		state.setBytesProcessed(bytes);
+	}
+
+	// {zh} 带锁的公共数据读取，每次都复制整个结构
+	// {en} Locked read of shared data, copying the whole struct every time
+	void dataMgrRtsInfoCopy(State& state) {
+		vrd::RTSInfo info;
+		info.app_id = "bench_app_id_0123456789abcdef";
+		info.rtm_token = std::string(160, 't');
+		info.server_url = "https://rtc-access.example.com/dispatch/v2";
+		info.server_signature = std::string(64, 's');
+		vrd::DataMgr::instance().setRTSInfo(info);
+		while (state.keepRunning()) {
+			auto copy = vrd::DataMgr::instance().rts_info();
+			vrd::bench::doNotOptimize(copy);
+		}
+	}
+
+	/** {zh}
+	 * 本地回环HTTP服务，对每个请求返回固定的200响应，连接保持复用
+	 */
+
+	/** {en}
+	* Loopback HTTP server answering every request with a fixed 200 response on kept-alive connections
+	*/
+	class LoopbackHttpServer : public QTcpServer {
+	public:
+		LoopbackHttpServer() {
+			QByteArray body = "{\"code\":200,\"message\":\"ok\",\"response\":{\"rtc_token\":\"bench_token\"}}";
+			response_ = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nConnection: keep-alive\r\n"
+				"Content-Length: " + QByteArray::number(body.size()) + "\r\n\r\n" + body;
+			QObject::connect(this, &QTcpServer::newConnection, this, [this] {
+				while (auto socket = nextPendingConnection()) {
+					QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+					QObject::connect(socket, &QTcpSocket::readyRead, socket, [this, socket] {
+						answer(socket);
+					});
+				}
+			});
+		}
+
+	private:
+		void answer(QTcpSocket* socket) {
+			auto& pending = pending_[socket];
+			pending += socket->readAll();
+			int end;
+			while ((end = pending.indexOf("\r\n\r\n")) >= 0) {
+				pending.remove(0, end + 4);
+				socket->write(response_);
+			}
+		}
+
+		QByteArray response_;
+		QMap<QTcpSocket*, QByteArray> pending_;
+	};
+
+	/** {zh}
+	 * 焦点模式下 N 个远端用户，subscribe 与 unsubscribe 经替身房间投递到其调度线程
+	 * scroll：每次迭代可视窗口（8人）下移一位；toggle_all：每次迭代在全部取消视频订阅与全部恢复之间切换
+	 * sdk_calls 为每次迭代发出的SDK调用数
+	 */
+
+	/** {en}
+	* N remote users in focus mode, subscribe and unsubscribe go through the stand-in room onto its scheduler thread
+	* scroll: each iteration moves the visible window (8 users) down by one; toggle_all: each iteration flips between
+	* every video unsubscribed and every video restored
+	* sdk_calls is the number of SDK calls issued per iteration
+	*/
+	void subscriptionLayout(State& state, bool toggle_all) {
+		const int kVisible = 8;
+		auto count = static_cast<int>(state.range(0));
+		vrd::fake::FakeRTCVideo engine("bench", nullptr);
+		std::unique_ptr<bytertc::IRTCRoom, void (*)(bytertc::IRTCRoom*)> room(
+			engine.createRTCRoom("call_123456"), [](bytertc::IRTCRoom* r) { r->destroy(); });
+		vrd::SubscriptionSet set;
+		std::vector<vrd::StreamSubscription> desired(count);
+		for (int i = 0; i < count; ++i) {
+			desired[i].user_id = "bench_user_" + std::to_string(i);
+			set.onPublished(desired[i].user_id, false, bytertc::kMediaStreamTypeBoth);
+		}
+		int64_t calls = 0;
+		int64_t round = 0;
+		while (state.keepRunning()) {
+			for (int i = 0; i < count; ++i) {
+				desired[i].video = toggle_all ? (round % 2) != 0
+					: ((i - round % count + count) % count) < kVisible;
+				set.setDesired(desired[i]);
+			}
+			calls += set.apply(room.get());
+			++round;
+		}
+		state.setItemsProcessed(state.iterations() * count);
+		state.counter("sdk_calls", static_cast<double>(calls) / std::max<int64_t>(state.iterations(), 1));
+	}
+
+	void httpReplyLoopback(State& state) {
+		LoopbackHttpServer server;
+		if (!server.listen(QHostAddress::LocalHost)) {
+			state.skipWithError("cannot listen on localhost");
+			return;
+		}
+		QUrl url(QString("http://127.0.0.1:%1/bench").arg(server.serverPort()));
+		int64_t failures = 0;
+		int64_t bytes = 0;
+		while (state.keepRunning()) {
+			QEventLoop loop;
+			auto reply = Http::instance().get(url);
+			QObject::connect(reply, &HttpReply::finished, &loop, [&](const HttpReply& finished) {
+				if (finished.isSuccessful()) {
+					bytes += finished.body().size();
+				}
+				else {
+					++failures;
+				}
+				loop.quit();
+			});
+			loop.exec();
+		}
+		if (failures > 0) {
+			state.skipWithError(std::to_string(failures) + " requests failed");
+			return;
+		}
+		state.setItemsProcessed(state.iterations());
+		state.setBytesProcessed(bytes);
+	}
+}
+
+VRD_BENCHMARK("ForwardEvent/post_dispatch", forwardEventSameThread)->arg(1)->arg(64)->arg(1024);
+VRD_BENCHMARK("ForwardEvent/cross_thread", forwardEventCrossThread)->arg(1)->arg(64)->arg(1024);
+VRD_BENCHMARK("SimpleMemoryPool/churn", memoryPoolChurn)->arg(4096)->arg(640 * 360 * 3 / 2);
+VRD_BENCHMARK("SimpleMemoryPool/churn_mixed", memoryPoolChurnMixed)->arg(16)->arg(256);
+VRD_BENCHMARK("DataMgr/rts_info/copy", dataMgrRtsInfoCopy);
+VRD_BENCHMARK("HttpReply/get_loopback", httpReplyLoopback);
+VRD_BENCHMARK("SubscriptionSet/scroll", [](State& state) { subscriptionLayout(state, false); })->arg(20)->arg(200);
+VRD_BENCHMARK("SubscriptionSet/toggle_all", [](State& state) { subscriptionLayout(state, true); })->arg(20)->arg(200);
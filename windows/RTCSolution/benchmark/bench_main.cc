@@ -0,0 +1,44 @@
+﻿#include <QApplication>
+#include <cstdio>
+
+#include "benchmark/bench.h"
+#include "core/rtc_engine_wrap.h"
+#include "core/session_base.h"
+
+namespace
+{
+	// {zh} 日志仍会格式化，与应用内开销一致，只是不输出调试级别的内容
+	// {en} Log messages are still formatted as in the app, only debug and info output is dropped
+	void quietMessageHandler(QtMsgType type, const QMessageLogContext& context, const QString& message) {
+		if (type == QtDebugMsg || type == QtInfoMsg) {
+			return;
+		}
+		fprintf(stderr, "%s\n", qPrintable(message));
+	}
+}
+
+/** {zh}
+ * 微基准入口，在无界面的Qt环境和替身RTC引擎上运行全部用例
+ * 用法: videocall_bench [--filter=正则] [--min-time=秒] [--out=结果JSON]
+ */
+
+/** {en}
+* Micro-benchmark entry, runs every case under offscreen Qt against the stand-in RTC engine
+* Usage: videocall_bench [--filter=regex] [--min-time=seconds] [--out=result JSON]
+*/
+int main(int argc, char* argv[]) {
+	if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+		qputenv("QT_QPA_PLATFORM", "offscreen");
+	}
+	QApplication app(argc, argv);
+	qInstallMessageHandler(quietMessageHandler);
+
+	vrd::SessionBase::registerThis();
+	RtcEngineWrap::instance().createEngine("bench");
+
+	auto ret = vrd::bench::runBenchmarks(argc, argv);
+
+	RtcEngineWrap::instance().destroyEngine();
+	qInstallMessageHandler(nullptr);
+	return ret;
+}
@@ -0,0 +1,286 @@
+﻿#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "benchmark/bench.h"
+#include "core/application.h"
+#include "core/json_stream.h"
+#include "core/rts_codec.h"
+#include "core/session_base.h"
+
+namespace
+{
+	using vrd::bench::State;
+
+	const char* const kAppId = "bench_app_id_0123456789abcdef";
+	const char* const kRoomId = "call_123456";
+	const char* const kUserId = "bench_user_0001";
+	const char* const kRequestId = "6f1c2d3e-4b5a-4c6d-8e7f-0123456789ab";
+	const char* const kDeviceId = "9a8b7c6d-5e4f-4a3b-2c1d-fedcba987654";
+	const char* const kInformEvent = "videocallOnCloseRoom";
+
+	// {zh} 与 VideoCallSession::joinCall 和 userReconnect 发出的content一致
+	// {en} Same content as sent by VideoCallSession::joinCall and userReconnect
+	QJsonObject roomContent() {
+		QJsonObject content;
+		content["login_token"] = QString(64, 'k');
+		content["user_id"] = kUserId;
+		content["room_id"] = kRoomId;
+		return content;
+	}
+
+	QJsonObject requestEnvelope(const char* event_name) {
+		QJsonObject message;
+		message["app_id"] = kAppId;
+		message["room_id"] = kRoomId;
+		message["user_id"] = kUserId;
+		message["event_name"] = event_name;
+		message["content"] = roomContent();
+		message["request_id"] = kRequestId;
+		message["device_id"] = kDeviceId;
+		return message;
+	}
+
+	QJsonObject informEnvelope() {
+		QJsonObject data;
+		data["room_id"] = kRoomId;
+		QJsonObject message;
+		message["message_type"] = "inform";
+		message["event"] = kInformEvent;
+		message["timestamp"] = 1700000000123456789.0;
+		message["data"] = data;
+		return message;
+	}
+
+	// {zh} 替身引擎回复请求时使用的消息格式
+	// {en} Message shape the stand-in engine answers requests with
+	std::string returnMessage() {
+		return std::string("{\"message_type\":\"return\",\"request_id\":\"") + kRequestId
+			+ "\",\"code\":200,\"message\":\"ok\",\"timestamp\":1700000000123456789"
+			+ ",\"response\":{\"rtc_token\":\"" + std::string(160, 't') + "\",\"duration\":0}}";
+	}
+
+	std::string informMessage() {
+		return QJsonDocument(informEnvelope()).toJson(QJsonDocument::Compact).toStdString();
+	}
+
+	void writeRequest(std::string& out, const char* event_name, const QJsonObject& content) {
+		vrd::JsonWriter writer(out);
+		writer.beginObject()
+			.key("app_id").value(kAppId)
+			.key("room_id").value(kRoomId)
+			.key("user_id").value(kUserId)
+			.key("event_name").value(event_name)
+			.key("content").beginStringValue().value(content).endStringValue()
+			.key("request_id").value(kRequestId)
+			.key("device_id").value(kDeviceId)
+			.endObject();
+	}
+
+	/** {zh}
+	 * 信令包JSON构建：一次写入复用缓冲区，对比原先先构建DOM、content缩进序列化后再整体序列化的方式
+	 */
+
+	/** {en}
+	* RTS envelope JSON building: one pass into a reused buffer, against the former path that built a DOM,
+	* serialized the content indented and then serialized the whole envelope
+	*/
+	void buildRequestStreaming(State& state) {
+		auto content = roomContent();
+		std::string buffer;
+		while (state.keepRunning()) {
+			buffer.clear();
+			writeRequest(buffer, "videocallJoinRoom", content);
+			vrd::bench::doNotOptimize(buffer);
+		}
+		state.counter("json_bytes", static_cast<double>(buffer.size()));
+	}
+
+	void buildRequestDom(State& state) {
+		auto content = roomContent();
+		std::string buffer;
+		while (state.keepRunning()) {
+			QJsonObject message;
+			message["app_id"] = kAppId;
+			message["room_id"] = kRoomId;
+			message["user_id"] = kUserId;
+			message["event_name"] = "videocallJoinRoom";
+			message["content"] = QString(QJsonDocument(content).toJson(QJsonDocument::Indented));
+			message["request_id"] = kRequestId;
+			message["device_id"] = kDeviceId;
+			buffer = std::string(QJsonDocument(message).toJson().constData());
+			vrd::bench::doNotOptimize(buffer);
+		}
+		state.counter("json_bytes", static_cast<double>(buffer.size()));
+	}
+
+	void parseReturnRoute(State& state) {
+		auto message = returnMessage();
+		while (state.keepRunning()) {
+			vrd::JsonRoute route;
+			vrd::readJsonRoute(message.data(), message.size(), route);
+			auto payload = vrd::parseJsonObject(message.data(), message.size());
+			vrd::bench::doNotOptimize(route);
+			vrd::bench::doNotOptimize(payload);
+		}
+		state.setBytesProcessed(state.iterations() * static_cast<int64_t>(message.size()));
+	}
+
+	void parseReturnDom(State& state) {
+		auto message = returnMessage();
+		while (state.keepRunning()) {
+			auto payload = QJsonDocument::fromJson(
+				QByteArray(message.data(), static_cast<int>(message.size()))).object();
+			auto messageType = payload["message_type"].toString();
+			auto requestId = payload["request_id"].toString();
+			vrd::bench::doNotOptimize(messageType);
+			vrd::bench::doNotOptimize(requestId);
+		}
+		state.setBytesProcessed(state.iterations() * static_cast<int64_t>(message.size()));
+	}
+
+	void parseInformRoute(State& state) {
+		auto message = informMessage();
+		while (state.keepRunning()) {
+			vrd::JsonRoute route;
+			vrd::readJsonRoute(message.data(), message.size(), route);
+			auto data = vrd::parseJsonObject(route.data ? route.data : "", route.data_size);
+			vrd::bench::doNotOptimize(route);
+			vrd::bench::doNotOptimize(data);
+		}
+		state.setBytesProcessed(state.iterations() * static_cast<int64_t>(message.size()));
+	}
+
+	void parseInformDom(State& state) {
+		auto message = informMessage();
+		while (state.keepRunning()) {
+			auto envelope = QJsonDocument::fromJson(
+				QByteArray(message.data(), static_cast<int>(message.size()))).object();
+			auto event = envelope["event"].toString();
+			auto data = envelope["data"].toObject();
+			vrd::bench::doNotOptimize(event);
+			vrd::bench::doNotOptimize(data);
+		}
+		state.setBytesProcessed(state.iterations() * static_cast<int64_t>(message.size()));
+	}
+
+	// {zh} 二进制信令与同一信令包的JSON发送形式对比，wire_bytes 为二进制帧大小，json_bytes 为JSON大小
+	// {en} Binary frames against the JSON form of the same envelope, wire_bytes is the frame size and json_bytes the JSON size
+	size_t jsonSize(const char* event_name, const QJsonObject& envelope) {
+		if (event_name == nullptr) {
+			return static_cast<size_t>(QJsonDocument(envelope).toJson(QJsonDocument::Compact).size());
+		}
+		std::string buffer;
+		writeRequest(buffer, event_name, roomContent());
+		return buffer.size();
+	}
+
+	void codecEncode(State& state, const char* event_name) {
+		auto envelope = event_name ? requestEnvelope(event_name) : informEnvelope();
+		QByteArray frame;
+		while (state.keepRunning()) {
+			frame = vrd::rts_codec::encode(envelope);
+			vrd::bench::doNotOptimize(frame);
+		}
+		state.counter("wire_bytes", frame.size());
+		state.counter("json_bytes", static_cast<double>(jsonSize(event_name, envelope)));
+	}
+
+	void codecDecode(State& state, const char* event_name) {
+		auto envelope = event_name ? requestEnvelope(event_name) : informEnvelope();
+		auto frame = vrd::rts_codec::encode(envelope);
+		auto data = reinterpret_cast<const uint8_t*>(frame.constData());
+		while (state.keepRunning()) {
+			QJsonObject decoded;
+			if (!vrd::rts_codec::decode(data, frame.size(), decoded)) {
+				state.skipWithError("decode failed");
+				break;
+			}
+			vrd::bench::doNotOptimize(decoded);
+		}
+		state.setBytesProcessed(state.iterations() * frame.size());
+		state.counter("wire_bytes", frame.size());
+	}
+
+	std::shared_ptr<vrd::SessionBase> session() {
+		static std::shared_ptr<vrd::SessionBase> base = [] {
+			auto session = VRD_FUNC_GET_COMPONET(vrd::SessionBase);
+			session->setUserId(kUserId);
+			session->setRoomId(kRoomId);
+			session->setToken(std::string(64, 'k'));
+			// {zh} 跳过业务服务器参数设置，请求直接发给替身引擎
+			// {en} Skip the business server params round trip, requests go straight to the stand-in engine
+			session->onServerParamsSetResult(200);
+			return session;
+		}();
+		return base;
+	}
+
+	// {zh} 等替身引擎回复完所有在途请求，避免回复落到后续用例的计时里
+	// {en} Wait for the stand-in engine to answer every in-flight request so replies do not land in later cases
+	void drainRequests(vrd::SessionBase& base) {
+		QElapsedTimer timer;
+		timer.start();
+		while (base.inFlightRequests() > 0 && timer.elapsed() < 10000) {
+			QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+		}
+	}
+
+	void sessionEmitMessage(State& state) {
+		auto base = session();
+		auto content = roomContent();
+		while (state.keepRunning()) {
+			base->_emitMessage("videocallJoinRoom", content);
+		}
+		drainRequests(*base);
+		state.setItemsProcessed(state.iterations());
+	}
+
+	/** {zh}
+	 * 通知消息从 onMessageReceived 进入，经线程池解码、按序回到主线程，到监听回调结束
+	 */
+
+	/** {en}
+	* Inform messages from onMessageReceived, through task pool decoding and in-order dispatch, to the end of the listener
+	*/
+	void sessionReceiveInform(State& state) {
+		auto batch = state.range(0);
+		auto base = session();
+		auto message = informMessage();
+		int64_t received = 0;
+		base->_onNotify(kInformEvent, [&received](const QJsonObject& data) {
+			++received;
+		});
+		int64_t expected = 0;
+		while (state.keepRunning()) {
+			for (int64_t i = 0; i < batch; ++i) {
+				base->onMessageReceived("server", message);
+			}
+			expected += batch;
+			while (received < expected) {
+				QCoreApplication::processEvents(QEventLoop::AllEvents);
+			}
+		}
+		base->_offNotify(kInformEvent);
+		state.setItemsProcessed(state.iterations() * batch);
+	}
+}
+
+VRD_BENCHMARK("RtsJson/build_request/streaming", buildRequestStreaming);
+VRD_BENCHMARK("RtsJson/build_request/dom", buildRequestDom);
+VRD_BENCHMARK("RtsJson/parse_return/route", parseReturnRoute);
+VRD_BENCHMARK("RtsJson/parse_return/dom", parseReturnDom);
+VRD_BENCHMARK("RtsJson/parse_inform/route", parseInformRoute);
+VRD_BENCHMARK("RtsJson/parse_inform/dom", parseInformDom);
+
+VRD_BENCHMARK("RtsCodec/encode/videocallJoinRoom", [](State& state) { codecEncode(state, "videocallJoinRoom"); });
+VRD_BENCHMARK("RtsCodec/encode/videocallReconnect", [](State& state) { codecEncode(state, "videocallReconnect"); });
+VRD_BENCHMARK("RtsCodec/encode/inform", [](State& state) { codecEncode(state, nullptr); });
+VRD_BENCHMARK("RtsCodec/decode/videocallJoinRoom", [](State& state) { codecDecode(state, "videocallJoinRoom"); });
+VRD_BENCHMARK("RtsCodec/decode/videocallReconnect", [](State& state) { codecDecode(state, "videocallReconnect"); });
+VRD_BENCHMARK("RtsCodec/decode/inform", [](State& state) { codecDecode(state, nullptr); });
+
+VRD_BENCHMARK("SessionBase/emit_message", sessionEmitMessage);
+VRD_BENCHMARK("SessionBase/receive_inform", sessionReceiveInform)->arg(1)->arg(64);
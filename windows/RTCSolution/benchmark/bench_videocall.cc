@@ -0,0 +1,209 @@
+﻿#include <QCoreApplication>
+#include <string>
+#include <vector>
+
+#include "benchmark/bench.h"
+#include "core/audio_level_meter.h"
+#include "core/rtc_engine_wrap.h"
+#include "videocall/core/data_mgr.h"
+#include "videocall/core/videocall_manager.h"
+#include "videocall/core/videocall_rtc_wrap.h"
+#include "videocall/feature/normal_video_view.h"
+#include "videocall/feature/videocall_main_page.h"
+
+namespace
+{
+	using vrd::bench::State;
+
+	const char* const kRoomId = "call_123456";
+
+	std::string benchUserId(int index) {
+		return "bench_user_" + std::to_string(index);
+	}
+
+	std::vector<videocall::User> makeUsers(int count) {
+		std::vector<videocall::User> users(count);
+		for (int i = 0; i < count; ++i) {
+			users[i].user_id = benchUserId(i);
+			users[i].user_name = "bench user name " + std::to_string(i);
+			users[i].is_mic_on = (i % 2) == 0;
+			users[i].is_camera_on = true;
+		}
+		return users;
+	}
+
+	/** {zh}
+	 * 与场景模块初始化时一致地连接信号，但关闭替身引擎的定时音量回调和本地电平分析，音量报告只来自用例本身
+	 * 不创建主页面单例，音量更新不会触发 updateData，页面相关开销由单独的用例测量
+	 */
+
+	/** {en}
+	* Wire up the signals as the scene module does, but turn off the stand-in engine's periodic volume reports
+	* and the local level meter so every report comes from the case itself
+	* The main page singleton is not created, so volume updates do not trigger updateData; page costs have their own cases
+	*/
+	void initVideoCall() {
+		static bool initialized = [] {
+			VideoCallRtcEngineWrap::init();
+			videocall::VideoCallManager::init();
+			vrd::AudioLevelMeter::instance().stop();
+			VideoCallRtcEngineWrap::setAudioVolumeIndicate(0);
+			videocall::DataMgr::instance().setRoomID(kRoomId);
+			videocall::DataMgr::instance().setUserID(benchUserId(0));
+			return true;
+		}();
+		(void)initialized;
+	}
+
+	// {zh} 视频渲染块由管理类持有，页面销毁前需先取下，否则会被页面一起删除
+	// {en} Video blocks are owned by the manager, so detach them before a page is destroyed or it would delete them
+	void detachVideoWidgets() {
+		for (auto& video : videocall::VideoCallManager::getVideoList()) {
+			video->setParent(nullptr);
+		}
+	}
+
+	/** {zh}
+	 * 远端音量回调从SDK线程进入，经 ForwardEvent 回到主线程、更新 DataMgr 并发出 sigOnAudioVolumeUpdate
+	 */
+
+	/** {en}
+	* A remote volume report enters on the SDK thread, comes back through a ForwardEvent, updates DataMgr
+	* and emits sigOnAudioVolumeUpdate
+	*/
+	void audioVolumeUpdate(State& state) {
+		initVideoCall();
+		auto count = static_cast<int>(state.range(0));
+		videocall::DataMgr::instance().setUsers(makeUsers(count));
+
+		std::vector<std::string> ids(count);
+		std::vector<bytertc::RemoteAudioPropertiesInfo> infos(count);
+		for (int i = 0; i < count; ++i) {
+			ids[i] = benchUserId(i);
+			infos[i].stream_key.room_id = kRoomId;
+			infos[i].stream_key.user_id = ids[i].c_str();
+			infos[i].stream_key.stream_index = bytertc::kStreamIndexMain;
+			infos[i].audio_properties_info.linear_volume = (i * 37) % 256;
+		}
+
+		int64_t updates = 0;
+		auto connection = QObject::connect(&VideoCallRtcEngineWrap::instance(),
+			&VideoCallRtcEngineWrap::sigOnAudioVolumeUpdate, [&updates] { ++updates; });
+		while (state.keepRunning()) {
+			RtcEngineWrap::instance().onRemoteAudioPropertiesReport(infos.data(), count, 255);
+			QCoreApplication::sendPostedEvents();
+		}
+		QObject::disconnect(connection);
+		if (updates != state.iterations()) {
+			state.skipWithError("not every volume report reached sigOnAudioVolumeUpdate");
+			return;
+		}
+		state.setItemsProcessed(state.iterations() * count);
+	}
+
+	void dataMgrUsersCopy(State& state) {
+		videocall::DataMgr::instance().setUsers(makeUsers(static_cast<int>(state.range(0))));
+		while (state.keepRunning()) {
+			auto users = videocall::DataMgr::instance().users();
+			vrd::bench::doNotOptimize(users);
+		}
+		state.setItemsProcessed(state.iterations() * state.range(0));
+	}
+
+	void dataMgrUsersRef(State& state) {
+		videocall::DataMgr::instance().setUsers(makeUsers(static_cast<int>(state.range(0))));
+		while (state.keepRunning()) {
+			auto& users = videocall::DataMgr::instance().ref_users();
+			vrd::bench::doNotOptimize(users);
+		}
+		state.setItemsProcessed(state.iterations() * state.range(0));
+	}
+
+	void dataMgrRemoteStreamInfosCopy(State& state) {
+		std::vector<videocall::StreamInfo> infos(static_cast<size_t>(state.range(0)));
+		for (size_t i = 0; i < infos.size(); ++i) {
+			infos[i].user_id = benchUserId(static_cast<int>(i));
+			infos[i].user_name = "bench user name " + std::to_string(i);
+		}
+		videocall::DataMgr::instance().setRemoteStreamInfos(std::move(infos));
+		while (state.keepRunning()) {
+			auto copy = videocall::DataMgr::instance().remote_stream_infos();
+			vrd::bench::doNotOptimize(copy);
+		}
+		state.setItemsProcessed(state.iterations() * state.range(0));
+	}
+
+	/** {zh}
+	 * 网格视图重新排布：join 为一人加入后从 n-1 块变为 n 块，forced 为人数不变的强制刷新
+	 */
+
+	/** {en}
+	* Grid view relayout: join goes from n-1 to n tiles as when a user joins, forced refreshes with an unchanged count
+	*/
+	void normalViewShowWidget(State& state, bool join) {
+		initVideoCall();
+		auto count = static_cast<int>(state.range(0));
+		{
+			NormalVideoView view;
+			view.resize(1280, 720);
+			view.show();
+			view.showWidget(count, true);
+			QCoreApplication::sendPostedEvents();
+			while (state.keepRunning()) {
+				if (join) {
+					view.showWidget(count - 1);
+					view.showWidget(count);
+				}
+				else {
+					view.showWidget(count, true);
+				}
+				QCoreApplication::sendPostedEvents();
+			}
+			detachVideoWidgets();
+		}
+		state.setItemsProcessed(state.iterations());
+	}
+
+	/** {zh}
+	 * 12人时主页面的 updateVideoWidget：steady 数据不变，mic_toggle 每次有一人切换麦克风
+	 */
+
+	/** {en}
+	* The main page's updateVideoWidget with 12 users: steady keeps the data, mic_toggle flips one user's mic each time
+	*/
+	void mainPageUpdateVideoWidget(State& state, bool toggle_mic) {
+		initVideoCall();
+		videocall::DataMgr::instance().setUsers(makeUsers(videocall::kMaxShowWidgetNum));
+		{
+			VideoCallMainPage page;
+			page.resize(1280, 800);
+			page.show();
+			page.updateVideoWidget();
+			QCoreApplication::sendPostedEvents();
+			int64_t next = 0;
+			while (state.keepRunning()) {
+				if (toggle_mic) {
+					auto& user = videocall::DataMgr::instance().ref_users()[next++ % videocall::kMaxShowWidgetNum];
+					user.is_mic_on = !user.is_mic_on;
+				}
+				page.updateVideoWidget();
+				QCoreApplication::sendPostedEvents();
+			}
+			detachVideoWidgets();
+		}
+		state.setItemsProcessed(state.iterations() * videocall::kMaxShowWidgetNum);
+	}
+}
+
+VRD_BENCHMARK("VideoCall/audio_volume_update", audioVolumeUpdate)->arg(10)->arg(50)->arg(200);
+VRD_BENCHMARK("DataMgr/users/copy", dataMgrUsersCopy)->arg(12)->arg(200);
+VRD_BENCHMARK("DataMgr/users/ref", dataMgrUsersRef)->arg(12)->arg(200);
+VRD_BENCHMARK("DataMgr/remote_stream_infos/copy", dataMgrRemoteStreamInfosCopy)->arg(12);
+VRD_BENCHMARK("NormalVideoView/show_widget/join", [](State& state) { normalViewShowWidget(state, true); })
+	->denseRange(1, videocall::kMaxShowWidgetNum)->minTime(0.2);
+VRD_BENCHMARK("NormalVideoView/show_widget/forced", [](State& state) { normalViewShowWidget(state, false); })
+	->denseRange(1, videocall::kMaxShowWidgetNum)->minTime(0.2);
+VRD_BENCHMARK("VideoCallMainPage/update_video_widget/steady", [](State& state) { mainPageUpdateVideoWidget(state, false); })
+	->minTime(0.2);
+VRD_BENCHMARK("VideoCallMainPage/update_video_widget/mic_toggle", [](State& state) { mainPageUpdateVideoWidget(state, true); })
+	->minTime(0.2);
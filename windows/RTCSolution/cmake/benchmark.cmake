@@ -0,0 +1,11 @@
+# 微基准程序，在替身RTC引擎和无界面Qt上测量核心路径，结果输出为 Google Benchmark 格式的 JSON
+# Micro-benchmarks measuring core paths on the stand-in RTC engine under offscreen Qt,
+# results are emitted as Google Benchmark compatible JSON
+
+file(GLOB BENCHMARK_FILES
+	${PORJECT_ROOT_PATH}/benchmark/*.h
+	${PORJECT_ROOT_PATH}/benchmark/*.cc
+)
+
+add_executable(videocall_bench ${BENCHMARK_FILES})
+target_link_libraries(videocall_bench videocall_core)
@@ -0,0 +1,18 @@
+# 替身RTC引擎，实现 BytePlusRTC 的接口并模拟远端用户，用于在没有SDK二进制的平台上做基准和回归测试
+# Stand-in RTC engine implementing the BytePlusRTC interfaces with simulated remote users,
+# used for benchmarks and regression tests on platforms without the SDK binaries
+
+find_package(Threads REQUIRED)
+
+file(GLOB FAKE_RTC_FILES
+	${PORJECT_ROOT_PATH}/rtc_sdk/fake/*.h
+	${PORJECT_ROOT_PATH}/rtc_sdk/fake/*.cc
+)
+
+add_library(bytertc_fake STATIC ${FAKE_RTC_FILES})
+set_target_properties(bytertc_fake PROPERTIES AUTOMOC OFF AUTOUIC OFF AUTORCC OFF)
+target_include_directories(bytertc_fake PUBLIC
+	${PORJECT_ROOT_PATH}/rtc_sdk/BytePlusRTC/include
+	${PORJECT_ROOT_PATH}/rtc_sdk/fake
+)
+target_link_libraries(bytertc_fake PUBLIC Threads::Threads)
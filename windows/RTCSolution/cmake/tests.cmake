@@ -0,0 +1,20 @@
+# 单元测试，每个测试是一个以失败数为返回值的可执行程序，由 ctest 运行
+# Unit tests, each one an executable returning its failure count, run by ctest
+
+enable_testing()
+
+function(vrd_add_test name)
+  add_executable(${name} ${PORJECT_ROOT_PATH}/tests/${name}.cc ${ARGN})
+  target_include_directories(${name} PRIVATE ${PORJECT_ROOT_PATH})
+  add_test(NAME ${name} COMMAND ${name})
+endfunction()
+
+vrd_add_test(subscription_set_test ${PORJECT_ROOT_PATH}/core/subscription_set.cc)
+set_target_properties(subscription_set_test PROPERTIES AUTOMOC OFF AUTOUIC OFF AUTORCC OFF)
+target_link_libraries(subscription_set_test bytertc_fake)
+
+if(Qt5_FOUND)
+  vrd_add_test(rts_request_tracker_test ${PORJECT_ROOT_PATH}/core/rts_request_tracker.cc)
+  set_target_properties(rts_request_tracker_test PROPERTIES AUTOMOC OFF AUTOUIC OFF AUTORCC OFF)
+  target_link_libraries(rts_request_tracker_test Qt5::Core)
+endif()
@@ -1,4 +1,4 @@
-#include "configer.h"
+#include "Configer.h"
 #include <QSettings>
 #include <memory>
 #include <QApplication>
@@ -1,6 +1,10 @@
-#include "util.h"
+#include "Util.h"
 
+#ifdef _WIN32
 #include <windows.h>
+#else
+#include <fstream>
+#endif
 
 #include <QUrl>
 #include <algorithm>
@@ -97,6 +101,7 @@ QDateTime UTC2Local(const QString& utc_time) {
 }
 
 std::string GetDeviceID() {
+#ifdef _WIN32
   const char* data_Set = "SOFTWARE\\Microsoft\\Cryptography";
   HKEY hKEY = nullptr;
   std::string key = "MachineGuid";
@@ -127,6 +132,14 @@ std::string GetDeviceID() {
   }
 
   return deviceId;
+#else
+  // {zh} 基于systemd的Linux主机的机器ID
+  // {en} Machine id of systemd based Linux hosts
+  std::string deviceId;
+  std::ifstream file("/etc/machine-id");
+  std::getline(file, deviceId);
+  return deviceId;
+#endif
 }
 
 QString elideText(const QFont& font, const QString& str, int width) {
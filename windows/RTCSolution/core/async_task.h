@@ -0,0 +1,288 @@
+﻿#ifndef VRD_ASYNCTASK_H
+#define VRD_ASYNCTASK_H
+
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "timer_wheel.h"
+
+namespace vrd
+{
+	// {zh} 任务错误码，其余非0值由业务定义（如服务端返回码）
+	// {en} Task error codes, other non-zero values are defined by the business (such as server codes)
+	enum TaskError {
+		kTaskErrorCancelled = -100,
+		kTaskErrorTimeout = 408,
+	};
+
+	// {zh} 无返回值任务的结果类型
+	// {en} Result type of tasks without a value
+	struct TaskVoid {};
+
+	template <typename T>
+	struct TaskResult {
+		int code = 0;
+		T value = T();
+
+		bool ok() const { return code == 0; }
+	};
+
+	template <typename T> class Task;
+
+	namespace detail
+	{
+		template <typename R, typename Enable = void> struct TaskOf;
+	}
+
+	/** {zh}
+	 * 轻量的Promise/Future任务，用于串联异步会话流程
+	 * 1, then 在成功时继续，失败和取消向后传递；always 无论结果都会继续
+	 * 2, withTimeout 基于共享时间轮，超时后以 kTaskErrorTimeout 结束并取消源任务
+	 * 3, cancel 以 kTaskErrorCancelled 结束任务，并执行 onCancel 注册的清理，沿链向上游传递
+	 * 只能在主线程完成任务（其他线程请先用 ForwardEvent 切回主线程），后续回调同步执行
+	 */
+
+	/** {en}
+	* Lightweight promise/future task for chaining asynchronous session flows
+	* 1, then continues on success and forwards failures and cancellation; always continues whatever the result
+	* 2, withTimeout runs on the shared timer wheel, ending with kTaskErrorTimeout and cancelling the source
+	* 3, cancel ends the task with kTaskErrorCancelled, runs the onCancel cleanups and propagates upstream
+	* Tasks must be settled on the main thread (post with ForwardEvent from other threads), continuations run synchronously
+	*/
+	template <typename T>
+	class Task
+	{
+	public:
+		using Result = TaskResult<T>;
+
+		Task() : state_(std::make_shared<State>()) {}
+
+		static Task resolved(T value) {
+			Task task;
+			task.resolve(std::move(value));
+			return task;
+		}
+
+		static Task failed(int code) {
+			Task task;
+			task.reject(code);
+			return task;
+		}
+
+		void resolve(T value) {
+			Result result;
+			result.value = std::move(value);
+			settle(result);
+		}
+
+		void reject(int code) {
+			Result result;
+			result.code = code != 0 ? code : kTaskErrorCancelled;
+			settle(result);
+		}
+
+		void settle(const Result& result) {
+			if (state_->settled) {
+				return;
+			}
+			state_->settled = true;
+			state_->result = result;
+			state_->on_cancel.clear();
+			auto continuations = std::move(state_->continuations);
+			state_->continuations.clear();
+			for (auto& continuation : continuations) {
+				continuation(state_->result);
+			}
+		}
+
+		void cancel() {
+			if (state_->settled) {
+				return;
+			}
+			auto hooks = std::move(state_->on_cancel);
+			state_->on_cancel.clear();
+			reject(kTaskErrorCancelled);
+			for (auto& hook : hooks) {
+				hook();
+			}
+		}
+
+		void onCancel(std::function<void(void)>&& hook) {
+			if (!state_->settled) {
+				state_->on_cancel.push_back(std::move(hook));
+			}
+		}
+
+		void onSettled(std::function<void(const Result&)>&& continuation) {
+			if (state_->settled) {
+				continuation(state_->result);
+				return;
+			}
+			state_->continuations.push_back(std::move(continuation));
+		}
+
+		bool isSettled() const { return state_->settled; }
+		const Result& result() const { return state_->result; }
+
+		template <typename F>
+		auto then(F f) -> typename detail::TaskOf<decltype(f(std::declval<const T&>()))>::type {
+			using Next = detail::TaskOf<decltype(f(std::declval<const T&>()))>;
+			typename Next::type next;
+			auto source = *this;
+			onSettled([next, f](const Result& result) mutable {
+				if (!result.ok()) {
+					next.reject(result.code);
+					return;
+				}
+				forward(Next::invoke(f, result.value), next);
+			});
+			next.onCancel([source]() mutable { source.cancel(); });
+			return next;
+		}
+
+		template <typename F>
+		auto always(F f) -> typename detail::TaskOf<decltype(f(std::declval<const Result&>()))>::type {
+			using Next = detail::TaskOf<decltype(f(std::declval<const Result&>()))>;
+			typename Next::type next;
+			auto source = *this;
+			onSettled([next, f](const Result& result) mutable {
+				forward(Next::invoke(f, result), next);
+			});
+			next.onCancel([source]() mutable { source.cancel(); });
+			return next;
+		}
+
+		Task withTimeout(int msec) const {
+			Task next;
+			auto source = *this;
+			auto timer = TimerWheel::instance().schedule(msec, [next, source]() mutable {
+				if (!next.isSettled()) {
+					next.reject(kTaskErrorTimeout);
+					source.cancel();
+				}
+			});
+			source.onSettled([next, timer](const Result& result) mutable {
+				TimerWheel::instance().cancel(timer);
+				next.settle(result);
+			});
+			next.onCancel([source, timer]() mutable {
+				TimerWheel::instance().cancel(timer);
+				source.cancel();
+			});
+			return next;
+		}
+
+	private:
+		struct State {
+			bool settled = false;
+			Result result;
+			std::vector<std::function<void(const Result&)>> continuations;
+			std::vector<std::function<void(void)>> on_cancel;
+		};
+
+		template <typename U>
+		static void forward(Task<U> inner, Task<U> next) {
+			inner.onSettled([next](const TaskResult<U>& result) mutable {
+				next.settle(result);
+			});
+			next.onCancel([inner]() mutable { inner.cancel(); });
+		}
+
+		template <typename U> friend class Task;
+
+		std::shared_ptr<State> state_;
+	};
+
+	namespace detail
+	{
+		template <typename R, typename Enable>
+		struct TaskOf {
+			using type = Task<R>;
+			template <typename F, typename A>
+			static type invoke(F& f, A&& arg) { return type::resolved(f(std::forward<A>(arg))); }
+		};
+
+		template <typename Enable>
+		struct TaskOf<void, Enable> {
+			using type = Task<TaskVoid>;
+			template <typename F, typename A>
+			static type invoke(F& f, A&& arg) {
+				f(std::forward<A>(arg));
+				return type::resolved(TaskVoid());
+			}
+		};
+
+		template <typename U, typename Enable>
+		struct TaskOf<Task<U>, Enable> {
+			using type = Task<U>;
+			template <typename F, typename A>
+			static type invoke(F& f, A&& arg) { return f(std::forward<A>(arg)); }
+		};
+	}
+
+	/** {zh}
+	 * 等待全部任务成功；任一失败时立即以该错误结束，并取消其余任务
+	 */
+
+	/** {en}
+	* Wait for all tasks to succeed; the first failure ends the result with its code and cancels the rest
+	*/
+	template <typename T>
+	Task<std::vector<T>> whenAll(const std::vector<Task<T>>& tasks) {
+		Task<std::vector<T>> all;
+		if (tasks.empty()) {
+			all.resolve(std::vector<T>());
+			return all;
+		}
+		struct Progress {
+			std::vector<T> values;
+			size_t remaining;
+		};
+		auto progress = std::make_shared<Progress>();
+		progress->values.resize(tasks.size());
+		progress->remaining = tasks.size();
+		for (size_t i = 0; i < tasks.size(); ++i) {
+			auto task = tasks[i];
+			task.onSettled([all, tasks, progress, i](const TaskResult<T>& result) mutable {
+				if (all.isSettled()) {
+					return;
+				}
+				if (!result.ok()) {
+					all.reject(result.code);
+					for (auto other : tasks) {
+						other.cancel();
+					}
+					return;
+				}
+				progress->values[i] = result.value;
+				if (--progress->remaining == 0) {
+					all.resolve(std::move(progress->values));
+				}
+			});
+		}
+		all.onCancel([tasks]() {
+			for (auto task : tasks) {
+				task.cancel();
+			}
+		});
+		return all;
+	}
+
+	// {zh} 在主线程事件循环上延迟指定时间后完成
+	// {en} Settles after the given delay on the main thread event loop
+	inline Task<TaskVoid> delay(int msec) {
+		Task<TaskVoid> task;
+		auto timer = TimerWheel::instance().schedule(msec, [task]() mutable {
+			task.resolve(TaskVoid());
+		});
+		task.onCancel([timer]() {
+			TimerWheel::instance().cancel(timer);
+		});
+		return task;
+	}
+}
+
+#endif // VRD_ASYNCTASK_H
@@ -0,0 +1,438 @@
+﻿#include "audio_level_meter.h"
+#include "Configer.h"
+
+#include <QString>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VRD_AUDIO_LEVEL_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace vrd
+{
+	namespace
+	{
+		const int kDefaultIntervalMs = 50;
+		const int kMinIntervalMs = 20;
+		const int kMaxIntervalMs = 100;
+		// {zh} 约340毫秒的48kHz单声道，足够覆盖最长分析间隔的双声道数据
+		// {en} About 340 ms of 48 kHz mono, enough for stereo over the longest analysis interval
+		const size_t kRingSamples = 16384;
+		const int64_t kStreamIdleMs = 1000;
+		const int64_t kRefreshMs = 250;
+		const unsigned int kVolumeStep = 8;
+
+		// {zh} 能量超过噪声底 kVoiceMarginDb 且高于 kVoiceMinDb 视为人声，之后保持 kHangoverMs
+		// {en} Energy kVoiceMarginDb above the noise floor and above kVoiceMinDb counts as voice, held for kHangoverMs after
+		const float kVoiceMarginDb = 12.0f;
+		const float kVoiceMinDb = -50.0f;
+		const int64_t kHangoverMs = 300;
+		// {zh} 噪声底随时下降，上升速度受限，持续说话时不会很快把人声当成噪声
+		// {en} The noise floor drops at once but rises slowly, so continuous speech is not soon taken for noise
+		const float kNoiseRiseDbPerSecond = 2.0f;
+		// {zh} 噪声底的初值上限，流开始时就在说话也能判出人声
+		// {en} Upper bound of the initial noise floor, so voice is detected when a stream starts mid-speech
+		const float kInitialNoiseFloorDb = -60.0f;
+
+		size_t roundUpPowerOfTwo(size_t value) {
+			size_t result = 1;
+			while (result < value) {
+				result <<= 1;
+			}
+			return result;
+		}
+	}
+
+	SampleRing::SampleRing(size_t capacity)
+		: buffer_(roundUpPowerOfTwo(capacity)), mask_(buffer_.size() - 1) {
+	}
+
+	bool SampleRing::write(const int16_t* samples, size_t count) {
+		auto head = head_.load(std::memory_order_relaxed);
+		auto tail = tail_.load(std::memory_order_acquire);
+		if (count > buffer_.size() - (head - tail)) {
+			return false;
+		}
+		auto start = head & mask_;
+		auto first = std::min(count, buffer_.size() - start);
+		memcpy(buffer_.data() + start, samples, first * sizeof(int16_t));
+		memcpy(buffer_.data(), samples + first, (count - first) * sizeof(int16_t));
+		head_.store(head + count, std::memory_order_release);
+		return true;
+	}
+
+	void SampleRing::reset() {
+		head_.store(0, std::memory_order_relaxed);
+		tail_.store(0, std::memory_order_relaxed);
+	}
+
+	AudioLevelMeter::Slot::Slot() : ring(kRingSamples) {
+	}
+
+	AudioLevelMeter& AudioLevelMeter::instance() {
+		static AudioLevelMeter meter;
+		return meter;
+	}
+
+	AudioLevelMeter::AudioLevelMeter() {
+		for (int i = 0; i <= kMaxRemoteStreams; ++i) {
+			slots_.emplace_back(new Slot);
+		}
+		resetSlots();
+	}
+
+	AudioLevelMeter::~AudioLevelMeter() {
+		stop();
+	}
+
+	bool AudioLevelMeter::start() {
+		if (thread_.joinable()) {
+			return true;
+		}
+		auto setting = Configer::instance().getData("perf/audio_level_interval_ms");
+		auto interval = setting.empty() ? kDefaultIntervalMs : QString::fromStdString(setting).toInt();
+		if (interval <= 0) {
+			return false;
+		}
+		interval_ms_ = std::max(kMinIntervalMs, std::min(kMaxIntervalMs, interval));
+
+		resetSlots();
+		auto& engine = RtcEngineWrap::instance();
+		if (engine.registerAudioFrameObserver(this) != 0) {
+			return false;
+		}
+		bytertc::AudioFormat record{ bytertc::kAudioSampleRate48000, bytertc::kAudioChannelMono };
+		engine.enableAudioFrameCallback(bytertc::AudioFrameCallbackMethod::kAudioFrameCallbackRecord, record);
+		// {zh} 远端流回调要求格式为 auto
+		// {en} Remote stream callbacks require the auto format
+		bytertc::AudioFormat remote{ bytertc::kAudioSampleRateAuto, bytertc::kAudioChannelAuto };
+		engine.enableAudioFrameCallback(bytertc::AudioFrameCallbackMethod::kAudioFrameCallbackRemoteUser, remote);
+
+		stopping_ = false;
+		last_publish_ms_ = 0;
+		thread_ = std::thread([this]() { run(); });
+		return true;
+	}
+
+	void AudioLevelMeter::stop() {
+		if (!thread_.joinable()) {
+			return;
+		}
+		auto& engine = RtcEngineWrap::instance();
+		engine.disableAudioFrameCallback(bytertc::AudioFrameCallbackMethod::kAudioFrameCallbackRecord);
+		engine.disableAudioFrameCallback(bytertc::AudioFrameCallbackMethod::kAudioFrameCallbackRemoteUser);
+		engine.registerAudioFrameObserver(nullptr);
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stopping_ = true;
+		}
+		wakeup_.notify_all();
+		thread_.join();
+
+		// {zh} 清空主线程上的电平，停止后不再显示说话状态
+		// {en} Clear the levels on the main thread so no one shows as speaking after the stop
+		auto& wrap = RtcEngineWrap::instance();
+		ForwardEvent::PostEvent(&wrap, [&wrap]() {
+			emit wrap.sigOnAudioLevelIndication(std::vector<AudioVolumeInfoWrap>(), std::vector<AudioVolumeInfoWrap>());
+		});
+	}
+
+	bool AudioLevelMeter::running() const {
+		return thread_.joinable();
+	}
+
+	int AudioLevelMeter::intervalMs() const {
+		return interval_ms_;
+	}
+
+	uint64_t AudioLevelMeter::droppedFrames() const {
+		return dropped_frames_;
+	}
+
+	void AudioLevelMeter::measure(const int16_t* samples, size_t count, Measure& result) {
+		size_t i = 0;
+		uint64_t sum = 0;
+		int high = 0;
+		int low = 0;
+#if defined(VRD_AUDIO_LEVEL_SSE2)
+		if (count >= 8) {
+			auto zero = _mm_setzero_si128();
+			auto sums = zero;
+			auto highs = zero;
+			auto lows = zero;
+			for (; i + 8 <= count; i += 8) {
+				auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+				// {zh} 相邻两样本的平方和最大为2^31，按无符号32位扩展到64位再累加
+				// {en} The sum of squares of two neighbouring samples is at most 2^31, so widen it as unsigned 32 bit to 64 bit
+				auto squares = _mm_madd_epi16(x, x);
+				sums = _mm_add_epi64(sums, _mm_unpacklo_epi32(squares, zero));
+				sums = _mm_add_epi64(sums, _mm_unpackhi_epi32(squares, zero));
+				highs = _mm_max_epi16(highs, x);
+				lows = _mm_min_epi16(lows, x);
+			}
+			uint64_t lanes[2];
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), sums);
+			sum = lanes[0] + lanes[1];
+			int16_t high_lanes[8];
+			int16_t low_lanes[8];
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(high_lanes), highs);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(low_lanes), lows);
+			for (int lane = 0; lane < 8; ++lane) {
+				high = std::max(high, static_cast<int>(high_lanes[lane]));
+				low = std::min(low, static_cast<int>(low_lanes[lane]));
+			}
+		}
+#endif
+		for (; i < count; ++i) {
+			int value = samples[i];
+			sum += static_cast<uint64_t>(value * value);
+			high = std::max(high, value);
+			low = std::min(low, value);
+		}
+		result.sum_squares += sum;
+		result.peak = std::max(result.peak, std::max(high, -low));
+		result.count += count;
+	}
+
+	bool AudioLevelMeter::process(int64_t now_ms, std::vector<AudioVolumeInfoWrap>& local,
+		std::vector<AudioVolumeInfoWrap>& remote) {
+		bool changed = false;
+		for (size_t i = 0; i < slots_.size(); ++i) {
+			auto& slot = *slots_[i];
+			if (slot.state.load(std::memory_order_acquire) != kSlotActive) {
+				continue;
+			}
+			Measure total;
+			slot.ring.drain([&total](const int16_t* samples, size_t count) { measure(samples, count, total); });
+			if (total.count > 0) {
+				analyze(slot, total, now_ms);
+			}
+			else if (now_ms - slot.last_frame_ms.load(std::memory_order_relaxed) > kStreamIdleMs) {
+				// {zh} 不看 has_floor：认领后一直没有可用PCM16样本的远端槽也要回收，否则会逐渐占满所有槽
+				// {en} Regardless of has_floor: a remote slot that never got usable PCM16 samples after being claimed
+				// {en} must be recycled too, or such slots slowly use up every slot
+				changed = changed || slot.published;
+				// {zh} 本地槽常驻，只清除电平
+				// {en} The local slot stays, only its level is cleared
+				if (i == 0) {
+					slot.has_floor = false;
+					slot.voice = false;
+					slot.published = false;
+				}
+				else {
+					retire(slot);
+				}
+				continue;
+			}
+			if (!slot.has_floor) {
+				continue;
+			}
+			auto delta = slot.volume > slot.published_volume ? slot.volume - slot.published_volume
+				: slot.published_volume - slot.volume;
+			if (!slot.published || slot.voice != slot.published_voice || delta >= kVolumeStep) {
+				changed = true;
+			}
+		}
+		if (!changed && now_ms - last_publish_ms_ < kRefreshMs) {
+			return false;
+		}
+
+		for (size_t i = 0; i < slots_.size(); ++i) {
+			auto& slot = *slots_[i];
+			if (slot.state.load(std::memory_order_acquire) != kSlotActive || !slot.has_floor) {
+				continue;
+			}
+			AudioVolumeInfoWrap info{ slot.volume, slot.stream_index, slot.user_id, slot.room_id, slot.voice ? 1 : 0 };
+			(i == 0 ? local : remote).push_back(std::move(info));
+			slot.published = true;
+			slot.published_volume = slot.volume;
+			slot.published_voice = slot.voice;
+		}
+		last_publish_ms_ = now_ms;
+		return true;
+	}
+
+	void AudioLevelMeter::analyze(Slot& slot, const Measure& measure, int64_t now_ms) {
+		auto mean_square = static_cast<double>(measure.sum_squares) / static_cast<double>(measure.count);
+		auto level_db = static_cast<float>(10.0 * std::log10(std::max(mean_square, 1.0) / (32768.0 * 32768.0)));
+		if (!slot.has_floor) {
+			slot.noise_floor_db = std::min(level_db, kInitialNoiseFloorDb);
+			slot.has_floor = true;
+		}
+		else if (level_db < slot.noise_floor_db) {
+			slot.noise_floor_db = level_db;
+		}
+		else {
+			slot.noise_floor_db = std::min(level_db, slot.noise_floor_db + kNoiseRiseDbPerSecond * interval_ms_ / 1000.0f);
+		}
+		if (level_db > kVoiceMinDb && level_db > slot.noise_floor_db + kVoiceMarginDb) {
+			slot.voice_until_ms = now_ms + kHangoverMs;
+		}
+		slot.voice = now_ms < slot.voice_until_ms;
+		// {zh} 与SDK的 linear_volume 同为 0~255
+		// {en} 0~255 like the SDK's linear_volume
+		slot.volume = static_cast<unsigned int>(std::min(measure.peak, 32767) * 255 / 32767);
+	}
+
+	void AudioLevelMeter::retire(Slot& slot) {
+		int expected = kSlotActive;
+		if (!slot.state.compare_exchange_strong(expected, kSlotRetiring)) {
+			return;
+		}
+		// {zh} 等待已确认该槽的生产者写完
+		// {en} Wait for a producer that has already confirmed the slot to finish writing
+		while (slot.writing.load()) {
+			std::this_thread::yield();
+		}
+		slot.key_hash.store(0, std::memory_order_relaxed);
+		slot.ring.reset();
+		slot.has_floor = false;
+		slot.voice = false;
+		slot.voice_until_ms = 0;
+		slot.published = false;
+		slot.state.store(kSlotFree);
+	}
+
+	void AudioLevelMeter::resetSlots() {
+		for (size_t i = 0; i < slots_.size(); ++i) {
+			auto& slot = *slots_[i];
+			slot.ring.reset();
+			slot.writing = false;
+			slot.last_frame_ms = 0;
+			slot.key_hash = 0;
+			slot.room_id.clear();
+			slot.user_id.clear();
+			slot.stream_index = bytertc::kStreamIndexMain;
+			slot.has_floor = false;
+			slot.voice = false;
+			slot.voice_until_ms = 0;
+			slot.published = false;
+			slot.state = i == 0 ? kSlotActive : kSlotFree;
+		}
+	}
+
+	void AudioLevelMeter::run() {
+		std::vector<AudioVolumeInfoWrap> local;
+		std::vector<AudioVolumeInfoWrap> remote;
+		auto due = std::chrono::steady_clock::now();
+		std::unique_lock<std::mutex> lock(mutex_);
+		for (;;) {
+			due += std::chrono::milliseconds(interval_ms_);
+			if (wakeup_.wait_until(lock, due, [this]() { return stopping_; })) {
+				return;
+			}
+			lock.unlock();
+			local.clear();
+			remote.clear();
+			if (process(nowMs(), local, remote)) {
+				auto& wrap = RtcEngineWrap::instance();
+				ForwardEvent::PostEvent(&wrap, [&wrap, local, remote]() {
+					emit wrap.sigOnAudioLevelIndication(local, remote);
+				});
+			}
+			lock.lock();
+		}
+	}
+
+	int64_t AudioLevelMeter::nowMs() {
+		return std::chrono::duration_cast<std::chrono::milliseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	uint64_t AudioLevelMeter::keyHash(const bytertc::RemoteStreamKey& key) {
+		// {zh} FNV-1a，0保留为空槽
+		// {en} FNV-1a, 0 is reserved for an empty slot
+		uint64_t hash = 14695981039346656037ull;
+		auto mix = [&hash](const char* text) {
+			for (auto p = text; p && *p; ++p) {
+				hash = (hash ^ static_cast<unsigned char>(*p)) * 1099511628211ull;
+			}
+			hash = (hash ^ 0xff) * 1099511628211ull;
+		};
+		mix(key.room_id);
+		mix(key.user_id);
+		hash ^= static_cast<uint64_t>(key.stream_index);
+		return hash == 0 ? 1 : hash;
+	}
+
+	bool AudioLevelMeter::matches(const Slot& slot, const bytertc::RemoteStreamKey& key) {
+		return slot.stream_index == key.stream_index
+			&& slot.user_id == (key.user_id ? key.user_id : "")
+			&& slot.room_id == (key.room_id ? key.room_id : "");
+	}
+
+	AudioLevelMeter::Slot* AudioLevelMeter::findRemote(const bytertc::RemoteStreamKey& key) {
+		auto hash = keyHash(key);
+		// {zh} 先比较哈希，命中后置写入标记再确认键；置位期间该槽不会被回收，键也不会改写
+		// {en} Compare hashes first, then set the writing flag and confirm the key; while it is set the slot is neither
+		// {en} recycled nor rewritten
+		for (size_t i = 1; i < slots_.size(); ++i) {
+			auto& slot = *slots_[i];
+			if (slot.key_hash.load(std::memory_order_relaxed) != hash) {
+				continue;
+			}
+			slot.writing.store(true);
+			if (slot.state.load() == kSlotActive && matches(slot, key)) {
+				return &slot;
+			}
+			slot.writing.store(false, std::memory_order_release);
+		}
+		for (size_t i = 1; i < slots_.size(); ++i) {
+			auto& slot = *slots_[i];
+			int expected = kSlotFree;
+			if (slot.state.load(std::memory_order_relaxed) != kSlotFree
+				|| !slot.state.compare_exchange_strong(expected, kSlotClaimed)) {
+				continue;
+			}
+			slot.room_id = key.room_id ? key.room_id : "";
+			slot.user_id = key.user_id ? key.user_id : "";
+			slot.stream_index = key.stream_index;
+			slot.key_hash.store(hash, std::memory_order_relaxed);
+			slot.last_frame_ms.store(nowMs(), std::memory_order_relaxed);
+			slot.writing.store(true);
+			slot.state.store(kSlotActive);
+			return &slot;
+		}
+		return nullptr;
+	}
+
+	void AudioLevelMeter::write(Slot& slot, const bytertc::IAudioFrame& frame) {
+		if (frame.frameType() != bytertc::kFrameTypePCM16) {
+			return;
+		}
+		auto samples = reinterpret_cast<const int16_t*>(frame.data());
+		auto count = static_cast<size_t>(frame.dataSize()) / sizeof(int16_t);
+		if (!slot.ring.write(samples, count)) {
+			++dropped_frames_;
+		}
+		slot.last_frame_ms.store(nowMs(), std::memory_order_relaxed);
+	}
+
+	void AudioLevelMeter::onRecordAudioFrameOriginal(const bytertc::IAudioFrame&) {
+	}
+
+	void AudioLevelMeter::onRecordAudioFrame(const bytertc::IAudioFrame& audio_frame) {
+		write(*slots_[0], audio_frame);
+	}
+
+	void AudioLevelMeter::onPlaybackAudioFrame(const bytertc::IAudioFrame&) {
+	}
+
+	void AudioLevelMeter::onRemoteUserAudioFrame(const bytertc::RemoteStreamKey& stream_info,
+		const bytertc::IAudioFrame& audio_frame) {
+		auto slot = findRemote(stream_info);
+		if (!slot) {
+			++dropped_frames_;
+			return;
+		}
+		write(*slot, audio_frame);
+		slot->writing.store(false, std::memory_order_release);
+	}
+
+	void AudioLevelMeter::onMixedAudioFrame(const bytertc::IAudioFrame&) {
+	}
+}
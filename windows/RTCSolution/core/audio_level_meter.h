@@ -0,0 +1,193 @@
+﻿#ifndef VRD_AUDIOLEVELMETER_H
+#define VRD_AUDIOLEVELMETER_H
+
+#include "rtc_engine_wrap.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vrd
+{
+	/** {zh}
+	 * 单生产者单消费者的PCM16环形缓冲，容量为2的幂
+	 * 生产者空间不足时整帧丢弃并返回 false，不覆盖未读数据，两端都不加锁不分配内存
+	 */
+
+	/** {en}
+	* Single-producer single-consumer PCM16 ring buffer with a power-of-two capacity
+	* When space runs out the producer drops the whole frame and returns false instead of overwriting unread data;
+	* neither side locks or allocates
+	*/
+	class SampleRing
+	{
+	public:
+		explicit SampleRing(size_t capacity);
+
+		bool write(const int16_t* samples, size_t count);
+		// {zh} 把所有可读样本以至多两段连续内存交给 fn(const int16_t*, size_t)
+		// {en} Hand every readable sample to fn(const int16_t*, size_t) as at most two contiguous spans
+		template <class Fn>
+		size_t drain(Fn&& fn) {
+			auto tail = tail_.load(std::memory_order_relaxed);
+			auto head = head_.load(std::memory_order_acquire);
+			auto count = head - tail;
+			if (count == 0) {
+				return 0;
+			}
+			auto start = tail & mask_;
+			auto first = std::min(count, buffer_.size() - start);
+			fn(buffer_.data() + start, first);
+			if (first < count) {
+				fn(buffer_.data(), count - first);
+			}
+			tail_.store(head, std::memory_order_release);
+			return count;
+		}
+		// {zh} 只在两端都不活动时调用
+		// {en} Only call while neither side is active
+		void reset();
+
+	private:
+		std::vector<int16_t> buffer_;
+		size_t mask_;
+		// {zh} 读写位置分处不同缓存行，避免两端线程互相失效
+		// {en} Read and write positions sit on separate cache lines so the two threads do not invalidate each other
+		char pad0_[64];
+		std::atomic<size_t> head_{ 0 };
+		char pad1_[64];
+		std::atomic<size_t> tail_{ 0 };
+		char pad2_[64];
+	};
+
+	/** {zh}
+	 * 本地音频电平分析，替代SDK按秒回调的音量，用于说话者高亮和音量指示
+	 * 1, 经 registerAudioFrameObserver 接收本地采集和每个远端流的PCM16帧，SDK音频线程只把样本复制进该流的 SampleRing
+	 * 2, 分析线程每 interval_ms 取出各流的新样本，计算RMS和峰值（x86用SSE2，其他平台为可向量化的循环），
+	 *    再以自适应噪声底的能量VAD判定是否有人声，带短暂拖尾避免字间闪烁
+	 * 3, 结果以 RtcEngineWrap::sigOnAudioLevelIndication 投递到主线程，只在人声状态、音量有明显变化或到刷新间隔时发送
+	 * 4, 超过1秒没有新帧的远端流被回收；同时最多跟踪 kMaxRemoteStreams 个远端流，多出的帧计入丢弃
+	 * 5, 配置项 perf/audio_level_interval_ms（默认50，范围20~100），设为0时不启用，仍使用SDK的音量回调
+	 */
+
+	/** {en}
+	* Local audio level analysis, replacing the SDK's once-a-second volume report for speaker highlight and volume meters
+	* 1, Receives PCM16 frames of local capture and every remote stream through registerAudioFrameObserver;
+	*    the SDK audio thread only copies samples into the stream's SampleRing
+	* 2, An analysis thread drains the new samples of every stream each interval_ms and computes RMS and peak
+	*    (SSE2 on x86, a vectorizable loop elsewhere), then an energy VAD with an adaptive noise floor decides on voice,
+	*    with a short hangover so it does not flicker between words
+	* 3, Results are posted to the main thread as RtcEngineWrap::sigOnAudioLevelIndication, only when voice state or volume
+	*    changes noticeably or the refresh interval has passed
+	* 4, Remote streams without a frame for a second are recycled; at most kMaxRemoteStreams remote streams are tracked,
+	*    frames beyond that count as dropped
+	* 5, Setting perf/audio_level_interval_ms (default 50, range 20~100), 0 disables it and the SDK volume report is used
+	*/
+	class AudioLevelMeter : public bytertc::IAudioFrameObserver
+	{
+	public:
+		static const int kMaxRemoteStreams = 32;
+
+		struct Measure {
+			uint64_t sum_squares = 0;
+			int peak = 0;
+			size_t count = 0;
+		};
+
+		static AudioLevelMeter& instance();
+
+		AudioLevelMeter();
+		~AudioLevelMeter();
+
+		// {zh} 在主线程、引擎创建后调用；未启用或引擎不存在时返回 false
+		// {en} Call on the main thread after the engine is created; returns false when disabled or without an engine
+		bool start();
+		void stop();
+		bool running() const;
+		int intervalMs() const;
+		uint64_t droppedFrames() const;
+
+		// {zh} 累加一段样本的平方和与峰值
+		// {en} Accumulate the sum of squares and peak of a span of samples
+		static void measure(const int16_t* samples, size_t count, Measure& result);
+
+		// {zh} 一次分析，分析线程按间隔调用；需要通知时返回 true 并填充本地和远端电平。公开用于基准测试
+		// {en} One analysis pass, called by the analysis thread each interval; returns true with the local and remote
+		// {en} levels filled when they should be published. Public for benchmarks
+		bool process(int64_t now_ms, std::vector<AudioVolumeInfoWrap>& local, std::vector<AudioVolumeInfoWrap>& remote);
+
+		void onRecordAudioFrameOriginal(const bytertc::IAudioFrame& audio_frame) override;
+		void onRecordAudioFrame(const bytertc::IAudioFrame& audio_frame) override;
+		void onPlaybackAudioFrame(const bytertc::IAudioFrame& audio_frame) override;
+		void onRemoteUserAudioFrame(const bytertc::RemoteStreamKey& stream_info, const bytertc::IAudioFrame& audio_frame) override;
+		void onMixedAudioFrame(const bytertc::IAudioFrame& audio_frame) override;
+
+	private:
+		enum SlotState {
+			kSlotFree = 0,
+			kSlotClaimed,
+			kSlotActive,
+			kSlotRetiring,
+		};
+
+		struct Slot {
+			Slot();
+
+			SampleRing ring;
+			std::atomic<int> state{ kSlotFree };
+			// {zh} 生产者写入期间置位，回收方等它清零后才复用该槽
+			// {en} Set while the producer writes, the recycler waits for it to clear before reusing the slot
+			std::atomic<bool> writing{ false };
+			std::atomic<int64_t> last_frame_ms{ 0 };
+			// {zh} 键的哈希，生产者查找时先比较它，避免读取正在改写的字符串
+			// {en} Hash of the key, compared first by producers so they never read strings being rewritten
+			std::atomic<uint64_t> key_hash{ 0 };
+			// {zh} 在 kSlotClaimed 时写入，kSlotActive 期间不变
+			// {en} Written while kSlotClaimed, unchanged while kSlotActive
+			std::string room_id;
+			std::string user_id;
+			bytertc::StreamIndex stream_index = bytertc::kStreamIndexMain;
+
+			// {zh} 以下只在分析线程访问
+			// {en} The members below are only touched on the analysis thread
+			float noise_floor_db = 0;
+			bool has_floor = false;
+			int64_t voice_until_ms = 0;
+			unsigned int volume = 0;
+			bool voice = false;
+			unsigned int published_volume = 0;
+			bool published_voice = false;
+			bool published = false;
+		};
+
+		void write(Slot& slot, const bytertc::IAudioFrame& frame);
+		Slot* findRemote(const bytertc::RemoteStreamKey& key);
+		static uint64_t keyHash(const bytertc::RemoteStreamKey& key);
+		static bool matches(const Slot& slot, const bytertc::RemoteStreamKey& key);
+		void analyze(Slot& slot, const Measure& measure, int64_t now_ms);
+		void retire(Slot& slot);
+		void resetSlots();
+		void run();
+		static int64_t nowMs();
+
+		// {zh} 0号为本地采集，其余为远端流
+		// {en} Slot 0 is local capture, the rest are remote streams
+		std::vector<std::unique_ptr<Slot>> slots_;
+		std::atomic<uint64_t> dropped_frames_{ 0 };
+		int interval_ms_ = 50;
+		int64_t last_publish_ms_ = 0;
+
+		std::thread thread_;
+		std::mutex mutex_;
+		std::condition_variable wakeup_;
+		bool stopping_ = false;
+	};
+}
+
+#endif // VRD_AUDIOLEVELMETER_H
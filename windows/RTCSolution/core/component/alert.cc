@@ -1,7 +1,7 @@
-﻿#include "Alert.h"
+﻿#include "alert.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
-#include <QPushbutton>
+#include <QPushButton>
 
 namespace vrd
 {
@@ -33,6 +33,14 @@ void ShareViewContainer::addItem(const SnapshotAttr& item, QPixmap&& map) {
     ++item_count_;
 }
 
+void ShareViewContainer::setItemPixmap(int index, QPixmap&& map) {
+    if (index < 0 || index >= static_cast<int>(share_wnds_.size())) {
+        return;
+    }
+    share_wnds_[index].first->setPixMap(map);
+    share_wnds_[index].first->update();
+}
+
 void ShareViewContainer::clear() {
     for (auto& pair : share_wnds_) {
         lay_->removeWidget(pair.first);
@@ -12,6 +12,7 @@ class ShareViewContainer : public QWidget {
   ~ShareViewContainer();
 
   void addItem(const SnapshotAttr& item, QPixmap&& map);
+  void setItemPixmap(int index, QPixmap&& map);
   void clear();
  signals:
   void sigItemPressed(SnapshotAttr item);
@@ -1,6 +1,6 @@
 #include "share_view_wnd.h"
 #include <QPainter>
-#include "core/util.h"
+#include "core/Util.h"
 
 static constexpr int kBorderSize = 4;
 static constexpr int kViewWidth = 160;
@@ -1,5 +1,5 @@
 #include "videocell.h"
-#include <QVBoxlayout>
+#include <QVBoxLayout>
 #include <QSpacerItem>
 #include <QLabel>
 #include <QEvent>
@@ -196,7 +196,7 @@ bool Videocell::eventFilter(QObject* obj, QEvent* event)
 	}
 }
 
-HWND Videocell::GetView()
+WId Videocell::GetView()
 {
-	return (HWND)pPreview->winId();
+	return pPreview->winId();
 }
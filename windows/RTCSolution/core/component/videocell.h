@@ -31,7 +31,7 @@ public slots:
 	void RemoteSetAudioMute(bool mute);
 	void RemoteSetVideoMute(bool mute);
 	bool eventFilter(QObject* obj, QEvent* event);
-	HWND GetView();
+	WId GetView();
 
 private:
 	//VideoStatus m_video_status_;
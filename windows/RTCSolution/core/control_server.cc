@@ -0,0 +1,274 @@
+﻿#include "control_server.h"
+#include "application.h"
+#include "json_stream.h"
+#include "session_base.h"
+#include "stall_watchdog.h"
+#include "Configer.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QJsonArray>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+namespace vrd
+{
+	namespace
+	{
+		const char* const kSocketArgument = "--control-socket=";
+		// {zh} 没有换行的超长输入视为异常客户端，直接断开
+		// {en} An overlong input without a newline marks a misbehaving client, which is dropped
+		const qint64 kMaxLineBytes = 1 << 20;
+		const size_t kTopHandlers = 5;
+
+		QJsonObject message(const char* text) {
+			QJsonObject result;
+			result["message"] = text;
+			return result;
+		}
+	}
+
+	ControlServer& ControlServer::instance() {
+		static ControlServer server;
+		return server;
+	}
+
+	QString ControlServer::configuredName(const QStringList& arguments) {
+		for (auto& argument : arguments) {
+			if (argument.startsWith(kSocketArgument)) {
+				return argument.mid(static_cast<int>(strlen(kSocketArgument)));
+			}
+		}
+		return QString::fromStdString(Configer::instance().getData("perf/control_socket"));
+	}
+
+	int64_t ControlServer::nowMs() {
+		return QDateTime::currentMSecsSinceEpoch();
+	}
+
+	ControlServer::ControlServer() {
+		addCommand("ping", [](const QJsonObject&, const Reply& reply) {
+			QJsonObject result;
+			result["pid"] = static_cast<double>(QCoreApplication::applicationPid());
+			result["t_ms"] = static_cast<double>(nowMs());
+			reply(0, result);
+		});
+		addCommand("commands", [this](const QJsonObject&, const Reply& reply) {
+			std::vector<std::string> names;
+			for (auto& command : commands_) {
+				names.push_back(command.first);
+			}
+			std::sort(names.begin(), names.end());
+			QJsonArray list;
+			for (auto& name : names) {
+				list.append(QString::fromStdString(name));
+			}
+			QJsonObject result;
+			result["commands"] = list;
+			reply(0, result);
+		});
+		addCommand("metrics", [this](const QJsonObject&, const Reply& reply) {
+			reply(0, metrics());
+		});
+	}
+
+	bool ControlServer::start(const QString& name) {
+		if (server_) {
+			return server_->isListening();
+		}
+		server_ = new QLocalServer(this);
+		// {zh} 只允许当前用户连接
+		// {en} Only the current user may connect
+		server_->setSocketOptions(QLocalServer::UserAccessOption);
+		QLocalServer::removeServer(name);
+		if (!server_->listen(name)) {
+			qWarning() << "control server failed to listen on" << name << server_->errorString();
+			delete server_;
+			server_ = nullptr;
+			return false;
+		}
+		connect(server_, &QLocalServer::newConnection, this, [this] { onNewConnection(); });
+		qInfo() << "control server listening on" << server_->fullServerName();
+		return true;
+	}
+
+	void ControlServer::stop() {
+		for (auto& client : clients_) {
+			if (client) {
+				client->disconnect(this);
+				client->abort();
+				client->deleteLater();
+			}
+		}
+		clients_.clear();
+		if (server_) {
+			server_->close();
+			delete server_;
+			server_ = nullptr;
+		}
+	}
+
+	bool ControlServer::running() const {
+		return server_ != nullptr;
+	}
+
+	void ControlServer::addCommand(const std::string& name, Command&& command) {
+		commands_[name] = std::move(command);
+	}
+
+	void ControlServer::addMetrics(const std::string& name, Metrics&& metrics) {
+		metrics_.emplace_back(name, std::move(metrics));
+	}
+
+	void ControlServer::publish(const char* event, const QJsonObject& data) {
+		if (!server_) {
+			return;
+		}
+		clients_.erase(std::remove_if(clients_.begin(), clients_.end(),
+			[](const QPointer<QLocalSocket>& client) { return client.isNull(); }), clients_.end());
+		if (clients_.empty()) {
+			return;
+		}
+		std::string line;
+		JsonWriter writer(line);
+		writer.beginObject()
+			.key("event").value(event)
+			.key("t_ms").value(nowMs());
+		if (!data.isEmpty()) {
+			writer.key("data").value(data);
+		}
+		writer.endObject();
+		for (auto& client : clients_) {
+			send(client, line);
+		}
+	}
+
+	void ControlServer::onNewConnection() {
+		while (auto socket = server_->nextPendingConnection()) {
+			clients_.emplace_back(socket);
+			connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+			connect(socket, &QLocalSocket::readyRead, this, [this, socket] { onReadyRead(socket); });
+		}
+	}
+
+	void ControlServer::onReadyRead(QLocalSocket* socket) {
+		QPointer<QLocalSocket> client(socket);
+		while (client && client->canReadLine()) {
+			auto line = client->readLine().trimmed();
+			if (!line.isEmpty()) {
+				dispatch(client, line);
+			}
+		}
+		if (client && client->bytesAvailable() > kMaxLineBytes) {
+			qWarning() << "control client sent an overlong line, disconnecting";
+			client->abort();
+		}
+	}
+
+	void ControlServer::dispatch(QLocalSocket* socket, const QByteArray& line) {
+		auto request = parseJsonObject(line.constData(), static_cast<size_t>(line.size()));
+		auto id = request["id"];
+		auto name = request["cmd"].toString().toStdString();
+
+		QPointer<QLocalSocket> client(socket);
+		auto replied = std::make_shared<bool>(false);
+		Reply reply = [this, client, id, replied](int code, const QJsonObject& result) {
+			if (*replied) {
+				return;
+			}
+			*replied = true;
+			if (!client) {
+				return;
+			}
+			std::string out;
+			JsonWriter writer(out);
+			writer.beginObject().key("id").value(id).key("code").value(code);
+			if (!result.isEmpty()) {
+				writer.key("result").value(result);
+			}
+			writer.endObject();
+			send(client, out);
+		};
+
+		if (name.empty()) {
+			reply(kErrorBadRequest, message("missing cmd"));
+			return;
+		}
+		auto it = commands_.find(name);
+		if (it == commands_.end()) {
+			reply(kErrorUnknownCommand, message("unknown cmd"));
+			return;
+		}
+		it->second(request["args"].toObject(), reply);
+	}
+
+	void ControlServer::send(QLocalSocket* socket, const std::string& line) {
+		if (!socket || socket->state() != QLocalSocket::ConnectedState) {
+			return;
+		}
+		socket->write(line.data(), static_cast<qint64>(line.size()));
+		socket->write("\n", 1);
+	}
+
+	/** {zh}
+	 * 内置指标：主线程事件循环延迟、卡顿次数、耗时最多的处理函数，以及各RTS请求的往返时延
+	 */
+
+	/** {en}
+	* Built-in metrics: main-thread event-loop latency, stall count, the most expensive handlers and RTT per RTS request
+	*/
+	QJsonObject ControlServer::metrics() const {
+		QJsonObject result;
+		result["t_ms"] = static_cast<double>(nowMs());
+
+		auto& watchdog = StallWatchdog::instance();
+		auto& latency = watchdog.latency();
+		QJsonObject main_thread;
+		main_thread["latency_samples"] = static_cast<double>(latency.count);
+		main_thread["latency_p50_ms"] = static_cast<double>(latency.percentile(0.5));
+		main_thread["latency_p99_ms"] = static_cast<double>(latency.percentile(0.99));
+		main_thread["latency_max_ms"] = static_cast<double>(latency.max_ms);
+		main_thread["stalls"] = static_cast<double>(watchdog.stalls());
+		QJsonArray handlers;
+		for (auto& handler : watchdog.topHandlers(kTopHandlers)) {
+			QJsonObject item;
+			item["name"] = QString::fromStdString(handler.name);
+			item["count"] = static_cast<double>(handler.count);
+			item["total_us"] = static_cast<double>(handler.total_us);
+			item["max_us"] = static_cast<double>(handler.max_us);
+			item["over_budget"] = static_cast<double>(handler.over_budget);
+			handlers.append(item);
+		}
+		main_thread["handlers"] = handlers;
+		result["main_thread"] = main_thread;
+
+		auto session = VRD_FUNC_GET_COMPONET(SessionBase);
+		if (session) {
+			QJsonObject rts;
+			rts["in_flight"] = static_cast<double>(session->inFlightRequests());
+			QJsonObject events;
+			for (auto& item : session->requestStats()) {
+				auto& stats = item.second;
+				QJsonObject event;
+				event["count"] = static_cast<double>(stats.rtt.count);
+				event["rtt_p50_ms"] = static_cast<double>(stats.rtt.percentile(0.5));
+				event["rtt_p99_ms"] = static_cast<double>(stats.rtt.percentile(0.99));
+				event["rtt_max_ms"] = static_cast<double>(stats.rtt.max_ms);
+				event["timeouts"] = static_cast<double>(stats.timeouts);
+				event["retries"] = static_cast<double>(stats.retries);
+				events[QString::fromStdString(item.first)] = event;
+			}
+			rts["events"] = events;
+			result["rts"] = rts;
+		}
+
+		for (auto& module : metrics_) {
+			result[QString::fromStdString(module.first)] = module.second();
+		}
+		return result;
+	}
+}
@@ -0,0 +1,89 @@
+﻿#ifndef VRD_CONTROLSERVER_H
+#define VRD_CONTROLSERVER_H
+
+#include <QJsonObject>
+#include <QObject>
+#include <QPointer>
+#include <QStringList>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class QLocalServer;
+class QLocalSocket;
+
+namespace vrd
+{
+	/** {zh}
+	 * 本地自动化控制服务，供压测脚本在不点击界面的情况下驱动应用
+	 * 1, 默认关闭；命令行 --control-socket=<名称> 或配置 perf/control_socket 指定本地套接字名后开启
+	 * 2, 每行一个JSON请求 {"id":1,"cmd":"join","args":{...}}，回复 {"id":1,"code":0,"result":{...}}，code非0表示失败
+	 * 3, 服务主动推送的事件为 {"event":"first_remote_video_frame","t_ms":...,"data":{...}}，t_ms 为系统时间毫秒
+	 * 4, 命令由各模块注册，映射到已有的业务入口；内置 ping、commands 和 metrics
+	 * 仅在主线程使用，命令可异步回复
+	 */
+
+	/** {en}
+	* Local automation control server, lets load-test scripts drive the app without clicking
+	* 1, Off by default; enabled by --control-socket=<name> on the command line or the perf/control_socket setting
+	* 2, One JSON request per line {"id":1,"cmd":"join","args":{...}}, answered with {"id":1,"code":0,"result":{...}};
+	*    a non-zero code is a failure
+	* 3, Pushed events look like {"event":"first_remote_video_frame","t_ms":...,"data":{...}}, t_ms is wall-clock milliseconds
+	* 4, Modules register commands mapped onto their existing entry points; ping, commands and metrics are built in
+	* Main thread only, commands may reply asynchronously
+	*/
+	class ControlServer : public QObject
+	{
+		Q_OBJECT
+
+	public:
+		enum Error {
+			kErrorUnknownCommand = -1,
+			kErrorBadRequest = -2,
+			// {zh} 当前状态下无法执行，例如未进房时切换视图
+			// {en} Not possible in the current state, such as switching views outside a call
+			kErrorUnavailable = -3,
+		};
+
+		// {zh} 每个请求恰好回复一次
+		// {en} Every request is answered exactly once
+		using Reply = std::function<void(int code, const QJsonObject& result)>;
+		using Command = std::function<void(const QJsonObject& args, const Reply& reply)>;
+		using Metrics = std::function<QJsonObject()>;
+
+		static ControlServer& instance();
+		// {zh} 未开启时返回空
+		// {en} Empty when not enabled
+		static QString configuredName(const QStringList& arguments);
+		static int64_t nowMs();
+
+		bool start(const QString& name);
+		void stop();
+		bool running() const;
+
+		void addCommand(const std::string& name, Command&& command);
+		// {zh} metrics 命令的结果中以 name 为键加入该模块的指标
+		// {en} Adds the module's metrics to the metrics command result under name
+		void addMetrics(const std::string& name, Metrics&& metrics);
+		void publish(const char* event, const QJsonObject& data = QJsonObject());
+
+	private:
+		ControlServer();
+
+		void onNewConnection();
+		void onReadyRead(QLocalSocket* socket);
+		void dispatch(QLocalSocket* socket, const QByteArray& line);
+		void send(QLocalSocket* socket, const std::string& line);
+		QJsonObject metrics() const;
+
+		QLocalServer* server_ = nullptr;
+		std::vector<QPointer<QLocalSocket>> clients_;
+		std::unordered_map<std::string, Command> commands_;
+		std::vector<std::pair<std::string, Metrics>> metrics_;
+	};
+}
+
+#endif // VRD_CONTROLSERVER_H
@@ -0,0 +1,220 @@
+﻿#include "device_registry.h"
+
+namespace vrd
+{
+	DeviceRegistry& DeviceRegistry::instance() {
+		static DeviceRegistry registry;
+		return registry;
+	}
+
+	void DeviceRegistry::attach(bytertc::IAudioDeviceManager* audio_manager,
+		bytertc::IVideoDeviceManager* video_manager) {
+		detach();
+		audio_manager_ = audio_manager;
+		video_manager_ = video_manager;
+	}
+
+	void DeviceRegistry::detach() {
+		audio_manager_ = nullptr;
+		video_manager_ = nullptr;
+		for (auto& table : tables_) {
+			table = Table();
+		}
+	}
+
+	void DeviceRegistry::devices(int device_type, std::vector<RtcDevice>& devices) {
+		devices.clear();
+		auto t = table(device_type);
+		if (!t) {
+			return;
+		}
+		devices.reserve(t->present);
+		for (auto& entry : t->entries) {
+			if (entry.present) {
+				devices.push_back(entry.device);
+			}
+		}
+	}
+
+	int DeviceRegistry::count(int device_type) {
+		auto t = table(device_type);
+		return t ? t->present : 0;
+	}
+
+	const RtcDevice* DeviceRegistry::find(int device_type, const std::string& device_id) {
+		auto t = table(device_type);
+		if (!t) {
+			return nullptr;
+		}
+		auto it = t->index_by_id.find(device_id);
+		if (it == t->index_by_id.end() || !t->entries[it->second].present) {
+			return nullptr;
+		}
+		return &t->entries[it->second].device;
+	}
+
+	const RtcDevice* DeviceRegistry::at(int device_type, int index) {
+		auto t = table(device_type);
+		if (!t || index < 0 || index >= static_cast<int>(t->entries.size()) || !t->entries[index].present) {
+			return nullptr;
+		}
+		return &t->entries[index].device;
+	}
+
+	std::string DeviceRegistry::currentId(int device_type) {
+		char device_id[bytertc::MAX_DEVICE_ID_LENGTH] = { 0 };
+		switch (device_type) {
+		case RtcDeviceTypeVideoCapture:
+			if (video_manager_) {
+				video_manager_->getVideoCaptureDevice(device_id);
+			}
+			break;
+		case RtcDeviceTypeAudioRecord:
+			if (audio_manager_) {
+				audio_manager_->getAudioCaptureDevice(device_id);
+			}
+			break;
+		case RtcDeviceTypeAudioPlayout:
+			if (audio_manager_) {
+				audio_manager_->getAudioPlaybackDevice(device_id);
+			}
+			break;
+		default:
+			break;
+		}
+		return device_id;
+	}
+
+	int DeviceRegistry::currentIndex(int device_type) {
+		if (auto device = find(device_type, currentId(device_type))) {
+			return device->index;
+		}
+		auto t = table(device_type);
+		if (t && device_type == RtcDeviceTypeVideoCapture) {
+			for (auto& entry : t->entries) {
+				if (entry.present) {
+					return entry.device.index;
+				}
+			}
+		}
+		return -1;
+	}
+
+	void DeviceRegistry::onAudioDeviceStateChanged(const std::string& device_id, bytertc::RTCAudioDeviceType type,
+		bytertc::MediaDeviceState state, bytertc::MediaDeviceError error) {
+		if (type == bytertc::kRTCAudioDeviceTypeCaptureDevice) {
+			apply(RtcDeviceTypeAudioRecord, device_id, state, error);
+		}
+		else if (type == bytertc::kRTCAudioDeviceTypeRenderDevice) {
+			apply(RtcDeviceTypeAudioPlayout, device_id, state, error);
+		}
+	}
+
+	void DeviceRegistry::onVideoDeviceStateChanged(const std::string& device_id, bytertc::RTCVideoDeviceType type,
+		bytertc::MediaDeviceState state, bytertc::MediaDeviceError error) {
+		if (type == bytertc::kRTCVideoDeviceTypeCaptureDevice) {
+			apply(RtcDeviceTypeVideoCapture, device_id, state, error);
+		}
+	}
+
+	DeviceRegistry::Table* DeviceRegistry::table(int device_type) {
+		if (device_type < 0 || device_type >= kDeviceTypeCount) {
+			return nullptr;
+		}
+		auto& t = tables_[device_type];
+		if (!t.loaded) {
+			enumerate(device_type, t);
+		}
+		return &t;
+	}
+
+	void DeviceRegistry::enumerate(int device_type, Table& table) {
+		bytertc::IDeviceCollection* collection = nullptr;
+		switch (device_type) {
+		case RtcDeviceTypeVideoCapture:
+			collection = video_manager_ ? video_manager_->enumerateVideoCaptureDevices() : nullptr;
+			break;
+		case RtcDeviceTypeAudioRecord:
+			collection = audio_manager_ ? audio_manager_->enumerateAudioCaptureDevices() : nullptr;
+			break;
+		case RtcDeviceTypeAudioPlayout:
+			collection = audio_manager_ ? audio_manager_->enumerateAudioPlaybackDevices() : nullptr;
+			break;
+		default:
+			break;
+		}
+		// {zh} 没有设备管理器时不标记为已加载，挂接后再枚举
+		// {en} Without a device manager the table stays unloaded and is enumerated once attached
+		if (!collection) {
+			return;
+		}
+		table.loaded = true;
+		char name[bytertc::MAX_DEVICE_ID_LENGTH];
+		char device_id[bytertc::MAX_DEVICE_ID_LENGTH];
+		int count = collection->getCount();
+		for (int i = 0; i < count; ++i) {
+			name[0] = '\0';
+			device_id[0] = '\0';
+			if (collection->getDevice(i, name, device_id) != 0) {
+				continue;
+			}
+			auto& entry = add(table, device_type, name, device_id);
+			if (!entry.present) {
+				entry.present = true;
+				++table.present;
+			}
+		}
+		collection->release();
+	}
+
+	DeviceRegistry::Entry& DeviceRegistry::add(Table& table, int device_type, const std::string& name,
+		const std::string& device_id) {
+		auto it = table.index_by_id.find(device_id);
+		if (it != table.index_by_id.end()) {
+			return table.entries[it->second];
+		}
+		auto index = static_cast<int>(table.entries.size());
+		table.index_by_id.emplace(device_id, index);
+		table.entries.emplace_back();
+		auto& entry = table.entries.back();
+		entry.device.name = name;
+		entry.device.device_id = device_id;
+		entry.device.type = device_type;
+		entry.device.index = index;
+		return entry;
+	}
+
+	void DeviceRegistry::apply(int device_type, const std::string& device_id, bytertc::MediaDeviceState state,
+		bytertc::MediaDeviceError error) {
+		auto& t = tables_[device_type];
+		DeviceChange change;
+		change.kind = state == bytertc::kMediaDeviceStateAdded ? DeviceChange::kAdded
+			: state == bytertc::kMediaDeviceStateRemoved ? DeviceChange::kRemoved : DeviceChange::kStateChanged;
+		change.device_type = device_type;
+		change.device_id = device_id;
+		change.state = state;
+		change.error = error;
+
+		// {zh} 尚未枚举过时直接枚举即得到变化后的设备表；只有插入未登记的设备才需要重新枚举
+		// {en} A table never enumerated already reflects the change once enumerated; otherwise only an unknown
+		// {en} device being plugged in needs enumerating again
+		if (!t.loaded || (change.kind == DeviceChange::kAdded && !t.index_by_id.count(device_id))) {
+			enumerate(device_type, t);
+		}
+
+		auto it = t.index_by_id.find(device_id);
+		if (it != t.index_by_id.end()) {
+			auto& entry = t.entries[it->second];
+			change.index = it->second;
+			if (change.kind == DeviceChange::kAdded && !entry.present) {
+				entry.present = true;
+				++t.present;
+			}
+			else if (change.kind == DeviceChange::kRemoved && entry.present) {
+				entry.present = false;
+				--t.present;
+			}
+		}
+		emit sigDeviceChanged(change);
+	}
+}
@@ -0,0 +1,115 @@
+﻿#ifndef VRD_DEVICEREGISTRY_H
+#define VRD_DEVICEREGISTRY_H
+
+#include "rtc_engine_wrap.h"
+#include <QObject>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace vrd
+{
+	struct DeviceChange {
+		enum Kind {
+			kAdded,
+			kRemoved,
+			kStateChanged,
+		};
+
+		Kind kind = kStateChanged;
+		// {zh} RtcDeviceTypeVideoCapture 等
+		// {en} RtcDeviceTypeVideoCapture and so on
+		int device_type = RtcDeviceTypeVideoCapture;
+		// {zh} 稳定序号，未登记的设备为-1
+		// {en} Stable index, -1 for a device that is not registered
+		int index = -1;
+		std::string device_id;
+		bytertc::MediaDeviceState state = bytertc::kMediaDeviceStateStarted;
+		bytertc::MediaDeviceError error = bytertc::kMediaDeviceErrorOK;
+	};
+
+	/** {zh}
+	 * 摄像头、麦克风和扬声器的设备表，替代每次弹出菜单或设备回调时的重新枚举
+	 * 1, 每类设备在首次查询时枚举一次，之后只按 onAudioDeviceStateChanged/onVideoDeviceStateChanged 增量更新
+	 * 2, 设备序号在设备表的生命周期内不变：拔出的设备保留位置并标记为不在位，重新插入时取回原序号，
+	 *    新设备追加在末尾，所以按序号切换设备不会因为热插拔选错
+	 * 3, 按设备ID查询为O(1)；插入未登记的设备时才重新枚举该类设备以取得名称
+	 * 4, 每次变化发出 sigDeviceChanged，携带类型化的 DeviceChange
+	 * 仅在主线程使用，由 RtcEngineWrap 在 initDevices/resetDevices 时挂接和清空
+	 */
+
+	/** {en}
+	* Registry of cameras, microphones and speakers, replacing re-enumeration on every popup or device callback
+	* 1, Each device type is enumerated once on the first query and then only updated with diffs from
+	*    onAudioDeviceStateChanged/onVideoDeviceStateChanged
+	* 2, Device indices are stable for the registry's lifetime: an unplugged device keeps its slot marked absent and
+	*    gets its index back when plugged in again, new devices are appended, so switching by index cannot pick
+	*    the wrong device after a hot-plug
+	* 3, Lookups by device id are O(1); a device type is only enumerated again when an unknown device is plugged in,
+	*    to learn its name
+	* 4, Every change emits sigDeviceChanged with a typed DeviceChange
+	* Main thread only, attached and cleared by RtcEngineWrap in initDevices/resetDevices
+	*/
+	class DeviceRegistry : public QObject
+	{
+		Q_OBJECT
+
+	public:
+		static DeviceRegistry& instance();
+
+		void attach(bytertc::IAudioDeviceManager* audio_manager, bytertc::IVideoDeviceManager* video_manager);
+		void detach();
+
+		// {zh} 在位的设备，按序号排列，RtcDevice::index 为稳定序号
+		// {en} Present devices in index order, RtcDevice::index is the stable index
+		void devices(int device_type, std::vector<RtcDevice>& devices);
+		int count(int device_type);
+		// {zh} 不在位或不存在时返回空
+		// {en} Null when absent or unknown
+		const RtcDevice* find(int device_type, const std::string& device_id);
+		const RtcDevice* at(int device_type, int index);
+		// {zh} SDK当前使用的设备；摄像头找不到时退回第一个在位的设备，其余返回-1
+		// {en} The device the SDK currently uses; cameras fall back to the first present device, other types return -1
+		std::string currentId(int device_type);
+		int currentIndex(int device_type);
+
+		void onAudioDeviceStateChanged(const std::string& device_id, bytertc::RTCAudioDeviceType type,
+			bytertc::MediaDeviceState state, bytertc::MediaDeviceError error);
+		void onVideoDeviceStateChanged(const std::string& device_id, bytertc::RTCVideoDeviceType type,
+			bytertc::MediaDeviceState state, bytertc::MediaDeviceError error);
+
+	signals:
+		void sigDeviceChanged(const vrd::DeviceChange& change);
+
+	private:
+		static const int kDeviceTypeCount = RtcDeviceTypeAudioPlayout + 1;
+
+		struct Entry {
+			RtcDevice device;
+			bool present = false;
+		};
+
+		struct Table {
+			bool loaded = false;
+			int present = 0;
+			std::vector<Entry> entries;
+			std::unordered_map<std::string, int> index_by_id;
+		};
+
+		DeviceRegistry() = default;
+
+		Table* table(int device_type);
+		// {zh} 枚举一类设备，把未登记的设备追加到表中
+		// {en} Enumerates one device type and appends the devices not registered yet
+		void enumerate(int device_type, Table& table);
+		Entry& add(Table& table, int device_type, const std::string& name, const std::string& device_id);
+		void apply(int device_type, const std::string& device_id, bytertc::MediaDeviceState state,
+			bytertc::MediaDeviceError error);
+
+		bytertc::IAudioDeviceManager* audio_manager_ = nullptr;
+		bytertc::IVideoDeviceManager* video_manager_ = nullptr;
+		Table tables_[kDeviceTypeCount];
+	};
+}
+
+#endif // VRD_DEVICEREGISTRY_H
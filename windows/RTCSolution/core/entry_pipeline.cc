@@ -0,0 +1,153 @@
+﻿#include "entry_pipeline.h"
+#include "trace_event.h"
+
+#include <QDebug>
+#include <algorithm>
+
+namespace vrd
+{
+EntryPipeline::EntryPipeline(const std::string& name) : name_(name) {
+}
+
+void EntryPipeline::add(const std::string& step, const std::vector<std::string>& deps, Action&& action) {
+	Step entry;
+	entry.name = step;
+	entry.action = std::move(action);
+	for (const auto& dep : deps) {
+		auto iter = std::find_if(steps_.begin(), steps_.end(), [&dep](const Step& other) {
+			return other.name == dep;
+		});
+		if (iter == steps_.end()) {
+			qWarning() << "EntryPipeline" << name_.c_str() << "unknown dependency:" << dep.c_str()
+				<< "of step:" << step.c_str();
+			continue;
+		}
+		entry.deps.push_back(static_cast<int>(iter - steps_.begin()));
+	}
+	steps_.push_back(std::move(entry));
+}
+
+void EntryPipeline::start(Finished&& finished) {
+	finished_ = std::move(finished);
+	clock_.start();
+	running_ = true;
+	schedule();
+}
+
+void EntryPipeline::cancel() {
+	if (!running_) {
+		return;
+	}
+	qDebug() << "EntryPipeline" << name_.c_str() << "cancelled after" << clock_.elapsed() << "ms";
+	running_ = false;
+	for (auto& step : steps_) {
+		if (step.state == State::kWaiting || step.state == State::kRunning) {
+			step.state = State::kSkipped;
+		}
+	}
+	finished_ = nullptr;
+}
+
+bool EntryPipeline::running() const {
+	return running_;
+}
+
+void EntryPipeline::mark(const std::string& milestone) const {
+	qDebug() << "EntryPipeline" << name_.c_str() << milestone.c_str() << "at" << clock_.elapsed() << "ms";
+	if (Tracer::enabled()) {
+		Tracer::instance().instant("entry", "milestone", milestone.data(), milestone.size());
+	}
+}
+
+void EntryPipeline::schedule() {
+	if (scheduling_) {
+		reschedule_ = true;
+		return;
+	}
+	scheduling_ = true;
+	std::weak_ptr<EntryPipeline> weak = shared_from_this();
+	do {
+		reschedule_ = false;
+		for (size_t i = 0; i < steps_.size() && running_; ++i) {
+			auto& step = steps_[i];
+			if (step.state != State::kWaiting) {
+				continue;
+			}
+			bool ready = std::all_of(step.deps.begin(), step.deps.end(), [this](int dep) {
+				return steps_[dep].state == State::kSucceeded;
+			});
+			if (!ready) {
+				continue;
+			}
+			step.state = State::kRunning;
+			step.start_ms = clock_.elapsed();
+			step.trace_start_us = Tracer::enabled() ? Tracer::now() : -1;
+			auto index = static_cast<int>(i);
+			auto action = step.action;
+			// {zh} 步骤可能同步完成，此时只标记需要再次调度
+			// {en} A step may complete synchronously, which only flags another scheduling pass
+			action([weak, index](int code) {
+				if (auto pipeline = weak.lock()) {
+					pipeline->onStepDone(index, code);
+				}
+			});
+		}
+	} while (reschedule_ && running_);
+	scheduling_ = false;
+
+	if (running_ && std::all_of(steps_.begin(), steps_.end(), [](const Step& step) {
+		return step.state == State::kSucceeded;
+	})) {
+		finish(0, std::string());
+	}
+}
+
+void EntryPipeline::onStepDone(int index, int code) {
+	if (!running_ || index < 0 || index >= static_cast<int>(steps_.size())
+		|| steps_[index].state != State::kRunning) {
+		return;
+	}
+	auto& step = steps_[index];
+	step.end_ms = clock_.elapsed();
+	if (step.trace_start_us >= 0 && Tracer::enabled()) {
+		Tracer::instance().complete("entry", "step", step.trace_start_us, Tracer::now() - step.trace_start_us,
+			step.name.data(), step.name.size());
+	}
+	if (code != 0) {
+		step.state = State::kFailed;
+		qWarning() << "EntryPipeline" << name_.c_str() << "step failed:" << step.name.c_str() << "code:" << code;
+		finish(code, step.name);
+		return;
+	}
+	step.state = State::kSucceeded;
+	schedule();
+}
+
+void EntryPipeline::finish(int code, const std::string& step) {
+	running_ = false;
+	for (auto& other : steps_) {
+		if (other.state == State::kWaiting || other.state == State::kRunning) {
+			other.state = State::kSkipped;
+		}
+	}
+	report();
+	auto finished = std::move(finished_);
+	finished_ = nullptr;
+	if (finished) {
+		finished(code, step);
+	}
+}
+
+void EntryPipeline::report() const {
+	qDebug() << "EntryPipeline" << name_.c_str() << "finished in" << clock_.elapsed() << "ms";
+	for (const auto& step : steps_) {
+		if (step.state == State::kSucceeded || step.state == State::kFailed) {
+			qDebug() << "  step" << step.name.c_str() << "start:" << step.start_ms << "ms, took:"
+				<< (step.end_ms - step.start_ms) << "ms" << (step.state == State::kFailed ? "(failed)" : "");
+		}
+		else {
+			qDebug() << "  step" << step.name.c_str() << "skipped";
+		}
+	}
+}
+}
@@ -0,0 +1,82 @@
+﻿#ifndef VRD_ENTRYPIPELINE_H
+#define VRD_ENTRYPIPELINE_H
+
+#include <QElapsedTimer>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace vrd
+{
+	/** {zh}
+	 * 场景进入流水线，按依赖关系调度各步骤
+	 * 1, 依赖全部成功的步骤立即开始，互不依赖的步骤（网络握手、引擎创建、设备初始化）并行进行
+	 * 2, 任一步骤失败或调用cancel后，尚未开始的步骤不再执行，迟到的完成通知被忽略
+	 * 3, 记录每个步骤的开始时间和耗时，结束时输出汇总
+	 * 只能在主线程使用
+	 */
+
+	/** {en}
+	* Scene entry pipeline that schedules steps by their dependencies
+	* 1, A step starts as soon as all its dependencies succeeded, so independent steps
+	*    (network handshakes, engine creation, device init) overlap
+	* 2, After a failure or cancel(), steps not yet started are skipped and late completions are ignored
+	* 3, Records the start time and duration of each step and logs a summary at the end
+	* Main thread only
+	*/
+	class EntryPipeline : public std::enable_shared_from_this<EntryPipeline>
+	{
+	public:
+		// {zh} 步骤完成时调用，code为0表示成功
+		// {en} Called when a step finishes, code 0 means success
+		using Done = std::function<void(int code)>;
+		using Action = std::function<void(Done done)>;
+		using Finished = std::function<void(int code, const std::string& step)>;
+
+		explicit EntryPipeline(const std::string& name);
+
+		void add(const std::string& step, const std::vector<std::string>& deps, Action&& action);
+		void start(Finished&& finished);
+		void cancel();
+		bool running() const;
+		// {zh} 记录一个相对流水线开始时间的里程碑，如首帧
+		// {en} Log a milestone relative to the pipeline start, such as a first frame
+		void mark(const std::string& milestone) const;
+
+	private:
+		enum class State {
+			kWaiting = 0,
+			kRunning,
+			kSucceeded,
+			kFailed,
+			kSkipped,
+		};
+
+		struct Step {
+			std::string name;
+			std::vector<int> deps;
+			Action action;
+			State state = State::kWaiting;
+			int64_t start_ms = 0;
+			int64_t end_ms = 0;
+			int64_t trace_start_us = -1;
+		};
+
+		void schedule();
+		void onStepDone(int index, int code);
+		void finish(int code, const std::string& step);
+		void report() const;
+
+		std::string name_;
+		std::vector<Step> steps_;
+		Finished finished_;
+		QElapsedTimer clock_;
+		bool running_ = false;
+		bool scheduling_ = false;
+		bool reschedule_ = false;
+	};
+}
+
+#endif // VRD_ENTRYPIPELINE_H
@@ -1,5 +1,6 @@
 ﻿#include "http.h"
-#include <QTimer>
+#include "core/trace_event.h"
+#include <QtCore/QCoreApplication>
 #include <QtCore/QMetaEnum>
 
 namespace {
@@ -17,29 +18,25 @@ HttpReply::HttpReply(const HttpRequestData& request, Http& http)
     reply_ = getNetworkReply(req_);
     setParent(reply_);
     initReplyConnections();
-    
-    timeout_timer_ = new QTimer(this);
-    timeout_timer_->setInterval(http_.getReadTimeout());
-    timeout_timer_->setSingleShot(true);
-    connect(timeout_timer_, &QTimer::timeout, this, &HttpReply::readTimeout);
-    timeout_timer_->start();
+    startTimeout();
+    if (vrd::Tracer::enabled()) {
+        trace_start_us_ = vrd::Tracer::now();
+    }
+}
+
+HttpReply::~HttpReply() {
+    stopTimeout();
 }
 
 QNetworkReply* HttpReply::getNetworkReply(const HttpRequestData& request) {
     QNetworkRequest req(request.url);
 
-    auto& headers = getDefaultRequestHeaders();
-    if (!request.headers.isEmpty()) headers = request.headers;
-
-    for (auto& it = headers.cbegin(); it != headers.cend(); ++it) {
+    auto headers = request.headers.isEmpty() ? getDefaultRequestHeaders() : request.headers;
+    for (auto it = headers.cbegin(); it != headers.cend(); ++it) {
         req.setRawHeader(it.key(), it.value());
     }
 
-    QNetworkAccessManager* manager = new QNetworkAccessManager();
-    manager->setRedirectPolicy(QNetworkRequest::NoLessSafeRedirectPolicy);
-    if (manager->networkAccessible() == QNetworkAccessManager::NotAccessible) {
-        manager->setNetworkAccessible(QNetworkAccessManager::Accessible);
-    }
+    auto manager = http_.networkManager();
 
     QNetworkReply* networkReply = nullptr;
     switch (request.operation) {
@@ -87,7 +84,13 @@ void HttpReply::emitError() {
 }
 
 void HttpReply::emitFinished() {
-    timeout_timer_->stop();
+    stopTimeout();
+    if (trace_start_us_ >= 0 && vrd::Tracer::enabled()) {
+        auto path = req_.url.path().toStdString();
+        vrd::Tracer::instance().complete("http", "request", trace_start_us_,
+            vrd::Tracer::now() - trace_start_us_, path.data(), path.size());
+        trace_start_us_ = -1;
+    }
     reply_->disconnect();
     emit finished(*this);
     reply_->deleteLater();
@@ -121,7 +124,7 @@ void HttpReply::replyError(QNetworkReply::NetworkError code) {
         setParent(reply_);
         initReplyConnections();
         retry_times_++;
-        timeout_timer_->start();
+        startTimeout();
     } else {
         emitError();
         return;
@@ -147,7 +150,29 @@ void HttpReply::readTimeout() {
     reply_ = getNetworkReply(req_);
     setParent(reply_);
     initReplyConnections();
-    timeout_timer_->start();
+    startTimeout();
+}
+
+/** {zh}
+ * 读超时挂在共享时间轮上，秒级超时不需要精确唤醒
+ */
+
+/** {en}
+* Read timeouts sit on the shared timer wheel, second-scale timeouts do not need precise wakeups
+*/
+void HttpReply::startTimeout() {
+    stopTimeout();
+    timeout_timer_ = vrd::TimerWheel::instance().schedule(http_.getReadTimeout(), [this]() {
+        timeout_timer_ = 0;
+        readTimeout();
+    }, vrd::TimerWheel::kCoarse);
+}
+
+void HttpReply::stopTimeout() {
+    if (timeout_timer_ != 0) {
+        vrd::TimerWheel::instance().cancel(timeout_timer_);
+        timeout_timer_ = 0;
+    }
 }
 
 int HttpReply::statusCode() const {
@@ -171,6 +196,26 @@ Http::Http()
     : read_timeout_(defaultReadTimeout),
     max_retries_(defaultMaxRetries) {}
 
+/** {zh}
+ * 所有请求共用一个 QNetworkAccessManager，连接和DNS缓存得以复用，也不会每个请求留下一个管理对象
+ * 挂在应用对象下，随应用退出销毁
+ */
+
+/** {en}
+* Every request shares one QNetworkAccessManager so connections and the DNS cache are reused,
+* and no manager is left behind per request; it is parented to the application and goes away with it
+*/
+QNetworkAccessManager* Http::networkManager() {
+    if (!manager_) {
+        manager_ = new QNetworkAccessManager(QCoreApplication::instance());
+        manager_->setRedirectPolicy(QNetworkRequest::NoLessSafeRedirectPolicy);
+    }
+    if (manager_->networkAccessible() == QNetworkAccessManager::NotAccessible) {
+        manager_->setNetworkAccessible(QNetworkAccessManager::Accessible);
+    }
+    return manager_;
+}
+
 void Http::setReadTimeout(int value) {
     read_timeout_ = value;
 }
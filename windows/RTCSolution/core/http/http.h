@@ -4,6 +4,7 @@
 #include <QNetworkReply>
 #include <QNetworkAccessManager>
 #include <QPointer>
+#include "core/timer_wheel.h"
 
 struct HttpRequestData {
     QUrl url;
@@ -18,6 +19,7 @@ class HttpReply : public QObject {
 
 public:
     HttpReply(const HttpRequestData& request, Http& http);
+    ~HttpReply();
     int statusCode() const;
     QString reasonPhrase() const;
     QByteArray body() const;
@@ -38,12 +40,15 @@ private:
     void initReplyConnections();
     void emitError();
     void emitFinished();
+    void startTimeout();
+    void stopTimeout();
 
     HttpRequestData req_;
     QPointer<QNetworkReply> reply_;
     QByteArray bytes_;
     Http& http_;
-    QTimer* timeout_timer_;
+    vrd::TimerWheel::TimerId timeout_timer_ = 0;
+    int64_t trace_start_us_ = -1;
     int retry_times_;
 };
 
@@ -69,7 +74,10 @@ public:
     HttpReply* get(const QUrl& url);
     HttpReply* post(const QUrl& url, const QByteArray& body, const QByteArray& contentType);
 
+    QNetworkAccessManager* networkManager();
+
 private:
+    QPointer<QNetworkAccessManager> manager_;
     int read_timeout_;
     int max_retries_;
 };
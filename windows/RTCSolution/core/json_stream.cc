@@ -0,0 +1,490 @@
+﻿#include "json_stream.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace vrd
+{
+JsonWriter::JsonWriter(std::string& out) : out_(out) {
+}
+
+JsonWriter& JsonWriter::beginObject() {
+	separator();
+	put('{');
+	first_.push_back(true);
+	return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+	put('}');
+	first_.pop_back();
+	return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+	separator();
+	put('[');
+	first_.push_back(true);
+	return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+	put(']');
+	first_.pop_back();
+	return *this;
+}
+
+JsonWriter& JsonWriter::key(const char* name) {
+	separator();
+	putString(name, std::strlen(name));
+	put(':');
+	after_key_ = true;
+	return *this;
+}
+
+JsonWriter& JsonWriter::beginStringValue() {
+	separator();
+	put('"');
+	in_string_value_ = true;
+	// {zh} 嵌套内容自成一个顶层，不继承外层的分隔状态
+	// {en} The nested content is its own top level and does not inherit the outer separator state
+	first_.push_back(true);
+	return *this;
+}
+
+JsonWriter& JsonWriter::endStringValue() {
+	first_.pop_back();
+	in_string_value_ = false;
+	put('"');
+	return *this;
+}
+
+JsonWriter& JsonWriter::value(const char* str) {
+	separator();
+	putString(str, std::strlen(str));
+	return *this;
+}
+
+JsonWriter& JsonWriter::value(const std::string& str) {
+	separator();
+	putString(str.data(), str.size());
+	return *this;
+}
+
+JsonWriter& JsonWriter::value(const QString& str) {
+	separator();
+	putString(str);
+	return *this;
+}
+
+JsonWriter& JsonWriter::value(bool b) {
+	separator();
+	b ? putRaw("true", 4) : putRaw("false", 5);
+	return *this;
+}
+
+JsonWriter& JsonWriter::value(int number) {
+	return value(static_cast<int64_t>(number));
+}
+
+JsonWriter& JsonWriter::value(int64_t number) {
+	separator();
+	char buf[24];
+	int len = std::snprintf(buf, sizeof(buf), "%lld", static_cast<long long>(number));
+	putRaw(buf, static_cast<size_t>(len));
+	return *this;
+}
+
+JsonWriter& JsonWriter::value(double number) {
+	if (std::floor(number) == number && std::fabs(number) <= 9007199254740992.0) {
+		return value(static_cast<int64_t>(number));
+	}
+	separator();
+	if (!std::isfinite(number)) {
+		putRaw("null", 4);
+		return *this;
+	}
+	char buf[32];
+	int len = std::snprintf(buf, sizeof(buf), "%.17g", number);
+	putRaw(buf, static_cast<size_t>(len));
+	return *this;
+}
+
+JsonWriter& JsonWriter::value(const QJsonValue& json) {
+	switch (json.type()) {
+	case QJsonValue::Bool:
+		return value(json.toBool());
+	case QJsonValue::Double:
+		return value(json.toDouble());
+	case QJsonValue::String:
+		return value(json.toString());
+	case QJsonValue::Array: {
+		beginArray();
+		const QJsonArray array = json.toArray();
+		for (const auto& item : array) {
+			value(item);
+		}
+		return endArray();
+	}
+	case QJsonValue::Object:
+		return value(json.toObject());
+	default:
+		separator();
+		putRaw("null", 4);
+		return *this;
+	}
+}
+
+JsonWriter& JsonWriter::value(const QJsonObject& object) {
+	beginObject();
+	for (auto iter = object.constBegin(); iter != object.constEnd(); ++iter) {
+		separator();
+		putString(iter.key());
+		put(':');
+		after_key_ = true;
+		value(iter.value());
+	}
+	return endObject();
+}
+
+void JsonWriter::separator() {
+	if (after_key_) {
+		after_key_ = false;
+		return;
+	}
+	if (!first_.empty()) {
+		if (!first_.back()) {
+			put(',');
+		}
+		first_.back() = false;
+	}
+}
+
+void JsonWriter::put(char c) {
+	// {zh} 处于字符串值内部时再做一层转义
+	// {en} Add one more level of escaping while inside a string value
+	if (in_string_value_ && (c == '"' || c == '\\')) {
+		out_.push_back('\\');
+	}
+	out_.push_back(c);
+}
+
+void JsonWriter::putRaw(const char* str, size_t size) {
+	if (!in_string_value_) {
+		out_.append(str, size);
+		return;
+	}
+	for (size_t i = 0; i < size; i++) {
+		put(str[i]);
+	}
+}
+
+void JsonWriter::putString(const char* str, size_t size) {
+	put('"');
+	for (size_t i = 0; i < size; i++) {
+		const unsigned char c = static_cast<unsigned char>(str[i]);
+		if (c == '"' || c == '\\' || c < 0x20) {
+			putEscaped(c);
+		}
+		else {
+			put(static_cast<char>(c));
+		}
+	}
+	put('"');
+}
+
+void JsonWriter::putString(const QString& str) {
+	put('"');
+	const ushort* utf16 = str.utf16();
+	const int size = str.size();
+	for (int i = 0; i < size; i++) {
+		uint32_t code_point = utf16[i];
+		if (code_point >= 0xd800 && code_point <= 0xdbff && i + 1 < size
+			&& utf16[i + 1] >= 0xdc00 && utf16[i + 1] <= 0xdfff) {
+			code_point = 0x10000 + ((code_point - 0xd800) << 10) + (utf16[i + 1] - 0xdc00);
+			i++;
+		}
+		if (code_point == '"' || code_point == '\\' || code_point < 0x20) {
+			putEscaped(code_point);
+		}
+		else if (code_point < 0x80) {
+			put(static_cast<char>(code_point));
+		}
+		else if (code_point < 0x800) {
+			put(static_cast<char>(0xc0 | (code_point >> 6)));
+			put(static_cast<char>(0x80 | (code_point & 0x3f)));
+		}
+		else if (code_point < 0x10000) {
+			put(static_cast<char>(0xe0 | (code_point >> 12)));
+			put(static_cast<char>(0x80 | ((code_point >> 6) & 0x3f)));
+			put(static_cast<char>(0x80 | (code_point & 0x3f)));
+		}
+		else {
+			put(static_cast<char>(0xf0 | (code_point >> 18)));
+			put(static_cast<char>(0x80 | ((code_point >> 12) & 0x3f)));
+			put(static_cast<char>(0x80 | ((code_point >> 6) & 0x3f)));
+			put(static_cast<char>(0x80 | (code_point & 0x3f)));
+		}
+	}
+	put('"');
+}
+
+void JsonWriter::putEscaped(uint32_t code_point) {
+	switch (code_point) {
+	case '"': putRaw("\\\"", 2); return;
+	case '\\': putRaw("\\\\", 2); return;
+	case '\n': putRaw("\\n", 2); return;
+	case '\r': putRaw("\\r", 2); return;
+	case '\t': putRaw("\\t", 2); return;
+	case '\b': putRaw("\\b", 2); return;
+	case '\f': putRaw("\\f", 2); return;
+	default: {
+		char buf[8];
+		int len = std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(code_point));
+		putRaw(buf, static_cast<size_t>(len));
+		return;
+	}
+	}
+}
+
+namespace
+{
+	class RouteScanner {
+	public:
+		RouteScanner(const char* json, size_t size) : cur_(json), end_(json + size) {}
+
+		bool scan(JsonRoute& route) {
+			skipSpace();
+			if (!consume('{')) {
+				return false;
+			}
+			skipSpace();
+			if (consume('}')) {
+				return true;
+			}
+			for (;;) {
+				std::string name;
+				skipSpace();
+				if (!readString(&name)) {
+					return false;
+				}
+				skipSpace();
+				if (!consume(':')) {
+					return false;
+				}
+				skipSpace();
+				std::string* target = nullptr;
+				if (name == "message_type") {
+					target = &route.message_type;
+				}
+				else if (name == "request_id") {
+					target = &route.request_id;
+				}
+				else if (name == "event") {
+					target = &route.event;
+				}
+				if (target && cur_ < end_ && *cur_ == '"') {
+					if (!readString(target)) {
+						return false;
+					}
+				}
+				else {
+					const char* begin = cur_;
+					if (!skipValue(0)) {
+						return false;
+					}
+					if (name == "data") {
+						route.data = begin;
+						route.data_size = static_cast<size_t>(cur_ - begin);
+					}
+				}
+				skipSpace();
+				if (consume('}')) {
+					return true;
+				}
+				if (!consume(',')) {
+					return false;
+				}
+			}
+		}
+
+	private:
+		void skipSpace() {
+			while (cur_ < end_ && (*cur_ == ' ' || *cur_ == '\n' || *cur_ == '\r' || *cur_ == '\t')) {
+				cur_++;
+			}
+		}
+
+		bool consume(char c) {
+			if (cur_ < end_ && *cur_ == c) {
+				cur_++;
+				return true;
+			}
+			return false;
+		}
+
+		bool readHex4(uint32_t& value) {
+			if (end_ - cur_ < 4) {
+				return false;
+			}
+			value = 0;
+			for (int i = 0; i < 4; i++) {
+				const char c = *cur_++;
+				value <<= 4;
+				if (c >= '0' && c <= '9') value |= c - '0';
+				else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+				else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+				else return false;
+			}
+			return true;
+		}
+
+		static void appendUtf8(std::string& out, uint32_t code_point) {
+			if (code_point < 0x80) {
+				out.push_back(static_cast<char>(code_point));
+			}
+			else if (code_point < 0x800) {
+				out.push_back(static_cast<char>(0xc0 | (code_point >> 6)));
+				out.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+			}
+			else if (code_point < 0x10000) {
+				out.push_back(static_cast<char>(0xe0 | (code_point >> 12)));
+				out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3f)));
+				out.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+			}
+			else {
+				out.push_back(static_cast<char>(0xf0 | (code_point >> 18)));
+				out.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3f)));
+				out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3f)));
+				out.push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+			}
+		}
+
+		// {zh} 读取字符串，out为空时只跳过
+		// {en} Read a string, or just skip it when out is null
+		bool readString(std::string* out) {
+			if (!consume('"')) {
+				return false;
+			}
+			while (cur_ < end_) {
+				const char c = *cur_++;
+				if (c == '"') {
+					return true;
+				}
+				if (c != '\\') {
+					if (out) {
+						out->push_back(c);
+					}
+					continue;
+				}
+				if (cur_ >= end_) {
+					return false;
+				}
+				const char escaped = *cur_++;
+				uint32_t code_point = 0;
+				switch (escaped) {
+				case '"': code_point = '"'; break;
+				case '\\': code_point = '\\'; break;
+				case '/': code_point = '/'; break;
+				case 'b': code_point = '\b'; break;
+				case 'f': code_point = '\f'; break;
+				case 'n': code_point = '\n'; break;
+				case 'r': code_point = '\r'; break;
+				case 't': code_point = '\t'; break;
+				case 'u': {
+					if (!readHex4(code_point)) {
+						return false;
+					}
+					uint32_t low = 0;
+					if (code_point >= 0xd800 && code_point <= 0xdbff && end_ - cur_ >= 6
+						&& cur_[0] == '\\' && cur_[1] == 'u') {
+						cur_ += 2;
+						if (!readHex4(low)) {
+							return false;
+						}
+						code_point = 0x10000 + ((code_point - 0xd800) << 10) + (low - 0xdc00);
+					}
+					break;
+				}
+				default:
+					return false;
+				}
+				if (out) {
+					appendUtf8(*out, code_point);
+				}
+			}
+			return false;
+		}
+
+		bool skipValue(int depth) {
+			if (depth > 64 || cur_ >= end_) {
+				return false;
+			}
+			const char c = *cur_;
+			if (c == '"') {
+				return readString(nullptr);
+			}
+			if (c == '{' || c == '[') {
+				const char close = c == '{' ? '}' : ']';
+				cur_++;
+				skipSpace();
+				if (consume(close)) {
+					return true;
+				}
+				for (;;) {
+					skipSpace();
+					if (c == '{') {
+						if (!readString(nullptr)) {
+							return false;
+						}
+						skipSpace();
+						if (!consume(':')) {
+							return false;
+						}
+						skipSpace();
+					}
+					if (!skipValue(depth + 1)) {
+						return false;
+					}
+					skipSpace();
+					if (consume(close)) {
+						return true;
+					}
+					if (!consume(',')) {
+						return false;
+					}
+				}
+			}
+			// {zh} 数字与true/false/null
+			// {en} Numbers and true/false/null
+			const char* begin = cur_;
+			while (cur_ < end_ && *cur_ != ',' && *cur_ != '}' && *cur_ != ']'
+				&& *cur_ != ' ' && *cur_ != '\n' && *cur_ != '\r' && *cur_ != '\t') {
+				cur_++;
+			}
+			return cur_ > begin;
+		}
+
+		const char* cur_;
+		const char* end_;
+	};
+}
+
+bool readJsonRoute(const char* json, size_t size, JsonRoute& route) {
+	if (!json) {
+		return false;
+	}
+	RouteScanner scanner(json, size);
+	return scanner.scan(route);
+}
+
+QJsonObject parseJsonObject(const char* json, size_t size) {
+	if (!json || size == 0) {
+		return QJsonObject();
+	}
+	return QJsonDocument::fromJson(QByteArray::fromRawData(json, static_cast<int>(size))).object();
+}
+}
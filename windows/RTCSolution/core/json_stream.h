@@ -0,0 +1,81 @@
+﻿#ifndef VRD_JSONSTREAM_H
+#define VRD_JSONSTREAM_H
+
+#include <QJsonObject>
+#include <QString>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace vrd
+{
+	/** {zh}
+	 * 流式JSON写入器，不构建DOM，直接追加到调用方提供的缓冲区
+	 * beginStringValue/endStringValue 之间写入的内容会作为一个JSON字符串值输出，
+	 * 用于一次性写出信令包中以字符串形式嵌套的content
+	 */
+
+	/** {en}
+	* Streaming JSON writer that appends straight into a caller-owned buffer without building a DOM
+	* Everything written between beginStringValue/endStringValue is emitted as one JSON string value,
+	* which lets the nested string-encoded content of an RTS envelope be written in the same pass
+	*/
+	class JsonWriter {
+	public:
+		explicit JsonWriter(std::string& out);
+
+		JsonWriter& beginObject();
+		JsonWriter& endObject();
+		JsonWriter& beginArray();
+		JsonWriter& endArray();
+		JsonWriter& key(const char* name);
+		JsonWriter& beginStringValue();
+		JsonWriter& endStringValue();
+
+		JsonWriter& value(const char* str);
+		JsonWriter& value(const std::string& str);
+		JsonWriter& value(const QString& str);
+		JsonWriter& value(bool b);
+		JsonWriter& value(int number);
+		JsonWriter& value(int64_t number);
+		JsonWriter& value(double number);
+		JsonWriter& value(const QJsonValue& json);
+		JsonWriter& value(const QJsonObject& object);
+
+	private:
+		void separator();
+		void put(char c);
+		void putRaw(const char* str, size_t size);
+		void putString(const char* str, size_t size);
+		void putString(const QString& str);
+		void putEscaped(uint32_t code_point);
+
+		std::string& out_;
+		// {zh} 每层容器是否还未写入元素
+		// {en} Whether each open container is still empty
+		std::vector<bool> first_;
+		bool after_key_ = false;
+		bool in_string_value_ = false;
+	};
+
+	/** {zh}
+	 * RTS信令路由信息，由SAX方式扫描顶层字段得到，data只记录原始字节区间，按需再解析
+	 */
+
+	/** {en}
+	* RTS routing fields, gathered by a SAX-style scan of the top level; data is kept as a raw byte span and parsed on demand
+	*/
+	struct JsonRoute {
+		std::string message_type;
+		std::string request_id;
+		std::string event;
+		const char* data = nullptr;
+		size_t data_size = 0;
+	};
+
+	bool readJsonRoute(const char* json, size_t size, JsonRoute& route);
+	QJsonObject parseJsonObject(const char* json, size_t size);
+}
+
+#endif // VRD_JSONSTREAM_H
@@ -0,0 +1,154 @@
+﻿#include "microphone_probe.h"
+#include "device_registry.h"
+#include "task_pool.h"
+
+namespace vrd
+{
+	MicrophoneProbe& MicrophoneProbe::instance() {
+		static MicrophoneProbe probe;
+		return probe;
+	}
+
+	void MicrophoneProbe::start(bytertc::IAudioDeviceManager* manager) {
+		stop();
+		manager_ = manager;
+		if (!manager_) {
+			return;
+		}
+		connect(&DeviceRegistry::instance(), &DeviceRegistry::sigDeviceChanged, this,
+			[this](const DeviceChange& change) { onDeviceChanged(change); });
+		probe();
+	}
+
+	void MicrophoneProbe::stop() {
+		DeviceRegistry::instance().disconnect(this);
+		if (auto job = std::move(job_)) {
+			std::unique_lock<std::mutex> lock(job->mutex);
+			job->cancelled = true;
+			job->finished.wait(lock, [&job] { return !job->running; });
+		}
+		++generation_;
+		manager_ = nullptr;
+		devices_.clear();
+		probing_ = false;
+		pending_ = false;
+		update();
+	}
+
+	void MicrophoneProbe::probe() {
+		if (!manager_) {
+			return;
+		}
+		if (probing_) {
+			pending_ = true;
+			return;
+		}
+		std::vector<RtcDevice> devices;
+		DeviceRegistry::instance().devices(RtcDeviceTypeAudioRecord, devices);
+		std::vector<std::string> unknown;
+		for (auto& device : devices) {
+			if (deviceCapability(device.device_id) == kUnknown) {
+				unknown.push_back(device.device_id);
+			}
+		}
+		if (unknown.empty()) {
+			update();
+			return;
+		}
+
+		probing_ = true;
+		auto manager = manager_;
+		auto generation = generation_;
+		job_ = std::make_shared<Job>();
+		auto job = job_;
+		// {zh} 设备管理器随引擎销毁，stop 会等待正在进行的探测返回，引擎销毁前须先调用 stop
+		// {en} The device manager dies with the engine; stop waits for a probe in progress,
+		// so it has to be called before the engine is destroyed
+		TaskPool::instance().submitThen(this, [manager, unknown, job]() {
+			Results results;
+			for (auto& device_id : unknown) {
+				{
+					std::lock_guard<std::mutex> lock(job->mutex);
+					if (job->cancelled) {
+						break;
+					}
+					job->running = true;
+				}
+				auto capable = manager->initAudioCaptureDeviceForTest(device_id.c_str()) == 0;
+				{
+					std::lock_guard<std::mutex> lock(job->mutex);
+					job->running = false;
+				}
+				job->finished.notify_all();
+				results.emplace_back(device_id, capable);
+			}
+			return results;
+		}, [this, generation](const Results& results) {
+			onProbed(generation, results);
+		}, TaskPool::kLow);
+	}
+
+	MicrophoneProbe::Capability MicrophoneProbe::capability() const {
+		return capability_;
+	}
+
+	MicrophoneProbe::Capability MicrophoneProbe::deviceCapability(const std::string& device_id) const {
+		auto it = devices_.find(device_id);
+		return it == devices_.end() ? kUnknown : it->second;
+	}
+
+	void MicrophoneProbe::onDeviceChanged(const DeviceChange& change) {
+		if (change.device_type != RtcDeviceTypeAudioRecord) {
+			return;
+		}
+		if (change.kind == DeviceChange::kRemoved) {
+			// {zh} 重新插入时再探测
+			// {en} Probed again when plugged back in
+			devices_.erase(change.device_id);
+			update();
+		}
+		else if (change.kind == DeviceChange::kAdded) {
+			update();
+			probe();
+		}
+	}
+
+	void MicrophoneProbe::onProbed(uint64_t generation, const Results& results) {
+		if (generation != generation_) {
+			return;
+		}
+		job_.reset();
+		probing_ = false;
+		for (auto& result : results) {
+			devices_[result.first] = result.second ? kCapable : kUnavailable;
+		}
+		update();
+		if (pending_) {
+			pending_ = false;
+			probe();
+		}
+	}
+
+	void MicrophoneProbe::update() {
+		auto capability = kUnknown;
+		if (manager_) {
+			std::vector<RtcDevice> devices;
+			DeviceRegistry::instance().devices(RtcDeviceTypeAudioRecord, devices);
+			capability = kUnavailable;
+			for (auto& device : devices) {
+				auto state = deviceCapability(device.device_id);
+				if (state == kCapable) {
+					capability = kCapable;
+					break;
+				}
+				if (state == kUnknown) {
+					capability = kUnknown;
+				}
+			}
+		}
+		if (capability != capability_) {
+			capability_ = capability;
+			emit sigCapabilityChanged(capability_);
+		}
+	}
+}
@@ -0,0 +1,95 @@
+﻿#ifndef VRD_MICROPHONEPROBE_H
+#define VRD_MICROPHONEPROBE_H
+
+#include "rtc_engine_wrap.h"
+#include <QObject>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace vrd
+{
+	struct DeviceChange;
+
+	/** {zh}
+	 * 麦克风可用性探测，替代每次打开麦克风时在主线程逐个调用 initAudioCaptureDeviceForTest
+	 * 1, 设备就绪时在线程池中探测一次所有麦克风，之后只在插入新麦克风时探测未知的设备，结果按设备ID缓存
+	 * 2, capability() 直接返回缓存的结论：任一在位麦克风可用即为 kCapable；
+	 *    仍有未探测完的设备且没有可用设备时为 kUnknown，调用方应按不可用处理而不是等待
+	 * 3, 结论变化时发出 sigCapabilityChanged
+	 * 仅在主线程调用，由 RtcEngineWrap 在 initDevices/resetDevices 时启动和停止
+	 */
+
+	/** {en}
+	* Microphone capability probe, replacing serial initAudioCaptureDeviceForTest calls on the main thread on every unmute
+	* 1, Once devices are ready every microphone is probed on the task pool; afterwards only unknown devices are probed
+	*    when a microphone is plugged in, and results are cached by device id
+	* 2, capability() answers from the cache: kCapable when any present microphone works; kUnknown while devices
+	*    are still unprobed and none is known to work, which callers treat as unavailable instead of waiting
+	* 3, sigCapabilityChanged is emitted when the answer changes
+	* Main thread only, started and stopped by RtcEngineWrap in initDevices/resetDevices
+	*/
+	class MicrophoneProbe : public QObject
+	{
+		Q_OBJECT
+
+	public:
+		enum Capability {
+			kUnknown = 0,
+			kCapable,
+			kUnavailable,
+		};
+
+		static MicrophoneProbe& instance();
+
+		void start(bytertc::IAudioDeviceManager* manager);
+		// {zh} 取消探测；线程池中正在调用设备管理器的探测会等它返回，之后引擎可以安全销毁
+		// {en} Cancels probing; a probe already calling into the device manager on the pool is waited for,
+		// after which the engine may be destroyed safely
+		void stop();
+		// {zh} 探测还没有结果的在位麦克风；已有探测在进行时合并到其完成之后
+		// {en} Probes the present microphones without a result; merged behind a probe already running
+		void probe();
+
+		Capability capability() const;
+		Capability deviceCapability(const std::string& device_id) const;
+
+	signals:
+		void sigCapabilityChanged(int capability);
+
+	private:
+		using Results = std::vector<std::pair<std::string, bool>>;
+
+		// {zh} 与线程池中的探测共享的状态
+		// {en} State shared with the probe running on the task pool
+		struct Job {
+			std::mutex mutex;
+			std::condition_variable finished;
+			bool cancelled = false;
+			bool running = false;
+		};
+
+		MicrophoneProbe() = default;
+
+		void onDeviceChanged(const DeviceChange& change);
+		void onProbed(uint64_t generation, const Results& results);
+		void update();
+
+		bytertc::IAudioDeviceManager* manager_ = nullptr;
+		std::shared_ptr<Job> job_;
+		std::unordered_map<std::string, Capability> devices_;
+		Capability capability_ = kUnknown;
+		bool probing_ = false;
+		bool pending_ = false;
+		// {zh} stop 后递增，丢弃之前发出的探测结果
+		// {en} Bumped by stop so results of earlier probes are dropped
+		uint64_t generation_ = 0;
+	};
+}
+
+#endif // VRD_MICROPHONEPROBE_H
@@ -0,0 +1,61 @@
+﻿#include "monitored_application.h"
+#include "stall_watchdog.h"
+#include "rtc_engine_wrap.h"
+#include "trace_event.h"
+
+#include <QThread>
+#include <typeinfo>
+
+namespace vrd
+{
+	namespace
+	{
+		const char* traceCategory(QEvent::Type type) {
+			switch (type) {
+			case QEvent::User:
+				return "bridge";
+			case QEvent::MetaCall:
+				return "slot";
+			case QEvent::Paint:
+				return "paint";
+			case QEvent::LayoutRequest:
+				return "layout";
+			default:
+				return nullptr;
+			}
+		}
+	}
+
+	MonitoredApplication::MonitoredApplication(int& argc, char** argv)
+		: QApplication(argc, argv) {
+	}
+
+	bool MonitoredApplication::notify(QObject* receiver, QEvent* event) {
+		if (QThread::currentThread() != thread()) {
+			return QApplication::notify(receiver, event);
+		}
+		// {zh} ForwardEvent 以其中任务的类型名标识，MSVC下包含投递它的函数名；其他事件以接收对象的类名标识
+		// {en} A ForwardEvent is named by its task's type, which includes the posting function under MSVC;
+		// other events are named by the receiver's class
+		const char* name = receiver->metaObject()->className();
+		if (event->type() == QEvent::User) {
+			auto forward = dynamic_cast<ForwardEvent*>(event);
+			if (forward != nullptr && forward->label_ != nullptr) {
+				name = forward->label_;
+			}
+			else if (forward != nullptr && forward->task_) {
+				name = forward->task_.target_type().name();
+			}
+		}
+		auto category = Tracer::enabled() ? traceCategory(event->type()) : nullptr;
+		auto traceStart = category ? Tracer::now() : -1;
+		auto& watchdog = StallWatchdog::instance();
+		watchdog.beginHandler(name, event->type());
+		auto handled = QApplication::notify(receiver, event);
+		watchdog.endHandler();
+		if (traceStart >= 0) {
+			Tracer::instance().complete(category, name, traceStart, Tracer::now() - traceStart);
+		}
+		return handled;
+	}
+}
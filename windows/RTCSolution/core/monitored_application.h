@@ -0,0 +1,24 @@
+﻿#ifndef VRD_MONITOREDAPPLICATION_H
+#define VRD_MONITOREDAPPLICATION_H
+
+#include <QApplication>
+
+namespace vrd
+{
+	/** {zh}
+	 * 对主线程的每个事件分发计时，交给 StallWatchdog 按处理函数统计
+	 */
+
+	/** {en}
+	* Times every event dispatched on the main thread and hands it to StallWatchdog for per-handler stats
+	*/
+	class MonitoredApplication : public QApplication
+	{
+	public:
+		MonitoredApplication(int& argc, char** argv);
+
+		bool notify(QObject* receiver, QEvent* event) override;
+	};
+}
+
+#endif // VRD_MONITOREDAPPLICATION_H
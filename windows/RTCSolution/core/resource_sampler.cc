@@ -0,0 +1,402 @@
+﻿#include "resource_sampler.h"
+#include "json_stream.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QObject>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#include <tlhelp32.h>
+#elif defined(__linux__)
+#include <dirent.h>
+#include <unistd.h>
+#include <cstdio>
+#endif
+
+// {zh} Qt 导出的调试钩子表，定义见 qhooks_p.h，GammaRay 等工具也通过它跟踪对象
+// {en} Qt's exported debugging hook table, see qhooks_p.h; tools like GammaRay track objects through it as well
+QT_BEGIN_NAMESPACE
+extern quintptr Q_CORE_EXPORT qtHookData[];
+QT_END_NAMESPACE
+
+namespace vrd
+{
+	namespace
+	{
+		const int kHookAddQObject = 3;
+		const int kHookRemoveQObject = 4;
+		const size_t kMaxSuspects = 10;
+		const double kMsPerHour = 3600.0 * 1000.0;
+
+		using ObjectHook = void (*)(QObject*);
+
+		struct ObjectCensus {
+			std::mutex mutex;
+			std::unordered_set<QObject*> live;
+			ObjectHook next_add = nullptr;
+			ObjectHook next_remove = nullptr;
+			bool installed = false;
+		};
+
+		// {zh} 不析构，进程退出时仍可能有对象销毁并调用钩子
+		// {en} Never destroyed, objects may still be deleted and call the hooks during process exit
+		ObjectCensus& census() {
+			static auto instance = new ObjectCensus;
+			return *instance;
+		}
+
+		void onAddObject(QObject* object) {
+			auto& c = census();
+			{
+				std::lock_guard<std::mutex> lock(c.mutex);
+				c.live.insert(object);
+			}
+			if (c.next_add) {
+				c.next_add(object);
+			}
+		}
+
+		void onRemoveObject(QObject* object) {
+			auto& c = census();
+			{
+				std::lock_guard<std::mutex> lock(c.mutex);
+				c.live.erase(object);
+			}
+			if (c.next_remove) {
+				c.next_remove(object);
+			}
+		}
+
+		// {zh} 删除对象的钩子需要同一把锁，持锁期间对象内存不会被释放；析构中的对象已退回 QObject 的元对象
+		// {en} The remove hook needs the same lock, so no object is freed while it is held;
+		// an object mid-destruction reports QObject's meta object
+		void countObjects(std::map<std::string, double>& values) {
+			auto& c = census();
+			std::unordered_map<const char*, int> by_class;
+			size_t total = 0;
+			{
+				std::lock_guard<std::mutex> lock(c.mutex);
+				total = c.live.size();
+				for (auto object : c.live) {
+					++by_class[object->metaObject()->className()];
+				}
+			}
+			values[ResourceSampler::kObjects] = static_cast<double>(total);
+			for (auto& item : by_class) {
+				values[std::string(ResourceSampler::kObjectPrefix) + item.first] = item.second;
+			}
+		}
+
+#ifdef __linux__
+		int countDirectory(const char* path) {
+			auto dir = opendir(path);
+			if (dir == nullptr) {
+				return -1;
+			}
+			int count = 0;
+			while (auto entry = readdir(dir)) {
+				if (entry->d_name[0] != '.') {
+					++count;
+				}
+			}
+			closedir(dir);
+			return count;
+		}
+#endif
+
+		struct Fit {
+			double per_hour = 0.0;
+			double first = 0.0;
+			double last = 0.0;
+		};
+
+		// {zh} 最小二乘斜率，另取前后各四分之一的均值，避免单次尖峰被当成持续增长
+		// {en} Least-squares slope, plus the means of the first and last quarters so a single spike is not taken for growth
+		Fit fitSeries(const std::vector<double>& x, const std::vector<double>& y) {
+			Fit fit;
+			auto n = x.size();
+			double mean_x = 0.0;
+			double mean_y = 0.0;
+			for (size_t i = 0; i < n; ++i) {
+				mean_x += x[i];
+				mean_y += y[i];
+			}
+			mean_x /= n;
+			mean_y /= n;
+			double sxy = 0.0;
+			double sxx = 0.0;
+			for (size_t i = 0; i < n; ++i) {
+				sxy += (x[i] - mean_x) * (y[i] - mean_y);
+				sxx += (x[i] - mean_x) * (x[i] - mean_x);
+			}
+			fit.per_hour = sxx > 0.0 ? sxy / sxx : 0.0;
+
+			auto quarter = std::max<size_t>(1, n / 4);
+			for (size_t i = 0; i < quarter; ++i) {
+				fit.first += y[i];
+				fit.last += y[n - quarter + i];
+			}
+			fit.first /= quarter;
+			fit.last /= quarter;
+			return fit;
+		}
+
+		void writeGrowth(JsonWriter& writer, const ResourceSampler::Growth& growth) {
+			writer.beginObject()
+				.key("name").value(growth.series)
+				.key("per_hour").value(growth.per_hour)
+				.key("first").value(growth.first)
+				.key("last").value(growth.last);
+			if (std::isfinite(growth.threshold)) {
+				writer.key("threshold").value(growth.threshold);
+			}
+			writer.key("leaking").value(growth.leaking).endObject();
+		}
+	}
+
+	void ResourceSampler::installObjectCensus() {
+		auto& c = census();
+		std::lock_guard<std::mutex> lock(c.mutex);
+		if (c.installed) {
+			return;
+		}
+		c.next_add = reinterpret_cast<ObjectHook>(qtHookData[kHookAddQObject]);
+		c.next_remove = reinterpret_cast<ObjectHook>(qtHookData[kHookRemoveQObject]);
+		qtHookData[kHookAddQObject] = reinterpret_cast<quintptr>(&onAddObject);
+		qtHookData[kHookRemoveQObject] = reinterpret_cast<quintptr>(&onRemoveObject);
+		c.installed = true;
+	}
+
+	bool ResourceSampler::objectCensusInstalled() {
+		auto& c = census();
+		std::lock_guard<std::mutex> lock(c.mutex);
+		return c.installed;
+	}
+
+	ResourceSampler::ResourceSampler() {
+		clock_.start();
+	}
+
+	void ResourceSampler::addGauge(const std::string& name, std::function<double()>&& gauge) {
+		gauges_.emplace_back(name, std::move(gauge));
+	}
+
+	void ResourceSampler::addSubsystemGauge(const std::string& name, std::function<double()>&& gauge) {
+		subsystems_.insert(name);
+		addGauge(name, std::move(gauge));
+	}
+
+	void ResourceSampler::setThreshold(const std::string& prefix, double per_hour) {
+		thresholds_[prefix] = per_hour;
+	}
+
+	void ResourceSampler::sample() {
+		Sample sample;
+		sample.elapsed_ms = clock_.elapsed();
+		readProcess(sample.values);
+		if (objectCensusInstalled()) {
+			countObjects(sample.values);
+		}
+		for (auto& gauge : gauges_) {
+			sample.values[gauge.first] = gauge.second();
+		}
+		samples_.push_back(std::move(sample));
+	}
+
+	const std::vector<ResourceSampler::Sample>& ResourceSampler::samples() const {
+		return samples_;
+	}
+
+	double ResourceSampler::threshold(const std::string& series) const {
+		auto result = std::numeric_limits<double>::infinity();
+		size_t matched = 0;
+		for (auto& item : thresholds_) {
+			if (item.first.size() >= matched && series.compare(0, item.first.size(), item.first) == 0) {
+				matched = item.first.size();
+				result = item.second;
+			}
+		}
+		return result;
+	}
+
+	bool ResourceSampler::isSource(const std::string& series) const {
+		return series.compare(0, strlen(kObjectPrefix), kObjectPrefix) == 0 || subsystems_.count(series) > 0;
+	}
+
+	ResourceSampler::Report ResourceSampler::analyze(int64_t warmup_ms) const {
+		Report report;
+		report.warmup_ms = warmup_ms;
+		if (!samples_.empty()) {
+			report.duration_ms = samples_.back().elapsed_ms;
+		}
+
+		std::vector<const Sample*> window;
+		std::set<std::string> names;
+		for (auto& sample : samples_) {
+			if (sample.elapsed_ms < warmup_ms) {
+				continue;
+			}
+			window.push_back(&sample);
+			for (auto& value : sample.values) {
+				names.insert(value.first);
+			}
+		}
+		report.samples = window.size();
+		// {zh} 样本太少时斜率没有意义，不做判定
+		// {en} The slope means nothing with too few samples, so nothing is judged
+		if (window.size() < 8) {
+			qWarning() << "resource sampler: only" << window.size() << "samples after warm-up, growth not analyzed";
+			return report;
+		}
+
+		std::vector<double> x(window.size());
+		std::vector<double> y(window.size());
+		for (size_t i = 0; i < window.size(); ++i) {
+			x[i] = window[i]->elapsed_ms / kMsPerHour;
+		}
+		for (auto& name : names) {
+			// {zh} 某类对象全部销毁后该序列不再出现，按0计
+			// {en} A class disappears from the samples once all its objects are gone, which counts as 0
+			for (size_t i = 0; i < window.size(); ++i) {
+				auto it = window[i]->values.find(name);
+				y[i] = it == window[i]->values.end() ? 0.0 : it->second;
+			}
+			auto fit = fitSeries(x, y);
+			Growth growth;
+			growth.series = name;
+			growth.per_hour = fit.per_hour;
+			growth.first = fit.first;
+			growth.last = fit.last;
+			growth.threshold = threshold(name);
+			growth.leaking = fit.per_hour > growth.threshold && fit.last > fit.first;
+			report.passed = report.passed && !growth.leaking;
+			report.series.push_back(std::move(growth));
+		}
+		std::stable_sort(report.series.begin(), report.series.end(), [](const Growth& a, const Growth& b) {
+			return a.per_hour > b.per_hour;
+		});
+
+		for (auto& growth : report.series) {
+			if (report.suspects.size() >= kMaxSuspects) {
+				break;
+			}
+			if (isSource(growth.series) && growth.per_hour > 0.0 && growth.last > growth.first) {
+				report.suspects.push_back(growth);
+			}
+		}
+		return report;
+	}
+
+	bool ResourceSampler::writeReport(const QString& path, const Report& report) const {
+		std::string out;
+		JsonWriter writer(out);
+		writer.beginObject()
+			.key("duration_ms").value(report.duration_ms)
+			.key("warmup_ms").value(report.warmup_ms)
+			.key("samples").value(static_cast<int64_t>(report.samples))
+			.key("passed").value(report.passed);
+		writer.key("series").beginArray();
+		for (auto& growth : report.series) {
+			writeGrowth(writer, growth);
+		}
+		writer.endArray();
+		writer.key("suspects").beginArray();
+		for (auto& growth : report.suspects) {
+			writeGrowth(writer, growth);
+		}
+		writer.endArray();
+
+		// {zh} 时间线只包含进程级序列和调用方指标，按类名的序列只出现在上面的汇总里
+		// {en} The timeline keeps process series and caller gauges only, per-class series appear in the summary above
+		writer.key("timeline").beginArray();
+		for (auto& sample : samples_) {
+			writer.beginObject().key("elapsed_ms").value(sample.elapsed_ms);
+			for (auto& value : sample.values) {
+				if (value.first.compare(0, strlen(kObjectPrefix), kObjectPrefix) != 0) {
+					writer.key(value.first.c_str()).value(value.second);
+				}
+			}
+			writer.endObject();
+		}
+		writer.endArray().endObject();
+
+		QFile file(path);
+		if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+			return false;
+		}
+		return file.write(out.data(), static_cast<qint64>(out.size())) == static_cast<qint64>(out.size());
+	}
+
+	void ResourceSampler::logReport(const Report& report) const {
+		qInfo() << "resource sampler:" << report.samples << "samples over" << report.duration_ms
+			<< "ms, warm-up" << report.warmup_ms << "ms," << (report.passed ? "passed" : "FAILED");
+		for (auto& growth : report.series) {
+			if (growth.leaking) {
+				qWarning() << "  leaking" << growth.series.c_str() << "per hour:" << growth.per_hour
+					<< "threshold:" << growth.threshold << "from" << growth.first << "to" << growth.last;
+			}
+		}
+		for (auto& growth : report.suspects) {
+			qInfo() << "  suspect" << growth.series.c_str() << "per hour:" << growth.per_hour
+				<< "from" << growth.first << "to" << growth.last;
+		}
+	}
+
+	void ResourceSampler::readProcess(std::map<std::string, double>& values) {
+#ifdef _WIN32
+		auto process = GetCurrentProcess();
+		PROCESS_MEMORY_COUNTERS counters = {};
+		if (GetProcessMemoryInfo(process, &counters, sizeof(counters))) {
+			values[kRss] = static_cast<double>(counters.WorkingSetSize);
+		}
+		DWORD handles = 0;
+		if (GetProcessHandleCount(process, &handles)) {
+			values[kHandles] = handles;
+		}
+		auto snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+		if (snapshot != INVALID_HANDLE_VALUE) {
+			auto pid = GetCurrentProcessId();
+			THREADENTRY32 entry = {};
+			entry.dwSize = sizeof(entry);
+			int threads = 0;
+			for (auto ok = Thread32First(snapshot, &entry); ok; ok = Thread32Next(snapshot, &entry)) {
+				if (entry.th32OwnerProcessID == pid) {
+					++threads;
+				}
+			}
+			CloseHandle(snapshot);
+			values[kThreads] = threads;
+		}
+#elif defined(__linux__)
+		if (auto statm = fopen("/proc/self/statm", "r")) {
+			unsigned long size = 0;
+			unsigned long resident = 0;
+			if (fscanf(statm, "%lu %lu", &size, &resident) == 2) {
+				values[kRss] = static_cast<double>(resident) * sysconf(_SC_PAGESIZE);
+			}
+			fclose(statm);
+		}
+		auto fds = countDirectory("/proc/self/fd");
+		if (fds >= 0) {
+			// {zh} 减去遍历目录本身打开的描述符
+			// {en} Minus the descriptor opened to list the directory
+			values[kHandles] = fds - 1;
+		}
+		auto threads = countDirectory("/proc/self/task");
+		if (threads >= 0) {
+			values[kThreads] = threads;
+		}
+#else
+		(void)values;
+#endif
+	}
+}
@@ -0,0 +1,106 @@
+﻿#ifndef VRD_RESOURCESAMPLER_H
+#define VRD_RESOURCESAMPLER_H
+
+#include <QElapsedTimer>
+#include <QString>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace vrd
+{
+	/** {zh}
+	 * 长时间运行的资源采样与增长检测
+	 * 1, 每次采样记录常驻内存、句柄数、线程数、存活QObject总数及按类名的数量，以及调用方注册的指标
+	 * 2, 按类名统计QObject依赖 Qt 的对象创建/销毁钩子，需在创建 QApplication 之前调用 installObjectCensus
+	 * 3, 分析时跳过预热阶段，对每个序列做最小二乘拟合，换算为每小时增长量，
+	 *    超过阈值且后段均值高于前段的序列判为泄漏，并按增长量列出最可能的来源（类名或子系统指标）
+	 */
+
+	/** {en}
+	* Resource sampling and growth detection for long runs
+	* 1, Every sample records resident memory, handle count, thread count, the live QObject total and counts per class,
+	*    plus the gauges registered by the caller
+	* 2, Per-class QObject counts rely on Qt's object add/remove hooks, call installObjectCensus before creating QApplication
+	* 3, Analysis skips the warm-up, fits each series by least squares and converts the slope to growth per hour;
+	*    a series over its threshold whose late mean is above its early mean is a leak, and the most likely sources
+	*    (class names or subsystem gauges) are listed by growth
+	*/
+	class ResourceSampler
+	{
+	public:
+		static constexpr const char* kRss = "rss_bytes";
+		static constexpr const char* kHandles = "handles";
+		static constexpr const char* kThreads = "threads";
+		static constexpr const char* kObjects = "qobjects";
+		// {zh} 按类名的QObject数量序列前缀，例如 "qobject.QNetworkAccessManager"
+		// {en} Prefix of per-class QObject count series, e.g. "qobject.QNetworkAccessManager"
+		static constexpr const char* kObjectPrefix = "qobject.";
+
+		struct Sample {
+			int64_t elapsed_ms = 0;
+			std::map<std::string, double> values;
+		};
+
+		struct Growth {
+			std::string series;
+			double per_hour = 0.0;
+			double first = 0.0;
+			double last = 0.0;
+			double threshold = 0.0;
+			bool leaking = false;
+		};
+
+		struct Report {
+			int64_t duration_ms = 0;
+			int64_t warmup_ms = 0;
+			size_t samples = 0;
+			bool passed = true;
+			// {zh} 所有序列，按每小时增长量从大到小
+			// {en} Every series, by growth per hour descending
+			std::vector<Growth> series;
+			// {zh} 增长最快的类名和子系统指标，即最可能的分配来源
+			// {en} Fastest growing classes and subsystem gauges, the likely allocating sources
+			std::vector<Growth> suspects;
+		};
+
+		// {zh} 只统计安装之后创建的对象，进程内只需调用一次
+		// {en} Only objects created after installing are counted, call once per process
+		static void installObjectCensus();
+		static bool objectCensusInstalled();
+
+		ResourceSampler();
+
+		void addGauge(const std::string& name, std::function<double()>&& gauge);
+		// {zh} 子系统指标（如在途请求数、用户列表长度）增长时会与各类QObject一起列为可能的来源
+		// {en} Subsystem gauges (in-flight requests, user list size) are listed as likely sources next to QObject classes
+		void addSubsystemGauge(const std::string& name, std::function<double()>&& gauge);
+		// {zh} 按名称前缀设置每小时增长阈值，最长的匹配前缀生效
+		// {en} Set the per-hour growth threshold by name prefix, the longest matching prefix applies
+		void setThreshold(const std::string& prefix, double per_hour);
+
+		void sample();
+		const std::vector<Sample>& samples() const;
+
+		Report analyze(int64_t warmup_ms) const;
+		bool writeReport(const QString& path, const Report& report) const;
+		void logReport(const Report& report) const;
+
+	private:
+		double threshold(const std::string& series) const;
+		bool isSource(const std::string& series) const;
+		static void readProcess(std::map<std::string, double>& values);
+
+		QElapsedTimer clock_;
+		std::vector<std::pair<std::string, std::function<double()>>> gauges_;
+		std::map<std::string, double> thresholds_;
+		std::set<std::string> subsystems_;
+		std::vector<Sample> samples_;
+	};
+}
+
+#endif // VRD_RESOURCESAMPLER_H
@@ -0,0 +1,305 @@
+﻿#include "rtc_callback_recorder.h"
+#include "trace_event.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QStandardPaths>
+#include <QDebug>
+
+namespace vrd
+{
+	std::atomic<bool> RtcCallbackRecorder::enabled_{ false };
+	constexpr size_t RtcCallbackRecorder::kFlushBytes;
+
+	RtcCallbackRecorder& RtcCallbackRecorder::instance() {
+		static RtcCallbackRecorder recorder;
+		return recorder;
+	}
+
+	RtcCallbackRecorder::RtcCallbackRecorder() : video_(&null_video_), room_(&null_room_) {
+	}
+
+	void RtcCallbackRecorder::setTarget(bytertc::IRTCVideoEventHandler* video, bytertc::IRTCRoomEventHandler* room) {
+		video_ = video != nullptr ? video : &null_video_;
+		room_ = room != nullptr ? room : &null_room_;
+	}
+
+	int RtcCallbackRecorder::start(const QString& path) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		std::lock_guard<std::mutex> file_lock(file_mutex_);
+		if (enabled_) {
+			return -1;
+		}
+		auto file_path = path;
+		if (file_path.isEmpty()) {
+			auto paths = QStandardPaths::standardLocations(QStandardPaths::StandardLocation::AppDataLocation);
+			auto dir = paths.empty() ? QString("vertc_log/") : paths[0] + "/vertc_log/";
+			QDir().mkpath(dir);
+			file_path = dir + QDateTime::currentDateTime().toString("yyyy-MM-dd_hh-mm-ss") + "_callbacks.vrdcb";
+		}
+		file_.setFileName(file_path);
+		if (!file_.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+			qWarning() << "failed to open callback record:" << file_path;
+			return -1;
+		}
+		buffer_.clear();
+		buffer_.append(kCallbackTraceMagic, sizeof(kCallbackTraceMagic) - 1);
+		buffer_.push_back(static_cast<char>(kCallbackTraceVersion));
+		CallbackTraceWriter(buffer_).varint(static_cast<uint64_t>(QDateTime::currentMSecsSinceEpoch()));
+		last_us_ = Tracer::now();
+		enabled_ = true;
+		qInfo() << "callback record started:" << file_path;
+		return 0;
+	}
+
+	QString RtcCallbackRecorder::stop() {
+		std::unique_lock<std::mutex> lock(mutex_);
+		if (!enabled_) {
+			return QString();
+		}
+		enabled_ = false;
+		std::string rest;
+		rest.swap(buffer_);
+		std::lock_guard<std::mutex> file_lock(file_mutex_);
+		lock.unlock();
+		file_.write(rest.data(), static_cast<qint64>(rest.size()));
+		file_.close();
+		qInfo() << "callback record written:" << file_.fileName();
+		return file_.fileName();
+	}
+
+	void RtcCallbackRecorder::append(RtcCallback id, const std::string& payload) {
+		std::unique_lock<std::mutex> lock(mutex_);
+		if (!enabled_) {
+			return;
+		}
+		// {zh} 在锁内取时间戳，保证文件中的时间单调递增
+		// {en} The timestamp is taken under the lock so times in the file never go backwards
+		auto now_us = Tracer::now();
+		CallbackTraceWriter writer(buffer_);
+		writer.varint(static_cast<uint64_t>(id));
+		writer.varint(static_cast<uint64_t>(now_us - last_us_));
+		writer.varint(payload.size());
+		buffer_.append(payload);
+		last_us_ = now_us;
+		if (buffer_.size() < kFlushBytes) {
+			return;
+		}
+		std::string chunk;
+		chunk.swap(buffer_);
+		std::lock_guard<std::mutex> file_lock(file_mutex_);
+		lock.unlock();
+		file_.write(chunk.data(), static_cast<qint64>(chunk.size()));
+	}
+
+	void RtcCallbackRecorder::onWarning(int warn) {
+		record(RtcCallback::kWarning, warn);
+		video_->onWarning(warn);
+	}
+
+	void RtcCallbackRecorder::onError(int err) {
+		record(RtcCallback::kError, err);
+		video_->onError(err);
+	}
+
+	void RtcCallbackRecorder::onRemoteAudioPropertiesReport(const bytertc::RemoteAudioPropertiesInfo* audio_properties_infos,
+		int audio_properties_info_number, int total_remote_volume) {
+		record(RtcCallback::kRemoteAudioPropertiesReport,
+			traceSpan(audio_properties_infos, audio_properties_info_number), total_remote_volume);
+		video_->onRemoteAudioPropertiesReport(audio_properties_infos, audio_properties_info_number, total_remote_volume);
+	}
+
+	void RtcCallbackRecorder::onLocalAudioPropertiesReport(const bytertc::LocalAudioPropertiesInfo* audio_properties_infos,
+		int audio_properties_info_number) {
+		record(RtcCallback::kLocalAudioPropertiesReport,
+			traceSpan(audio_properties_infos, audio_properties_info_number));
+		video_->onLocalAudioPropertiesReport(audio_properties_infos, audio_properties_info_number);
+	}
+
+	void RtcCallbackRecorder::onUserStartAudioCapture(const char* room_id, const char* user_id) {
+		record(RtcCallback::kUserStartAudioCapture, room_id, user_id);
+		video_->onUserStartAudioCapture(room_id, user_id);
+	}
+
+	void RtcCallbackRecorder::onUserStopAudioCapture(const char* room_id, const char* user_id) {
+		record(RtcCallback::kUserStopAudioCapture, room_id, user_id);
+		video_->onUserStopAudioCapture(room_id, user_id);
+	}
+
+	void RtcCallbackRecorder::onFirstLocalAudioFrame(bytertc::StreamIndex index) {
+		record(RtcCallback::kFirstLocalAudioFrame, index);
+		video_->onFirstLocalAudioFrame(index);
+	}
+
+	void RtcCallbackRecorder::onLogReport(const char* log_type, const char* log_content) {
+		record(RtcCallback::kLogReport, log_type, log_content);
+		video_->onLogReport(log_type, log_content);
+	}
+
+	void RtcCallbackRecorder::onFirstLocalVideoFrameCaptured(bytertc::StreamIndex index, bytertc::VideoFrameInfo info) {
+		record(RtcCallback::kFirstLocalVideoFrameCaptured, index, info);
+		video_->onFirstLocalVideoFrameCaptured(index, info);
+	}
+
+	void RtcCallbackRecorder::onFirstRemoteVideoFrameDecoded(const bytertc::RemoteStreamKey key,
+		const bytertc::VideoFrameInfo& info) {
+		record(RtcCallback::kFirstRemoteVideoFrameDecoded, key, info);
+		video_->onFirstRemoteVideoFrameDecoded(key, info);
+	}
+
+	void RtcCallbackRecorder::onUserStartVideoCapture(const char* room_id, const char* user_id) {
+		record(RtcCallback::kUserStartVideoCapture, room_id, user_id);
+		video_->onUserStartVideoCapture(room_id, user_id);
+	}
+
+	void RtcCallbackRecorder::onUserStopVideoCapture(const char* room_id, const char* user_id) {
+		record(RtcCallback::kUserStopVideoCapture, room_id, user_id);
+		video_->onUserStopVideoCapture(room_id, user_id);
+	}
+
+	void RtcCallbackRecorder::onAudioDeviceStateChanged(const char* device_id, bytertc::RTCAudioDeviceType device_type,
+		bytertc::MediaDeviceState device_state, bytertc::MediaDeviceError device_error) {
+		record(RtcCallback::kAudioDeviceStateChanged, device_id, device_type, device_state, device_error);
+		video_->onAudioDeviceStateChanged(device_id, device_type, device_state, device_error);
+	}
+
+	void RtcCallbackRecorder::onVideoDeviceStateChanged(const char* device_id, bytertc::RTCVideoDeviceType device_type,
+		bytertc::MediaDeviceState device_state, bytertc::MediaDeviceError device_error) {
+		record(RtcCallback::kVideoDeviceStateChanged, device_id, device_type, device_state, device_error);
+		video_->onVideoDeviceStateChanged(device_id, device_type, device_state, device_error);
+	}
+
+	void RtcCallbackRecorder::onAudioPlaybackDeviceTestVolume(int volume) {
+		record(RtcCallback::kAudioPlaybackDeviceTestVolume, volume);
+		video_->onAudioPlaybackDeviceTestVolume(volume);
+	}
+
+	void RtcCallbackRecorder::onLocalVideoStateChanged(bytertc::StreamIndex index, bytertc::LocalVideoStreamState state,
+		bytertc::LocalVideoStreamError error) {
+		record(RtcCallback::kLocalVideoStateChanged, index, state, error);
+		video_->onLocalVideoStateChanged(index, state, error);
+	}
+
+	void RtcCallbackRecorder::onLocalAudioStateChanged(bytertc::LocalAudioStreamState state, bytertc::LocalAudioStreamError error) {
+		record(RtcCallback::kLocalAudioStateChanged, state, error);
+		video_->onLocalAudioStateChanged(state, error);
+	}
+
+	void RtcCallbackRecorder::onSysStats(const bytertc::SysStats& stats) {
+		record(RtcCallback::kSysStats, stats);
+		video_->onSysStats(stats);
+	}
+
+	void RtcCallbackRecorder::onNetworkTypeChanged(bytertc::NetworkType type) {
+		record(RtcCallback::kNetworkTypeChanged, type);
+		video_->onNetworkTypeChanged(type);
+	}
+
+	void RtcCallbackRecorder::onLoginResult(const char* uid, int error_code, int elapsed) {
+		record(RtcCallback::kLoginResult, uid, error_code, elapsed);
+		video_->onLoginResult(uid, error_code, elapsed);
+	}
+
+	void RtcCallbackRecorder::onServerParamsSetResult(int error) {
+		record(RtcCallback::kServerParamsSetResult, error);
+		video_->onServerParamsSetResult(error);
+	}
+
+	void RtcCallbackRecorder::onUserMessageReceivedOutsideRoom(const char* uid, const char* message) {
+		record(RtcCallback::kUserMessageReceivedOutsideRoom, uid, message);
+		video_->onUserMessageReceivedOutsideRoom(uid, message);
+	}
+
+	void RtcCallbackRecorder::onUserBinaryMessageReceivedOutsideRoom(const char* uid, int size, const uint8_t* message) {
+		record(RtcCallback::kUserBinaryMessageReceivedOutsideRoom, uid, TraceBlob{ message, size });
+		video_->onUserBinaryMessageReceivedOutsideRoom(uid, size, message);
+	}
+
+	void RtcCallbackRecorder::onServerMessageSendResult(int64_t msgid, int error, const bytertc::ServerACKMsg& msg) {
+		record(RtcCallback::kServerMessageSendResult, msgid, error, msg);
+		video_->onServerMessageSendResult(msgid, error, msg);
+	}
+
+	void RtcCallbackRecorder::onRoomStateChanged(const char* room_id, const char* uid, int state, const char* extra_info) {
+		record(RtcCallback::kRoomStateChanged, room_id, uid, state, extra_info);
+		room_->onRoomStateChanged(room_id, uid, state, extra_info);
+	}
+
+	void RtcCallbackRecorder::onRoomStats(const bytertc::RtcRoomStats& stats) {
+		record(RtcCallback::kRoomStats, stats);
+		room_->onRoomStats(stats);
+	}
+
+	void RtcCallbackRecorder::onLocalStreamStats(const bytertc::LocalStreamStats& stats) {
+		record(RtcCallback::kLocalStreamStats, stats);
+		room_->onLocalStreamStats(stats);
+	}
+
+	void RtcCallbackRecorder::onRemoteStreamStats(const bytertc::RemoteStreamStats& stats) {
+		record(RtcCallback::kRemoteStreamStats, stats);
+		room_->onRemoteStreamStats(stats);
+	}
+
+	void RtcCallbackRecorder::onLeaveRoom(const bytertc::RtcRoomStats& stats) {
+		record(RtcCallback::kLeaveRoom, stats);
+		room_->onLeaveRoom(stats);
+	}
+
+	void RtcCallbackRecorder::onUserJoined(const bytertc::UserInfo& userInfo, int elapsed) {
+		record(RtcCallback::kUserJoined, userInfo, elapsed);
+		room_->onUserJoined(userInfo, elapsed);
+	}
+
+	void RtcCallbackRecorder::onUserLeave(const char* uid, bytertc::UserOfflineReason reason) {
+		record(RtcCallback::kUserLeave, uid, reason);
+		room_->onUserLeave(uid, reason);
+	}
+
+	void RtcCallbackRecorder::onUserPublishStream(const char* uid, bytertc::MediaStreamType type) {
+		record(RtcCallback::kUserPublishStream, uid, type);
+		room_->onUserPublishStream(uid, type);
+	}
+
+	void RtcCallbackRecorder::onUserUnpublishStream(const char* uid, bytertc::MediaStreamType type,
+		bytertc::StreamRemoveReason reason) {
+		record(RtcCallback::kUserUnpublishStream, uid, type, reason);
+		room_->onUserUnpublishStream(uid, type, reason);
+	}
+
+	void RtcCallbackRecorder::onUserPublishScreen(const char* uid, bytertc::MediaStreamType type) {
+		record(RtcCallback::kUserPublishScreen, uid, type);
+		room_->onUserPublishScreen(uid, type);
+	}
+
+	void RtcCallbackRecorder::onUserUnpublishScreen(const char* uid, bytertc::MediaStreamType type,
+		bytertc::StreamRemoveReason reason) {
+		record(RtcCallback::kUserUnpublishScreen, uid, type, reason);
+		room_->onUserUnpublishScreen(uid, type, reason);
+	}
+
+	void RtcCallbackRecorder::onStreamSubscribed(bytertc::SubscribeState state_code, const char* user_id,
+		const bytertc::SubscribeConfig& info) {
+		record(RtcCallback::kStreamSubscribed, state_code, user_id, info);
+		room_->onStreamSubscribed(state_code, user_id, info);
+	}
+
+	void RtcCallbackRecorder::onStreamPublishSuccess(const char* user_id, bool is_screen) {
+		record(RtcCallback::kStreamPublishSuccess, user_id, is_screen);
+		room_->onStreamPublishSuccess(user_id, is_screen);
+	}
+
+	void RtcCallbackRecorder::onRoomMessageReceived(const char* uid, const char* message) {
+		record(RtcCallback::kRoomMessageReceived, uid, message);
+		room_->onRoomMessageReceived(uid, message);
+	}
+
+	void RtcCallbackRecorder::onUserMessageReceived(const char* uid, const char* message) {
+		record(RtcCallback::kUserMessageReceived, uid, message);
+		room_->onUserMessageReceived(uid, message);
+	}
+
+	void RtcCallbackRecorder::onUserBinaryMessageReceived(const char* uid, int size, const uint8_t* message) {
+		record(RtcCallback::kUserBinaryMessageReceived, uid, TraceBlob{ message, size });
+		room_->onUserBinaryMessageReceived(uid, size, message);
+	}
+}
@@ -0,0 +1,139 @@
+﻿#ifndef VRD_RTCCALLBACKRECORDER_H
+#define VRD_RTCCALLBACKRECORDER_H
+
+#include <QFile>
+#include <QString>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "core/rtc_callback_trace.h"
+
+namespace vrd
+{
+	/** {zh}
+	 * SDK 回调录制器，作为引擎和房间的回调对象接在 SDK 与 RtcEngineWrap 之间
+	 * 1, 每个回调先把参数和单调时间戳写入缓冲区，再原样转发给目标对象，格式见 rtc_callback_trace.h
+	 * 2, 是否经过录制器在创建引擎时决定，配置项 perf/callback_record 为1时启动即开始录制
+	 * 3, 缓冲区超过阈值后写入文件，写文件时不阻塞其他线程的录制
+	 * 4, 录制的文件可用 RtcCallbackReplayer 回放，复现回调风暴并测量处理耗时
+	 */
+
+	/** {en}
+	* SDK callback recorder, installed as the engine and room event handler between the SDK and RtcEngineWrap
+	* 1, Every callback writes its arguments and a monotonic timestamp into a buffer, then forwards the call unchanged
+	*    to the target, see rtc_callback_trace.h for the format
+	* 2, Whether callbacks pass through the recorder is decided when the engine is created, recording starts at launch
+	*    when the perf/callback_record setting is 1
+	* 3, The buffer is written to the file once it passes a threshold, other threads keep recording during the write
+	* 4, Recorded files are replayed with RtcCallbackReplayer to reproduce callback storms and measure their handling
+	*/
+	class RtcCallbackRecorder : public bytertc::IRTCVideoEventHandler, public bytertc::IRTCRoomEventHandler
+	{
+	public:
+		static RtcCallbackRecorder& instance();
+
+		static bool enabled() {
+			return enabled_.load(std::memory_order_relaxed);
+		}
+		// {zh} 开始录制，path 为空时写入日志目录；成功返回0
+		// {en} Start recording, an empty path writes into the log directory; returns 0 on success
+		int start(const QString& path = QString());
+		// {zh} 停止录制并写完剩余数据，返回文件路径，未在录制时为空
+		// {en} Stop recording and write the remaining data, returns the file path or empty when not recording
+		QString stop();
+		// {zh} 回调转发的目标，需在创建引擎前设置
+		// {en} Where callbacks are forwarded to, must be set before the engine is created
+		void setTarget(bytertc::IRTCVideoEventHandler* video, bytertc::IRTCRoomEventHandler* room);
+
+		// IRTCVideoEventHandler
+		void onWarning(int warn) override;
+		void onError(int err) override;
+		void onRemoteAudioPropertiesReport(const bytertc::RemoteAudioPropertiesInfo* audio_properties_infos,
+			int audio_properties_info_number, int total_remote_volume) override;
+		void onLocalAudioPropertiesReport(const bytertc::LocalAudioPropertiesInfo* audio_properties_infos,
+			int audio_properties_info_number) override;
+		void onUserStartAudioCapture(const char* room_id, const char* user_id) override;
+		void onUserStopAudioCapture(const char* room_id, const char* user_id) override;
+		void onFirstLocalAudioFrame(bytertc::StreamIndex index) override;
+		void onLogReport(const char* log_type, const char* log_content) override;
+		void onFirstLocalVideoFrameCaptured(bytertc::StreamIndex index, bytertc::VideoFrameInfo info) override;
+		void onFirstRemoteVideoFrameDecoded(const bytertc::RemoteStreamKey key,
+			const bytertc::VideoFrameInfo& info) override;
+		void onUserStartVideoCapture(const char* room_id, const char* user_id) override;
+		void onUserStopVideoCapture(const char* room_id, const char* user_id) override;
+		void onAudioDeviceStateChanged(const char* device_id, bytertc::RTCAudioDeviceType device_type,
+			bytertc::MediaDeviceState device_state, bytertc::MediaDeviceError device_error) override;
+		void onVideoDeviceStateChanged(const char* device_id, bytertc::RTCVideoDeviceType device_type,
+			bytertc::MediaDeviceState device_state, bytertc::MediaDeviceError device_error) override;
+		void onAudioPlaybackDeviceTestVolume(int volume) override;
+		void onLocalVideoStateChanged(bytertc::StreamIndex index, bytertc::LocalVideoStreamState state,
+			bytertc::LocalVideoStreamError error) override;
+		void onLocalAudioStateChanged(bytertc::LocalAudioStreamState state,
+			bytertc::LocalAudioStreamError error) override;
+		void onSysStats(const bytertc::SysStats& stats) override;
+		void onNetworkTypeChanged(bytertc::NetworkType type) override;
+		void onLoginResult(const char* uid, int error_code, int elapsed) override;
+		void onServerParamsSetResult(int error) override;
+		void onUserMessageReceivedOutsideRoom(const char* uid, const char* message) override;
+		void onUserBinaryMessageReceivedOutsideRoom(const char* uid, int size, const uint8_t* message) override;
+		void onServerMessageSendResult(int64_t msgid, int error, const bytertc::ServerACKMsg& msg) override;
+
+		// IRTCRoomEventHandler
+		void onRoomStateChanged(const char* room_id, const char* uid, int state, const char* extra_info) override;
+		void onRoomStats(const bytertc::RtcRoomStats& stats) override;
+		void onLocalStreamStats(const bytertc::LocalStreamStats& stats) override;
+		void onRemoteStreamStats(const bytertc::RemoteStreamStats& stats) override;
+		void onLeaveRoom(const bytertc::RtcRoomStats& stats) override;
+		void onUserJoined(const bytertc::UserInfo& userInfo, int elapsed) override;
+		void onUserLeave(const char* uid, bytertc::UserOfflineReason reason) override;
+		void onUserPublishStream(const char* uid, bytertc::MediaStreamType type) override;
+		void onUserUnpublishStream(const char* uid, bytertc::MediaStreamType type,
+			bytertc::StreamRemoveReason reason) override;
+		void onUserPublishScreen(const char* uid, bytertc::MediaStreamType type) override;
+		void onUserUnpublishScreen(const char* uid, bytertc::MediaStreamType type,
+			bytertc::StreamRemoveReason reason) override;
+		void onStreamSubscribed(bytertc::SubscribeState state_code, const char* user_id,
+			const bytertc::SubscribeConfig& info) override;
+		void onStreamPublishSuccess(const char* user_id, bool is_screen) override;
+		void onRoomMessageReceived(const char* uid, const char* message) override;
+		void onUserMessageReceived(const char* uid, const char* message) override;
+		void onUserBinaryMessageReceived(const char* uid, int size, const uint8_t* message) override;
+
+	private:
+		static constexpr size_t kFlushBytes = 64 * 1024;
+
+		RtcCallbackRecorder();
+
+		template <class... Args>
+		void record(RtcCallback id, const Args&... args) {
+			if (!enabled()) {
+				return;
+			}
+			thread_local std::string payload;
+			payload.clear();
+			CallbackTraceWriter writer(payload);
+			int order[] = { 0, (writer(args), 0)... };
+			(void)order;
+			append(id, payload);
+		}
+		void append(RtcCallback id, const std::string& payload);
+
+		static std::atomic<bool> enabled_;
+		bytertc::IRTCVideoEventHandler null_video_;
+		bytertc::IRTCRoomEventHandler null_room_;
+		bytertc::IRTCVideoEventHandler* video_;
+		bytertc::IRTCRoomEventHandler* room_;
+
+		std::mutex mutex_;
+		std::string buffer_;
+		int64_t last_us_ = 0;
+		// {zh} 写文件单独加锁，先取得文件锁再释放缓冲区锁，保证数据块按顺序写入
+		// {en} File writes have their own lock, taken before the buffer lock is released so chunks land in order
+		std::mutex file_mutex_;
+		QFile file_;
+	};
+}
+
+#endif // VRD_RTCCALLBACKRECORDER_H
@@ -0,0 +1,191 @@
+﻿#include "rtc_callback_replayer.h"
+
+#include <QFile>
+#include <QDebug>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace vrd
+{
+	RtcCallbackReplayer::RtcCallbackReplayer(bytertc::IRTCVideoEventHandler* video, bytertc::IRTCRoomEventHandler* room)
+		: video_(video), room_(room) {
+	}
+
+	int RtcCallbackReplayer::replay(const QString& path, double speed) {
+		QFile file(path);
+		if (!file.open(QIODevice::ReadOnly)) {
+			qWarning() << "failed to open callback record:" << path;
+			return -1;
+		}
+		// {zh} 先整体读入内存，回放计时不受磁盘影响
+		// {en} Read everything up front so disk reads do not skew replay timing
+		auto bytes = file.readAll();
+		return replayData(std::string(bytes.constData(), static_cast<size_t>(bytes.size())), speed);
+	}
+
+	int RtcCallbackReplayer::replayData(const std::string& data, double speed) {
+		constexpr size_t kMagicSize = sizeof(kCallbackTraceMagic) - 1;
+		if (data.size() < kMagicSize + 1 || memcmp(data.data(), kCallbackTraceMagic, kMagicSize) != 0) {
+			qWarning() << "not a callback record";
+			return -2;
+		}
+		if (static_cast<uint8_t>(data[kMagicSize]) != kCallbackTraceVersion) {
+			qWarning() << "unsupported callback record version:" << static_cast<int>(data[kMagicSize]);
+			return -2;
+		}
+		CallbackTraceReader file(data.data(), data.size());
+		file.skip(kMagicSize + 1);
+		file.varint();
+		if (!file.ok()) {
+			return -2;
+		}
+
+		cancelled_ = false;
+		recorded_us_ = 0;
+		auto start = std::chrono::steady_clock::now();
+		int count = 0;
+		while (!file.atEnd() && !cancelled_) {
+			auto id = static_cast<RtcCallback>(file.varint());
+			auto delta_us = file.varint();
+			auto size = static_cast<size_t>(file.varint());
+			auto payload = file.position();
+			if (!file.ok() || !file.skip(size)) {
+				qWarning() << "callback record truncated after" << count << "callbacks";
+				break;
+			}
+			recorded_us_ += static_cast<int64_t>(delta_us);
+			if (speed > 0) {
+				std::this_thread::sleep_until(start + std::chrono::microseconds(
+					static_cast<int64_t>(static_cast<double>(recorded_us_) / speed)));
+			}
+			CallbackTraceReader reader(payload, size);
+			if (dispatch(id, reader)) {
+				++count;
+			}
+		}
+		return count;
+	}
+
+	void RtcCallbackReplayer::cancel() {
+		cancelled_ = true;
+	}
+
+	bool RtcCallbackReplayer::dispatch(RtcCallback id, CallbackTraceReader& reader) {
+		switch (id) {
+		case RtcCallback::kRemoteAudioPropertiesReport: {
+			int total_remote_volume = 0;
+			reader.span(remote_audio_);
+			reader(total_remote_volume);
+			if (!reader.ok()) {
+				return false;
+			}
+			video_->onRemoteAudioPropertiesReport(remote_audio_.data(), static_cast<int>(remote_audio_.size()),
+				total_remote_volume);
+			return true;
+		}
+		case RtcCallback::kLocalAudioPropertiesReport: {
+			reader.span(local_audio_);
+			if (!reader.ok()) {
+				return false;
+			}
+			video_->onLocalAudioPropertiesReport(local_audio_.data(), static_cast<int>(local_audio_.size()));
+			return true;
+		}
+		case RtcCallback::kUserBinaryMessageReceivedOutsideRoom:
+		case RtcCallback::kUserBinaryMessageReceived: {
+			const char* uid = nullptr;
+			const uint8_t* message = nullptr;
+			int size = 0;
+			reader(uid);
+			reader.blob(message, size);
+			if (!reader.ok()) {
+				return false;
+			}
+			if (id == RtcCallback::kUserBinaryMessageReceived) {
+				room_->onUserBinaryMessageReceived(uid, size, message);
+			}
+			else {
+				video_->onUserBinaryMessageReceivedOutsideRoom(uid, size, message);
+			}
+			return true;
+		}
+		case RtcCallback::kWarning:
+			return invoke(reader, video_, &bytertc::IRTCVideoEventHandler::onWarning);
+		case RtcCallback::kError:
+			return invoke(reader, video_, &bytertc::IRTCVideoEventHandler::onError);
+		case RtcCallback::kUserStartAudioCapture:
+			return invoke(reader, video_, &bytertc::IRTCVideoEventHandler::onUserStartAudioCapture);
+		case RtcCallback::kUserStopAudioCapture:
+			return invoke(reader, video_, &bytertc::IRTCVideoEventHandler::onUserStopAudioCapture);
+		case RtcCallback::kFirstLocalAudioFrame:
+			return invoke(reader, video_, &bytertc::IRTCVideoEventHandler::onFirstLocalAudioFrame);
+		case RtcCallback::kLogReport:
+			return invoke(reader, video_, &bytertc::IRTCVideoEventHandler::onLogReport);
+		case RtcCallback::kFirstLocalVideoFrameCaptured:
+			return invoke(reader, video_, &bytertc::IRTCVideoEventHandler::onFirstLocalVideoFrameCaptured);
+		case RtcCallback::kFirstRemoteVideoFrameDecoded:
+			return invoke(reader, video_, &bytertc::IRTCVideoEventHandler::onFirstRemoteVideoFrameDecoded);
+		case RtcCallback::kUserStartVideoCapture:
+			return invoke(reader, video_, &bytertc::IRTCVideoEventHandler::onUserStartVideoCapture);
+		case RtcCallback::kUserStopVideoCapture:
+			return invoke(reader, video_, &bytertc::IRTCVideoEventHandler::onUserStopVideoCapture);
+		case RtcCallback::kAudioDeviceStateChanged:
+			return invoke(reader, video_, &bytertc::IRTCVideoEventHandler::onAudioDeviceStateChanged);
+		case RtcCallback::kVideoDeviceStateChanged:
+			return invoke(reader, video_, &bytertc::IRTCVideoEventHandler::onVideoDeviceStateChanged);
+		case RtcCallback::kAudioPlaybackDeviceTestVolume:
+			return invoke(reader, video_, &bytertc::IRTCVideoEventHandler::onAudioPlaybackDeviceTestVolume);
+		case RtcCallback::kLocalVideoStateChanged:
+			return invoke(reader, video_, &bytertc::IRTCVideoEventHandler::onLocalVideoStateChanged);
+		case RtcCallback::kLocalAudioStateChanged:
+			return invoke(reader, video_, &bytertc::IRTCVideoEventHandler::onLocalAudioStateChanged);
+		case RtcCallback::kSysStats:
+			return invoke(reader, video_, &bytertc::IRTCVideoEventHandler::onSysStats);
+		case RtcCallback::kNetworkTypeChanged:
+			return invoke(reader, video_, &bytertc::IRTCVideoEventHandler::onNetworkTypeChanged);
+		case RtcCallback::kLoginResult:
+			return invoke(reader, video_, &bytertc::IRTCVideoEventHandler::onLoginResult);
+		case RtcCallback::kServerParamsSetResult:
+			return invoke(reader, video_, &bytertc::IRTCVideoEventHandler::onServerParamsSetResult);
+		case RtcCallback::kUserMessageReceivedOutsideRoom:
+			return invoke(reader, video_, &bytertc::IRTCVideoEventHandler::onUserMessageReceivedOutsideRoom);
+		case RtcCallback::kServerMessageSendResult:
+			return invoke(reader, video_, &bytertc::IRTCVideoEventHandler::onServerMessageSendResult);
+		case RtcCallback::kRoomStateChanged:
+			return invoke(reader, room_, &bytertc::IRTCRoomEventHandler::onRoomStateChanged);
+		case RtcCallback::kRoomStats:
+			return invoke(reader, room_, &bytertc::IRTCRoomEventHandler::onRoomStats);
+		case RtcCallback::kLocalStreamStats:
+			return invoke(reader, room_, &bytertc::IRTCRoomEventHandler::onLocalStreamStats);
+		case RtcCallback::kRemoteStreamStats:
+			return invoke(reader, room_, &bytertc::IRTCRoomEventHandler::onRemoteStreamStats);
+		case RtcCallback::kLeaveRoom:
+			return invoke(reader, room_, &bytertc::IRTCRoomEventHandler::onLeaveRoom);
+		case RtcCallback::kUserJoined:
+			return invoke(reader, room_, &bytertc::IRTCRoomEventHandler::onUserJoined);
+		case RtcCallback::kUserLeave:
+			return invoke(reader, room_, &bytertc::IRTCRoomEventHandler::onUserLeave);
+		case RtcCallback::kUserPublishStream:
+			return invoke(reader, room_, &bytertc::IRTCRoomEventHandler::onUserPublishStream);
+		case RtcCallback::kUserUnpublishStream:
+			return invoke(reader, room_, &bytertc::IRTCRoomEventHandler::onUserUnpublishStream);
+		case RtcCallback::kUserPublishScreen:
+			return invoke(reader, room_, &bytertc::IRTCRoomEventHandler::onUserPublishScreen);
+		case RtcCallback::kUserUnpublishScreen:
+			return invoke(reader, room_, &bytertc::IRTCRoomEventHandler::onUserUnpublishScreen);
+		case RtcCallback::kStreamSubscribed:
+			return invoke(reader, room_, &bytertc::IRTCRoomEventHandler::onStreamSubscribed);
+		case RtcCallback::kStreamPublishSuccess:
+			return invoke(reader, room_, &bytertc::IRTCRoomEventHandler::onStreamPublishSuccess);
+		case RtcCallback::kRoomMessageReceived:
+			return invoke(reader, room_, &bytertc::IRTCRoomEventHandler::onRoomMessageReceived);
+		case RtcCallback::kUserMessageReceived:
+			return invoke(reader, room_, &bytertc::IRTCRoomEventHandler::onUserMessageReceived);
+		default:
+			// {zh} 新版本录制的未知回调
+			// {en} Unknown callback recorded by a newer build
+			return false;
+		}
+	}
+}
@@ -0,0 +1,80 @@
+﻿#ifndef VRD_RTCCALLBACKREPLAYER_H
+#define VRD_RTCCALLBACKREPLAYER_H
+
+#include <QString>
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "core/rtc_callback_trace.h"
+
+namespace vrd
+{
+	/** {zh}
+	 * 回放 RtcCallbackRecorder 录制的回调，按录制时的参数依次调用目标对象
+	 * 1, 在调用 replay 的线程上执行，相当于 SDK 的回调线程，不需要创建引擎
+	 * 2, speed 为1时按原始间隔回放，大于1时加速，小于等于0时不等待，尽快回放
+	 * 3, 原本来自多个 SDK 线程的回调在回放时按时间顺序串行执行
+	 */
+
+	/** {en}
+	* Replays callbacks recorded by RtcCallbackRecorder, calling the targets with the recorded arguments in order
+	* 1, Runs on the thread that calls replay, which stands in for the SDK callback thread, no engine is needed
+	* 2, A speed of 1 keeps the recorded intervals, above 1 plays faster, 0 or below does not wait at all
+	* 3, Callbacks that originally came from several SDK threads are replayed serially in time order
+	*/
+	class RtcCallbackReplayer
+	{
+	public:
+		RtcCallbackReplayer(bytertc::IRTCVideoEventHandler* video, bytertc::IRTCRoomEventHandler* room);
+
+		// {zh} 返回回放的回调数，文件无法打开或格式不对时返回负数
+		// {en} Returns the number of callbacks replayed, negative when the file cannot be opened or is not a record
+		int replay(const QString& path, double speed = 1.0);
+		int replayData(const std::string& data, double speed = 1.0);
+		// {zh} 可在其他线程调用，当前回调结束后停止
+		// {en} May be called from another thread, stops after the current callback
+		void cancel();
+		// {zh} 最近一次回放覆盖的录制时长
+		// {en} Recorded time span covered by the last replay
+		int64_t recordedDurationUs() const {
+			return recorded_us_;
+		}
+
+	private:
+		bool dispatch(RtcCallback id, CallbackTraceReader& reader);
+
+		template <class Handler, class... Args>
+		static bool invoke(CallbackTraceReader& reader, Handler* handler, void (Handler::*method)(Args...)) {
+			return invoke(reader, handler, method, std::index_sequence_for<Args...>());
+		}
+		template <class Handler, class... Args, size_t... I>
+		static bool invoke(CallbackTraceReader& reader, Handler* handler, void (Handler::*method)(Args...),
+			std::index_sequence<I...>) {
+			std::tuple<typename std::decay<Args>::type...> args;
+			// {zh} 花括号初始化保证参数按声明顺序读取
+			// {en} Brace initialization guarantees the arguments are read in declaration order
+			int order[] = { 0, (reader(std::get<I>(args)), 0)... };
+			(void)order;
+			if (!reader.ok()) {
+				return false;
+			}
+			(handler->*method)(std::get<I>(args)...);
+			return true;
+		}
+
+		bytertc::IRTCVideoEventHandler* video_;
+		bytertc::IRTCRoomEventHandler* room_;
+		std::atomic<bool> cancelled_{ false };
+		int64_t recorded_us_ = 0;
+		// {zh} 音量回调的数组在多次回放间复用，避免每条记录重新分配
+		// {en} Arrays for volume callbacks are reused across records instead of reallocated each time
+		std::vector<bytertc::RemoteAudioPropertiesInfo> remote_audio_;
+		std::vector<bytertc::LocalAudioPropertiesInfo> local_audio_;
+	};
+}
+
+#endif // VRD_RTCCALLBACKREPLAYER_H
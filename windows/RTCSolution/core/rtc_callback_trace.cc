@@ -0,0 +1,122 @@
+﻿#include "rtc_callback_trace.h"
+
+#include <cstring>
+
+namespace vrd
+{
+	void CallbackTraceWriter::varint(uint64_t value) {
+		while (value >= 0x80) {
+			out_.push_back(static_cast<char>((value & 0x7f) | 0x80));
+			value >>= 7;
+		}
+		out_.push_back(static_cast<char>(value));
+	}
+
+	void CallbackTraceWriter::blob(const void* data, int size) {
+		if (data == nullptr || size <= 0) {
+			varint(0);
+			return;
+		}
+		varint(static_cast<uint64_t>(size));
+		out_.append(static_cast<const char*>(data), static_cast<size_t>(size));
+	}
+
+	void CallbackTraceWriter::floats(const float* data, int size) {
+		// {zh} 频谱通常未开启，全为0，只写到最后一个非0值
+		// {en} The spectrum is usually disabled and all zero, only write up to the last non-zero value
+		while (size > 0 && data[size - 1] == 0.0f) {
+			--size;
+		}
+		varint(static_cast<uint64_t>(size));
+		out_.append(reinterpret_cast<const char*>(data), static_cast<size_t>(size) * sizeof(float));
+	}
+
+	void CallbackTraceWriter::put(bool value) {
+		out_.push_back(value ? 1 : 0);
+	}
+
+	void CallbackTraceWriter::put(float value) {
+		out_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
+	void CallbackTraceWriter::put(double value) {
+		out_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
+	void CallbackTraceWriter::put(const char* value) {
+		if (value == nullptr) {
+			varint(0);
+			return;
+		}
+		auto size = strlen(value);
+		varint(static_cast<uint64_t>(size) + 1);
+		out_.append(value, size);
+	}
+
+	void CallbackTraceWriter::put(const TraceBlob& value) {
+		blob(value.data, value.size);
+	}
+
+	uint64_t CallbackTraceReader::varint() {
+		uint64_t value = 0;
+		for (int shift = 0; shift < 64; shift += 7) {
+			if (pos_ >= end_) {
+				break;
+			}
+			auto byte = static_cast<uint8_t>(*pos_++);
+			value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+			if ((byte & 0x80) == 0) {
+				return value;
+			}
+		}
+		ok_ = false;
+		return 0;
+	}
+
+	bool CallbackTraceReader::skip(size_t size) {
+		if (size > static_cast<size_t>(end_ - pos_)) {
+			ok_ = false;
+			pos_ = end_;
+			return false;
+		}
+		pos_ += size;
+		return true;
+	}
+
+	void CallbackTraceReader::floats(float* data, int size) {
+		auto count = varint();
+		if (count > static_cast<uint64_t>(size) || !skip(static_cast<size_t>(count) * sizeof(float))) {
+			ok_ = false;
+			return;
+		}
+		memcpy(data, pos_ - count * sizeof(float), static_cast<size_t>(count) * sizeof(float));
+		memset(data + count, 0, static_cast<size_t>(size - count) * sizeof(float));
+	}
+
+	void CallbackTraceReader::get(bool& value) {
+		value = pos_ < end_ && *pos_ != 0;
+		skip(1);
+	}
+
+	void CallbackTraceReader::get(float& value) {
+		if (skip(sizeof(value))) {
+			memcpy(&value, pos_ - sizeof(value), sizeof(value));
+		}
+	}
+
+	void CallbackTraceReader::get(double& value) {
+		if (skip(sizeof(value))) {
+			memcpy(&value, pos_ - sizeof(value), sizeof(value));
+		}
+	}
+
+	void CallbackTraceReader::get(const char*& value) {
+		auto length = varint();
+		if (length == 0 || !ok_ || !skip(static_cast<size_t>(length - 1))) {
+			value = nullptr;
+			return;
+		}
+		strings_.emplace_back(pos_ - (length - 1), static_cast<size_t>(length - 1));
+		value = strings_.back().c_str();
+	}
+}
@@ -0,0 +1,340 @@
+﻿#ifndef VRD_RTCCALLBACKTRACE_H
+#define VRD_RTCCALLBACKTRACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "bytertc_video_event_handler.h"
+#include "bytertc_room_event_handler.h"
+
+namespace vrd
+{
+	/** {zh}
+	 * SDK 回调录制文件的二进制格式
+	 * 1, 文件头: "VRDCB" + 版本号(1字节) + 录制开始的墙上时间(毫秒, varint)
+	 * 2, 每条记录: 回调编号(varint) + 距上一条的微秒数(varint) + 参数长度(varint) + 参数
+	 * 3, 整数和枚举按 zigzag varint 编码，与平台上 int/long 的宽度无关；浮点按小端原样写入；
+	 *    字符串写长度加一，0 表示空指针
+	 * 4, 回调编号只能追加，不能复用或调整，旧文件中的未知编号在回放时跳过
+	 */
+
+	/** {en}
+	* Binary format of recorded SDK callbacks
+	* 1, File header: "VRDCB" + version (1 byte) + wall-clock start time of the recording in ms (varint)
+	* 2, Each record: callback id (varint) + microseconds since the previous record (varint) + payload size (varint) + payload
+	* 3, Integers and enums are zigzag varints, independent of the platform's int/long width; floats are written
+	*    raw in little endian; strings are written as length plus one, 0 means a null pointer
+	* 4, Callback ids are append-only and never reused or renumbered, unknown ids in older files are skipped on replay
+	*/
+	enum class RtcCallback : uint8_t {
+		// IRTCVideoEventHandler
+		kWarning = 1,
+		kError = 2,
+		kRemoteAudioPropertiesReport = 3,
+		kLocalAudioPropertiesReport = 4,
+		kUserStartAudioCapture = 5,
+		kUserStopAudioCapture = 6,
+		kFirstLocalAudioFrame = 7,
+		kLogReport = 8,
+		kFirstLocalVideoFrameCaptured = 9,
+		kFirstRemoteVideoFrameDecoded = 10,
+		kUserStartVideoCapture = 11,
+		kUserStopVideoCapture = 12,
+		kAudioDeviceStateChanged = 13,
+		kVideoDeviceStateChanged = 14,
+		kAudioPlaybackDeviceTestVolume = 15,
+		kLocalVideoStateChanged = 16,
+		kLocalAudioStateChanged = 17,
+		kSysStats = 18,
+		kNetworkTypeChanged = 19,
+		kLoginResult = 20,
+		kServerParamsSetResult = 21,
+		kUserMessageReceivedOutsideRoom = 22,
+		kUserBinaryMessageReceivedOutsideRoom = 23,
+		kServerMessageSendResult = 24,
+
+		// IRTCRoomEventHandler
+		kRoomStateChanged = 64,
+		kRoomStats = 65,
+		kLocalStreamStats = 66,
+		kRemoteStreamStats = 67,
+		kLeaveRoom = 68,
+		kUserJoined = 69,
+		kUserLeave = 70,
+		kUserPublishStream = 71,
+		kUserUnpublishStream = 72,
+		kUserPublishScreen = 73,
+		kUserUnpublishScreen = 74,
+		kStreamSubscribed = 75,
+		kStreamPublishSuccess = 76,
+		kRoomMessageReceived = 77,
+		kUserMessageReceived = 78,
+		kUserBinaryMessageReceived = 79,
+	};
+
+	constexpr char kCallbackTraceMagic[] = "VRDCB";
+	constexpr uint8_t kCallbackTraceVersion = 1;
+
+	// {zh} 指针加长度形式的参数，只用于录制
+	// {en} Pointer-plus-count arguments, only used when recording
+	template <class T>
+	struct TraceSpan {
+		const T* data;
+		int size;
+	};
+
+	struct TraceBlob {
+		const void* data;
+		int size;
+	};
+
+	template <class T>
+	TraceSpan<T> traceSpan(const T* data, int size) {
+		return TraceSpan<T>{ data, size };
+	}
+
+	class CallbackTraceWriter
+	{
+	public:
+		explicit CallbackTraceWriter(std::string& out) : out_(out) {
+		}
+
+		template <class T>
+		CallbackTraceWriter& operator()(const T& value) {
+			put(value);
+			return *this;
+		}
+
+		void varint(uint64_t value);
+		void blob(const void* data, int size);
+		void floats(const float* data, int size);
+
+	private:
+		void put(bool value);
+		void put(float value);
+		void put(double value);
+		void put(const char* value);
+		void put(const TraceBlob& value);
+
+		template <class T>
+		typename std::enable_if<std::is_integral<T>::value>::type put(T value) {
+			auto wide = static_cast<int64_t>(value);
+			varint((static_cast<uint64_t>(wide) << 1) ^ static_cast<uint64_t>(wide >> 63));
+		}
+		template <class T>
+		typename std::enable_if<std::is_enum<T>::value>::type put(T value) {
+			put(static_cast<typename std::underlying_type<T>::type>(value));
+		}
+		template <class T>
+		typename std::enable_if<std::is_class<T>::value>::type put(const T& value) {
+			// {zh} 字段表对读写共用，写入时不会修改
+			// {en} Field lists are shared by reader and writer, the writer never modifies them
+			traceFields(*this, const_cast<T&>(value));
+		}
+		template <class T>
+		void put(const TraceSpan<T>& span) {
+			auto size = span.data != nullptr && span.size > 0 ? span.size : 0;
+			varint(static_cast<uint64_t>(size));
+			for (int i = 0; i < size; ++i) {
+				put(span.data[i]);
+			}
+		}
+
+		std::string& out_;
+	};
+
+	class CallbackTraceReader
+	{
+	public:
+		CallbackTraceReader(const char* data, size_t size) : pos_(data), end_(data + size) {
+		}
+
+		template <class T>
+		CallbackTraceReader& operator()(T& value) {
+			get(value);
+			return *this;
+		}
+
+		bool ok() const {
+			return ok_;
+		}
+		bool atEnd() const {
+			return pos_ >= end_;
+		}
+		const char* position() const {
+			return pos_;
+		}
+		uint64_t varint();
+		bool skip(size_t size);
+		void floats(float* data, int size);
+		// {zh} 数据存放在读取器内，clearStrings 之前一直有效
+		// {en} The data lives in the reader and stays valid until clearStrings
+		template <class T>
+		void blob(T*& data, int& size) {
+			auto length = varint();
+			if (!ok_ || length > static_cast<uint64_t>(end_ - pos_)) {
+				ok_ = false;
+				data = nullptr;
+				size = 0;
+				return;
+			}
+			strings_.emplace_back(pos_, static_cast<size_t>(length));
+			pos_ += length;
+			data = reinterpret_cast<T*>(&strings_.back()[0]);
+			size = static_cast<int>(length);
+		}
+		template <class T>
+		void span(std::vector<T>& out) {
+			auto size = varint();
+			// {zh} 每个元素至少占1字节，借此拒绝损坏的长度
+			// {en} Every element takes at least one byte, which rejects corrupt counts
+			if (!ok_ || size > static_cast<uint64_t>(end_ - pos_)) {
+				ok_ = false;
+				out.clear();
+				return;
+			}
+			out.resize(static_cast<size_t>(size));
+			for (auto& item : out) {
+				get(item);
+			}
+		}
+		void clearStrings() {
+			strings_.clear();
+		}
+
+	private:
+		void get(bool& value);
+		void get(float& value);
+		void get(double& value);
+		void get(const char*& value);
+
+		template <class T>
+		typename std::enable_if<std::is_integral<T>::value>::type get(T& value) {
+			auto raw = varint();
+			value = static_cast<T>(static_cast<int64_t>(raw >> 1) ^ -static_cast<int64_t>(raw & 1));
+		}
+		template <class T>
+		typename std::enable_if<std::is_enum<T>::value>::type get(T& value) {
+			typename std::underlying_type<T>::type raw = 0;
+			get(raw);
+			value = static_cast<T>(raw);
+		}
+		template <class T>
+		typename std::enable_if<std::is_class<T>::value>::type get(T& value) {
+			traceFields(*this, value);
+		}
+
+		const char* pos_;
+		const char* end_;
+		bool ok_ = true;
+		// {zh} deque 追加元素时不移动已有字符串，回调拿到的指针保持有效
+		// {en} deque does not move existing strings on append, so pointers handed to callbacks stay valid
+		std::deque<std::string> strings_;
+	};
+
+	// {zh} 各结构体的字段表，新增字段只能追加在末尾并提升版本号
+	// {en} Field lists of each struct, new fields may only be appended at the end with a version bump
+	template <class Io>
+	void traceFields(Io& io, bytertc::UserInfo& s) {
+		io(s.uid)(s.extra_info);
+	}
+
+	template <class Io>
+	void traceFields(Io& io, bytertc::RemoteStreamKey& s) {
+		io(s.room_id)(s.user_id)(s.stream_index);
+	}
+
+	template <class Io>
+	void traceFields(Io& io, bytertc::RtcRoomStats& s) {
+		io(s.txLostrate)(s.rxLostrate)(s.rtt)(s.duration)(s.tx_bytes)(s.rx_bytes)
+			(s.tx_kbitrate)(s.rx_kbitrate)(s.rx_audio_kbitrate)(s.tx_audio_kbitrate)
+			(s.rx_video_kbitrate)(s.tx_video_kbitrate)(s.rx_screen_kbitrate)(s.tx_screen_kbitrate)
+			(s.user_count)(s.cpu_app_usage)(s.cpu_total_usage)(s.tx_jitter)(s.rx_jitter)
+			(s.tx_cellular_kbitrate)(s.rx_cellular_kbitrate);
+	}
+
+	template <class Io>
+	void traceFields(Io& io, bytertc::LocalAudioStats& s) {
+		io(s.audio_loss_rate)(s.send_kbitrate)(s.record_sample_rate)(s.stats_interval)(s.rtt)
+			(s.num_channels)(s.sent_sample_rate)(s.jitter);
+	}
+
+	template <class Io>
+	void traceFields(Io& io, bytertc::LocalVideoStats& s) {
+		io(s.sent_kbitrate)(s.input_frame_rate)(s.sent_frame_rate)(s.encoder_output_frame_rate)
+			(s.renderer_output_frame_rate)(s.stats_interval)(s.video_loss_rate)(s.rtt)(s.encoded_bitrate)
+			(s.encoded_frame_width)(s.encoded_frame_height)(s.encoded_frame_count)(s.codec_type)
+			(s.is_screen)(s.jitter)(s.video_denoise_mode);
+	}
+
+	template <class Io>
+	void traceFields(Io& io, bytertc::LocalStreamStats& s) {
+		io(s.audio_stats)(s.video_stats)(s.local_tx_quality)(s.local_rx_quality)(s.is_screen);
+	}
+
+	template <class Io>
+	void traceFields(Io& io, bytertc::RemoteAudioStats& s) {
+		io(s.audio_loss_rate)(s.received_kbitrate)(s.stall_count)(s.stall_duration)(s.e2e_delay)
+			(s.playout_sample_rate)(s.stats_interval)(s.rtt)(s.total_rtt)(s.quality)
+			(s.jitter_buffer_delay)(s.num_channels)(s.received_sample_rate)(s.frozen_rate)
+			(s.concealed_samples)(s.concealment_event)(s.dec_sample_rate)(s.dec_duration)(s.jitter);
+	}
+
+	template <class Io>
+	void traceFields(Io& io, bytertc::RemoteVideoStats& s) {
+		io(s.width)(s.height)(s.video_loss_rate)(s.received_kbitrate)(s.decoder_output_frame_rate)
+			(s.renderer_output_frame_rate)(s.stall_count)(s.stall_duration)(s.e2e_delay)(s.is_screen)
+			(s.stats_interval)(s.rtt)(s.frozen_rate)(s.codec_type)(s.video_index)(s.jitter)
+			(s.super_resolution_mode);
+	}
+
+	template <class Io>
+	void traceFields(Io& io, bytertc::RemoteStreamStats& s) {
+		io(s.uid)(s.audio_stats)(s.video_stats)(s.remote_tx_quality)(s.remote_rx_quality)(s.is_screen);
+	}
+
+	template <class Io>
+	void traceFields(Io& io, bytertc::SysStats& s) {
+		io(s.cpu_cores)(s.cpu_app_usage)(s.cpu_total_usage)(s.memory_usage)(s.full_memory)
+			(s.total_memory_usage)(s.free_memory)(s.memory_ratio)(s.total_memory_ratio);
+	}
+
+	template <class Io>
+	void traceFields(Io& io, bytertc::VideoFrameInfo& s) {
+		io(s.width)(s.height)(s.rotation);
+	}
+
+	template <class Io>
+	void traceFields(Io& io, bytertc::SubscribeConfig& s) {
+		io(s.is_screen)(s.sub_video)(s.sub_audio)(s.video_index)(s.priority)(s.svc_layer)
+			(s.framerate)(s.sub_width)(s.sub_height)(s.sub_video_index);
+	}
+
+	template <class Io>
+	void traceFields(Io& io, bytertc::ServerACKMsg& s) {
+		io.blob(s.ACKMsg, s.length);
+	}
+
+	template <class Io>
+	void traceFields(Io& io, bytertc::AudioPropertiesInfo& s) {
+		io(s.linear_volume)(s.nonlinear_volume);
+		io.floats(s.spectrum, SPECTRUM_SIZE);
+		io(s.vad);
+	}
+
+	template <class Io>
+	void traceFields(Io& io, bytertc::RemoteAudioPropertiesInfo& s) {
+		io(s.stream_key)(s.audio_properties_info);
+	}
+
+	template <class Io>
+	void traceFields(Io& io, bytertc::LocalAudioPropertiesInfo& s) {
+		io(s.stream_index)(s.audio_properties_info);
+	}
+}
+
+#endif // VRD_RTCCALLBACKTRACE_H
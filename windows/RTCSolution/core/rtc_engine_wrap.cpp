@@ -1,4 +1,10 @@
 #include "rtc_engine_wrap.h"
+#include "device_registry.h"
+#include "microphone_probe.h"
+#include "rtc_callback_recorder.h"
+#include "trace_event.h"
+#include <QJsonDocument>
+#include <QJsonObject>
 #define API_CALL_ERROR 999
 
 #define CHECK_POINTER(X, Y) \
@@ -61,7 +67,16 @@ int RtcEngineWrap::SetDeviceId(const std::string& device_id) {
 }
 
 void RtcEngineWrap::createEngine(const std::string& app_id) {
-    video_engine_.reset(bytertc::createRTCVideo(app_id.c_str(), this, nullptr));
+    bytertc::IRTCVideoEventHandler* video_handler = this;
+    room_handler_ = this;
+    // {zh} 录制开启时，引擎和房间的回调先经过录制器再转发回来
+    // {en} While recording, engine and room callbacks pass through the recorder before reaching us
+    if (vrd::RtcCallbackRecorder::enabled()) {
+        vrd::RtcCallbackRecorder::instance().setTarget(this, this);
+        video_handler = &vrd::RtcCallbackRecorder::instance();
+        room_handler_ = &vrd::RtcCallbackRecorder::instance();
+    }
+    video_engine_.reset(bytertc::createRTCVideo(app_id.c_str(), video_handler, nullptr));
 }
 
 std::string RtcEngineWrap::getSDKVersion() { 
@@ -69,6 +84,9 @@ std::string RtcEngineWrap::getSDKVersion() {
 }
 
 void RtcEngineWrap::destroyEngine() {
+    // {zh} 设备管理器属于引擎，先停止使用它们的后台探测
+    // {en} The device managers belong to the engine, stop the background probe using them first
+    resetDevices();
     video_engine_.reset();
 }
 
@@ -77,6 +95,8 @@ int RtcEngineWrap::initDevices() {
     CHECK_POINTER(video_engine_, -API_CALL_ERROR);
     audio_device_manager_.reset(video_engine_->getAudioDeviceManager());
     video_device_manager_.reset(video_engine_->getVideoDeviceManager());
+    vrd::DeviceRegistry::instance().attach(audio_device_manager_.get(), video_device_manager_.get());
+    vrd::MicrophoneProbe::instance().start(audio_device_manager_.get());
 
     video_engine_->startVideoCapture();
     video_engine_->startAudioCapture();
@@ -94,6 +114,8 @@ int RtcEngineWrap::initDevices() {
 }
 
 void RtcEngineWrap::resetDevices() {
+	vrd::MicrophoneProbe::instance().stop();
+	vrd::DeviceRegistry::instance().detach();
 	video_device_manager_.reset();
 	audio_device_manager_.reset();
 }
@@ -124,8 +146,10 @@ int RtcEngineWrap::joinRoom(const std::string& token,
                             const std::string& room_id,
                             const bytertc::UserInfo& userInfo,
                             bytertc::RoomProfileType profileType) {
+  VRD_TRACE_SCOPE("rtc", "joinRoom");
   CHECK_POINTER(video_engine_, -API_CALL_ERROR);
   room_id_ = room_id;
+  subscriptions_.clear();
 
   bytertc::RTCRoomConfig config;
   config.room_profile_type = profileType;
@@ -174,6 +198,42 @@ int RtcEngineWrap::setLocalVideoCanvas(const std::string& uid,
   return video_engine_->setLocalVideoCanvas(index, vc);
 }
 
+int RtcEngineWrap::requestRemoteVideoKeyFrame(const std::string& user_id,
+                                              bytertc::StreamIndex index,
+                                              const std::string& room_id) {
+    CHECK_POINTER(video_engine_, -API_CALL_ERROR);
+    bytertc::RemoteStreamKey key;
+    key.room_id = room_id.empty() ? room_id_.c_str() : room_id.c_str();
+    key.user_id = user_id.c_str();
+    key.stream_index = index;
+    video_engine_->requestRemoteVideoKeyFrame(key);
+    return 0;
+}
+
+int RtcEngineWrap::pauseAllSubscribedStream(
+        bytertc::PauseResumeControlMediaType media_type) {
+    // {zh} 仅作用于已加入的房间，避免在退房后重新创建房间对象
+    // {en} Only applies to the joined room, so a room is not re-created after leaving
+    auto find_it = rooms_.find(room_id_);
+    if (find_it != rooms_.cend()) {
+        find_it->second->pauseAllSubscribedStream(media_type);
+        return 0;
+    }
+    return -API_CALL_ERROR;
+}
+
+int RtcEngineWrap::resumeAllSubscribedStream(
+        bytertc::PauseResumeControlMediaType media_type) {
+    // {zh} 仅作用于已加入的房间，避免在退房后重新创建房间对象
+    // {en} Only applies to the joined room, so a room is not re-created after leaving
+    auto find_it = rooms_.find(room_id_);
+    if (find_it != rooms_.cend()) {
+        find_it->second->resumeAllSubscribedStream(media_type);
+        return 0;
+    }
+    return -API_CALL_ERROR;
+}
+
 int RtcEngineWrap::startPreview() {
   CHECK_POINTER(video_engine_, -API_CALL_ERROR);
   video_engine_->startVideoCapture();
@@ -236,6 +296,7 @@ int RtcEngineWrap::leaveRoom() {
     if (auto rtcRoom = getRtcRoom(room_id_)) {
         rtcRoom->leaveRoom();
     }
+    subscriptions_.clear();
     destoryRtcRoom(room_id_);
     return 0;
 }
@@ -274,35 +335,53 @@ int RtcEngineWrap::unPublish() {
 
 int RtcEngineWrap::subscribeVideoStream(
         const std::string& uid, const bytertc::SubscribeConfig& config) {
-    bool sub_audio = config.sub_audio;
-    bool sub_video = config.sub_video;
-    bytertc::MediaStreamType media_type;
-    if (sub_audio && sub_video) {
-        media_type = bytertc::MediaStreamType::kMediaStreamTypeBoth;
-    }
-    else if (!sub_audio && sub_video) {
-        media_type = bytertc::MediaStreamType::kMediaStreamTypeVideo;
-    }
-    else if (!sub_video && sub_audio) {
-        media_type = bytertc::MediaStreamType::kMediaStreamTypeAudio;
-    }
-
-    bytertc::SubscribeVideoConfig videoConfig;
-    videoConfig.priority = config.priority;
-    videoConfig.video_index = config.video_index;
-    if (auto rtcRoom = getRtcRoom(room_id_)) {
-        config.is_screen ? rtcRoom->subscribeScreen(uid.c_str(), media_type)
-                        : rtcRoom->subscribeStream(uid.c_str(), media_type);
-    }
-    return 0;
+    auto subscription = subscriptions_.desired(uid, config.is_screen);
+    subscription.audio = config.sub_audio;
+    subscription.video = config.sub_video;
+    return applySubscriptions({ subscription });
 }
 
 int RtcEngineWrap::unSubscribeVideoStream(const std::string& uid,
                                           bool is_screen) {
-    if (auto rtcRoom = getRtcRoom(room_id_)) {
-        is_screen ? rtcRoom->unsubscribeScreen(uid.c_str(), bytertc::MediaStreamType::kMediaStreamTypeBoth)
-            : rtcRoom->unsubscribeStream(uid.c_str(), bytertc::MediaStreamType::kMediaStreamTypeBoth);
+    auto subscription = subscriptions_.desired(uid, is_screen);
+    subscription.audio = false;
+    subscription.video = false;
+    return applySubscriptions({ subscription });
+}
+
+/** {zh}
+ * 只切换某个用户主流的视频订阅，音频保持订阅
+ */
+
+/** {en}
+* Toggle only the video subscription of a user's main stream, audio stays subscribed
+*/
+int RtcEngineWrap::setRemoteVideoSubscribed(const std::string& uid,
+                                            bool subscribed) {
+    auto subscription = subscriptions_.desired(uid, false);
+    subscription.video = subscribed;
+    return applySubscriptions({ subscription });
+}
+
+int RtcEngineWrap::applySubscriptions(
+        const std::vector<vrd::StreamSubscription>& subscriptions) {
+    for (auto& subscription : subscriptions) {
+        subscriptions_.setDesired(subscription);
+    }
+    return syncSubscriptions();
+}
+
+vrd::StreamSubscription RtcEngineWrap::desiredSubscription(const std::string& uid,
+                                                           bool is_screen) const {
+    return subscriptions_.desired(uid, is_screen);
+}
+
+int RtcEngineWrap::syncSubscriptions() {
+    auto find_it = rooms_.find(room_id_);
+    if (find_it == rooms_.cend()) {
+        return -API_CALL_ERROR;
     }
+    subscriptions_.apply(find_it->second.get());
     return 0;
 }
 
@@ -382,8 +461,14 @@ int RtcEngineWrap::getShareList(std::vector<SnapshotAttr>& list) {
 QPixmap RtcEngineWrap::getThumbnail(SnapshotAttr::SnapshotType type,
                                     void* source_id, int max_width,
                                     int max_height) {
-    QPixmap pix_map;
-    CHECK_POINTER(video_engine_, pix_map);
+    return QPixmap::fromImage(getThumbnailImage(type, source_id, max_width, max_height));
+}
+
+QImage RtcEngineWrap::getThumbnailImage(SnapshotAttr::SnapshotType type,
+                                        void* source_id, int max_width,
+                                        int max_height) {
+    QImage image;
+    CHECK_POINTER(video_engine_, image);
 
     auto s_type = bytertc::kScreenCaptureSourceTypeUnknown;
     switch (type) {
@@ -397,227 +482,70 @@ QPixmap RtcEngineWrap::getThumbnail(SnapshotAttr::SnapshotType type,
         break;
     }
     auto p = video_engine_->getThumbnail(s_type, source_id, max_width, max_height);
-    CHECK_POINTER(p, pix_map);
+    CHECK_POINTER(p, image);
 
-    QImage img(reinterpret_cast<uchar*>(p->getPlaneData(0)), p->width(),
-        p->height(), QImage::Format::Format_RGB32);
-    return QPixmap::fromImage(img);
+    image = QImage(reinterpret_cast<uchar*>(p->getPlaneData(0)), p->width(),
+        p->height(), QImage::Format::Format_RGB32).copy();
+    p->release();
+    return image;
 }
 
 int RtcEngineWrap::getAudioInputDevices(std::vector<RtcDevice>& devices) {
     CHECK_POINTER(this->audio_device_manager_, -API_CALL_ERROR);
-    char szName[512], szId[512];
-    std::string strSelectedDeviceId;
-
-    int devIdx = 0;
-    audio_input_devices_.clear();
-    bytertc::IDeviceCollection* pAudioRecordCollection =
-        audio_device_manager_->enumerateAudioCaptureDevices();
-    if (pAudioRecordCollection) {
-        memset(szName, 0, sizeof(szName));
-        memset(szId, 0, sizeof(szId));
-        devIdx = 0;
-
-        audio_device_manager_->getAudioCaptureDevice(szId);
-        strSelectedDeviceId = szId;
-
-        int nAudioRecNum = pAudioRecordCollection->getCount();
-        if (nAudioRecNum > 0) {
-            for (int i = 0; i < nAudioRecNum; ++i) {
-                memset(szName, 0, sizeof(szName));
-                memset(szId, 0, sizeof(szId));
-                if (pAudioRecordCollection->getDevice(i, szName, szId) == 0) {
-                    if (strSelectedDeviceId == szId) {
-                        current_audio_input_idx_ = i;
-                    }
-                    RtcDevice device;
-                    device.type = RtcDeviceTypeAudioRecord;
-                    device.name = szName;
-                    device.device_id = szId;
-                    audio_input_devices_.push_back(device);
-                }
-            }
-        }
-        devices = audio_input_devices_;
-        pAudioRecordCollection->release();
-        pAudioRecordCollection = nullptr;
-    }
+    vrd::DeviceRegistry::instance().devices(RtcDeviceTypeAudioRecord, devices);
     return 0;
 }
 
 int RtcEngineWrap::setAudioInputDevice(int index) {
-    if (audio_input_devices_.size() <= static_cast<unsigned int>(index) ||
-        index < 0)
-        return -API_CALL_ERROR;
-    current_audio_input_idx_ = index;
+    auto device = vrd::DeviceRegistry::instance().at(RtcDeviceTypeAudioRecord, index);
+    CHECK_POINTER(device, -API_CALL_ERROR);
     audio_device_manager_->followSystemCaptureDevice(false);
-    return audio_device_manager_->setAudioCaptureDevice(
-        audio_input_devices_[index].device_id.c_str());
+    return audio_device_manager_->setAudioCaptureDevice(device->device_id.c_str());
 }
 
 int RtcEngineWrap::getAudioInputDevice(std::string& guid) {
-    guid.reserve(512);
-    return audio_device_manager_->getAudioCaptureDevice(
-        const_cast<char*>(guid.data()));
+    CHECK_POINTER(this->audio_device_manager_, -API_CALL_ERROR);
+    guid = vrd::DeviceRegistry::instance().currentId(RtcDeviceTypeAudioRecord);
+    return 0;
 }
 
 int RtcEngineWrap::getCurrentAudioInputDeviceIndex() {
-    return current_audio_input_idx_;
+    return vrd::DeviceRegistry::instance().currentIndex(RtcDeviceTypeAudioRecord);
 }
 
 int RtcEngineWrap::getAudioOutputDevices(std::vector<RtcDevice>& devices) {
-    CHECK_POINTER(video_engine_, -API_CALL_ERROR);
-    std::string strSelectedDeviceId;
-    char szName[512], szId[512];
-    int devIdx = 0;
-
-    audio_output_devices_.clear();
-
-    bytertc::IAudioDeviceManager* pAudioDeviceManager =
-        video_engine_->getAudioDeviceManager();
-    if (pAudioDeviceManager) {
-    bytertc::IDeviceCollection* pAudioPlayoutCollection =
-        pAudioDeviceManager->enumerateAudioPlaybackDevices();
-    if (pAudioPlayoutCollection) {
-        memset(szName, 0, sizeof(szName));
-        memset(szId, 0, sizeof(szId));
-        devIdx = 0;
-
-        pAudioDeviceManager->getAudioPlaybackDevice(szId);
-        strSelectedDeviceId = szId;
-
-        int nAudioRecNum = pAudioPlayoutCollection->getCount();
-        if (nAudioRecNum > 0) {
-        for (int i = 0; i < nAudioRecNum; ++i) {
-            memset(szName, 0, sizeof(szName));
-            memset(szId, 0, sizeof(szId));
-
-            if (pAudioPlayoutCollection->getDevice(i, szName, szId) == 0) {
-            if (strSelectedDeviceId == szId) {
-                current_audio_output_idx_ = i;
-            }
-
-            RtcDevice device;
-            device.type = RtcDeviceTypeAudioPlayout;
-            device.name = szName;
-            device.device_id = szId;
-
-            audio_output_devices_.push_back(device);
-            }
-        }
-        }
-        devices = audio_output_devices_;
-        pAudioPlayoutCollection->release();
-        pAudioPlayoutCollection = nullptr;
-    }
-    }
+    CHECK_POINTER(this->audio_device_manager_, -API_CALL_ERROR);
+    vrd::DeviceRegistry::instance().devices(RtcDeviceTypeAudioPlayout, devices);
     return 0;
 }
 
 int RtcEngineWrap::setAudioOutputDevice(int index) {
-    if (audio_output_devices_.size() >= static_cast<unsigned int>(index) 
-        || index < 0)
-        return -API_CALL_ERROR;
-    current_audio_output_idx_ = index;
+    auto device = vrd::DeviceRegistry::instance().at(RtcDeviceTypeAudioPlayout, index);
+    CHECK_POINTER(device, -API_CALL_ERROR);
     audio_device_manager_->followSystemPlaybackDevice(false);
-    return audio_device_manager_->setAudioPlaybackDevice(
-        audio_output_devices_[index].device_id.c_str());
+    return audio_device_manager_->setAudioPlaybackDevice(device->device_id.c_str());
 }
 
 int RtcEngineWrap::getAudioOutputDevice(std::string& guid) {
-    guid.resize(512);
-    return audio_device_manager_->getAudioPlaybackDevice(
-        const_cast<char*>(guid.c_str()));
+    CHECK_POINTER(this->audio_device_manager_, -API_CALL_ERROR);
+    guid = vrd::DeviceRegistry::instance().currentId(RtcDeviceTypeAudioPlayout);
+    return 0;
 }
 
 int RtcEngineWrap::getCurrentAudioOutputDeviceIndex() {
-    return current_audio_output_idx_;
+    return vrd::DeviceRegistry::instance().currentIndex(RtcDeviceTypeAudioPlayout);
 }
 
 int RtcEngineWrap::getVideoCaptureDevices(std::vector<RtcDevice>& devices) {
-    std::string strSelectedDeviceId;
-    char szName[512], szId[512];
-    int devIdx = 0;
-
-    camera_devices_.clear();
-
-    bytertc::IDeviceCollection* pVideoRecordCollection =
-        video_device_manager_->enumerateVideoCaptureDevices();
-    if (pVideoRecordCollection) {
-    memset(szName, 0, sizeof(szName));
-    memset(szId, 0, sizeof(szId));
-    devIdx = 0;
-
-    video_device_manager_->getVideoCaptureDevice(szId);
-    strSelectedDeviceId = szId;
-
-    int nVideoCaptureNum = pVideoRecordCollection->getCount();
-    if (nVideoCaptureNum > 0) {
-        current_camera_idx_ = 0;
-        for (int i = 0; i < nVideoCaptureNum; ++i) {
-        memset(szName, 0, sizeof(szName));
-        memset(szId, 0, sizeof(szId));
-
-        if (pVideoRecordCollection->getDevice(i, szName, szId) == 0) {
-            if (strSelectedDeviceId == szId) {
-            current_camera_idx_ = i;
-            }
-
-            RtcDevice device;
-            device.type = RtcDeviceTypeVideoCapture;
-            device.name = szName;
-            device.device_id = szId;
-
-            camera_devices_.push_back(device);
-        }
-        }
-    }
-    devices = camera_devices_;
-
-    pVideoRecordCollection->release();
-    pVideoRecordCollection = nullptr;
-    }
+    CHECK_POINTER(this->video_device_manager_, -API_CALL_ERROR);
+    vrd::DeviceRegistry::instance().devices(RtcDeviceTypeVideoCapture, devices);
     return 0;
 }
 
 int RtcEngineWrap::setVideoCaptureDevice(int index) {
-    if (camera_devices_.size() <= static_cast<unsigned int>(index) || index < 0)
-        return -API_CALL_ERROR;
-    return video_device_manager_->setVideoCaptureDevice(
-        camera_devices_[index].device_id.c_str());
-}
-
-bool RtcEngineWrap::audioReocrdDeviceTest() {
-    bool res = false;
-    char szName[512];
-    char szId[512];
-    if (audio_device_manager_) {
-        bytertc::IDeviceCollection* pAudioRecordCollection =
-            audio_device_manager_->enumerateAudioCaptureDevices();
-        if (pAudioRecordCollection) {
-            memset(szName, 0, sizeof(szName));
-            memset(szId, 0, sizeof(szId));
-
-            int nAudioRecNum = pAudioRecordCollection->getCount();
-            if (nAudioRecNum > 0) {
-                current_audio_input_idx_ = 0;
-                for (int i = 0; i < nAudioRecNum; ++i) {
-                    memset(szName, 0, sizeof(szName));
-
-                    if (pAudioRecordCollection->getDevice(i, szName, szId) == 0) {
-                        auto code =
-                            audio_device_manager_->initAudioCaptureDeviceForTest(szId);
-                        if (code == 0) {
-                            res = true;
-                        }
-                    }
-                }
-            }
-            pAudioRecordCollection->release();
-            pAudioRecordCollection = nullptr;
-        }
-    }
-    return res;
+    auto device = vrd::DeviceRegistry::instance().at(RtcDeviceTypeVideoCapture, index);
+    CHECK_POINTER(device, -API_CALL_ERROR);
+    return video_device_manager_->setVideoCaptureDevice(device->device_id.c_str());
 }
 
 int RtcEngineWrap::feedBack(bytertc::ProblemFeedbackOption* type, 
@@ -638,12 +566,37 @@ int RtcEngineWrap::setAudioVolumeIndicate(int indicate) {
     return 0;
 }
 
+int RtcEngineWrap::registerAudioFrameObserver(bytertc::IAudioFrameObserver* observer) {
+    CHECK_POINTER(video_engine_, -API_CALL_ERROR);
+    video_engine_->registerAudioFrameObserver(observer);
+    return 0;
+}
+
+int RtcEngineWrap::enableAudioFrameCallback(bytertc::AudioFrameCallbackMethod method, bytertc::AudioFormat format) {
+    CHECK_POINTER(video_engine_, -API_CALL_ERROR);
+    video_engine_->enableAudioFrameCallback(method, format);
+    return 0;
+}
+
+int RtcEngineWrap::disableAudioFrameCallback(bytertc::AudioFrameCallbackMethod method) {
+    CHECK_POINTER(video_engine_, -API_CALL_ERROR);
+    video_engine_->disableAudioFrameCallback(method);
+    return 0;
+}
+
 void RtcEngineWrap::emitOnRTSMessageArrived(const char* uid, const char* message) {
 	ForwardEvent::PostEvent(this, [=, uid = std::string(uid), message = std::string(message)]{
 	    emit sigOnMessageReceived(uid, message);
 	});
 }
 
+void RtcEngineWrap::emitOnRTSBinaryMessageArrived(const char* uid, int size, const uint8_t* message) {
+	ForwardEvent::PostEvent(this, [=, uid = std::string(uid),
+		message = std::string(reinterpret_cast<const char*>(message), size > 0 ? size : 0)]{
+	    emit sigOnBinaryMessageReceived(uid, message);
+	});
+}
+
 std::unique_ptr<bytertc::IRTCVideo, std::function<void(bytertc::IRTCVideo*)>>&
 RtcEngineWrap::getRtcEngine() {
 	return video_engine_;
@@ -669,18 +622,18 @@ std::shared_ptr<bytertc::IRTCRoom> RtcEngineWrap::getRtcRoom(const std::string&
     rooms_[room_id] = std::shared_ptr<bytertc::IRTCRoom>(
         video_engine_->createRTCRoom(room_id.c_str()),
         [=](bytertc::IRTCRoom* room) { room->destroy(); });
-    rooms_[room_id]->setRTCRoomEventHandler(this);
+    rooms_[room_id]->setRTCRoomEventHandler(room_handler_);
     return rooms_[room_id];
 }
 
 int RtcEngineWrap::getVideoCaptureDevice(std::string& guid) {
-    guid.resize(512);
-    return video_device_manager_->getVideoCaptureDevice(
-        const_cast<char*>(guid.c_str()));
+    CHECK_POINTER(this->video_device_manager_, -API_CALL_ERROR);
+    guid = vrd::DeviceRegistry::instance().currentId(RtcDeviceTypeVideoCapture);
+    return 0;
 }
 
 int RtcEngineWrap::getCurrentVideoCaptureDeviceIndex() {
-    return current_camera_idx_;
+    return vrd::DeviceRegistry::instance().currentIndex(RtcDeviceTypeVideoCapture);
 }
 
 void RtcEngineWrap::followSystemCaptureDevice(bool enabled) {
@@ -762,8 +715,30 @@ int RtcEngineWrap::stopScreenAudioCapture() {
     return 0;
 }
 
+int RtcEngineWrap::setVideoSourceType(bytertc::StreamIndex index, bytertc::VideoSourceType type) {
+    CHECK_POINTER(video_engine_, -API_CALL_ERROR);
+    video_engine_->setVideoSourceType(index, type);
+    return 0;
+}
+
+int RtcEngineWrap::pushExternalVideoFrame(bytertc::IVideoFrame* frame) {
+    CHECK_POINTER(video_engine_, -API_CALL_ERROR);
+    return video_engine_->pushExternalVideoFrame(frame);
+}
+
+int RtcEngineWrap::setAudioSourceType(bytertc::AudioSourceType type) {
+    CHECK_POINTER(video_engine_, -API_CALL_ERROR);
+    return video_engine_->setAudioSourceType(type);
+}
+
+int RtcEngineWrap::pushExternalAudioFrame(bytertc::IAudioFrame* frame) {
+    CHECK_POINTER(video_engine_, -API_CALL_ERROR);
+    return video_engine_->pushExternalAudioFrame(frame);
+}
+
 void RtcEngineWrap::onRoomStateChanged(const char* room_id, const char* uid,
                                        int state, const char* extra_info) {
+    VRD_TRACE_INSTANT("rtc", "onRoomStateChanged");
     ForwardEvent::PostEvent(
         this, [=, rid = std::string(room_id), uid = std::string(uid),
         extra_info = std::string(extra_info)]{
@@ -788,7 +763,28 @@ void RtcEngineWrap::onRemoteStreamStats(
     wrap.remote_tx_quality = stats.remote_tx_quality;
     wrap.uid = stats.uid;
     wrap.video_stats = stats.video_stats;
-    ForwardEvent::PostEvent(this, [=] { emit sigOnRemoteStreamStats(wrap); });
+    bool post = false;
+    {
+        std::lock_guard<std::mutex> lock(remote_stats_mutex_);
+        pending_remote_stats_[wrap.uid] = std::move(wrap);
+        post = !remote_stats_flush_posted_;
+        remote_stats_flush_posted_ = true;
+    }
+    if (post) {
+        ForwardEvent::PostEvent(this, [this] { flushRemoteStreamStats(); });
+    }
+}
+
+void RtcEngineWrap::flushRemoteStreamStats() {
+    std::map<std::string, RemoteStreamStatsWrap> batch;
+    {
+        std::lock_guard<std::mutex> lock(remote_stats_mutex_);
+        batch.swap(pending_remote_stats_);
+        remote_stats_flush_posted_ = false;
+    }
+    for (const auto& item : batch) {
+        emit sigOnRemoteStreamStats(item.second);
+    }
 }
 
 void RtcEngineWrap::onWarning(int warn) {
@@ -808,7 +804,8 @@ void RtcEngineWrap::onRemoteAudioPropertiesReport(
             audio_properties_infos[i].audio_properties_info.linear_volume,
             audio_properties_infos[i].stream_key.stream_index,
             audio_properties_infos[i].stream_key.user_id,
-            audio_properties_infos[i].stream_key.room_id
+            audio_properties_infos[i].stream_key.room_id,
+            audio_properties_infos[i].audio_properties_info.vad
         };
         vec_.push_back(std::move(wrap));
     }
@@ -822,6 +819,9 @@ void RtcEngineWrap::onLocalAudioPropertiesReport(const bytertc::LocalAudioProper
         AudioVolumeInfoWrap wrap{
             audio_properties_infos[i].audio_properties_info.linear_volume,
             audio_properties_infos[i].stream_index,
+            "",
+            "",
+            audio_properties_infos[i].audio_properties_info.vad
         };
         vec_.push_back(std::move(wrap));
     }
@@ -838,13 +838,20 @@ void RtcEngineWrap::onUserJoined(const bytertc::UserInfo& userInfo,
     UserInfoWrap wrap;
     wrap.uid = std::string(userInfo.uid);
     wrap.extra_info = std::string(userInfo.extra_info);
+    // {zh} 在回调线程解析，保持与用户离开回调的先后顺序
+    // {en} Parsed on the callback thread so the order relative to the user leave callback is kept
+    auto infoArray = QByteArray(wrap.extra_info.data(), static_cast<int>(wrap.extra_info.size()));
+    wrap.user_name = std::string(QJsonDocument::fromJson(infoArray).object()["user_name"].toString().toUtf8());
     ForwardEvent::PostEvent(this, [=] { emit sigOnUserJoined(wrap, elapsed); });
 }
 
 void RtcEngineWrap::onUserLeave(const char* uid,
                                 bytertc::UserOfflineReason reason) {
     ForwardEvent::PostEvent(
-        this, [=, uid = std::string(uid)]{ emit sigOnUserLeave(uid, reason); });
+        this, [=, uid = std::string(uid)]{
+            subscriptions_.onUserLeave(uid);
+            emit sigOnUserLeave(uid, reason);
+        });
 }
 
 void RtcEngineWrap::onUserStartAudioCapture(const char* room_id, const char* user_id) {
@@ -872,6 +879,10 @@ void RtcEngineWrap::onLogReport(const char* log_type, const char* log_content) {
 
 void RtcEngineWrap::onUserPublishStream(const char* uid, bytertc::MediaStreamType type) {
     ForwardEvent::PostEvent(this, [=, uid = std::string(uid)]{
+        // {zh} 自动订阅已订阅新发布的媒体，把它补齐到期望的订阅状态
+        // {en} Auto subscribe has taken the new media, bring it to the desired subscription
+        subscriptions_.onPublished(uid, false, type);
+        syncSubscriptions();
         emit sigOnUserPublishStream(uid, type);
     });
 }
@@ -879,12 +890,15 @@ void RtcEngineWrap::onUserPublishStream(const char* uid, bytertc::MediaStreamTyp
 void RtcEngineWrap::onUserUnpublishStream(const char* uid, bytertc::MediaStreamType type,
         bytertc::StreamRemoveReason reason) {
     ForwardEvent::PostEvent(this, [=, uid = std::string(uid)]{
+        subscriptions_.onUnpublished(uid, false, type);
         emit sigOnUserUnPublishStream(uid, type, reason);
     });
 }
 
 void RtcEngineWrap::onUserPublishScreen(const char* uid, bytertc::MediaStreamType type) {
     ForwardEvent::PostEvent(this, [=, uid = std::string(uid)]{
+        subscriptions_.onPublished(uid, true, type);
+        syncSubscriptions();
         emit sigOnUserPublishScreen(uid, type);
     });
 }
@@ -892,6 +906,7 @@ void RtcEngineWrap::onUserPublishScreen(const char* uid, bytertc::MediaStreamTyp
 void RtcEngineWrap::onUserUnpublishScreen(const char* uid,
     bytertc::MediaStreamType type, bytertc::StreamRemoveReason reason) {
     ForwardEvent::PostEvent(this, [=, uid = std::string(uid)]{
+        subscriptions_.onUnpublished(uid, true, type);
         emit sigOnUserUnPublishScreen(uid, type, reason);
     });
 }
@@ -912,12 +927,14 @@ void RtcEngineWrap::onStreamPublishSuccess(const char* user_id,
 
 void RtcEngineWrap::onFirstLocalVideoFrameCaptured(
     bytertc::StreamIndex index, bytertc::VideoFrameInfo info) {
+  VRD_TRACE_INSTANT("rtc", "onFirstLocalVideoFrameCaptured");
   ForwardEvent::PostEvent(
       this, [=] { emit sigOnFirstLocalVideoFrameCaptured(index, info); });
 }
 
 void RtcEngineWrap::onFirstRemoteVideoFrameDecoded(
     const bytertc::RemoteStreamKey key, const bytertc::VideoFrameInfo& info) {
+    VRD_TRACE_INSTANT("rtc", "onFirstRemoteVideoFrameDecoded");
     RemoteStreamKeyWrap wrap;
     wrap.room_id = std::string(key.room_id);
     wrap.user_id = std::string(key.user_id);
@@ -942,6 +959,8 @@ void RtcEngineWrap::onAudioDeviceStateChanged(const char* device_id,
     bytertc::RTCAudioDeviceType device_type, bytertc::MediaDeviceState device_state, 
     bytertc::MediaDeviceError device_error) {
     ForwardEvent::PostEvent(this, [=, device_id = std::string(device_id)]{
+        vrd::DeviceRegistry::instance().onAudioDeviceStateChanged(device_id, device_type, device_state,
+                                    device_error);
         emit sigOnAudioDeviceStateChanged(device_id, device_type, device_state,
                                     device_error);
     });
@@ -951,6 +970,8 @@ void RtcEngineWrap::onVideoDeviceStateChanged(const char* device_id,
     bytertc::RTCVideoDeviceType device_type, bytertc::MediaDeviceState device_state,
     bytertc::MediaDeviceError device_error) {
     ForwardEvent::PostEvent(this, [=, device_id = std::string(device_id)]{
+        vrd::DeviceRegistry::instance().onVideoDeviceStateChanged(device_id, device_type, device_state,
+                                    device_error);
         emit sigOnVideoDeviceStateChanged(device_id, device_type, device_state,
                                     device_error);
     });
@@ -987,6 +1008,7 @@ void RtcEngineWrap::onNetworkTypeChanged(bytertc::NetworkType type) {
 }
 
 void RtcEngineWrap::onLoginResult(const char* uid, int error_code, int elapsed) {
+	VRD_TRACE_INSTANT("rtc", "onLoginResult");
 	ForwardEvent::PostEvent(this, [=, uid = std::string(uid)]{
 	emit sigOnLoginResult(uid, error_code, elapsed);
 		});
@@ -1008,6 +1030,14 @@ void RtcEngineWrap::onUserMessageReceivedOutsideRoom(const char* uid, const char
     emitOnRTSMessageArrived(uid, message);
 }
 
+void RtcEngineWrap::onUserBinaryMessageReceived(const char* uid, int size, const uint8_t* message) {
+    emitOnRTSBinaryMessageArrived(uid, size, message);
+}
+
+void RtcEngineWrap::onUserBinaryMessageReceivedOutsideRoom(const char* uid, int size, const uint8_t* message) {
+    emitOnRTSBinaryMessageArrived(uid, size, message);
+}
+
 void RtcEngineWrap::onServerMessageSendResult(int64_t msgid, int error, const bytertc::ServerACKMsg& msg) {
     ForwardEvent::PostEvent(this, [=] { emit sigOnServerMessageSendResult(msgid, error, msg); });
 }
@@ -4,11 +4,14 @@
 #include <QObject>
 #include <QPixmap>
 #include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 
 #include "core/common_define.h"
+#include "core/subscription_set.h"
 #include "rtc/bytertc_advance.h"
 #include "rtc/bytertc_engine_interface.h"
 #include "rtc/bytertc_video_frame.h"
@@ -38,6 +41,9 @@ public:
         QCoreApplication::postEvent(obj, event);
     }
     std::function<void(void)> task_;
+    // {zh} 耗时统计中显示的名称，为空时使用任务的类型名
+    // {en} Name shown in handler timings, the task's type name is used when empty
+    const char* label_ = nullptr;
 };
 
 enum {
@@ -71,6 +77,9 @@ struct RtcDevice {
     std::string name;
     std::string device_id;
     int type;
+    // {zh} vrd::DeviceRegistry 分配的稳定序号，传给 set*Device；热插拔后不变
+    // {en} Stable index assigned by vrd::DeviceRegistry and passed to set*Device; unchanged across hot-plugs
+    int index = -1;
 };
 
 struct AudioVolumeInfoWrap {
@@ -78,6 +87,9 @@ struct AudioVolumeInfoWrap {
     bytertc::StreamIndex stream_index;
     std::string uid;
     std::string roomId;
+    // {zh} 1为有人声，0为无；SDK未开启VAD时为-1，只按音量判断
+    // {en} 1 for voice, 0 for none; -1 when the SDK has VAD off, judge by volume only
+    int vad;
     bool operator<(const AudioVolumeInfoWrap& rhs) {
         return this->volume < rhs.volume;
     }
@@ -95,6 +107,9 @@ struct RemoteStreamStatsWrap {
 struct UserInfoWrap {
     std::string uid;
     std::string extra_info;
+    // {zh} 从 extra_info 中解析出的用户名，在SDK回调线程解析
+    // {en} User name parsed from extra_info on the SDK callback thread
+    std::string user_name;
 };
 
 struct MediaStreamInfoWrap {
@@ -154,6 +169,10 @@ public:
 		void* view, const std::string& room_id = "");
 	int setLocalVideoCanvas(const std::string& uid, bytertc::StreamIndex index,
 		bytertc::RenderMode mode, void* view);
+	int requestRemoteVideoKeyFrame(const std::string& user_id,
+		bytertc::StreamIndex index, const std::string& room_id = "");
+	int pauseAllSubscribedStream(bytertc::PauseResumeControlMediaType media_type);
+	int resumeAllSubscribedStream(bytertc::PauseResumeControlMediaType media_type);
 
 	int startPreview();
 	int stopPreview();
@@ -171,6 +190,14 @@ public:
     int subscribeVideoStream(const std::string& uid,
         const bytertc::SubscribeConfig& config);
     int unSubscribeVideoStream(const std::string& uid, bool is_screen);
+    int setRemoteVideoSubscribed(const std::string& uid, bool subscribed);
+    // {zh} 设置所列各路流的期望订阅状态，与已应用的状态比较后一次发出最少的SDK调用；未发布的流在发布时补齐
+    // {en} Sets the desired state of each listed stream and issues the fewest SDK calls against the applied state in one pass;
+    // streams not published yet catch up when they are
+    int applySubscriptions(const std::vector<vrd::StreamSubscription>& subscriptions);
+    // {zh} 某路流当前的期望订阅状态，调用方只改需要的字段再交给 applySubscriptions
+    // {en} Current desired state of a stream, callers change only the fields they own before passing it to applySubscriptions
+    vrd::StreamSubscription desiredSubscription(const std::string& uid, bool is_screen) const;
 
     int enableSimulcastMode(bool enabled);
 	int setVideoProfiles(const bytertc::VideoEncoderConfig& config);
@@ -180,6 +207,10 @@ public:
 	int getShareList(std::vector<SnapshotAttr>& list);
 	QPixmap getThumbnail(SnapshotAttr::SnapshotType type, void* source_id,
 		int max_width, int max_height);
+	// {zh} 可在工作线程调用，返回的图像不引用SDK内存
+	// {en} May be called on a worker thread, the returned image does not reference SDK memory
+	QImage getThumbnailImage(SnapshotAttr::SnapshotType type, void* source_id,
+		int max_width, int max_height);
 
     int getAudioInputDevices(std::vector<RtcDevice>&);
     int setAudioInputDevice(int index);
@@ -206,11 +237,24 @@ public:
 	int stopScreenCapture();
 	int startScreenAudioCapture();
 	int stopScreenAudioCapture();
-	bool audioReocrdDeviceTest();
+
+	// {zh} 自定义音视频源；推帧可在任意线程调用，但须在 destroyEngine 之前停止。视频帧由SDK接管，音频帧推入后仍由调用方释放
+	// {en} Custom media sources; frames may be pushed on any thread but must stop before destroyEngine.
+	// {en} Video frames are taken over by the SDK, audio frames are still released by the caller after the push
+	int setVideoSourceType(bytertc::StreamIndex index, bytertc::VideoSourceType type);
+	int pushExternalVideoFrame(bytertc::IVideoFrame* frame);
+	int setAudioSourceType(bytertc::AudioSourceType type);
+	int pushExternalAudioFrame(bytertc::IAudioFrame* frame);
 	int feedBack(bytertc::ProblemFeedbackOption* type, int count, const std::string& problem_desc);
 	int setAudioVolumeIndicate(int indicate);
+	// {zh} 音频帧回调，观察者在SDK音频线程被调用
+	// {en} Audio frame callbacks, the observer is called on SDK audio threads
+	int registerAudioFrameObserver(bytertc::IAudioFrameObserver* observer);
+	int enableAudioFrameCallback(bytertc::AudioFrameCallbackMethod method, bytertc::AudioFormat format);
+	int disableAudioFrameCallback(bytertc::AudioFrameCallbackMethod method);
 
 	void emitOnRTSMessageArrived(const char* uid, const char* message);
+	void emitOnRTSBinaryMessageArrived(const char* uid, int size, const uint8_t* message);
 
     std::unique_ptr<bytertc::IRTCVideo, std::function<void(bytertc::IRTCVideo*)>>&
         getRtcEngine();
@@ -229,6 +273,10 @@ signals:
     void sigOnRemoteAudioVolumeIndication(std::vector<AudioVolumeInfoWrap> speakers,
         int totalVolume);
     void sigOnLocalAudioVolumeIndication(std::vector<AudioVolumeInfoWrap> speakers);
+    // {zh} vrd::AudioLevelMeter 的本地和远端电平，一次通知包含全部流
+    // {en} Local and remote levels from vrd::AudioLevelMeter, one notification covers every stream
+    void sigOnAudioLevelIndication(std::vector<AudioVolumeInfoWrap> local,
+        std::vector<AudioVolumeInfoWrap> remote);
     void sigOnLeaveRoom(bytertc::RtcRoomStats stats);
     void sigOnUserJoined(UserInfoWrap user_info,int elapsed);
     void sigOnUserLeave(std::string uid, bytertc::UserOfflineReason reason);
@@ -278,6 +326,7 @@ signals:
     void sigOnLoginResult(std::string uid, int error_code, int elapsed);
     void sigOnServerParamsSetResult(int error);
     void sigOnMessageReceived(std::string uid, std::string message);
+    void sigOnBinaryMessageReceived(std::string uid, std::string message);
     void sigOnServerMessageSendResult(int64_t msgid, int error, const bytertc::ServerACKMsg& msg);
 
 public:
@@ -338,13 +387,23 @@ public:
     void onRoomMessageReceived(const char* uid, const char* message) override;
     void onUserMessageReceived(const char* uid, const char* message) override;
     void onUserMessageReceivedOutsideRoom(const char* uid, const char* message) override;
+    void onUserBinaryMessageReceived(const char* uid, int size, const uint8_t* message) override;
+    void onUserBinaryMessageReceivedOutsideRoom(const char* uid, int size, const uint8_t* message) override;
     void onServerMessageSendResult(int64_t msgid, int error, const bytertc::ServerACKMsg& msg) override;
 
+private:
+    void flushRemoteStreamStats();
+    int syncSubscriptions();
+
 protected:
     std::string room_id_ = "";
     std::unique_ptr<bytertc::IRTCVideo,
         std::function<void(bytertc::IRTCVideo*)>> video_engine_;
     std::unordered_map<std::string, std::shared_ptr<bytertc::IRTCRoom>> rooms_;
+    bytertc::IRTCRoomEventHandler* room_handler_ = this;
+    // {zh} room_id_ 房间内远端流的订阅状态，只在主线程访问
+    // {en} Subscription state of the remote streams in room_id_, main thread only
+    vrd::SubscriptionSet subscriptions_;
 
     std::unique_ptr<bytertc::IVideoDeviceManager,
         std::function<void(bytertc::IVideoDeviceManager*)>>
@@ -352,10 +411,10 @@ protected:
     std::unique_ptr<bytertc::IAudioDeviceManager,
         std::function<void(bytertc::IAudioDeviceManager*)>>
         audio_device_manager_;
-    std::vector<RtcDevice> audio_input_devices_;
-    int current_audio_input_idx_ = -1;
-    std::vector<RtcDevice> audio_output_devices_;
-    int current_audio_output_idx_ = -1;
-    std::vector<RtcDevice> camera_devices_;
-    int current_camera_idx_ = -1;
+
+    // {zh} 远端流统计在SDK回调线程按用户合并，主线程每批只处理每个用户的最新一条
+    // {en} Remote stream stats are merged per user on the SDK callback thread, the main thread only handles the latest one per user per batch
+    std::mutex remote_stats_mutex_;
+    std::map<std::string, RemoteStreamStatsWrap> pending_remote_stats_;
+    bool remote_stats_flush_posted_ = false;
 };
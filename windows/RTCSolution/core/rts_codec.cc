@@ -0,0 +1,386 @@
+﻿#include "rts_codec.h"
+
+#include <QJsonArray>
+#include <cmath>
+#include <cstring>
+
+namespace vrd
+{
+namespace rts_codec
+{
+namespace
+{
+	const char kMagic[2] = { 'R', 'B' };
+	const int kHeaderSize = 3;
+	const int kMaxDepth = 32;
+
+	// {zh} 信令包顶层字段编号表，编号即下标加一，只允许在末尾追加
+	// {en} Top-level envelope field ids, the id is the index plus one, entries may only be appended
+	const char* const kEnvelopeKeys[] = {
+		"app_id", "room_id", "user_id", "event_name", "request_id", "device_id",
+		"content", "message_type", "code", "message", "timestamp", "response",
+		"event", "data", "accept_binary",
+	};
+	const int kEnvelopeKeyCount = sizeof(kEnvelopeKeys) / sizeof(kEnvelopeKeys[0]);
+
+	int envelopeKeyId(const QString& key) {
+		for (int i = 0; i < kEnvelopeKeyCount; i++) {
+			if (key == QLatin1String(kEnvelopeKeys[i])) {
+				return i + 1;
+			}
+		}
+		return 0;
+	}
+
+	class Writer {
+	public:
+		explicit Writer(QByteArray& out) : out_(out) {}
+
+		void writeNil() { putByte(0xc0); }
+		void writeBool(bool value) { putByte(value ? 0xc3 : 0xc2); }
+
+		void writeInt(int64_t value) {
+			if (value >= 0 && value <= 0x7f) {
+				putByte(static_cast<uint8_t>(value));
+			}
+			else if (value < 0 && value >= -32) {
+				putByte(static_cast<uint8_t>(0xe0 | (value + 32)));
+			}
+			else if (value >= INT8_MIN && value <= INT8_MAX) {
+				putByte(0xd0);
+				putBigEndian(static_cast<uint64_t>(value), 1);
+			}
+			else if (value >= INT16_MIN && value <= INT16_MAX) {
+				putByte(0xd1);
+				putBigEndian(static_cast<uint64_t>(value), 2);
+			}
+			else if (value >= INT32_MIN && value <= INT32_MAX) {
+				putByte(0xd2);
+				putBigEndian(static_cast<uint64_t>(value), 4);
+			}
+			else {
+				putByte(0xd3);
+				putBigEndian(static_cast<uint64_t>(value), 8);
+			}
+		}
+
+		void writeDouble(double value) {
+			uint64_t bits = 0;
+			std::memcpy(&bits, &value, sizeof(bits));
+			putByte(0xcb);
+			putBigEndian(bits, 8);
+		}
+
+		void writeString(const QString& value) {
+			const QByteArray utf8 = value.toUtf8();
+			const uint32_t size = static_cast<uint32_t>(utf8.size());
+			if (size < 32) {
+				putByte(static_cast<uint8_t>(0xa0 | size));
+			}
+			else if (size <= 0xff) {
+				putByte(0xd9);
+				putBigEndian(size, 1);
+			}
+			else if (size <= 0xffff) {
+				putByte(0xda);
+				putBigEndian(size, 2);
+			}
+			else {
+				putByte(0xdb);
+				putBigEndian(size, 4);
+			}
+			out_.append(utf8);
+		}
+
+		void writeArrayHeader(uint32_t size) {
+			writeContainerHeader(size, 0x90, 0xdc, 0xdd);
+		}
+
+		void writeMapHeader(uint32_t size) {
+			writeContainerHeader(size, 0x80, 0xde, 0xdf);
+		}
+
+		void writeValue(const QJsonValue& value) {
+			switch (value.type()) {
+			case QJsonValue::Bool:
+				writeBool(value.toBool());
+				break;
+			case QJsonValue::Double: {
+				// {zh} 可精确表示的整数按整数编码，节省空间
+				// {en} Integers that are exactly representable are encoded as integers to save space
+				const double number = value.toDouble();
+				if (std::floor(number) == number && std::fabs(number) <= 9007199254740992.0) {
+					writeInt(static_cast<int64_t>(number));
+				}
+				else {
+					writeDouble(number);
+				}
+				break;
+			}
+			case QJsonValue::String:
+				writeString(value.toString());
+				break;
+			case QJsonValue::Array: {
+				const QJsonArray array = value.toArray();
+				writeArrayHeader(static_cast<uint32_t>(array.size()));
+				for (const auto& item : array) {
+					writeValue(item);
+				}
+				break;
+			}
+			case QJsonValue::Object:
+				writeObject(value.toObject(), false);
+				break;
+			default:
+				writeNil();
+				break;
+			}
+		}
+
+		void writeObject(const QJsonObject& object, bool envelope) {
+			writeMapHeader(static_cast<uint32_t>(object.size()));
+			for (auto iter = object.constBegin(); iter != object.constEnd(); ++iter) {
+				const int key_id = envelope ? envelopeKeyId(iter.key()) : 0;
+				if (key_id > 0) {
+					writeInt(key_id);
+				}
+				else {
+					writeString(iter.key());
+				}
+				writeValue(iter.value());
+			}
+		}
+
+	private:
+		void putByte(uint8_t value) { out_.append(static_cast<char>(value)); }
+
+		void putBigEndian(uint64_t value, int bytes) {
+			for (int i = bytes - 1; i >= 0; i--) {
+				putByte(static_cast<uint8_t>(value >> (i * 8)));
+			}
+		}
+
+		void writeContainerHeader(uint32_t size, uint8_t fix, uint8_t tag16, uint8_t tag32) {
+			if (size < 16) {
+				putByte(static_cast<uint8_t>(fix | size));
+			}
+			else if (size <= 0xffff) {
+				putByte(tag16);
+				putBigEndian(size, 2);
+			}
+			else {
+				putByte(tag32);
+				putBigEndian(size, 4);
+			}
+		}
+
+		QByteArray& out_;
+	};
+
+	class Reader {
+	public:
+		Reader(const uint8_t* data, int size) : cur_(data), end_(data + size) {}
+
+		bool atEnd() const { return cur_ == end_; }
+
+		bool readValue(QJsonValue& value, int depth) {
+			if (depth > kMaxDepth) {
+				return false;
+			}
+			uint8_t tag = 0;
+			if (!readByte(tag)) {
+				return false;
+			}
+			if (tag <= 0x7f) {
+				value = static_cast<int>(tag);
+				return true;
+			}
+			if (tag >= 0xe0) {
+				value = static_cast<int>(static_cast<int8_t>(tag));
+				return true;
+			}
+			if ((tag & 0xe0) == 0xa0) {
+				return readString(tag & 0x1f, value);
+			}
+			if ((tag & 0xf0) == 0x90) {
+				return readArray(tag & 0x0f, value, depth);
+			}
+			if ((tag & 0xf0) == 0x80) {
+				return readMap(tag & 0x0f, value, depth, false);
+			}
+
+			uint64_t raw = 0;
+			switch (tag) {
+			case 0xc0: value = QJsonValue(QJsonValue::Null); return true;
+			case 0xc2: value = false; return true;
+			case 0xc3: value = true; return true;
+			case 0xcc: if (!readBigEndian(raw, 1)) return false; value = static_cast<double>(raw); return true;
+			case 0xcd: if (!readBigEndian(raw, 2)) return false; value = static_cast<double>(raw); return true;
+			case 0xce: if (!readBigEndian(raw, 4)) return false; value = static_cast<double>(raw); return true;
+			case 0xcf: if (!readBigEndian(raw, 8)) return false; value = static_cast<double>(raw); return true;
+			case 0xd0: if (!readBigEndian(raw, 1)) return false; value = static_cast<double>(static_cast<int8_t>(raw)); return true;
+			case 0xd1: if (!readBigEndian(raw, 2)) return false; value = static_cast<double>(static_cast<int16_t>(raw)); return true;
+			case 0xd2: if (!readBigEndian(raw, 4)) return false; value = static_cast<double>(static_cast<int32_t>(raw)); return true;
+			case 0xd3: if (!readBigEndian(raw, 8)) return false; value = static_cast<double>(static_cast<int64_t>(raw)); return true;
+			case 0xca: {
+				if (!readBigEndian(raw, 4)) return false;
+				uint32_t bits = static_cast<uint32_t>(raw);
+				float number = 0;
+				std::memcpy(&number, &bits, sizeof(number));
+				value = static_cast<double>(number);
+				return true;
+			}
+			case 0xcb: {
+				if (!readBigEndian(raw, 8)) return false;
+				double number = 0;
+				std::memcpy(&number, &raw, sizeof(number));
+				value = number;
+				return true;
+			}
+			case 0xd9: return readBigEndian(raw, 1) && readString(raw, value);
+			case 0xda: return readBigEndian(raw, 2) && readString(raw, value);
+			case 0xdb: return readBigEndian(raw, 4) && readString(raw, value);
+			case 0xdc: return readBigEndian(raw, 2) && readArray(raw, value, depth);
+			case 0xdd: return readBigEndian(raw, 4) && readArray(raw, value, depth);
+			case 0xde: return readBigEndian(raw, 2) && readMap(raw, value, depth, false);
+			case 0xdf: return readBigEndian(raw, 4) && readMap(raw, value, depth, false);
+			default:
+				return false;
+			}
+		}
+
+		bool readEnvelope(QJsonObject& envelope) {
+			uint8_t tag = 0;
+			if (!readByte(tag)) {
+				return false;
+			}
+			uint64_t size = 0;
+			if ((tag & 0xf0) == 0x80) {
+				size = tag & 0x0f;
+			}
+			else if (tag == 0xde) {
+				if (!readBigEndian(size, 2)) return false;
+			}
+			else if (tag == 0xdf) {
+				if (!readBigEndian(size, 4)) return false;
+			}
+			else {
+				return false;
+			}
+			QJsonValue value;
+			if (!readMap(size, value, 0, true)) {
+				return false;
+			}
+			envelope = value.toObject();
+			return true;
+		}
+
+	private:
+		bool readByte(uint8_t& value) {
+			if (cur_ >= end_) {
+				return false;
+			}
+			value = *cur_++;
+			return true;
+		}
+
+		bool readBigEndian(uint64_t& value, int bytes) {
+			if (end_ - cur_ < bytes) {
+				return false;
+			}
+			value = 0;
+			for (int i = 0; i < bytes; i++) {
+				value = (value << 8) | *cur_++;
+			}
+			return true;
+		}
+
+		bool readString(uint64_t size, QJsonValue& value) {
+			if (static_cast<uint64_t>(end_ - cur_) < size) {
+				return false;
+			}
+			value = QString::fromUtf8(reinterpret_cast<const char*>(cur_), static_cast<int>(size));
+			cur_ += size;
+			return true;
+		}
+
+		bool readArray(uint64_t size, QJsonValue& value, int depth) {
+			// {zh} 每个元素至少占1字节，超出剩余长度的数量视为非法
+			// {en} Each element takes at least one byte, a count beyond the remaining bytes is rejected
+			if (static_cast<uint64_t>(end_ - cur_) < size) {
+				return false;
+			}
+			QJsonArray array;
+			for (uint64_t i = 0; i < size; i++) {
+				QJsonValue item;
+				if (!readValue(item, depth + 1)) {
+					return false;
+				}
+				array.append(item);
+			}
+			value = array;
+			return true;
+		}
+
+		bool readMap(uint64_t size, QJsonValue& value, int depth, bool envelope) {
+			if (static_cast<uint64_t>(end_ - cur_) < size * 2) {
+				return false;
+			}
+			QJsonObject object;
+			for (uint64_t i = 0; i < size; i++) {
+				QJsonValue key;
+				QJsonValue item;
+				if (!readValue(key, depth + 1) || !readValue(item, depth + 1)) {
+					return false;
+				}
+				QString name;
+				if (key.isString()) {
+					name = key.toString();
+				}
+				else if (envelope && key.isDouble()) {
+					const int key_id = key.toInt();
+					if (key_id < 1 || key_id > kEnvelopeKeyCount) {
+						return false;
+					}
+					name = QLatin1String(kEnvelopeKeys[key_id - 1]);
+				}
+				else {
+					return false;
+				}
+				object.insert(name, item);
+			}
+			value = object;
+			return true;
+		}
+
+		const uint8_t* cur_;
+		const uint8_t* end_;
+	};
+}
+
+QByteArray encode(const QJsonObject& envelope) {
+	QByteArray out;
+	out.reserve(256);
+	out.append(kMagic, sizeof(kMagic));
+	out.append(static_cast<char>(kVersion));
+	Writer writer(out);
+	writer.writeObject(envelope, true);
+	return out;
+}
+
+bool isBinaryFrame(const uint8_t* data, int size) {
+	return data && size >= kHeaderSize
+		&& data[0] == static_cast<uint8_t>(kMagic[0])
+		&& data[1] == static_cast<uint8_t>(kMagic[1]);
+}
+
+bool decode(const uint8_t* data, int size, QJsonObject& envelope) {
+	if (!isBinaryFrame(data, size) || data[2] != kVersion) {
+		return false;
+	}
+	Reader reader(data + kHeaderSize, size - kHeaderSize);
+	return reader.readEnvelope(envelope) && reader.atEnd();
+}
+
+}  // namespace rts_codec
+}  // namespace vrd
@@ -0,0 +1,32 @@
+﻿#ifndef VRD_RTSCODEC_H
+#define VRD_RTSCODEC_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <cstdint>
+
+namespace vrd
+{
+	/** {zh}
+	 * RTS二进制信令编解码
+	 * 帧格式：2字节魔数 "RB" + 1字节版本号 + MessagePack编码的信令包，
+	 * 信令包顶层的已知字段以整数编号代替字段名，content等业务字段直接以对象编码，不再嵌套JSON字符串
+	 */
+
+	/** {en}
+	* Binary RTS signaling codec
+	* Frame layout: 2-byte magic "RB" + 1-byte version + MessagePack encoded envelope,
+	* known top-level envelope fields are keyed by integer ids instead of names, and business fields such as content
+	* are encoded as objects instead of nested JSON strings
+	*/
+	namespace rts_codec
+	{
+		static constexpr uint8_t kVersion = 1;
+
+		QByteArray encode(const QJsonObject& envelope);
+		bool decode(const uint8_t* data, int size, QJsonObject& envelope);
+		bool isBinaryFrame(const uint8_t* data, int size);
+	}
+}
+
+#endif // VRD_RTSCODEC_H
@@ -0,0 +1,208 @@
+﻿#include "rts_request_tracker.h"
+
+#include <algorithm>
+
+namespace vrd
+{
+void RtsRequestTracker::RttHistogram::add(int64_t rtt_ms) {
+	int index = 0;
+	while (index < kBuckets - 1 && rtt_ms > bucketUpperBound(index)) {
+		++index;
+	}
+	++buckets[index];
+	++count;
+	total_ms += rtt_ms;
+	max_ms = std::max(max_ms, rtt_ms);
+}
+
+int64_t RtsRequestTracker::RttHistogram::percentile(double p) const {
+	if (count == 0) {
+		return 0;
+	}
+	auto target = static_cast<uint64_t>(p * count);
+	uint64_t seen = 0;
+	for (int i = 0; i < kBuckets - 1; ++i) {
+		seen += buckets[i];
+		if (seen > target) {
+			return std::min(bucketUpperBound(i), max_ms);
+		}
+	}
+	return max_ms;
+}
+
+int64_t RtsRequestTracker::RttHistogram::bucketUpperBound(int index) {
+	return int64_t(1) << index;
+}
+
+RtsRequestTracker::RtsRequestTracker(int tick_ms, int slots)
+	: tick_ms_(std::max(tick_ms, 1)), wheel_(std::max(slots, 1)) {
+}
+
+void RtsRequestTracker::setDefaultPolicy(const Policy& policy) {
+	default_policy_ = policy;
+}
+
+void RtsRequestTracker::setPolicy(const std::string& event_name, const Policy& policy) {
+	policies_[event_name] = policy;
+}
+
+const RtsRequestTracker::Policy& RtsRequestTracker::policy(const std::string& event_name) const {
+	auto iter = policies_.find(event_name);
+	return iter != policies_.end() ? iter->second : default_policy_;
+}
+
+void RtsRequestTracker::add(const std::string& request_id, Request&& request, int64_t now_ms) {
+	const auto& rule = policy(request.event_name);
+	request.sent_ms = now_ms;
+	request.deadline_ms = now_ms + rule.timeout_ms;
+	request.max_retries = rule.max_retries;
+	if (cursor_tick_ < 0) {
+		cursor_tick_ = now_ms / tick_ms_;
+	}
+	auto deadline = request.deadline_ms;
+	auto result = requests_.emplace(request_id, std::move(request));
+	if (!result.second) {
+		return;
+	}
+	++stats_[result.first->second.event_name].in_flight;
+	schedule(request_id, deadline);
+}
+
+RtsRequestTracker::Request* RtsRequestTracker::find(const std::string& request_id) {
+	auto iter = requests_.find(request_id);
+	return iter != requests_.end() ? &iter->second : nullptr;
+}
+
+bool RtsRequestTracker::complete(const std::string& request_id, int64_t now_ms, Request& out) {
+	auto iter = requests_.find(request_id);
+	if (iter == requests_.end()) {
+		return false;
+	}
+	stats_[iter->second.event_name].rtt.add(std::max<int64_t>(now_ms - iter->second.sent_ms, 0));
+	remove(iter, out);
+	return true;
+}
+
+void RtsRequestTracker::retry(const std::string& request_id, int64_t now_ms) {
+	auto iter = requests_.find(request_id);
+	if (iter == requests_.end()) {
+		return;
+	}
+	auto& request = iter->second;
+	++request.attempts;
+	request.deadline_ms = now_ms + policy(request.event_name).timeout_ms;
+	++stats_[request.event_name].retries;
+	schedule(request_id, request.deadline_ms);
+}
+
+bool RtsRequestTracker::fail(const std::string& request_id, Request& out) {
+	auto iter = requests_.find(request_id);
+	if (iter == requests_.end()) {
+		return false;
+	}
+	++stats_[iter->second.event_name].timeouts;
+	remove(iter, out);
+	return true;
+}
+
+/** {zh}
+ * 推进时间轮到当前时刻，只访问经过的槽位；
+ * 已完成或已重新安排的请求在槽位中留下的旧记录在此时丢弃
+ */
+
+/** {en}
+* Advance the wheel to now, visiting only the slots passed over;
+* stale entries left behind by completed or re-armed requests are dropped here
+*/
+void RtsRequestTracker::expire(int64_t now_ms, std::vector<std::string>& due) {
+	auto now_tick = now_ms / tick_ms_;
+	if (cursor_tick_ < 0) {
+		cursor_tick_ = now_tick;
+	}
+	auto slots = static_cast<int64_t>(wheel_.size());
+	auto steps = std::min(now_tick - cursor_tick_ + 1, slots);
+	for (int64_t i = 0; i < steps; ++i) {
+		auto& slot = wheel_[static_cast<size_t>((cursor_tick_ + i) % slots)];
+		auto keep = slot.begin();
+		for (auto& entry : slot) {
+			if (entry.deadline_ms > now_ms) {
+				// {zh} 截止时间在后续轮次
+				// {en} Deadline falls in a later revolution
+				if (&*keep != &entry) {
+					*keep = std::move(entry);
+				}
+				++keep;
+				continue;
+			}
+			auto iter = requests_.find(entry.request_id);
+			if (iter != requests_.end() && iter->second.deadline_ms == entry.deadline_ms) {
+				due.push_back(std::move(entry.request_id));
+			}
+		}
+		slot.erase(keep, slot.end());
+	}
+	cursor_tick_ = std::max(cursor_tick_, now_tick + 1);
+}
+
+void RtsRequestTracker::bindMessage(int64_t message_id, const std::string& request_id) {
+	messages_[message_id] = request_id;
+}
+
+bool RtsRequestTracker::takeMessage(int64_t message_id, std::string& request_id) {
+	auto iter = messages_.find(message_id);
+	if (iter == messages_.end()) {
+		return false;
+	}
+	request_id = std::move(iter->second);
+	messages_.erase(iter);
+	return true;
+}
+
+void RtsRequestTracker::takeAll(std::vector<std::pair<std::string, Request>>& out) {
+	out.reserve(out.size() + requests_.size());
+	for (auto& item : requests_) {
+		out.emplace_back(item.first, std::move(item.second));
+	}
+	clear();
+}
+
+void RtsRequestTracker::clear() {
+	for (auto& slot : wheel_) {
+		slot.clear();
+	}
+	requests_.clear();
+	messages_.clear();
+	for (auto& stat : stats_) {
+		stat.second.in_flight = 0;
+	}
+}
+
+size_t RtsRequestTracker::inFlight() const {
+	return requests_.size();
+}
+
+const std::unordered_map<std::string, RtsRequestTracker::EventStats>& RtsRequestTracker::stats() const {
+	return stats_;
+}
+
+void RtsRequestTracker::schedule(const std::string& request_id, int64_t deadline_ms) {
+	// {zh} 向上取整到槽位：expire 访问到该槽位时槽内的截止时间都已过，游标越过后不会漏掉本轮到期的请求
+	// {en} Round up to the slot: once expire reaches it every deadline in it has passed, so the cursor never
+	// leaves a request due this revolution behind
+	auto tick = (deadline_ms + tick_ms_ - 1) / tick_ms_;
+	if (cursor_tick_ >= 0) {
+		tick = std::max(tick, cursor_tick_);
+	}
+	auto slots = static_cast<int64_t>(wheel_.size());
+	wheel_[static_cast<size_t>(tick % slots)].push_back({ request_id, deadline_ms });
+}
+
+void RtsRequestTracker::remove(std::unordered_map<std::string, Request>::iterator iter, Request& out) {
+	auto& stat = stats_[iter->second.event_name];
+	if (stat.in_flight > 0) {
+		--stat.in_flight;
+	}
+	out = std::move(iter->second);
+	requests_.erase(iter);
+}
+}
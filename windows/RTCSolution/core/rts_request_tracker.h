@@ -0,0 +1,130 @@
+﻿#ifndef VRD_RTSREQUESTTRACKER_H
+#define VRD_RTSREQUESTTRACKER_H
+
+#include <QJsonObject>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace vrd
+{
+	/** {zh}
+	 * RTS请求跟踪表
+	 * 1, 以请求ID哈希索引在途请求，记录事件名、发送时间和截止时间
+	 * 2, 截止时间挂在时间轮上，到期的请求由调用方重试或以超时错误结束
+	 * 3, 按事件名统计在途数量、超时与重试次数，以及往返时延直方图
+	 * 时间由调用方传入（毫秒，单调递增），本类不持有定时器
+	 */
+
+	/** {en}
+	* RTS request tracking table
+	* 1, In-flight requests are hashed by request id and keep the event name, send time and deadline
+	* 2, Deadlines sit on a timer wheel, due requests are retried or finished with a timeout error by the caller
+	* 3, Per event name it counts in-flight requests, timeouts and retries, and keeps an RTT histogram
+	* Time is passed in by the caller (milliseconds, monotonic), this class owns no timer
+	*/
+	class RtsRequestTracker {
+	public:
+		using Callback = std::function<void(const QJsonObject& response)>;
+
+		struct Policy {
+			int timeout_ms = 10000;
+			// {zh} 超时后以相同请求ID重发的次数，仅用于幂等请求
+			// {en} Times the request is resent with the same request id after a timeout, idempotent requests only
+			int max_retries = 0;
+		};
+
+		struct Request {
+			std::string event_name;
+			Callback callback;
+			bool show_err = false;
+			int64_t sent_ms = 0;
+			int64_t deadline_ms = 0;
+			int attempts = 1;
+			int max_retries = 0;
+			// {zh} 追踪开启时请求发出的时间，-1表示不追踪
+			// {en} Time the request was issued while tracing, -1 when not traced
+			int64_t trace_start_us = -1;
+			// {zh} 仅在需要重发时保留（可重试或以二进制发送）
+			// {en} Only kept when the request may be resent (retryable or sent in binary)
+			QJsonObject content;
+		};
+
+		struct RttHistogram {
+			static constexpr int kBuckets = 16;
+			// {zh} 第i个桶统计 (2^(i-1), 2^i] 毫秒的往返时延，最后一个桶收纳更大的值
+			// {en} Bucket i counts RTTs in (2^(i-1), 2^i] ms, the last bucket takes everything above
+			uint32_t buckets[kBuckets] = {};
+			uint64_t count = 0;
+			int64_t total_ms = 0;
+			int64_t max_ms = 0;
+
+			void add(int64_t rtt_ms);
+			int64_t percentile(double p) const;
+			static int64_t bucketUpperBound(int index);
+		};
+
+		struct EventStats {
+			size_t in_flight = 0;
+			uint64_t timeouts = 0;
+			uint64_t retries = 0;
+			RttHistogram rtt;
+		};
+
+		explicit RtsRequestTracker(int tick_ms = 100, int slots = 256);
+
+		void setDefaultPolicy(const Policy& policy);
+		void setPolicy(const std::string& event_name, const Policy& policy);
+		const Policy& policy(const std::string& event_name) const;
+
+		void add(const std::string& request_id, Request&& request, int64_t now_ms);
+		Request* find(const std::string& request_id);
+		// {zh} 收到回复时移除请求并记录往返时延，返回false表示请求不存在（已超时或重复回复）
+		// {en} Remove the request on reply and record its RTT, false if unknown (timed out or duplicate reply)
+		bool complete(const std::string& request_id, int64_t now_ms, Request& out);
+		// {zh} 重发后重新计算截止时间
+		// {en} Re-arm the deadline after a resend
+		void retry(const std::string& request_id, int64_t now_ms);
+		// {zh} 以超时结束请求
+		// {en} Finish a request as timed out
+		bool fail(const std::string& request_id, Request& out);
+		// {zh} 收集截止时间已过的请求ID
+		// {en} Collect the ids of requests past their deadline
+		void expire(int64_t now_ms, std::vector<std::string>& due);
+
+		void bindMessage(int64_t message_id, const std::string& request_id);
+		bool takeMessage(int64_t message_id, std::string& request_id);
+
+		// {zh} 取出所有在途请求并清空，用于登出时统一结束它们
+		// {en} Take every request in flight and clear the tracker, used to finish them all on logout
+		void takeAll(std::vector<std::pair<std::string, Request>>& out);
+		void clear();
+		size_t inFlight() const;
+		const std::unordered_map<std::string, EventStats>& stats() const;
+
+	private:
+		struct WheelEntry {
+			std::string request_id;
+			int64_t deadline_ms;
+		};
+
+		void schedule(const std::string& request_id, int64_t deadline_ms);
+		void remove(std::unordered_map<std::string, Request>::iterator iter, Request& out);
+
+		int tick_ms_;
+		std::vector<std::vector<WheelEntry>> wheel_;
+		int64_t cursor_tick_ = -1;
+		Policy default_policy_;
+		std::unordered_map<std::string, Policy> policies_;
+		std::unordered_map<std::string, Request> requests_;
+		// {zh} 发送消息id到请求ID，发送结果回调后移除
+		// {en} Sent message id to request id, removed once the send result arrives
+		std::unordered_map<int64_t, std::string> messages_;
+		std::unordered_map<std::string, EventStats> stats_;
+	};
+}
+
+#endif // VRD_RTSREQUESTTRACKER_H
@@ -8,56 +8,143 @@
 #include "http.h"
 #include "scene_select_widget.h"
 #include "rts_params.h"
+#include "rts_codec.h"
+#include "json_stream.h"
+#include "task_pool.h"
+#include "trace_event.h"
+#include "Configer.h"
 
-#include <QTimer>
 #include <QJsonObject>
 #include <QJsonDocument>
 
 namespace vrd {
-static const QString MESSAGE_TYPE_RETURN = "return";
-static const QString MESSAGE_TYPE_INFORM = "inform";
+static const char* const MESSAGE_TYPE_RETURN = "return";
+static const char* const MESSAGE_TYPE_INFORM = "inform";
+// {zh} 请求超时未收到回复时回调的错误码
+// {en} Error code passed to the callback when a request times out without a reply
+static const int REQUEST_TIMEOUT_CODE = 408;
+static const int REQUEST_TICK_MS = 100;
+static const size_t MAX_OFFLINE_REQUESTS = 32;
+
+const char* const SessionBase::kEntryStepFetchParams = "fetch_params";
+const char* const SessionBase::kEntryStepCreateEngine = "create_engine";
+const char* const SessionBase::kEntryStepEngineReady = "engine_ready";
+const char* const SessionBase::kEntryStepLogin = "login";
+const char* const SessionBase::kEntryStepServerParams = "server_params";
 
 void SessionBase::registerThis() {
 	VRD_FUNC_RIGESTER_COMPONET(vrd::SessionBase, SessionBase);
 }
 
 SessionBase::SessionBase() {
-    net_live_timer_ = new QTimer();
-    net_live_timer_->start();
-    net_live_timer_->setInterval(3000);
-    net_live_timer_->setSingleShot(false);
+    binary_protocol_allowed_ = Configer::instance().getData("rts/binary_protocol") == "1";
+	clock_.start();
+	RtsRequestTracker::Policy policy;
+	auto timeout = QString::fromStdString(Configer::instance().getData("rts/request_timeout_ms")).toInt();
+	if (timeout > 0) {
+		policy.timeout_ms = timeout;
+	}
+	requests_.setDefaultPolicy(policy);
 	initConnections();
 }
 
 SessionBase::~SessionBase() {
-    net_live_timer_->stop();
-    net_live_timer_->deleteLater();
+    net_live_timer_.stop();
+    request_timer_.stop();
 }
 
-void SessionBase::connectRTS(CSTRING_REF_PARAM scenesName, std::function<void(void)>&& callback) {
-    vrd::getJoinRTSParams(scenesName, token_, [this, callback](int code) {
-    if (code == 200) {
+/** {zh}
+ * 以流水线方式进入场景：
+ * 获取业务参数 与 用本地配置的AppId创建引擎 并行；两者完成后设置业务标识（AppId不一致时重建引擎）；
+ * 之后依次登录RTS、设置业务服务器参数，场景步骤（如设备初始化）在引擎就绪后与登录并行
+ */
+
+/** {en}
+* Enter a scene through a pipeline:
+* fetching the join params runs alongside creating the engine with the locally configured app id;
+* once both finish the business id is set (the engine is recreated if the app id differs);
+* then RTS login and server params follow, while scene steps (such as device init) overlap them once the engine is ready
+*/
+void SessionBase::connectRTS(CSTRING_REF_PARAM scenesName, std::function<void(void)>&& callback,
+	std::function<void(EntryPipeline&)>&& addSceneSteps) {
+	if (entry_pipeline_) {
+		entry_pipeline_->cancel();
+	}
+	auto pipeline = std::make_shared<EntryPipeline>(scenesName);
+	auto token = token_;
+	pipeline->add(kEntryStepFetchParams, {}, [scenesName, token](EntryPipeline::Done done) {
+		vrd::getJoinRTSParams(scenesName, token, [done](int code) {
+			done(code == 200 ? 0 : code);
+		});
+	});
+	pipeline->add(kEntryStepCreateEngine, {}, [this](EntryPipeline::Done done) {
+		if (!vrd::APPID.empty()) {
+			RtcEngineWrap::instance().createEngine(vrd::APPID);
+			engine_app_id_ = vrd::APPID;
+		}
+		done(0);
+	});
+	pipeline->add(kEntryStepEngineReady, { kEntryStepFetchParams, kEntryStepCreateEngine }, [this](EntryPipeline::Done done) {
 		auto rts_info = vrd::DataMgr::instance().rts_info();
-		// {zh} 创建引擎
-		// {en} create RTC Engine
-		RtcEngineWrap::instance().createEngine(rts_info.app_id);
+		if (!RtcEngineWrap::instance().getRtcEngine() || engine_app_id_ != rts_info.app_id) {
+			// {zh} 创建引擎
+			// {en} create RTC Engine
+			RtcEngineWrap::instance().createEngine(rts_info.app_id);
+			engine_app_id_ = rts_info.app_id;
+		}
+		const auto& engine = RtcEngineWrap::instance().getRtcEngine();
+		if (!engine) {
+			done(-API_CALL_ERROR);
+			return;
+		}
 		// {zh} 设置业务标识参数
 		// {en} Set business identification parameters
-		RtcEngineWrap::instance().getRtcEngine()->setBusinessId(vrd::DataMgr::instance().business_Id().c_str());
-		_loginRTS(rts_info.rtm_token, [this, rts_info, callback](int code) {
-            if (code == bytertc::LoginErrorCode::kLoginErrorCodeSuccess) {
-                setServerParams(rts_info.server_signature, rts_info.server_url);
-                connect_rts_callback_ = callback;
-            }
-            else {
-                qWarning() << "login error: error_code" << code;
-            }
-            });
+		engine->setBusinessId(vrd::DataMgr::instance().business_Id().c_str());
+		done(0);
+	});
+	pipeline->add(kEntryStepLogin, { kEntryStepEngineReady }, [this](EntryPipeline::Done done) {
+		_loginRTS(vrd::DataMgr::instance().rts_info().rtm_token, [done](int code) {
+			if (code != bytertc::LoginErrorCode::kLoginErrorCodeSuccess) {
+				qWarning() << "login error: error_code" << code;
+			}
+			done(code);
+		});
+	});
+	pipeline->add(kEntryStepServerParams, { kEntryStepLogin }, [this](EntryPipeline::Done done) {
+		auto rts_info = vrd::DataMgr::instance().rts_info();
+		server_params_callback_ = [done](int code) {
+			done(code == 200 ? 0 : code);
+		};
+		setServerParams(rts_info.server_signature, rts_info.server_url);
+	});
+	if (addSceneSteps) {
+		addSceneSteps(*pipeline);
+	}
+	entry_pipeline_ = pipeline;
+	pipeline->start([this, callback](int code, const std::string& step) {
+		if (code != 0) {
+			qWarning() << "connectRTS failed at step:" << step.c_str() << ", code:" << code;
+			return;
 		}
-    });
+		if (callback) {
+			_emitCallback(std::function<void(void)>(callback));
+		}
+	});
+}
+
+void SessionBase::markEntry(CSTRING_REF_PARAM milestone) {
+	if (entry_pipeline_) {
+		entry_pipeline_->mark(milestone);
+	}
 }
 
 void SessionBase::disconnectRTS() {
+	if (entry_pipeline_) {
+		entry_pipeline_->cancel();
+	}
+	engine_login_callback_ = nullptr;
+	server_params_callback_ = nullptr;
+	engine_app_id_.clear();
 	_logoutRTS();
 	RtcEngineWrap::instance().destroyEngine();
 }
@@ -82,6 +169,21 @@ CSTRING_REF_PARAM SessionBase::_token() {
     return token_; 
 }
 
+void SessionBase::setRequestPolicy(CSTRING_REF_PARAM name, int timeout_ms, int max_retries) {
+	RtsRequestTracker::Policy policy;
+	policy.timeout_ms = timeout_ms;
+	policy.max_retries = max_retries;
+	requests_.setPolicy(name, policy);
+}
+
+size_t SessionBase::inFlightRequests() const {
+	return requests_.inFlight();
+}
+
+const std::unordered_map<std::string, RtsRequestTracker::EventStats>& SessionBase::requestStats() const {
+	return requests_.stats();
+}
+
 void SessionBase::_emitCallback(std::function<void(void)>&& cb) {
     cb_helper_.emitCallback(std::move(cb));
 }
@@ -92,10 +194,11 @@ void SessionBase::initConnections() {
         this, &SessionBase::onServerMessageSendResult);
     QObject::connect(&RtcEngineWrap::instance(), &RtcEngineWrap::sigOnMessageReceived,
         this, &SessionBase::onMessageReceived);
+    QObject::connect(&RtcEngineWrap::instance(), &RtcEngineWrap::sigOnBinaryMessageReceived,
+        this, &SessionBase::onBinaryMessageReceived);
     QObject::connect(&RtcEngineWrap::instance(), &RtcEngineWrap::sigOnServerParamsSetResult,
         this, &SessionBase::onServerParamsSetResult);
-
-    QObject::connect(net_live_timer_, &QTimer::timeout, this, [this]() {
+    net_live_timer_.start(3000, [this]() {
         auto& httpInstance = Http::instance();
         // {zh} 仅用于检测网络连接状态
 		// {en} only check network connection
@@ -109,7 +212,7 @@ void SessionBase::initConnections() {
                 vrd::util::closeFixedToast();
             }
             });
-        });
+        }, TimerWheel::kCoarse);
 }
 
 
@@ -148,125 +251,417 @@ void SessionBase::setServerParams(std::string signature, std::string url) {
 void SessionBase::onServerParamsSetResult(int code) {
     if (code != 200) {
         qWarning()<< " onServerParamsSetResult fail: errorCode = " << code;
+        if (server_params_callback_) {
+            auto callback = std::move(server_params_callback_);
+            server_params_callback_ = nullptr;
+            callback(code);
+        }
         return;
     }
     init_server_completed_ = true;
-    if (connect_rts_callback_) {
-        _emitCallback(std::move(connect_rts_callback_));
-        connect_rts_callback_ = nullptr;
+    _flushOffline();
+    if (server_params_callback_) {
+        auto callback = std::move(server_params_callback_);
+        server_params_callback_ = nullptr;
+        callback(code);
     }
 }
 
 void SessionBase::_emitMessage(CSTRING_REF_PARAM name, const QJsonObject& content,
 	std::function<void(const QJsonObject& response)>&& callback, bool show_err) {
+	RtsRequestTracker::Request request;
+	request.event_name = name;
+	request.callback = std::move(callback);
+	request.show_err = show_err;
+	request.content = content;
+	if (Tracer::enabled()) {
+		request.trace_start_us = Tracer::now();
+	}
+	if (request.content.isEmpty()) {
+		request.content["login_token"] = QString::fromStdString(token_);
+	}
 	if (!init_server_completed_) {
-		qWarning()<< "sendServerMessage failed, init_server_completed_: false";
+		_enqueueOffline(std::move(request));
+		return;
+	}
+	_sendRequest(std::move(request));
+}
+
+void SessionBase::_sendRequest(RtsRequestTracker::Request&& request) {
+	auto requestId = util::newUuid();
+	auto msgId = _sendMessage(request.event_name, requestId, request.content);
+	if (msgId <= 0) {
+		// {zh} 没有引擎或SDK拒绝发送时不会有回复，立即以超时结束，调用方不会一直等待
+		// {en} Without an engine or when the SDK refuses the send no reply will come, finish it as timed out right away
+		// so the caller does not wait forever
+		qWarning() << "sendServerMessage failed, event_name: " << request.event_name.c_str();
+		_deliverTimeout(std::move(request), requestId);
 		return;
 	}
-	if (content.isEmpty()) {
-		content["login_token"] = QString::fromStdString(token_);
+	// {zh} 只有可能重发的请求才保留content
+	// {en} Content is only kept for requests that may be resent
+	if (requests_.policy(request.event_name).max_retries <= 0 && binary_message_ids_.count(msgId) == 0) {
+		request.content = QJsonObject();
+	}
+	requests_.add(requestId, std::move(request), _now());
+	requests_.bindMessage(msgId, requestId);
+	_updateRequestTimer();
+}
+
+/** {zh}
+ * 业务服务器参数未设置完成时暂存请求，设置成功后按顺序发送；队列满时最早的请求以超时结束
+ */
+
+/** {en}
+* Hold requests until the business server params are set, then send them in order;
+* when the queue is full the oldest request is finished as timed out
+*/
+void SessionBase::_enqueueOffline(RtsRequestTracker::Request&& request) {
+	qDebug() << "server params not ready, queue request: " << request.event_name.c_str();
+	if (offline_requests_.size() >= MAX_OFFLINE_REQUESTS) {
+		auto dropped = std::move(offline_requests_.front());
+		offline_requests_.pop_front();
+		qWarning() << "offline request queue full, drop: " << dropped.event_name.c_str();
+		_deliverTimeout(std::move(dropped), std::string());
+	}
+	request.deadline_ms = _now() + requests_.policy(request.event_name).timeout_ms;
+	offline_requests_.push_back(std::move(request));
+	_updateRequestTimer();
+}
+
+void SessionBase::_flushOffline() {
+	_expireOffline(_now());
+	while (init_server_completed_ && !offline_requests_.empty()) {
+		auto request = std::move(offline_requests_.front());
+		offline_requests_.pop_front();
+		_sendRequest(std::move(request));
+	}
+	_updateRequestTimer();
+}
+
+void SessionBase::_expireOffline(int64_t now) {
+	for (auto iter = offline_requests_.begin(); iter != offline_requests_.end();) {
+		if (iter->deadline_ms > now) {
+			++iter;
+			continue;
+		}
+		auto request = std::move(*iter);
+		iter = offline_requests_.erase(iter);
+		qWarning() << "offline request expired: " << request.event_name.c_str();
+		_deliverTimeout(std::move(request), std::string());
+	}
+}
+
+/** {zh}
+ * 发送RTS信令：服务端已支持时以二进制帧发送，content直接以对象编码；
+ * 否则将信令包与content一次写入复用的缓冲区，以JSON发送，并在允许时声明可接收二进制回复
+ */
+
+/** {en}
+* Send an RTS message: as a binary frame with content encoded as an object once the server supports it,
+* otherwise the envelope and content are written in one pass into a reused buffer and sent as JSON,
+* advertising that binary replies are accepted when allowed
+*/
+int64_t SessionBase::_sendMessage(CSTRING_REF_PARAM name, CSTRING_REF_PARAM requestId,
+	const QJsonObject& content) {
+	const auto& engine = RtcEngineWrap::instance().getRtcEngine();
+	if (!engine) {
+		return -1;
 	}
-	
-	QJsonObject message;
 	auto res_info = vrd::DataMgr::instance().rts_info();
-	message["app_id"] =  QString::fromStdString(res_info.app_id);
-	message["room_id"] = QString::fromStdString(room_id_);
-	message["user_id"] = QString::fromStdString(user_id_);
-	message["event_name"] = QString::fromStdString(name);
-	QJsonDocument contentDoc(content);
-	message["content"] = QString(contentDoc.toJson(QJsonDocument::Indented));;
-	auto requestId = QString::fromStdString(util::newUuid());
-	message["request_id"] = requestId;
-	message["device_id"] =  QString::fromStdString(util::machineUuid());
-	qDebug()<< "sendServerMessage eventName:" << name.c_str() << "message: "<< message;
-	auto messageStr = QString(QJsonDocument(message).toJson());
-	auto messageStdString = std::string(messageStr.toUtf8());
-	if (const auto& engine = RtcEngineWrap::instance().getRtcEngine())
-	{
-		auto msgId = engine->sendServerMessage(messageStdString.c_str());
+	if (binary_protocol_active_) {
+		QJsonObject message;
+		message["app_id"] = QString::fromStdString(res_info.app_id);
+		message["room_id"] = QString::fromStdString(room_id_);
+		message["user_id"] = QString::fromStdString(user_id_);
+		message["event_name"] = QString::fromStdString(name);
+		message["content"] = content;
+		message["request_id"] = QString::fromStdString(requestId);
+		message["device_id"] = QString::fromStdString(util::machineUuid());
+		qDebug()<< "sendServerBinaryMessage eventName:" << name.c_str() << "message: "<< message;
+		auto frame = rts_codec::encode(message);
+		auto msgId = engine->sendServerBinaryMessage(frame.size(),
+			reinterpret_cast<const uint8_t*>(frame.constData()));
 		if (msgId > 0) {
-			callback_with_requsetId_[requestId] = std::make_tuple(callback, show_err);
-			callback_with_messageId_[msgId] = message;
-		}
-		else {
-			qWarning() << "sendServerMessage failed, event_name: " << name.c_str();
+			binary_message_ids_.insert(msgId);
 		}
+		return msgId;
+	}
+
+	send_buffer_.clear();
+	JsonWriter writer(send_buffer_);
+	writer.beginObject()
+		.key("app_id").value(res_info.app_id)
+		.key("room_id").value(room_id_)
+		.key("user_id").value(user_id_)
+		.key("event_name").value(name)
+		.key("content").beginStringValue().value(content).endStringValue()
+		.key("request_id").value(requestId)
+		.key("device_id").value(util::machineUuid());
+	if (binary_protocol_allowed_) {
+		writer.key("accept_binary").value(static_cast<int>(rts_codec::kVersion));
 	}
+	writer.endObject();
+	qDebug()<< "sendServerMessage eventName:" << name.c_str() << "message: "<< send_buffer_.c_str();
+	return engine->sendServerMessage(send_buffer_.c_str());
 }
 
 void SessionBase::onServerMessageSendResult(int64_t msgid, int error, const bytertc::ServerACKMsg& msg) {
-	if (error != bytertc::UserMessageSendResult::kUserMessageSendResultSuccess) {
-		auto messageJsonObj = callback_with_messageId_[msgid];
-		qWarning()<< "Message send result exception, error_code: "<< error << ", event_name: "<< messageJsonObj["event_name"];
+	auto sentAsBinary = binary_message_ids_.erase(msgid) > 0;
+	std::string requestId;
+	if (!requests_.takeMessage(msgid, requestId)
+		|| error == bytertc::UserMessageSendResult::kUserMessageSendResultSuccess) {
+		return;
+	}
+	auto request = requests_.find(requestId);
+	auto eventName = request ? request->event_name : std::string();
+	qWarning()<< "Message send result exception, error_code: "<< error << ", event_name: "<< eventName.c_str();
+	// {zh} 二进制发送失败时回退到JSON，并重发该请求；其余失败等待超时处理
+	// {en} Fall back to JSON when a binary send fails, and resend the request; other failures are left to the deadline
+	if (sentAsBinary && request) {
+		binary_protocol_active_ = false;
+		auto resendId = _sendMessage(request->event_name, requestId, request->content);
+		if (resendId > 0) {
+			requests_.bindMessage(resendId, requestId);
+		}
 	}
-	callback_with_messageId_.erase(msgid);
 }
 
 /** {zh}
-* 收到RTS业务请求回调消息或通知消息，并解析
+* 收到RTS业务请求回调消息或通知消息，在线程池中扫描路由字段，按到达顺序回到主线程分发；
+* 消息内容只在处理函数需要时解析
 */
 
 /** {en}
-* Received RTS business request callback message or notification message, and parsed
+* Received RTS business request callback message or notification message; routing is scanned on the task pool
+* and messages are dispatched on the main thread in arrival order; the payload is only parsed when a handler needs it
 */
 void SessionBase::onMessageReceived(const std::string& uid, const std::string& message) {
-	auto messageByteArray = QByteArray(message.data(), static_cast<int>(message.size()));
-	auto messageJsonObj = QJsonDocument::fromJson(messageByteArray).object();
-	qDebug()<<"SessionBase::onMessageReceived: "<< messageJsonObj;
-	auto messageType = messageJsonObj["message_type"].toString();
-	if(messageType == vrd::MESSAGE_TYPE_RETURN) {
-		auto requestId = messageJsonObj["request_id"].toString();
-		if (!requestId.isEmpty()) {
-			if (callback_with_requsetId_.count(requestId) == 0) {
-				qWarning()<<"cannot find the callback with requestId: "<< requestId;
-				return;
-			}
-			auto mapValue = callback_with_requsetId_[requestId];
-			auto callback = std::get<0>(mapValue);
-			auto show_error = std::get<1>(mapValue);
+	auto seq = inbound_next_seq_++;
+	TaskPool::instance().submitThen(this, [message]() {
+		return _decodeMessage(message);
+	}, [this, seq](InboundMessage inbound) {
+		_receiveInbound(seq, std::move(inbound));
+	}, TaskPool::kHigh);
+}
+
+/** {zh}
+* 收到RTS二进制信令，解码后按JSON信令同样处理；首次收到时切换为二进制发送
+*/
 
-			_emitCallback([this, callback, messageJsonObj, show_error]() {
-				if (callback) {
-					callback(messageJsonObj);
+/** {en}
+* Received a binary RTS message, handled like a JSON one once decoded; the first one switches sending to binary
+*/
+void SessionBase::onBinaryMessageReceived(const std::string& uid, const std::string& message) {
+	auto seq = inbound_next_seq_++;
+	TaskPool::instance().submitThen(this, [message]() {
+		return _decodeBinaryMessage(message);
+	}, [this, seq](InboundMessage inbound) {
+		_receiveInbound(seq, std::move(inbound));
+	}, TaskPool::kHigh);
+}
+
+SessionBase::InboundMessage SessionBase::_decodeMessage(const std::string& message) {
+	qDebug()<<"SessionBase::onMessageReceived: "<< message.c_str();
+	InboundMessage inbound;
+	JsonRoute route;
+	if (!readJsonRoute(message.data(), message.size(), route)) {
+		qWarning()<<"SessionBase::onMessageReceived: invalid message";
+		return inbound;
+	}
+	inbound.valid = true;
+	inbound.message_type = route.message_type;
+	if (route.message_type == vrd::MESSAGE_TYPE_RETURN) {
+		inbound.key = route.request_id;
+		inbound.json = message;
+	}
+	else if (route.message_type == vrd::MESSAGE_TYPE_INFORM) {
+		inbound.key = route.event;
+		inbound.json.assign(route.data ? route.data : "", route.data_size);
+	}
+	return inbound;
+}
+
+SessionBase::InboundMessage SessionBase::_decodeBinaryMessage(const std::string& message) {
+	InboundMessage inbound;
+	QJsonObject messageJsonObj;
+	auto data = reinterpret_cast<const uint8_t*>(message.data());
+	if (!rts_codec::decode(data, static_cast<int>(message.size()), messageJsonObj)) {
+		qWarning() << "SessionBase::onBinaryMessageReceived: invalid frame, size: " << message.size();
+		return inbound;
+	}
+	qDebug()<<"SessionBase::onBinaryMessageReceived: "<< messageJsonObj;
+	inbound.valid = true;
+	inbound.binary = true;
+	inbound.message_type = messageJsonObj["message_type"].toString().toStdString();
+	if (inbound.message_type == vrd::MESSAGE_TYPE_RETURN) {
+		inbound.key = messageJsonObj["request_id"].toString().toStdString();
+		inbound.payload = messageJsonObj;
+	}
+	else if (inbound.message_type == vrd::MESSAGE_TYPE_INFORM) {
+		inbound.key = messageJsonObj["event"].toString().toStdString();
+		inbound.payload = messageJsonObj["data"].toObject();
+	}
+	return inbound;
+}
+
+void SessionBase::_receiveInbound(uint64_t seq, InboundMessage&& inbound) {
+	inbound_ready_[seq] = std::move(inbound);
+	while (!inbound_ready_.empty() && inbound_ready_.begin()->first == inbound_dispatch_seq_) {
+		auto next = std::move(inbound_ready_.begin()->second);
+		inbound_ready_.erase(inbound_ready_.begin());
+		++inbound_dispatch_seq_;
+		_dispatchInbound(std::move(next));
+	}
+}
+
+void SessionBase::_dispatchInbound(InboundMessage&& inbound) {
+	if (!inbound.valid) {
+		return;
+	}
+	if (inbound.binary && binary_protocol_allowed_ && !binary_protocol_active_) {
+		binary_protocol_active_ = true;
+	}
+	std::function<QJsonObject()> materialize;
+	if (inbound.binary) {
+		auto payload = std::move(inbound.payload);
+		materialize = [payload]() {
+			return payload;
+		};
+	}
+	else {
+		auto json = std::move(inbound.json);
+		materialize = [json]() {
+			return parseJsonObject(json.data(), json.size());
+		};
+	}
+	if (inbound.message_type == vrd::MESSAGE_TYPE_RETURN) {
+		_dispatchReturn(inbound.key, std::move(materialize));
+	}
+	else if (inbound.message_type == vrd::MESSAGE_TYPE_INFORM) {
+		_dispatchInform(inbound.key, std::move(materialize));
+	}
+}
+
+void SessionBase::_dispatchReturn(const std::string& requestId, std::function<QJsonObject()>&& materialize) {
+	if (requestId.empty()) {
+		return;
+	}
+	RtsRequestTracker::Request request;
+	if (!requests_.complete(requestId, _now(), request)) {
+		qWarning()<<"cannot find the callback with requestId: "<< requestId.c_str();
+		return;
+	}
+	_updateRequestTimer();
+	_deliverResponse(std::move(request), std::move(materialize));
+}
+
+void SessionBase::_deliverResponse(RtsRequestTracker::Request&& request, std::function<QJsonObject()>&& materialize) {
+	if (request.trace_start_us >= 0 && Tracer::enabled()) {
+		Tracer::instance().complete("rts", "request", request.trace_start_us, Tracer::now() - request.trace_start_us,
+			request.event_name.data(), request.event_name.size());
+	}
+	auto callback = std::move(request.callback);
+	auto show_error = request.show_err;
+	if (!callback && !show_error) {
+		return;
+	}
+
+	_emitCallback([callback, materialize, show_error]() {
+		auto messageJsonObj = materialize();
+		if (callback) {
+			callback(messageJsonObj);
+		}
+		auto code = messageJsonObj["code"].toInt();
+		if (show_error && code != 200) {
+			auto errInfo = util::getErrorInfo(code);
+			if (errInfo != nullptr) {
+				if (errInfo->is_error) {
+					util::showToastError(0, errInfo->error_msg);
 				}
-				auto code = messageJsonObj["code"].toInt();
-				if (show_error && code != 200) {
-					auto errInfo = util::getErrorInfo(code);
-					if (errInfo != nullptr) {
-						if (errInfo->is_error) {
-							util::showToastError(0, errInfo->error_msg);
-						}
-						else {
-							util::showToastInfo(errInfo->error_msg);
-						}
-					}
-					else {
-						auto errMsg = messageJsonObj["message"].toString();
-						util::showToastError(0, errMsg.toStdString());
-					}
+				else {
+					util::showToastInfo(errInfo->error_msg);
 				}
-			});
-			callback_with_requsetId_.erase(requestId);
+			}
+			else {
+				auto errMsg = messageJsonObj["message"].toString();
+				util::showToastError(0, errMsg.toStdString());
+			}
 		}
-	}
-	else if(messageType == vrd::MESSAGE_TYPE_INFORM) {
-		auto eventName = messageJsonObj["event"].toString();
-		if(!eventName.isEmpty()) {
-			auto eventNameStr = std::string(eventName.toUtf8());
-			if (event_listeners_.count(eventNameStr) == 0)
-			{
-				qWarning()<<"cannot find the event listener with event name: "<< eventName;
-				return;
+	});
+}
+
+/** {zh}
+ * 检查到期请求：可重试的请求以相同请求ID重发，其余以超时错误回调；同时清理过期的暂存请求
+ */
+
+/** {en}
+* Check due requests: retryable ones are resent with the same request id, the rest get a timeout error;
+* expired queued requests are dropped as well
+*/
+void SessionBase::_onRequestTick() {
+	std::vector<std::string> due;
+	auto now = _now();
+	requests_.expire(now, due);
+	for (const auto& requestId : due) {
+		auto request = requests_.find(requestId);
+		if (!request) {
+			continue;
+		}
+		if (request->attempts <= request->max_retries) {
+			qWarning()<< "request timeout, retry: "<< request->event_name.c_str() << ", attempt: "<< request->attempts;
+			auto msgId = _sendMessage(request->event_name, requestId, request->content);
+			if (msgId > 0) {
+				requests_.bindMessage(msgId, requestId);
 			}
-			auto eventListener = event_listeners_[eventNameStr];
-			auto dataJsonObj = messageJsonObj["data"].toObject();
-			_emitCallback([this, eventListener, dataJsonObj]() {
-				if (eventListener) {
-					eventListener(dataJsonObj);
-				}
-			});
+			requests_.retry(requestId, now);
+			continue;
 		}
+		RtsRequestTracker::Request timedOut;
+		requests_.fail(requestId, timedOut);
+		qWarning()<< "request timeout: "<< timedOut.event_name.c_str() << ", request_id: "<< requestId.c_str();
+		_deliverTimeout(std::move(timedOut), requestId);
 	}
+	_expireOffline(now);
+	_updateRequestTimer();
+}
+
+void SessionBase::_deliverTimeout(RtsRequestTracker::Request&& request, const std::string& requestId) {
+	_deliverResponse(std::move(request), [requestId]() {
+		QJsonObject response;
+		response["code"] = REQUEST_TIMEOUT_CODE;
+		response["message"] = QObject::tr("network_messsage_408");
+		response["request_id"] = QString::fromStdString(requestId);
+		return response;
+	});
+}
+
+void SessionBase::_updateRequestTimer() {
+	if (requests_.inFlight() == 0 && offline_requests_.empty()) {
+		request_timer_.stop();
+	}
+	else if (!request_timer_.isActive()) {
+		request_timer_.start(REQUEST_TICK_MS, [this]() { _onRequestTick(); });
+	}
+}
+
+int64_t SessionBase::_now() const {
+	return clock_.elapsed();
+}
+
+void SessionBase::_dispatchInform(const std::string& eventName, std::function<QJsonObject()>&& materialize) {
+	if (eventName.empty()) {
+		return;
+	}
+	auto iter = event_listeners_.find(eventName);
+	if (iter == event_listeners_.end() || !iter->second) {
+		qWarning()<<"cannot find the event listener with event name: "<< eventName.c_str();
+		return;
+	}
+	auto eventListener = iter->second;
+	_emitCallback([eventListener, materialize]() {
+		eventListener(materialize());
+	});
 }
 
 void SessionBase::onLoginResult(const std::string& uid, int error_code, int elapsed) {
@@ -275,11 +670,7 @@ void SessionBase::onLoginResult(const std::string& uid, int error_code, int elap
         engine_login_callback_ = nullptr;
 	}
 
-    if (error_code == bytertc::LoginErrorCode::kLoginErrorCodeSuccess) {
-		auto res_info = vrd::DataMgr::instance().rts_info();
-		setServerParams(res_info.server_signature, res_info.server_url);
-	}
-	else {
+    if (error_code != bytertc::LoginErrorCode::kLoginErrorCodeSuccess) {
 		qWarning()<< "onLoginResult fail: error_code: "<< error_code ;
 	}
 }
@@ -342,6 +733,26 @@ void SessionBase::_logoutRTS() {
     if (const auto& engine = RtcEngineWrap::instance().getRtcEngine()) {
         engine->logout();
     }
+    binary_protocol_active_ = false;
+    binary_message_ids_.clear();
+    // {zh} 重新登录后需要再次设置业务服务器参数，期间的请求进入暂存队列
+    // {en} Server params must be set again after the next login, requests in between are queued
+    init_server_completed_ = false;
+
+    // {zh} 暂存和在途的请求属于本次会话，以超时结束一次，不能发到下次登录的会话里，也不能带着旧token重发
+    // {en} Queued and in-flight requests belong to this session: finish each once as timed out so none is sent
+    // into the next login's session or resent with the old token
+    std::vector<std::pair<std::string, RtsRequestTracker::Request>> inFlight;
+    requests_.takeAll(inFlight);
+    auto offline = std::move(offline_requests_);
+    offline_requests_.clear();
+    for (auto& item : inFlight) {
+        _deliverTimeout(std::move(item.second), item.first);
+    }
+    for (auto& request : offline) {
+        _deliverTimeout(std::move(request), std::string());
+    }
+    _updateRequestTimer();
 }
 
 }  // namespace vrd
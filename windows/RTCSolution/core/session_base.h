@@ -3,11 +3,19 @@
 #include "callback_helper.h"
 #include "component_interface.h"
 #include "core/rtc_engine_wrap.h"
+#include "rts_request_tracker.h"
+#include "entry_pipeline.h"
+#include "timer_helper.h"
+#include <QElapsedTimer>
+#include <QJsonObject>
 #include <QObject>
+#include <deque>
 #include <functional>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
+#include <unordered_map>
 
 #define CSTRING_REF_PARAM const std::string&
 
@@ -28,8 +36,18 @@ public:
     SessionBase();
     ~SessionBase();
 
-	void connectRTS(CSTRING_REF_PARAM scenesName, std::function<void(void)>&& callback);
+	// {zh} addSceneSteps 可向进入流水线追加场景步骤，依赖 kEntryStepEngineReady 的步骤与RTS登录并行
+	// {en} addSceneSteps may append scene steps to the entry pipeline, steps depending on kEntryStepEngineReady overlap the RTS login
+	void connectRTS(CSTRING_REF_PARAM scenesName, std::function<void(void)>&& callback,
+		std::function<void(EntryPipeline&)>&& addSceneSteps = nullptr);
 	void disconnectRTS();
+	void markEntry(CSTRING_REF_PARAM milestone);
+
+	static const char* const kEntryStepFetchParams;
+	static const char* const kEntryStepCreateEngine;
+	static const char* const kEntryStepEngineReady;
+	static const char* const kEntryStepLogin;
+	static const char* const kEntryStepServerParams;
 
 public:
 	static void registerThis();
@@ -50,11 +68,18 @@ public:
 	CSTRING_REF_PARAM _userId();
 	CSTRING_REF_PARAM _token();
 
+	// {zh} 设置某个请求的超时时间和重试次数，仅对幂等请求设置重试
+	// {en} Set the timeout and retry count of a request, only set retries for idempotent requests
+	void setRequestPolicy(CSTRING_REF_PARAM name, int timeout_ms, int max_retries = 0);
+	size_t inFlightRequests() const;
+	const std::unordered_map<std::string, RtsRequestTracker::EventStats>& requestStats() const;
+
 public slots:
 	void onLoginResult(const std::string& uid, int error_code, int elapsed);
 	void onServerParamsSetResult(int error);
 	void onServerMessageSendResult(int64_t msgid, int error, const bytertc::ServerACKMsg& msg);
 	void onMessageReceived(const std::string& uid, const std::string& message);
+	void onBinaryMessageReceived(const std::string& uid, const std::string& message);
 
 private:
 	void initConnections();
@@ -64,11 +89,54 @@ private:
 	void _loginRTS(const std::string& token, CallBackFunction&& callback);
 	void _logoutRTS();
 
+	int64_t _sendMessage(CSTRING_REF_PARAM name, CSTRING_REF_PARAM requestId, const QJsonObject& content);
+	void _sendRequest(RtsRequestTracker::Request&& request);
+	void _enqueueOffline(RtsRequestTracker::Request&& request);
+	void _flushOffline();
+	void _expireOffline(int64_t now);
+	void _deliverTimeout(RtsRequestTracker::Request&& request, const std::string& requestId);
+	void _dispatchReturn(const std::string& requestId, std::function<QJsonObject()>&& materialize);
+	void _deliverResponse(RtsRequestTracker::Request&& request, std::function<QJsonObject()>&& materialize);
+	void _onRequestTick();
+	void _updateRequestTimer();
+	int64_t _now() const;
+	void _dispatchInform(const std::string& eventName, std::function<QJsonObject()>&& materialize);
+
+	// {zh} 在线程池中解码完成的RTS消息
+	// {en} An RTS message decoded on the task pool
+	struct InboundMessage {
+		bool valid = false;
+		bool binary = false;
+		std::string message_type;
+		// {zh} RETURN 消息为请求ID，INFORM 消息为事件名
+		// {en} The request id for RETURN messages, the event name for INFORM messages
+		std::string key;
+		// {zh} JSON 信令的原文（RETURN 为整条消息，INFORM 为 data 部分），只在处理函数需要时解析
+		// {en} Raw text of a JSON message (the whole message for RETURN, the data part for INFORM),
+		// parsed only when a handler needs it
+		std::string json;
+		// {zh} 二进制信令解码时已得到的内容
+		// {en} Content already produced by decoding a binary message
+		QJsonObject payload;
+	};
+	static InboundMessage _decodeMessage(const std::string& message);
+	static InboundMessage _decodeBinaryMessage(const std::string& message);
+	void _receiveInbound(uint64_t seq, InboundMessage&& inbound);
+	void _dispatchInbound(InboundMessage&& inbound);
+
 private:
 	CallBackFunction engine_login_callback_{nullptr};
-	std::function<void(void)> connect_rts_callback_{nullptr};
+	CallBackFunction server_params_callback_{nullptr};
+	std::shared_ptr<EntryPipeline> entry_pipeline_;
+	// {zh} 当前引擎创建时使用的AppId
+	// {en} App id the current engine was created with
+	std::string engine_app_id_;
 	CallbackHelper cb_helper_;
-	QTimer* net_live_timer_{ nullptr };
+	TimerHelper net_live_timer_;
+	// {zh} 有在途请求时驱动请求超时检查
+	// {en} Drives request deadline checks while requests are in flight
+	TimerHelper request_timer_;
+	QElapsedTimer clock_;
 	
     std::string user_id_;
 	std::string token_;
@@ -76,15 +144,32 @@ private:
 	// {zh} 是否完成业务服务器初始化标志
 	// {en} Whether to complete the business server initialization flag
     bool init_server_completed_{ false };
-
-	// {zh} RTS请求消息反馈集合，关键字为请求ID, 值为请求回调及显示错误标志
-	// {en} RTS request message feedback collection, the keyword is the request ID, and the value is the request callback and display error flag
-	std::map<QString, std::tuple<std::function<void(const QJsonObject& response)>, bool>> callback_with_requsetId_;
-	// {zh} RTS请求消息结果集合，关键字为发送消息id, 值为请求回调
-	// {en} RTS request message result set, the keyword is the sent message id, and the value is the request callback
-	std::map<int64_t, QJsonObject> callback_with_messageId_;
+	// {zh} 是否允许使用二进制信令，由配置项 rts/binary_protocol 开启
+	// {en} Whether binary signaling is allowed, enabled by the rts/binary_protocol setting
+	bool binary_protocol_allowed_{ false };
+	// {zh} 服务端已回复过二进制信令，后续请求改用二进制发送
+	// {en} The server has answered in binary, so later requests are sent in binary
+	bool binary_protocol_active_{ false };
+	// {zh} 以二进制发送的消息id，发送失败时回退为JSON重发
+	// {en} Ids of messages sent in binary, they are resent as JSON if sending fails
+	std::set<int64_t> binary_message_ids_;
+
+	// {zh} 在途RTS请求，按请求ID索引回调、截止时间和往返时延统计，发送消息id映射到请求ID
+	// {en} In-flight RTS requests, indexing callbacks, deadlines and RTT stats by request id, and mapping sent message ids to request ids
+	RtsRequestTracker requests_;
+	// {zh} 业务服务器参数设置完成前发出的请求，按发出顺序暂存，有上限和截止时间
+	// {en} Requests issued before the server params are set, kept in order with a size cap and deadlines
+	std::deque<RtsRequestTracker::Request> offline_requests_;
+	// {zh} JSON信令写入缓冲区，多次发送间复用
+	// {en} JSON message buffer, reused across sends
+	std::string send_buffer_;
 	// {zh} RTS通知消息监听器, 关键字为消息名，值为通知处理回调
 	// {en} RTS notification message listener, the keyword is the message name, and the value is the notification processing callback
 	std::map<std::string, std::function<void(const QJsonObject& data)>> event_listeners_;
+	// {zh} 收到的消息在线程池中并行解码，按到达序号重排后依次分发
+	// {en} Received messages are decoded in parallel on the task pool, then reordered by arrival sequence before dispatch
+	uint64_t inbound_next_seq_{ 0 };
+	uint64_t inbound_dispatch_seq_{ 0 };
+	std::map<uint64_t, InboundMessage> inbound_ready_;
 };
 }  // namespace vrd
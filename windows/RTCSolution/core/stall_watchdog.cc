@@ -0,0 +1,194 @@
+﻿#include "stall_watchdog.h"
+#include "task_pool.h"
+#include "Configer.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QEvent>
+#include <algorithm>
+#include <chrono>
+
+namespace vrd
+{
+	namespace
+	{
+		int configValue(const char* key, int fallback) {
+			auto value = QString::fromStdString(Configer::instance().getData(key)).toInt();
+			return value > 0 ? value : fallback;
+		}
+	}
+
+	StallWatchdog& StallWatchdog::instance() {
+		static StallWatchdog watchdog;
+		return watchdog;
+	}
+
+	StallWatchdog::~StallWatchdog() {
+		stop();
+	}
+
+	void StallWatchdog::start() {
+		if (thread_.joinable()) {
+			return;
+		}
+		interval_ms_ = configValue("perf/watchdog_interval_ms", interval_ms_);
+		threshold_ms_ = configValue("perf/stall_threshold_ms", threshold_ms_);
+		budget_ms_ = configValue("perf/handler_budget_ms", budget_ms_);
+		stopping_ = false;
+		thread_ = std::thread([this]() { run(); });
+		summary_timer_ = TimerWheel::instance().scheduleRepeating(60 * 1000, [this]() {
+			logSummary();
+		}, TimerWheel::kCoarse);
+	}
+
+	void StallWatchdog::stop() {
+		if (!thread_.joinable()) {
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stopping_ = true;
+		}
+		wakeup_.notify_all();
+		thread_.join();
+		TimerWheel::instance().cancel(summary_timer_);
+		summary_timer_ = 0;
+		logSummary();
+	}
+
+	void StallWatchdog::run() {
+		bool reported = false;
+		std::unique_lock<std::mutex> lock(mutex_);
+		while (!wakeup_.wait_for(lock, std::chrono::milliseconds(interval_ms_), [this]() { return stopping_; })) {
+			auto now = nowUs() / 1000;
+			auto sent = probe_sent_ms_.load();
+			if (sent < 0) {
+				reported = false;
+				probe_sent_ms_ = now;
+				TaskPool::postTo(QCoreApplication::instance(), [this, now]() { probe(now); });
+				continue;
+			}
+			if (reported || now - sent < threshold_ms_) {
+				continue;
+			}
+			reported = true;
+			++stalls_;
+			StallInfo stall;
+			stall.duration_ms = now - sent;
+			auto outer = outer_handler_.load();
+			auto inner = inner_handler_.load();
+			if (outer != nullptr) {
+				stall.handler = handlerName(Key{ outer, outer_kind_ });
+				if (inner != nullptr && inner != outer) {
+					stall.handler += " > " + handlerName(Key{ inner, inner_kind_ });
+				}
+			}
+			qWarning() << "main thread stalled for at least" << stall.duration_ms << "ms in:"
+				<< (stall.handler.empty() ? "<idle or unknown>" : stall.handler.c_str());
+			std::lock_guard<std::mutex> stallLock(stall_mutex_);
+			last_stall_ = std::move(stall);
+		}
+	}
+
+	void StallWatchdog::probe(int64_t sent_ms) {
+		latency_.add(nowUs() / 1000 - sent_ms);
+		probe_sent_ms_ = -1;
+	}
+
+	void StallWatchdog::beginHandler(const char* name, int kind) {
+		Key key{ name, kind };
+		if (frames_.empty()) {
+			outer_kind_ = kind;
+			outer_handler_ = name;
+		}
+		inner_kind_ = kind;
+		inner_handler_ = name;
+		frames_.push_back(Frame{ key, nowUs() });
+	}
+
+	void StallWatchdog::endHandler() {
+		if (frames_.empty()) {
+			return;
+		}
+		auto frame = frames_.back();
+		frames_.pop_back();
+		auto elapsed = nowUs() - frame.start_us;
+		auto& stats = handlers_[frame.key];
+		++stats.count;
+		stats.total_us += elapsed;
+		stats.max_us = std::max(stats.max_us, elapsed);
+		if (elapsed > budget_ms_ * 1000) {
+			++stats.over_budget;
+			qWarning() << "handler over budget:" << handlerName(frame.key).c_str()
+				<< "took" << elapsed / 1000 << "ms, budget" << budget_ms_ << "ms";
+		}
+		if (frames_.empty()) {
+			outer_handler_ = nullptr;
+			inner_handler_ = nullptr;
+		}
+		else {
+			inner_kind_ = frames_.back().key.kind;
+			inner_handler_ = frames_.back().key.name;
+		}
+	}
+
+	const StallWatchdog::LatencyHistogram& StallWatchdog::latency() const {
+		return latency_;
+	}
+
+	uint64_t StallWatchdog::stalls() const {
+		return stalls_;
+	}
+
+	StallWatchdog::StallInfo StallWatchdog::lastStall() const {
+		std::lock_guard<std::mutex> lock(stall_mutex_);
+		return last_stall_;
+	}
+
+	int StallWatchdog::budgetMs() const {
+		return budget_ms_;
+	}
+
+	std::vector<StallWatchdog::HandlerStats> StallWatchdog::topHandlers(size_t count) const {
+		std::vector<HandlerStats> result;
+		result.reserve(handlers_.size());
+		for (const auto& item : handlers_) {
+			result.push_back(item.second);
+			result.back().name = handlerName(item.first);
+		}
+		std::sort(result.begin(), result.end(), [](const HandlerStats& a, const HandlerStats& b) {
+			return a.total_us > b.total_us;
+		});
+		if (result.size() > count) {
+			result.resize(count);
+		}
+		return result;
+	}
+
+	void StallWatchdog::logSummary() const {
+		qInfo() << "main thread latency p50:" << latency_.percentile(0.5) << "ms, p99:" << latency_.percentile(0.99)
+			<< "ms, max:" << latency_.max_ms << "ms, stalls:" << stalls();
+		for (const auto& handler : topHandlers(10)) {
+			qInfo() << "  handler" << handler.name.c_str() << "count:" << handler.count
+				<< "total:" << handler.total_us / 1000 << "ms, max:" << handler.max_us / 1000
+				<< "ms, over budget:" << handler.over_budget;
+		}
+	}
+
+	int64_t StallWatchdog::nowUs() {
+		return std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	std::string StallWatchdog::handlerName(const Key& key) {
+		std::string name = key.name ? key.name : "";
+		switch (key.kind) {
+		case QEvent::User:
+			return name;
+		case QEvent::MetaCall:
+			return name + " (queued call)";
+		default:
+			return name + " (event " + std::to_string(key.kind) + ")";
+		}
+	}
+}
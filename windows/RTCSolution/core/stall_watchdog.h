@@ -0,0 +1,131 @@
+﻿#ifndef VRD_STALLWATCHDOG_H
+#define VRD_STALLWATCHDOG_H
+
+#include "rts_request_tracker.h"
+#include "timer_wheel.h"
+#include <QString>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace vrd
+{
+	/** {zh}
+	 * 主线程卡顿监测
+	 * 1, 监测线程按固定间隔向主线程事件循环投递探测事件，记录事件循环延迟直方图
+	 * 2, 探测事件超过阈值仍未执行时视为卡顿，记录当时正在执行的事件处理函数并写日志
+	 * 3, 主线程每个事件处理（ForwardEvent、排队的槽函数调用等）的耗时按处理函数统计，超出预算的会被标记
+	 * 4, 配置项 perf/watchdog_interval_ms、perf/stall_threshold_ms、perf/handler_budget_ms
+	 */
+
+	/** {en}
+	* Main-thread stall monitor
+	* 1, A watchdog thread posts probe events to the main event loop at a fixed interval and records an event-loop latency histogram
+	* 2, A probe still pending past the threshold counts as a stall, the event handler running at that moment is captured and logged
+	* 3, Every main-thread event handler (ForwardEvent, queued slot calls and so on) is timed per handler, those over budget are flagged
+	* 4, Settings perf/watchdog_interval_ms, perf/stall_threshold_ms, perf/handler_budget_ms
+	*/
+	class StallWatchdog
+	{
+	public:
+		using LatencyHistogram = RtsRequestTracker::RttHistogram;
+
+		struct HandlerStats {
+			std::string name;
+			uint64_t count = 0;
+			int64_t total_us = 0;
+			int64_t max_us = 0;
+			uint64_t over_budget = 0;
+		};
+
+		struct StallInfo {
+			int64_t duration_ms = 0;
+			std::string handler;
+		};
+
+		static StallWatchdog& instance();
+
+		// {zh} 在主线程调用
+		// {en} Call on the main thread
+		void start();
+		void stop();
+
+		// {zh} 主线程事件处理开始和结束，可嵌套
+		// {en} Start and end of a main-thread event handler, may nest
+		void beginHandler(const char* name, int kind);
+		void endHandler();
+
+		const LatencyHistogram& latency() const;
+		uint64_t stalls() const;
+		StallInfo lastStall() const;
+		int budgetMs() const;
+		// {zh} 按总耗时排序的处理函数统计
+		// {en} Handler stats sorted by total time
+		std::vector<HandlerStats> topHandlers(size_t count) const;
+		void logSummary() const;
+
+	private:
+		struct Key {
+			const char* name;
+			int kind;
+			bool operator==(const Key& other) const {
+				return name == other.name && kind == other.kind;
+			}
+		};
+		struct KeyHash {
+			size_t operator()(const Key& key) const {
+				return std::hash<const void*>()(key.name) ^ static_cast<size_t>(key.kind);
+			}
+		};
+		struct Frame {
+			Key key;
+			int64_t start_us;
+		};
+
+		StallWatchdog() = default;
+		~StallWatchdog();
+
+		void run();
+		void probe(int64_t sent_ms);
+		static int64_t nowUs();
+		static std::string handlerName(const Key& key);
+
+		int interval_ms_ = 100;
+		int threshold_ms_ = 200;
+		int budget_ms_ = 50;
+
+		std::thread thread_;
+		std::mutex mutex_;
+		std::condition_variable wakeup_;
+		bool stopping_ = false;
+		TimerWheel::TimerId summary_timer_ = 0;
+
+		// {zh} 未完成探测的发送时间，-1表示没有在途探测
+		// {en} Send time of the pending probe, -1 when none is in flight
+		std::atomic<int64_t> probe_sent_ms_{ -1 };
+		// {zh} 主线程最外层和最内层正在执行的处理函数，供监测线程读取
+		// {en} Outermost and innermost handlers running on the main thread, read by the watchdog thread
+		std::atomic<const char*> outer_handler_{ nullptr };
+		std::atomic<int> outer_kind_{ 0 };
+		std::atomic<const char*> inner_handler_{ nullptr };
+		std::atomic<int> inner_kind_{ 0 };
+		std::atomic<uint64_t> stalls_{ 0 };
+		mutable std::mutex stall_mutex_;
+		StallInfo last_stall_;
+
+		// {zh} 以下只在主线程访问
+		// {en} Main thread only below
+		LatencyHistogram latency_;
+		std::vector<Frame> frames_;
+		std::unordered_map<Key, HandlerStats, KeyHash> handlers_;
+	};
+}
+
+#endif // VRD_STALLWATCHDOG_H
@@ -0,0 +1,206 @@
+﻿#include "subscription_set.h"
+
+namespace vrd
+{
+	namespace
+	{
+		enum { kAudio = 0, kVideo, kMediaCount };
+
+		bool sameLayer(const bytertc::RemoteVideoConfig& lhs, const bytertc::RemoteVideoConfig& rhs) {
+			return lhs.framerate == rhs.framerate && lhs.resolution_width == rhs.resolution_width
+				&& lhs.resolution_height == rhs.resolution_height;
+		}
+
+		int mediaBits(bool audio, bool video) {
+			return (audio ? bytertc::kMediaStreamTypeAudio : 0) | (video ? bytertc::kMediaStreamTypeVideo : 0);
+		}
+
+		// {zh} 全量调用之后一路流还需的调用，返回媒体位组合，0表示不需要
+		// 订阅会替换原有订阅，所以有媒体要打开时按完整的期望状态订阅；否则只取消订阅要关闭的媒体
+		// {en} Call a stream still needs after the room-wide call, returned as media bits, 0 when none is needed
+		// A subscribe replaces the previous one, so when some media turns on the stream is subscribed with its full
+		// desired state; otherwise only the media turning off is unsubscribed
+		int streamCall(const StreamSubscription& desired, bool audio, bool video, bool* subscribe) {
+			if ((desired.audio && !audio) || (desired.video && !video)) {
+				*subscribe = true;
+				return mediaBits(desired.audio, desired.video);
+			}
+			*subscribe = false;
+			return mediaBits(audio && !desired.audio, video && !desired.video);
+		}
+
+		void subscribe(bytertc::IRTCRoom* room, const StreamSubscription& stream, bool subscribed, int media) {
+			auto uid = stream.user_id.c_str();
+			auto type = static_cast<bytertc::MediaStreamType>(media);
+			if (stream.is_screen) {
+				subscribed ? room->subscribeScreen(uid, type) : room->unsubscribeScreen(uid, type);
+			}
+			else {
+				subscribed ? room->subscribeStream(uid, type) : room->unsubscribeStream(uid, type);
+			}
+		}
+	}
+
+	void SubscriptionSet::setDesired(const StreamSubscription& subscription) {
+		streams_[Key(subscription.user_id, subscription.is_screen)].desired = subscription;
+	}
+
+	StreamSubscription SubscriptionSet::desired(const std::string& user_id, bool is_screen) const {
+		auto it = streams_.find(Key(user_id, is_screen));
+		if (it != streams_.end()) {
+			return it->second.desired;
+		}
+		StreamSubscription subscription;
+		subscription.user_id = user_id;
+		subscription.is_screen = is_screen;
+		return subscription;
+	}
+
+	void SubscriptionSet::onPublished(const std::string& user_id, bool is_screen, bytertc::MediaStreamType type) {
+		auto& stream = streams_[Key(user_id, is_screen)];
+		stream.desired.user_id = user_id;
+		stream.desired.is_screen = is_screen;
+		if (stream.published == 0) {
+			stream.applied = StreamSubscription();
+			stream.applied.user_id = user_id;
+			stream.applied.is_screen = is_screen;
+		}
+		stream.published |= type;
+		// {zh} 自动订阅会订阅新发布的媒体
+		// {en} Auto subscribe picks up newly published media
+		if (type & bytertc::kMediaStreamTypeAudio) {
+			stream.applied.audio = true;
+		}
+		if (type & bytertc::kMediaStreamTypeVideo) {
+			stream.applied.video = true;
+		}
+	}
+
+	void SubscriptionSet::onUnpublished(const std::string& user_id, bool is_screen, bytertc::MediaStreamType type) {
+		auto it = streams_.find(Key(user_id, is_screen));
+		if (it != streams_.end()) {
+			it->second.published &= ~type;
+		}
+	}
+
+	void SubscriptionSet::onUserLeave(const std::string& user_id) {
+		streams_.erase(Key(user_id, false));
+		streams_.erase(Key(user_id, true));
+	}
+
+	void SubscriptionSet::clear() {
+		streams_.clear();
+	}
+
+	int SubscriptionSet::apply(bytertc::IRTCRoom* room) {
+		if (!room) {
+			return 0;
+		}
+		std::vector<Stream*> pending;
+		int calls = 0;
+		const StreamSubscription* common = nullptr;
+		bool uniform = true;
+		bool main_pending = false;
+		bool all_off[kMediaCount] = { true, true };
+		bool turning_off[kMediaCount] = {};
+		for (auto& item : streams_) {
+			auto& stream = item.second;
+			if (stream.published == 0) {
+				continue;
+			}
+			auto& desired = stream.desired;
+			auto& applied = stream.applied;
+			bool changed = desired.audio != applied.audio || desired.video != applied.video;
+			if (!desired.is_screen) {
+				if (!common) {
+					common = &desired;
+				}
+				uniform = uniform && desired.audio == common->audio && desired.video == common->video;
+				main_pending = main_pending || changed;
+				all_off[kAudio] = all_off[kAudio] && !desired.audio;
+				all_off[kVideo] = all_off[kVideo] && !desired.video;
+				turning_off[kAudio] = turning_off[kAudio] || (applied.audio && !desired.audio);
+				turning_off[kVideo] = turning_off[kVideo] || (applied.video && !desired.video);
+				// {zh} 先设分层再订阅，首帧即为期望的分层
+				// {en} Set the layer before subscribing so the first frames already come in that layer
+				if (desired.video && !sameLayer(desired.layer, applied.layer)) {
+					room->setRemoteVideoConfig(desired.user_id.c_str(), desired.layer);
+					applied.layer = desired.layer;
+					++calls;
+				}
+			}
+			if (changed) {
+				pending.push_back(&stream);
+			}
+		}
+
+		// {zh} 全量接口的方案：0不用，1到3为 unsubscribeAllStreams 的媒体位组合，4为 subscribeAllStreams
+		// subscribeAllStreams 同样是替换，只在所有主流期望完全一致时使用，一次把主流都带到期望状态
+		// {en} Room-wide plans: 0 none, 1 to 3 the media bits of unsubscribeAllStreams, 4 subscribeAllStreams
+		// subscribeAllStreams replaces as well, so it is only used when every main stream wants exactly the same,
+		// and then brings all of them to their desired state in one call
+		const int kSubscribeAll = 4;
+		auto available = [&](int plan) {
+			if (plan == kSubscribeAll) {
+				return main_pending && uniform && (common->audio || common->video);
+			}
+			for (int m = 0; m < kMediaCount; ++m) {
+				if ((plan & (1 << m)) && !(all_off[m] && turning_off[m])) {
+					return false;
+				}
+			}
+			return true;
+		};
+		auto remaining = [&](const Stream& stream, int plan, bool* subscribe) {
+			auto& desired = stream.desired;
+			bool audio = stream.applied.audio;
+			bool video = stream.applied.video;
+			if (!desired.is_screen) {
+				if (plan == kSubscribeAll) {
+					audio = desired.audio;
+					video = desired.video;
+				}
+				else {
+					audio = audio && !(plan & bytertc::kMediaStreamTypeAudio);
+					video = video && !(plan & bytertc::kMediaStreamTypeVideo);
+				}
+			}
+			return streamCall(desired, audio, video, subscribe);
+		};
+		// {zh} 取调用数最少的方案，相同时优先逐路调用
+		// {en} The cheapest plan wins and per-stream calls win ties
+		int best_plan = 0;
+		int best_cost = -1;
+		for (int plan = 0; plan <= kSubscribeAll; ++plan) {
+			if (!available(plan)) {
+				continue;
+			}
+			int cost = plan != 0 ? 1 : 0;
+			for (auto stream : pending) {
+				bool subscribed = false;
+				cost += remaining(*stream, plan, &subscribed) != 0 ? 1 : 0;
+			}
+			if (best_cost < 0 || cost < best_cost) {
+				best_cost = cost;
+				best_plan = plan;
+			}
+		}
+
+		if (best_plan == kSubscribeAll) {
+			room->subscribeAllStreams(static_cast<bytertc::MediaStreamType>(mediaBits(common->audio, common->video)));
+		}
+		else if (best_plan != 0) {
+			room->unsubscribeAllStreams(static_cast<bytertc::MediaStreamType>(best_plan));
+		}
+		for (auto stream : pending) {
+			bool subscribed = false;
+			auto media = remaining(*stream, best_plan, &subscribed);
+			if (media != 0) {
+				subscribe(room, stream->desired, subscribed, media);
+			}
+			stream->applied.audio = stream->desired.audio;
+			stream->applied.video = stream->desired.video;
+		}
+		return calls + best_cost;
+	}
+}
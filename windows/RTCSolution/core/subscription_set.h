@@ -0,0 +1,79 @@
+﻿#ifndef VRD_SUBSCRIPTIONSET_H
+#define VRD_SUBSCRIPTIONSET_H
+
+#include "bytertc_room.h"
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace vrd
+{
+	/** {zh}
+	 * 一路远端流期望的订阅状态
+	 * layer 为主流期望的视频分层，全为0时不指定，由SDK决定；屏幕流忽略 layer
+	 */
+
+	/** {en}
+	* Desired subscription of one remote stream
+	* layer is the preferred video layer of a main stream, all zero leaves it to the SDK; screen streams ignore it
+	*/
+	struct StreamSubscription {
+		std::string user_id;
+		bool is_screen = false;
+		bool audio = true;
+		bool video = true;
+		bytertc::RemoteVideoConfig layer;
+	};
+
+	/** {zh}
+	 * 当前房间远端流的订阅表，保存每路流期望的和已经应用到SDK的订阅状态
+	 * 1, 远端发布某种媒体时按自动订阅记为该媒体已订阅，之后把差异补齐到期望状态；全部取消发布后只保留期望状态
+	 * 2, apply 一次比较所有已发布流的期望与已应用状态，只发出必要的 subscribe/unsubscribe/setRemoteVideoConfig 调用；
+	 *    订阅会替换原有订阅，所以总是按完整的期望媒体订阅，只有取消订阅按单个媒体；
+	 *    所有主流期望一致且 subscribeAllStreams/unsubscribeAllStreams 调用更少时改用全量接口
+	 * 仅在主线程调用，由 RtcEngineWrap 持有
+	 */
+
+	/** {en}
+	* Subscription table of the remote streams in the current room, keeping the desired and the applied state per stream
+	* 1, Newly published media counts as subscribed, as auto subscribe does, and the stream is then brought to its
+	*    desired state; once everything is unpublished only the desired state is kept
+	* 2, apply compares desired and applied state of every published stream in one pass and issues only the needed
+	*    subscribe/unsubscribe/setRemoteVideoConfig calls; a subscribe replaces the previous one, so it always carries
+	*    the full desired media and only unsubscribes are per media; when every main stream wants the same and
+	*    subscribeAllStreams/unsubscribeAllStreams takes fewer calls, the room-wide call is used instead
+	* Main thread only, owned by RtcEngineWrap
+	*/
+	class SubscriptionSet
+	{
+	public:
+		void setDesired(const StreamSubscription& subscription);
+		// {zh} 未设置过期望状态的流视为音视频均订阅
+		// {en} A stream without a desired state counts as audio and video subscribed
+		StreamSubscription desired(const std::string& user_id, bool is_screen) const;
+
+		void onPublished(const std::string& user_id, bool is_screen, bytertc::MediaStreamType type);
+		void onUnpublished(const std::string& user_id, bool is_screen, bytertc::MediaStreamType type);
+		void onUserLeave(const std::string& user_id);
+		void clear();
+
+		// {zh} 返回发出的SDK调用次数
+		// {en} Returns the number of SDK calls issued
+		int apply(bytertc::IRTCRoom* room);
+
+	private:
+		struct Stream {
+			// {zh} 已发布的媒体，MediaStreamType 的位组合
+			// {en} Published media as MediaStreamType bits
+			int published = 0;
+			StreamSubscription desired;
+			StreamSubscription applied;
+		};
+		using Key = std::pair<std::string, bool>;
+
+		std::map<Key, Stream> streams_;
+	};
+}
+
+#endif // VRD_SUBSCRIPTIONSET_H
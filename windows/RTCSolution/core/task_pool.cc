@@ -0,0 +1,210 @@
+﻿#include "task_pool.h"
+#include "rtc_engine_wrap.h"
+#include "trace_event.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <map>
+
+namespace vrd
+{
+	namespace
+	{
+		/** {zh}
+		 * 每个目标线程一个的 ForwardEvent 接收对象，执行投递过来的后续处理
+		 */
+
+		/** {en}
+		* One ForwardEvent receiver per target thread, runs the posted continuations
+		*/
+		class ForwardReceiver : public QObject
+		{
+		public:
+			bool event(QEvent* e) override {
+				if (e->type() == QEvent::User) {
+					static_cast<ForwardEvent*>(e)->execTask();
+					return true;
+				}
+				return QObject::event(e);
+			}
+		};
+
+		std::mutex g_receivers_mutex;
+		std::map<QThread*, ForwardReceiver*> g_receivers;
+
+		ForwardReceiver* receiverFor(QThread* thread) {
+			std::lock_guard<std::mutex> lock(g_receivers_mutex);
+			auto iter = g_receivers.find(thread);
+			if (iter != g_receivers.end()) {
+				return iter->second;
+			}
+			auto receiver = new ForwardReceiver();
+			receiver->moveToThread(thread);
+			g_receivers[thread] = receiver;
+			QObject::connect(thread, &QThread::finished, receiver, [thread, receiver]() {
+				{
+					std::lock_guard<std::mutex> lock(g_receivers_mutex);
+					g_receivers.erase(thread);
+				}
+				receiver->deleteLater();
+			}, Qt::DirectConnection);
+			return receiver;
+		}
+	}
+
+	std::atomic<int64_t> TaskPool::continuation_us_{ 0 };
+
+	TaskPool& TaskPool::instance() {
+		static TaskPool pool;
+		return pool;
+	}
+
+	TaskPool::TaskPool() {
+		int count = static_cast<int>(std::thread::hardware_concurrency()) / 2;
+		count = std::max(2, std::min(count, 8));
+		for (int i = 0; i < count; ++i) {
+			workers_.emplace_back(new Worker());
+		}
+		for (int i = 0; i < count; ++i) {
+			workers_[i]->thread = std::thread([this, i]() { run(i); });
+		}
+	}
+
+	TaskPool::~TaskPool() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stopping_ = true;
+		}
+		wakeup_.notify_all();
+		for (auto& worker : workers_) {
+			if (worker->thread.joinable()) {
+				worker->thread.join();
+			}
+		}
+	}
+
+	void TaskPool::submit(std::function<void(void)>&& task, Priority priority, int affinity) {
+		if (!task || stopping_) {
+			return;
+		}
+		if (affinity >= 0) {
+			auto& worker = *workers_[affinity % workers_.size()];
+			std::lock_guard<std::mutex> lock(worker.mutex);
+			worker.queues[priority].push_back(std::move(task));
+		}
+		else {
+			std::lock_guard<std::mutex> lock(global_mutex_);
+			global_[priority].push_back(std::move(task));
+		}
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			++pending_;
+		}
+		wakeup_.notify_one();
+	}
+
+	void TaskPool::postTo(QObject* context, std::function<void(void)>&& continuation) {
+		if (context == nullptr) {
+			return;
+		}
+		post(context->thread(), QPointer<QObject>(context), std::move(continuation));
+	}
+
+	void TaskPool::post(QThread* thread, const QPointer<QObject>& context,
+		std::function<void(void)>&& continuation) {
+		if (thread == nullptr) {
+			return;
+		}
+		auto label = continuation.target_type().name();
+		auto event = new ForwardEvent([context, continuation]() {
+			if (context.isNull()) {
+				return;
+			}
+			QElapsedTimer timer;
+			timer.start();
+			continuation();
+			continuation_us_ += timer.nsecsElapsed() / 1000;
+		});
+		event->label_ = label;
+		QCoreApplication::postEvent(receiverFor(thread), event);
+	}
+
+	int TaskPool::workerCount() const {
+		return static_cast<int>(workers_.size());
+	}
+
+	TaskPool::Stats TaskPool::stats() const {
+		Stats stats;
+		stats.executed = executed_;
+		stats.stolen = stolen_;
+		stats.busy_us = busy_us_;
+		stats.continuation_us = continuation_us_;
+		return stats;
+	}
+
+	void TaskPool::run(int index) {
+		Tracer::setThreadName("task_pool");
+		std::function<void(void)> task;
+		while (true) {
+			if (take(index, task)) {
+				--pending_;
+				QElapsedTimer timer;
+				timer.start();
+				task();
+				task = nullptr;
+				busy_us_ += timer.nsecsElapsed() / 1000;
+				++executed_;
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(mutex_);
+			wakeup_.wait(lock, [this]() { return stopping_ || pending_ > 0; });
+			if (stopping_) {
+				return;
+			}
+		}
+	}
+
+	bool TaskPool::take(int index, std::function<void(void)>& task) {
+		auto& worker = *workers_[index];
+		for (int priority = kHigh; priority < kPriorityCount; ++priority) {
+			if (popFront(worker.mutex, worker.queues[priority], task)) {
+				return true;
+			}
+			if (popFront(global_mutex_, global_[priority], task)) {
+				return true;
+			}
+			if (steal(index, priority, task)) {
+				++stolen_;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool TaskPool::popFront(std::mutex& mutex, std::deque<std::function<void(void)>>& queue,
+		std::function<void(void)>& task) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (queue.empty()) {
+			return false;
+		}
+		task = std::move(queue.front());
+		queue.pop_front();
+		return true;
+	}
+
+	bool TaskPool::steal(int index, int priority, std::function<void(void)>& task) {
+		auto count = static_cast<int>(workers_.size());
+		for (int i = 1; i < count; ++i) {
+			auto& victim = *workers_[(index + i) % count];
+			std::lock_guard<std::mutex> lock(victim.mutex);
+			auto& queue = victim.queues[priority];
+			if (!queue.empty()) {
+				task = std::move(queue.back());
+				queue.pop_back();
+				return true;
+			}
+		}
+		return false;
+	}
+}
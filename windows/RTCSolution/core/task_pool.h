@@ -0,0 +1,119 @@
+﻿#ifndef VRD_TASKPOOL_H
+#define VRD_TASKPOOL_H
+
+#include <QObject>
+#include <QPointer>
+#include <QThread>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace vrd
+{
+	/** {zh}
+	 * 共享的工作窃取线程池，用于把解析、图像转换等计算移出主线程
+	 * 1, 每个工作线程有自己的队列，空闲时从全局队列取任务，再从其他线程队列尾部窃取
+	 * 2, 任务按优先级取出，高优先级先执行；affinity 提示任务优先放到某个工作线程
+	 * 3, submitThen 在工作线程执行计算，结果通过 ForwardEvent 投递回 context 所在线程；
+	 *    context 已销毁时丢弃结果
+	 * 4, 任务之间不保证执行顺序，需要有序时由调用方按序号重排
+	 */
+
+	/** {en}
+	* Shared work-stealing thread pool, used to move parsing, image conversion and similar work off the main thread
+	* 1, Each worker owns a queue, when idle it takes from the global queue, then steals from the back of other workers' queues
+	* 2, Tasks are taken by priority, higher first; affinity hints which worker a task should be queued on
+	* 3, submitThen runs the work on a worker and posts the result back to the context's thread with a ForwardEvent;
+	*    the result is dropped if the context has been destroyed
+	* 4, Tasks are not ordered relative to each other, callers that need order reorder by sequence number
+	*/
+	class TaskPool
+	{
+	public:
+		enum Priority {
+			kHigh = 0,
+			kNormal,
+			kLow,
+			kPriorityCount,
+		};
+		static constexpr int kAnyWorker = -1;
+
+		struct Stats {
+			uint64_t executed = 0;
+			uint64_t stolen = 0;
+			// {zh} 工作线程执行任务的累计耗时
+			// {en} Total time workers spent running tasks
+			int64_t busy_us = 0;
+			// {zh} 投递回目标线程的后续处理的累计耗时
+			// {en} Total time spent in continuations on their target threads
+			int64_t continuation_us = 0;
+		};
+
+		static TaskPool& instance();
+
+		void submit(std::function<void(void)>&& task, Priority priority = kNormal, int affinity = kAnyWorker);
+
+		// {zh} 在工作线程执行 work，在 context 所在线程以其返回值调用 then，须在 context 所在线程调用
+		// {en} Run work on a worker and call then with its result on the context's thread, call it on the context's thread
+		template <typename Work, typename Then>
+		void submitThen(QObject* context, Work work, Then then,
+			Priority priority = kNormal, int affinity = kAnyWorker) {
+			QPointer<QObject> guard(context);
+			auto thread = context->thread();
+			submit([guard, thread, work, then]() mutable {
+				auto result = work();
+				post(thread, guard, [then, result]() mutable {
+					then(std::move(result));
+				});
+			}, priority, affinity);
+		}
+
+		// {zh} 把后续处理投递到 context 所在线程执行，context 已销毁时丢弃
+		// {en} Post a continuation to the context's thread, it is dropped if the context has been destroyed
+		static void postTo(QObject* context, std::function<void(void)>&& continuation);
+
+		int workerCount() const;
+		Stats stats() const;
+
+	private:
+		struct Worker {
+			std::mutex mutex;
+			std::deque<std::function<void(void)>> queues[kPriorityCount];
+			std::thread thread;
+		};
+
+		TaskPool();
+		~TaskPool();
+
+		static void post(QThread* thread, const QPointer<QObject>& context,
+			std::function<void(void)>&& continuation);
+		void run(int index);
+		bool take(int index, std::function<void(void)>& task);
+		bool popFront(std::mutex& mutex, std::deque<std::function<void(void)>>& queue,
+			std::function<void(void)>& task);
+		bool steal(int index, int priority, std::function<void(void)>& task);
+
+		std::vector<std::unique_ptr<Worker>> workers_;
+		std::mutex mutex_;
+		std::condition_variable wakeup_;
+		std::deque<std::function<void(void)>> global_[kPriorityCount];
+		std::mutex global_mutex_;
+		// {zh} 已入队未取出的任务数，入队和取出不在同一把锁下，可能短暂为负
+		// {en} Queued but not yet taken tasks, queueing and taking use different locks so it may briefly go negative
+		std::atomic<int64_t> pending_{ 0 };
+		std::atomic<bool> stopping_{ false };
+		std::atomic<uint64_t> executed_{ 0 };
+		std::atomic<uint64_t> stolen_{ 0 };
+		std::atomic<int64_t> busy_us_{ 0 };
+		static std::atomic<int64_t> continuation_us_;
+	};
+}
+
+#endif // VRD_TASKPOOL_H
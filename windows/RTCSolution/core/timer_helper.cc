@@ -12,18 +12,24 @@ namespace vrd
 	{
 		if (object_ != nullptr)
 		{
+			object_->stop();
 			object_->deleteLater();
 			object_ = nullptr;
 		}
 	}
 
-	void TimerHelper::start(int msec, std::function<void(void)>&& callback)
+	void TimerHelper::start(int msec, std::function<void(void)>&& callback, TimerWheel::Precision precision)
 	{
-		object_->start(msec, std::move(callback));
+		object_->start(msec, std::move(callback), precision);
 	}
 
 	void TimerHelper::stop()
 	{
 		object_->stop();
 	}
+
+	bool TimerHelper::isActive() const
+	{
+		return object_->isActive();
+	}
 }
@@ -2,6 +2,7 @@
 #define VRD_TIMERHELPER_H
 
 #include <functional>
+#include "timer_wheel.h"
 
 namespace vrd
 {
@@ -14,8 +15,10 @@ namespace vrd
 		~TimerHelper();
 
 	public:
-		void start(int msec, std::function<void(void)>&& callback);
+		void start(int msec, std::function<void(void)>&& callback,
+			TimerWheel::Precision precision = TimerWheel::kFine);
 		void stop();
+		bool isActive() const;
 
 	private:
 		TimerObject *object_;
@@ -1,23 +1,35 @@
 ﻿#include "timer_object.h"
-#include <QMetaType>
 
 namespace vrd
 {
 	TimerObject::TimerObject()
-		: timer_(this)
 	{
-		connect(&timer_, &QTimer::timeout, this, QOverload<>::of(&TimerObject::onTimeout));
 	}
 
-	void TimerObject::start(int msec, std::function<void(void)> &&callback)
+	TimerObject::~TimerObject()
 	{
+		stop();
+	}
+
+	void TimerObject::start(int msec, std::function<void(void)> &&callback, TimerWheel::Precision precision)
+	{
+		stop();
 		cb_ = callback;
-		timer_.start(msec);
+		id_ = TimerWheel::instance().scheduleRepeating(msec, [this]() { onTimeout(); }, precision);
 	}
 
 	void TimerObject::stop()
 	{
-		timer_.stop();
+		if (id_ != 0)
+		{
+			TimerWheel::instance().cancel(id_);
+			id_ = 0;
+		}
+	}
+
+	bool TimerObject::isActive() const
+	{
+		return id_ != 0 && TimerWheel::instance().isActive(id_);
 	}
 
 	void TimerObject::onTimeout()
@@ -2,7 +2,8 @@
 #define VRD_TIMEOBJECT_H
 
 #include <functional>
-#include <QTimer>
+#include <QObject>
+#include "timer_wheel.h"
 
 namespace vrd
 {
@@ -10,16 +11,18 @@ namespace vrd
 	{
 	public:
 		TimerObject();
+		~TimerObject();
 
 	public:
-		void start(int msec, std::function<void(void)>&& callback);
+		void start(int msec, std::function<void(void)>&& callback,
+			TimerWheel::Precision precision = TimerWheel::kFine);
 		void stop();
+		bool isActive() const;
 
-	private slots:
+	private:
 		void onTimeout();
 
-	private:
-		QTimer timer_;
+		TimerWheel::TimerId id_ = 0;
 		std::function<void(void)> cb_;
 	};
 }
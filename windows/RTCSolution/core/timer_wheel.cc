@@ -0,0 +1,262 @@
+﻿#include "timer_wheel.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace vrd
+{
+TimerWheel& TimerWheel::instance() {
+	static TimerWheel wheel;
+	return wheel;
+}
+
+TimerWheel::TimerWheel() {
+	std::fill(std::begin(buckets_), std::end(buckets_), -1);
+	std::fill(std::begin(level_count_), std::end(level_count_), 0);
+	clock_.start();
+	wakeup_.setSingleShot(true);
+	wakeup_.setTimerType(Qt::PreciseTimer);
+	connect(&wakeup_, &QTimer::timeout, this, [this] {
+		run();
+		rearm();
+	});
+}
+
+TimerWheel::TimerId TimerWheel::schedule(int msec, std::function<void(void)>&& callback, Precision precision) {
+	return add(msec, 0, std::move(callback), precision);
+}
+
+TimerWheel::TimerId TimerWheel::scheduleRepeating(int msec, std::function<void(void)>&& callback, Precision precision) {
+	auto interval = std::max<int64_t>((std::max(msec, 0) + kTickMs - 1) / kTickMs, 1);
+	return add(msec, interval, std::move(callback), precision);
+}
+
+bool TimerWheel::cancel(TimerId id) {
+	auto index = find(id);
+	if (index < 0) {
+		return false;
+	}
+	unlink(index);
+	release(index);
+	if (pending_ == 0) {
+		wakeup_.stop();
+	}
+	return true;
+}
+
+bool TimerWheel::isActive(TimerId id) const {
+	return find(id) >= 0;
+}
+
+size_t TimerWheel::pending() const {
+	return pending_;
+}
+
+TimerWheel::TimerId TimerWheel::add(int msec, int64_t interval, std::function<void(void)>&& callback, Precision precision) {
+	if (pending_ == 0) {
+		current_ = nowTick();
+	}
+	int index = 0;
+	if (!free_.empty()) {
+		index = free_.back();
+		free_.pop_back();
+	}
+	else {
+		index = static_cast<int>(nodes_.size());
+		nodes_.emplace_back();
+	}
+	auto& node = nodes_[index];
+	node.callback = std::move(callback);
+	// {zh} 向上取整到tick边界，保证不会提前触发
+	// {en} Round up to a tick boundary so timers never fire early
+	node.due = (clock_.elapsed() + std::max(msec, 0) + kTickMs - 1) / kTickMs;
+	node.interval = interval;
+	node.precision = precision;
+	node.in_use = true;
+	++pending_;
+	place(index);
+	rearm();
+	return (static_cast<TimerId>(node.generation) << 32) | static_cast<uint32_t>(index + 1);
+}
+
+void TimerWheel::place(int index) {
+	auto& node = nodes_[index];
+	node.expires = node.due;
+	if (node.precision == kCoarse) {
+		node.expires = (node.due + kCoarseTicks - 1) / kCoarseTicks * kCoarseTicks;
+	}
+	auto expires = node.expires;
+	auto delta = expires - current_;
+	if (delta < 0) {
+		link(index, static_cast<int>(current_ & (kSlots - 1)));
+		return;
+	}
+	int level = 0;
+	while (level < kLevels - 1 && delta >= (int64_t(1) << (kSlotBits * (level + 1)))) {
+		++level;
+	}
+	auto max_delta = (int64_t(1) << (kSlotBits * kLevels)) - 1;
+	if (delta > max_delta) {
+		expires = current_ + max_delta;
+	}
+	auto slot = static_cast<int>((expires >> (kSlotBits * level)) & (kSlots - 1));
+	link(index, level * kSlots + slot);
+}
+
+void TimerWheel::link(int index, int bucket) {
+	auto& node = nodes_[index];
+	node.bucket = bucket;
+	node.prev = -1;
+	node.next = buckets_[bucket];
+	if (node.next >= 0) {
+		nodes_[node.next].prev = index;
+	}
+	buckets_[bucket] = index;
+	++level_count_[bucket / kSlots];
+}
+
+void TimerWheel::unlink(int index) {
+	auto& node = nodes_[index];
+	if (node.bucket < 0) {
+		return;
+	}
+	if (node.prev >= 0) {
+		nodes_[node.prev].next = node.next;
+	}
+	else {
+		buckets_[node.bucket] = node.next;
+	}
+	if (node.next >= 0) {
+		nodes_[node.next].prev = node.prev;
+	}
+	--level_count_[node.bucket / kSlots];
+	node.bucket = -1;
+	node.prev = -1;
+	node.next = -1;
+}
+
+void TimerWheel::release(int index) {
+	auto& node = nodes_[index];
+	node.callback = nullptr;
+	node.in_use = false;
+	if (++node.generation == 0) {
+		node.generation = 1;
+	}
+	free_.push_back(index);
+	--pending_;
+}
+
+/** {zh}
+ * 把上一层当前槽位的定时器重新分配到下层，返回该槽位下标；返回0表示该层也转完一圈
+ */
+
+/** {en}
+* Redistribute the current slot of a level into the levels below and return the slot index;
+* 0 means that level has wrapped as well
+*/
+int TimerWheel::cascade(int level) {
+	auto slot = static_cast<int>((current_ >> (kSlotBits * level)) & (kSlots - 1));
+	auto bucket = level * kSlots + slot;
+	auto index = buckets_[bucket];
+	while (index >= 0) {
+		auto next = nodes_[index].next;
+		unlink(index);
+		place(index);
+		index = next;
+	}
+	return slot;
+}
+
+void TimerWheel::fire(int index) {
+	auto& node = nodes_[index];
+	if (node.interval > 0) {
+		// {zh} 先重新挂入时间轮，回调中可以直接取消；错过的周期只补触发一次
+		// {en} Re-link before the callback so it can cancel itself; missed periods fire only once
+		auto callback = node.callback;
+		auto now = nowTick();
+		node.due += node.interval;
+		if (node.due <= now) {
+			node.due = now + node.interval;
+		}
+		place(index);
+		callback();
+		return;
+	}
+	auto callback = std::move(node.callback);
+	release(index);
+	callback();
+}
+
+void TimerWheel::run() {
+	auto now = nowTick();
+	std::vector<std::pair<int, uint32_t>> due;
+	while (current_ <= now && pending_ > 0) {
+		auto slot = static_cast<int>(current_ & (kSlots - 1));
+		if (slot == 0) {
+			for (int level = 1; level < kLevels && cascade(level) == 0; ++level) {
+			}
+		}
+		due.clear();
+		for (auto index = buckets_[slot]; index >= 0;) {
+			auto next = nodes_[index].next;
+			due.emplace_back(index, nodes_[index].generation);
+			unlink(index);
+			index = next;
+		}
+		++current_;
+		for (const auto& item : due) {
+			// {zh} 回调中可能取消了同一槽位的其他定时器
+			// {en} A callback may have cancelled another timer from the same slot
+			if (nodes_[item.first].in_use && nodes_[item.first].generation == item.second) {
+				fire(item.first);
+			}
+		}
+	}
+	if (pending_ == 0) {
+		current_ = now + 1;
+	}
+}
+
+/** {zh}
+ * 按最近的非空槽位设置唤醒时间；上层有定时器时最晚在下一次级联时唤醒
+ */
+
+/** {en}
+* Set the wakeup to the nearest non-empty slot; while upper levels hold timers, wake no later than the next cascade
+*/
+void TimerWheel::rearm() {
+	if (pending_ == 0) {
+		wakeup_.stop();
+		return;
+	}
+	int64_t wake = -1;
+	if (level_count_[0] > 0) {
+		for (int64_t tick = current_; tick < current_ + kSlots; ++tick) {
+			if (buckets_[tick & (kSlots - 1)] >= 0) {
+				wake = tick;
+				break;
+			}
+		}
+	}
+	auto boundary = (current_ | (kSlots - 1)) + 1;
+	if (wake < 0 || (wake > boundary && pending_ > level_count_[0])) {
+		wake = boundary;
+	}
+	auto delay = std::max<int64_t>(wake * kTickMs - clock_.elapsed(), 0);
+	wakeup_.start(static_cast<int>(delay));
+}
+
+int64_t TimerWheel::nowTick() const {
+	return clock_.elapsed() / kTickMs;
+}
+
+int TimerWheel::find(TimerId id) const {
+	auto index = static_cast<int>(id & 0xffffffffu) - 1;
+	auto generation = static_cast<uint32_t>(id >> 32);
+	if (index < 0 || index >= static_cast<int>(nodes_.size())) {
+		return -1;
+	}
+	const auto& node = nodes_[index];
+	return node.in_use && node.generation == generation ? index : -1;
+}
+}
@@ -0,0 +1,91 @@
+﻿#ifndef VRD_TIMERWHEEL_H
+#define VRD_TIMERWHEEL_H
+
+#include <QElapsedTimer>
+#include <QTimer>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace vrd
+{
+	/** {zh}
+	 * 分层时间轮定时服务，所有定时器共用一个唤醒定时器
+	 * 1, 4层、每层64个槽位，精度10ms，插入和取消均为O(1)
+	 * 2, kCoarse 精度的定时器到期时间向上取整到160ms，便于合并唤醒
+	 * 3, 只能在主线程使用，回调在主线程执行
+	 */
+
+	/** {en}
+	* Hierarchical timing-wheel service, all timers share one wakeup timer
+	* 1, 4 levels of 64 slots with a 10ms tick, insert and cancel are O(1)
+	* 2, kCoarse timers have their expiry rounded up to 160ms so wakeups coalesce
+	* 3, Main thread only, callbacks run on the main thread
+	*/
+	class TimerWheel : public QObject
+	{
+	public:
+		enum Precision {
+			kFine = 0,
+			kCoarse,
+		};
+		using TimerId = uint64_t;
+
+		static TimerWheel& instance();
+
+		TimerId schedule(int msec, std::function<void(void)>&& callback, Precision precision = kFine);
+		TimerId scheduleRepeating(int msec, std::function<void(void)>&& callback, Precision precision = kFine);
+		bool cancel(TimerId id);
+		bool isActive(TimerId id) const;
+		size_t pending() const;
+
+	private:
+		static constexpr int kTickMs = 10;
+		static constexpr int kCoarseTicks = 16;
+		static constexpr int kSlotBits = 6;
+		static constexpr int kSlots = 1 << kSlotBits;
+		static constexpr int kLevels = 4;
+
+		struct Node {
+			std::function<void(void)> callback;
+			// {zh} 名义到期tick，重复定时器据此累加，避免漂移
+			// {en} Nominal due tick, repeating timers accumulate from it so they do not drift
+			int64_t due = 0;
+			int64_t expires = 0;
+			int64_t interval = 0;
+			uint32_t generation = 1;
+			int prev = -1;
+			int next = -1;
+			int bucket = -1;
+			Precision precision = kFine;
+			bool in_use = false;
+		};
+
+		TimerWheel();
+		~TimerWheel() = default;
+
+		TimerId add(int msec, int64_t interval, std::function<void(void)>&& callback, Precision precision);
+		void place(int index);
+		void link(int index, int bucket);
+		void unlink(int index);
+		void release(int index);
+		int cascade(int level);
+		void fire(int index);
+		void run();
+		void rearm();
+		int64_t nowTick() const;
+		int find(TimerId id) const;
+
+		QElapsedTimer clock_;
+		QTimer wakeup_;
+		int64_t current_ = 0;
+		std::vector<Node> nodes_;
+		std::vector<int> free_;
+		int buckets_[kLevels * kSlots];
+		size_t level_count_[kLevels];
+		size_t pending_ = 0;
+	};
+}
+
+#endif // VRD_TIMERWHEEL_H
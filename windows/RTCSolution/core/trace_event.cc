@@ -0,0 +1,165 @@
+﻿#include "trace_event.h"
+#include "json_stream.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+#include <QDebug>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace vrd
+{
+	std::atomic<bool> Tracer::enabled_{ false };
+	constexpr size_t Tracer::kBufferEvents;
+	constexpr size_t Tracer::kDetailSize;
+
+	Tracer& Tracer::instance() {
+		static Tracer tracer;
+		return tracer;
+	}
+
+	int64_t Tracer::now() {
+		return std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	void Tracer::setThreadName(const char* name) {
+		instance().buffer()->thread_name = name;
+	}
+
+	void Tracer::start() {
+		++session_;
+		enabled_ = true;
+		qInfo() << "trace started";
+	}
+
+	QString Tracer::stop() {
+		if (!enabled_) {
+			return QString();
+		}
+		enabled_ = false;
+		auto paths = QStandardPaths::standardLocations(QStandardPaths::StandardLocation::AppDataLocation);
+		auto dir = paths.empty() ? QString("vertc_log/") : paths[0] + "/vertc_log/";
+		QDir().mkpath(dir);
+		auto path = dir + QDateTime::currentDateTime().toString("yyyy-MM-dd_hh-mm-ss") + "_trace.json";
+		if (!writeJson(path)) {
+			qWarning() << "failed to write trace:" << path;
+			return QString();
+		}
+		qInfo() << "trace written:" << path;
+		return path;
+	}
+
+	Tracer::ThreadBuffer* Tracer::buffer() {
+		thread_local ThreadBuffer* local = nullptr;
+		if (local == nullptr) {
+			// {zh} 缓冲区在线程退出后仍保留，导出时还能读到其中的事件
+			// {en} Buffers outlive their threads so their events can still be exported
+			local = new ThreadBuffer();
+			std::lock_guard<std::mutex> lock(mutex_);
+			local->tid = static_cast<int>(buffers_.size()) + 1;
+			buffers_.push_back(local);
+		}
+		return local;
+	}
+
+	void Tracer::complete(const char* category, const char* name, int64_t start_us, int64_t duration_us,
+		const char* detail, size_t detail_size) {
+		record('X', category, name, start_us, duration_us, detail, detail_size);
+	}
+
+	void Tracer::instant(const char* category, const char* name, const char* detail, size_t detail_size) {
+		record('i', category, name, now(), 0, detail, detail_size);
+	}
+
+	void Tracer::record(char phase, const char* category, const char* name, int64_t ts_us, int64_t dur_us,
+		const char* detail, size_t detail_size) {
+		if (!enabled()) {
+			return;
+		}
+		auto local = buffer();
+		auto session = session_.load(std::memory_order_acquire);
+		if (local->session.load(std::memory_order_relaxed) != session) {
+			// {zh} 事件数组在首次记录时才分配，只命名过的线程不占内存
+			// {en} The event array is allocated on first record, threads that were only named cost nothing
+			if (local->events.empty()) {
+				local->events.resize(kBufferEvents);
+			}
+			local->count.store(0, std::memory_order_relaxed);
+			local->session.store(session, std::memory_order_release);
+		}
+		auto index = local->count.load(std::memory_order_relaxed);
+		if (index >= local->events.size()) {
+			return;
+		}
+		auto& event = local->events[index];
+		event.category = category;
+		event.name = name;
+		event.ts_us = ts_us;
+		event.dur_us = dur_us;
+		event.phase = phase;
+		auto size = std::min(detail_size, kDetailSize - 1);
+		if (detail != nullptr && size > 0) {
+			memcpy(event.detail, detail, size);
+		}
+		event.detail[detail != nullptr ? size : 0] = '\0';
+		local->count.store(index + 1, std::memory_order_release);
+	}
+
+	bool Tracer::writeJson(const QString& path) {
+		std::vector<ThreadBuffer*> buffers;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			buffers = buffers_;
+		}
+		auto session = session_.load(std::memory_order_acquire);
+		std::string out;
+		JsonWriter writer(out);
+		writer.beginObject().key("traceEvents").beginArray();
+		for (auto local : buffers) {
+			if (local->session.load(std::memory_order_acquire) != session) {
+				continue;
+			}
+			auto threadName = local->thread_name.load();
+			if (threadName != nullptr) {
+				writer.beginObject()
+					.key("ph").value("M").key("name").value("thread_name")
+					.key("pid").value(1).key("tid").value(local->tid)
+					.key("args").beginObject().key("name").value(threadName).endObject()
+					.endObject();
+			}
+			auto count = std::min(local->count.load(std::memory_order_acquire), kBufferEvents);
+			for (size_t i = 0; i < count; ++i) {
+				const auto& event = local->events[i];
+				char phase[2] = { event.phase, '\0' };
+				writer.beginObject()
+					.key("name").value(event.name)
+					.key("cat").value(event.category)
+					.key("ph").value(phase)
+					.key("ts").value(event.ts_us)
+					.key("pid").value(1)
+					.key("tid").value(local->tid);
+				if (event.phase == 'X') {
+					writer.key("dur").value(event.dur_us);
+				}
+				else {
+					writer.key("s").value("t");
+				}
+				if (event.detail[0] != '\0') {
+					writer.key("args").beginObject().key("detail").value(event.detail).endObject();
+				}
+				writer.endObject();
+			}
+		}
+		writer.endArray().endObject();
+
+		QFile file(path);
+		if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+			return false;
+		}
+		return file.write(out.data(), static_cast<qint64>(out.size())) == static_cast<qint64>(out.size());
+	}
+}
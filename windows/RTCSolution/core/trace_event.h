@@ -0,0 +1,132 @@
+﻿#ifndef VRD_TRACEEVENT_H
+#define VRD_TRACEEVENT_H
+
+#include <QString>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace vrd
+{
+	/** {zh}
+	 * 轻量的跨线程耗时追踪，输出 Chrome trace_event JSON，可用 chrome://tracing 或 Perfetto 打开
+	 * 1, 每个线程写自己的缓冲区，写入无锁，缓冲区写满后丢弃后续事件
+	 * 2, 关闭时每个埋点只有一次原子读取
+	 * 3, name 和 category 必须是静态字符串，动态内容放在 detail 中，超长会被截断
+	 * 4, 配置项 perf/trace 为1时启动即开始追踪，也可在运行时调用 start/stop 切换
+	 */
+
+	/** {en}
+	* Lightweight cross-thread span tracing that writes Chrome trace_event JSON, viewable in chrome://tracing or Perfetto
+	* 1, Each thread writes its own buffer without locks, events past a full buffer are dropped
+	* 2, When disabled every trace point costs a single atomic load
+	* 3, name and category must be static strings, dynamic content goes into detail and is truncated if too long
+	* 4, Tracing starts at launch when the perf/trace setting is 1, and can be toggled at runtime with start/stop
+	*/
+	class Tracer
+	{
+	public:
+		static Tracer& instance();
+
+		static bool enabled() {
+			return enabled_.load(std::memory_order_relaxed);
+		}
+		static int64_t now();
+		// {zh} 为当前线程命名，在追踪视图中显示
+		// {en} Name the calling thread in the trace view
+		static void setThreadName(const char* name);
+
+		void start();
+		// {zh} 停止追踪并写入日志目录，返回文件路径，失败时为空
+		// {en} Stop tracing and write the trace into the log directory, returns the file path or empty on failure
+		QString stop();
+		bool writeJson(const QString& path);
+
+		void complete(const char* category, const char* name, int64_t start_us, int64_t duration_us,
+			const char* detail = nullptr, size_t detail_size = 0);
+		void instant(const char* category, const char* name, const char* detail = nullptr, size_t detail_size = 0);
+
+	private:
+		static constexpr size_t kBufferEvents = 1 << 15;
+		static constexpr size_t kDetailSize = 48;
+
+		struct Event {
+			const char* category;
+			const char* name;
+			int64_t ts_us;
+			int64_t dur_us;
+			char phase;
+			char detail[kDetailSize];
+		};
+
+		struct ThreadBuffer {
+			std::vector<Event> events;
+			// {zh} 已发布的事件数，由写入线程递增，导出时读取
+			// {en} Published event count, advanced by the writing thread and read by the exporter
+			std::atomic<size_t> count{ 0 };
+			std::atomic<uint32_t> session{ 0 };
+			std::atomic<const char*> thread_name{ nullptr };
+			int tid = 0;
+		};
+
+		Tracer() = default;
+
+		ThreadBuffer* buffer();
+		void record(char phase, const char* category, const char* name, int64_t ts_us, int64_t dur_us,
+			const char* detail, size_t detail_size);
+
+		static std::atomic<bool> enabled_;
+		std::atomic<uint32_t> session_{ 0 };
+		std::mutex mutex_;
+		std::vector<ThreadBuffer*> buffers_;
+	};
+
+	/** {zh}
+	 * 作用域耗时，析构时记录一个完整事件
+	 */
+
+	/** {en}
+	* Scoped span, records a complete event when destroyed
+	*/
+	class TraceScope
+	{
+	public:
+		TraceScope(const char* category, const char* name)
+			: category_(category), name_(name), start_us_(Tracer::enabled() ? Tracer::now() : -1) {
+		}
+		// {zh} 只在追踪开启时复制 detail，可以传入临时对象
+		// {en} detail is only copied while tracing, temporaries may be passed
+		TraceScope(const char* category, const char* name, const std::string& detail)
+			: category_(category), name_(name), start_us_(Tracer::enabled() ? Tracer::now() : -1) {
+			if (start_us_ >= 0) {
+				detail_ = detail;
+			}
+		}
+		~TraceScope() {
+			if (start_us_ >= 0) {
+				Tracer::instance().complete(category_, name_, start_us_, Tracer::now() - start_us_,
+					detail_.data(), detail_.size());
+			}
+		}
+
+	private:
+		const char* category_;
+		const char* name_;
+		int64_t start_us_;
+		std::string detail_;
+	};
+}
+
+#define VRD_TRACE_CONCAT_INNER(a, b) a##b
+#define VRD_TRACE_CONCAT(a, b) VRD_TRACE_CONCAT_INNER(a, b)
+#define VRD_TRACE_SCOPE(category, name) \
+	vrd::TraceScope VRD_TRACE_CONCAT(vrd_trace_scope_, __LINE__)(category, name)
+#define VRD_TRACE_SCOPE_DETAIL(category, name, detail) \
+	vrd::TraceScope VRD_TRACE_CONCAT(vrd_trace_scope_, __LINE__)(category, name, detail)
+#define VRD_TRACE_INSTANT(category, name) \
+	do { if (vrd::Tracer::enabled()) vrd::Tracer::instance().instant(category, name); } while (0)
+
+#endif // VRD_TRACEEVENT_H
@@ -4,6 +4,7 @@
 static const vrd::ErrorInfo errorInfos[] = 
 {
 	{ 406, QObject::tr("network_messsage_406").toUtf8().data(), true },
+	{ 408, QObject::tr("network_messsage_408").toUtf8().data(), true },
 	{ 422, QObject::tr("network_messsage_422").toUtf8().data(), true },
 	{ 430, QObject::tr("network_messsage_430").toUtf8().data(), true },
 	{ 440, QObject::tr("network_messsage_440").toUtf8().data(), true },
@@ -1,5 +1,5 @@
 #include "login_widget.h"
-#include "core/configer.h"
+#include "core/Configer.h"
 #include "core/application.h"
 #include "core/session_base.h"
 #include "core/util_uuid.h"
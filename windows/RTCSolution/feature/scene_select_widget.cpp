@@ -1,9 +1,10 @@
 #include "scene_select_widget.h"
-#include "core/configer.h"
+#include "core/Configer.h"
 #include "feature/data_mgr.h"
 #include "core/application.h"
 #include "core/navigator_interface.h"
 #include "core/session_base.h"
+#include "core/control_server.h"
 #include "input_dlg.h"
 #include "core/util_tip.h"
 #include "core/component/image_button.h"
@@ -49,6 +50,7 @@ SceneSelectWidget::SceneSelectWidget(QWidget* parent) : QWidget(parent) {
 	ui.setupUi(this);
 	initControls();
 	initConnects();
+	initControlCommands();
 }
 
 SceneSelectWidget::~SceneSelectWidget() {
@@ -115,6 +117,33 @@ void SceneSelectWidget::initConnects() {
         [=] { emit sigLogOut();
         });
 }
+
+/** {zh}
+ * 自动化控制命令 open_scene {"scene":"videocall"}，与点击场景按钮相同；仅在场景选择页显示时可用
+ */
+
+/** {en}
+* Automation command open_scene {"scene":"videocall"}, same as clicking the scene button;
+* only available while the scene selection page is shown
+*/
+void SceneSelectWidget::initControlCommands() {
+    vrd::ControlServer::instance().addCommand("open_scene",
+        [=](const QJsonObject& args, const vrd::ControlServer::Reply& reply) {
+            auto scene = args["scene"].toString();
+            if (!scene_names_.contains(scene)) {
+                reply(vrd::ControlServer::kErrorBadRequest, QJsonObject());
+                return;
+            }
+            if (!isVisible()) {
+                reply(vrd::ControlServer::kErrorUnavailable, QJsonObject());
+                return;
+            }
+            hide();
+            VRD_FUNC_GET_COMPONET(vrd::INavigator)->go(scene.toStdString());
+            emit enterScene(scene);
+            reply(0, QJsonObject());
+        });
+}
 void SceneSelectWidget::setupMeetingSceneButton() {
     auto meetingBtn = new ImageButton(this);
     ui.sceneSelectLayout->addWidget(meetingBtn, scene_count_ / 4, 
@@ -132,6 +161,7 @@ void SceneSelectWidget::setupMeetingSceneButton() {
     meetingBtn->setFixedSize(QSize(220,220));
 	meetingBtn->text()->setAlignment(Qt::AlignHCenter | Qt::AlignVCenter);
 	meetingBtn->setText(QObject::tr("meeting"));
+	scene_names_ << "meeting";
 	connect(meetingBtn, &ImageButton::sigPressed, this, [=] {
 		hide();
 		VRD_FUNC_GET_COMPONET(vrd::INavigator)->go("meeting");
@@ -156,6 +186,7 @@ void SceneSelectWidget::setupEduSceneButton() {
 	eduBtn->text()->setAlignment(Qt::AlignHCenter |
 		Qt::AlignVCenter);
 	eduBtn->setText(QObject::tr("online_edu"));
+	scene_names_ << "edu";
     eduBtn->setFixedSize(QSize(220,220));
     connect(eduBtn, &ImageButton::sigPressed, this,
         [=] {
@@ -199,6 +230,7 @@ void SceneSelectWidget::setupVideoCallSceneButton() {
     videoCallBtn->text()->setAlignment(Qt::AlignHCenter |
         Qt::AlignVCenter);
     videoCallBtn->setText(QObject::tr("audio_video_calls"));
+    scene_names_ << "videocall";
     videoCallBtn->setFixedSize(QSize(220, 220));
     connect(videoCallBtn, &ImageButton::sigPressed, this,
         [=] {
@@ -30,7 +30,11 @@ class SceneSelectWidget : public QWidget {
 	void setupEduSceneButton();
 	void setupMoreSceneButton();
 	void setupVideoCallSceneButton();
+	void initControlCommands();
 	int scene_count_{ 0 };
+	// {zh} 已添加按钮的场景，供自动化控制的 open_scene 校验
+	// {en} Scenes that have a button, checked by the open_scene automation command
+	QStringList scene_names_;
 
  private:
 	bool enabled_controls_;
@@ -1,5 +1,5 @@
 #pragma once
-#include <QHboxLayout>
+#include <QHBoxLayout>
 #include <QLabel>
 #include <QWidget>
 
@@ -2,8 +2,14 @@
 #include <QApplication>
 #include <QTranslator>
 #include "core/application.h"
+#include "core/control_server.h"
+#include "core/monitored_application.h"
 #include "core/module_navigator.h"
+#include "core/rtc_callback_recorder.h"
 #include "core/session_base.h"
+#include "core/stall_watchdog.h"
+#include "core/trace_event.h"
+#include "core/Configer.h"
 #include "logger.h"
 
 #include "login_widget.h"
@@ -13,7 +19,7 @@ void regComponents();
 int main(int argc, char* argv[]) {
     QApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
     QApplication::setAttribute(Qt::AA_UseHighDpiPixmaps);
-    QApplication a(argc, argv);
+    vrd::MonitoredApplication a(argc, argv);
 
     QTranslator translator;
     if (translator.load(QLocale(), "common", "_", ":/translations")) {
@@ -24,13 +30,31 @@ int main(int argc, char* argv[]) {
 
     QApplication::setQuitOnLastWindowClosed(false);
     regComponents();
+    // {zh} 需在引擎创建前开启，登录态恢复时可能马上创建引擎
+    // {en} Must start before the engine is created, restoring a saved login may create it right away
+    if (Configer::instance().getData("perf/callback_record") == "1") {
+        vrd::RtcCallbackRecorder::instance().start();
+    }
 
     LoginWidget w;
     w.checkSaveData();
  
     qInstallMessageHandler(Common::log::outputMessage);
     qInfo("-----------app start");
+    vrd::StallWatchdog::instance().start();
+    vrd::Tracer::setThreadName("main");
+    if (Configer::instance().getData("perf/trace") == "1") {
+        vrd::Tracer::instance().start();
+    }
+    auto control_socket = vrd::ControlServer::configuredName(a.arguments());
+    if (!control_socket.isEmpty()) {
+        vrd::ControlServer::instance().start(control_socket);
+    }
     int nRet = a.exec();
+    vrd::ControlServer::instance().stop();
+    vrd::RtcCallbackRecorder::instance().stop();
+    vrd::Tracer::instance().stop();
+    vrd::StallWatchdog::instance().stop();
     qInfo("-----------app quit");
     qInstallMessageHandler(nullptr);
     return nRet;
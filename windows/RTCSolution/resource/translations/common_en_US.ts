@@ -226,6 +226,10 @@
 		<source>network_messsage_419</source>
 		<translation>User has left</translation>
 	</message>
+	<message>
+		<source>network_messsage_408</source>
+		<translation>Request timed out. Please try again</translation>
+	</message>
 	<message>
 		<source>network_messsage_406</source>
 		<translation>Number of users exceeded the limit</translation>
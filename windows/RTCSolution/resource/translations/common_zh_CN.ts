@@ -226,6 +226,10 @@
 		<source>network_messsage_419</source>
 		<translation>用户已离开房间</translation>
 	</message>
+	<message>
+		<source>network_messsage_408</source>
+		<translation>请求超时，请重试</translation>
+	</message>
 	<message>
 		<source>network_messsage_406</source>
 		<translation>房间人数超过限制</translation>
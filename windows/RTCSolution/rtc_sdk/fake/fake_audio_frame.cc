@@ -0,0 +1,72 @@
+﻿#include "fake_audio_frame.h"
+#include <cmath>
+
+namespace vrd
+{
+namespace fake
+{
+	FakeAudioFrame* FakeAudioFrame::build(const bytertc::AudioFrameBuilder& builder) {
+		return new FakeAudioFrame(builder);
+	}
+
+	void FakeAudioFrame::synthesize(int16_t* samples, size_t count, int sample_rate, uint64_t first_sample,
+		bool speaking, uint32_t seed) {
+		const double kPi = 3.14159265358979323846;
+		auto frequency = 180.0 + (seed % 8) * 20.0;
+		auto noise = seed * 2654435761u + static_cast<uint32_t>(first_sample);
+		for (size_t i = 0; i < count; ++i) {
+			auto t = static_cast<double>(first_sample + i) / sample_rate;
+			noise = noise * 1664525u + 1013904223u;
+			auto hiss = static_cast<int>(noise >> 27) - 16;
+			double value = hiss;
+			if (speaking) {
+				// {zh} 约4Hz的包络，接近音节节奏
+				// {en} An envelope around 4 Hz, close to the syllable rate
+				auto envelope = 0.6 + 0.4 * std::sin(2 * kPi * 4.0 * t);
+				value += 8000.0 * envelope * std::sin(2 * kPi * frequency * t);
+			}
+			samples[i] = static_cast<int16_t>(value);
+		}
+	}
+
+	FakeAudioFrame::FakeAudioFrame(const bytertc::AudioFrameBuilder& builder)
+		: builder_(builder) {
+		if (builder.deep_copy && builder.data && builder.data_size > 0) {
+			storage_.assign(builder.data, builder.data + builder.data_size);
+			builder_.data = storage_.data();
+		}
+	}
+
+	int64_t FakeAudioFrame::timestampUs() const {
+		return builder_.timestamp_us;
+	}
+
+	bytertc::AudioSampleRate FakeAudioFrame::sampleRate() const {
+		return builder_.sample_rate;
+	}
+
+	bytertc::AudioChannel FakeAudioFrame::channel() const {
+		return builder_.channel;
+	}
+
+	uint8_t* FakeAudioFrame::data() const {
+		return builder_.data;
+	}
+
+	int FakeAudioFrame::dataSize() const {
+		return static_cast<int>(builder_.data_size);
+	}
+
+	bytertc::AudioFrameType FakeAudioFrame::frameType() const {
+		return bytertc::kFrameTypePCM16;
+	}
+
+	void FakeAudioFrame::release() {
+		delete this;
+	}
+
+	bool FakeAudioFrame::isMutedData() const {
+		return false;
+	}
+}
+}
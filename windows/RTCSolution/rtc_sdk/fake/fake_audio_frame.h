@@ -0,0 +1,48 @@
+﻿#ifndef VRD_FAKE_AUDIO_FRAME_H
+#define VRD_FAKE_AUDIO_FRAME_H
+
+#include "rtc/bytertc_audio_frame.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vrd
+{
+namespace fake
+{
+	/** {zh}
+	 * 内存PCM16音频帧，deep_copy 时复制数据，否则引用构造者的缓冲
+	 */
+
+	/** {en}
+	* In-memory PCM16 audio frame, copying the data when deep_copy is set and referencing the builder's buffer otherwise
+	*/
+	class FakeAudioFrame final : public bytertc::IAudioFrame {
+	public:
+		static FakeAudioFrame* build(const bytertc::AudioFrameBuilder& builder);
+		// {zh} 生成单声道PCM：说话时为带起伏的低频音，否则为很低的噪声；first_sample 保证相位连续，seed 区分用户
+		// {en} Generates mono PCM: a low tone with a varying envelope while speaking, faint noise otherwise;
+		// {en} first_sample keeps the phase continuous and seed tells users apart
+		static void synthesize(int16_t* samples, size_t count, int sample_rate, uint64_t first_sample,
+			bool speaking, uint32_t seed);
+
+		int64_t timestampUs() const override;
+		bytertc::AudioSampleRate sampleRate() const override;
+		bytertc::AudioChannel channel() const override;
+		uint8_t* data() const override;
+		int dataSize() const override;
+		bytertc::AudioFrameType frameType() const override;
+		void release() override;
+		bool isMutedData() const override;
+
+	private:
+		explicit FakeAudioFrame(const bytertc::AudioFrameBuilder& builder);
+		~FakeAudioFrame() override = default;
+
+		bytertc::AudioFrameBuilder builder_;
+		std::vector<uint8_t> storage_;
+	};
+}
+}
+
+#endif // VRD_FAKE_AUDIO_FRAME_H
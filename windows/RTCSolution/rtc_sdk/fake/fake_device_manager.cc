@@ -0,0 +1,258 @@
+﻿#include "fake_device_manager.h"
+#include <algorithm>
+#include <cstring>
+
+namespace vrd
+{
+namespace fake
+{
+	namespace {
+	void copyDeviceString(char* dst, const std::string& src) {
+		auto size = std::min(src.size(), static_cast<size_t>(bytertc::MAX_DEVICE_ID_LENGTH - 1));
+		memcpy(dst, src.data(), size);
+		dst[size] = '\0';
+	}
+
+	int findDevice(const std::vector<FakeDevice>& devices, const char* device_id) {
+		for (size_t i = 0; i < devices.size(); ++i) {
+			if (device_id && devices[i].id == device_id) {
+				return static_cast<int>(i);
+			}
+		}
+		return -1;
+	}
+	}  // namespace
+
+	FakeAudioDeviceCollection::FakeAudioDeviceCollection(const std::vector<FakeDevice>& devices)
+		: devices_(devices) {
+	}
+
+	int FakeAudioDeviceCollection::getCount() {
+		return static_cast<int>(devices_.size());
+	}
+
+	int FakeAudioDeviceCollection::getDevice(int index, char device_name[bytertc::MAX_DEVICE_ID_LENGTH],
+		char device_id[bytertc::MAX_DEVICE_ID_LENGTH]) {
+		if (index < 0 || index >= getCount()) {
+			return -1;
+		}
+		copyDeviceString(device_name, devices_[index].name);
+		copyDeviceString(device_id, devices_[index].id);
+		return 0;
+	}
+
+	int FakeAudioDeviceCollection::getDevice(int index, bytertc::AudioDeviceInfo* audio_device_info) {
+		if (index < 0 || index >= getCount() || !audio_device_info) {
+			return -1;
+		}
+		copyDeviceString(audio_device_info->device_name, devices_[index].name);
+		copyDeviceString(audio_device_info->device_id, devices_[index].id);
+		audio_device_info->is_system_default = index == 0;
+		return 0;
+	}
+
+	void FakeAudioDeviceCollection::release() {
+		delete this;
+	}
+
+	FakeVideoDeviceCollection::FakeVideoDeviceCollection(const std::vector<FakeDevice>& devices)
+		: devices_(devices) {
+	}
+
+	int FakeVideoDeviceCollection::getCount() {
+		return static_cast<int>(devices_.size());
+	}
+
+	int FakeVideoDeviceCollection::getDevice(int index, char device_name[bytertc::MAX_DEVICE_ID_LENGTH],
+		char device_id[bytertc::MAX_DEVICE_ID_LENGTH]) {
+		if (index < 0 || index >= getCount()) {
+			return -1;
+		}
+		copyDeviceString(device_name, devices_[index].name);
+		copyDeviceString(device_id, devices_[index].id);
+		return 0;
+	}
+
+	int FakeVideoDeviceCollection::getDevice(int index, bytertc::VideoDeviceInfo* video_device_info) {
+		if (index < 0 || index >= getCount() || !video_device_info) {
+			return -1;
+		}
+		copyDeviceString(video_device_info->device_name, devices_[index].name);
+		copyDeviceString(video_device_info->device_id, devices_[index].id);
+		return 0;
+	}
+
+	void FakeVideoDeviceCollection::release() {
+		delete this;
+	}
+
+	FakeAudioDeviceManager::FakeAudioDeviceManager(Scheduler& scheduler, bytertc::IRTCVideoEventHandler* handler)
+		: scheduler_(scheduler)
+		, handler_(handler)
+		, capture_devices_{ {"fake_microphone_0", "Fake Microphone"} }
+		, playback_devices_{ {"fake_speaker_0", "Fake Speaker"} }
+		, capture_device_id_(capture_devices_.front().id)
+		, playback_device_id_(playback_devices_.front().id) {
+	}
+
+	FakeAudioDeviceManager::~FakeAudioDeviceManager() {
+		scheduler_.cancel(this);
+	}
+
+	bytertc::IAudioDeviceCollection* FakeAudioDeviceManager::enumerateAudioPlaybackDevices() {
+		return new FakeAudioDeviceCollection(playback_devices_);
+	}
+
+	bytertc::IAudioDeviceCollection* FakeAudioDeviceManager::enumerateAudioCaptureDevices() {
+		return new FakeAudioDeviceCollection(capture_devices_);
+	}
+
+	void FakeAudioDeviceManager::followSystemPlaybackDevice(bool followed) {
+		if (followed) {
+			playback_device_id_ = playback_devices_.front().id;
+		}
+	}
+
+	void FakeAudioDeviceManager::followSystemCaptureDevice(bool followed) {
+		if (followed) {
+			capture_device_id_ = capture_devices_.front().id;
+		}
+	}
+
+	int FakeAudioDeviceManager::setAudioPlaybackDevice(const char device_id[bytertc::MAX_DEVICE_ID_LENGTH]) {
+		if (findDevice(playback_devices_, device_id) < 0) {
+			return -1;
+		}
+		playback_device_id_ = device_id;
+		return 0;
+	}
+
+	int FakeAudioDeviceManager::setAudioCaptureDevice(const char device_id[bytertc::MAX_DEVICE_ID_LENGTH]) {
+		if (findDevice(capture_devices_, device_id) < 0) {
+			return -1;
+		}
+		capture_device_id_ = device_id;
+		return 0;
+	}
+
+	int FakeAudioDeviceManager::setAudioPlaybackDeviceVolume(unsigned int volume) {
+		playback_volume_ = volume;
+		return 0;
+	}
+
+	int FakeAudioDeviceManager::getAudioPlaybackDeviceVolume(unsigned int* volume) {
+		*volume = playback_volume_;
+		return 0;
+	}
+
+	int FakeAudioDeviceManager::setAudioCaptureDeviceVolume(unsigned int volume) {
+		capture_volume_ = volume;
+		return 0;
+	}
+
+	int FakeAudioDeviceManager::getAudioCaptureDeviceVolume(unsigned int* volume) {
+		*volume = capture_volume_;
+		return 0;
+	}
+
+	int FakeAudioDeviceManager::setAudioPlaybackDeviceMute(bool mute) {
+		playback_mute_ = mute;
+		return 0;
+	}
+
+	int FakeAudioDeviceManager::getAudioPlaybackDeviceMute(bool* mute) {
+		*mute = playback_mute_;
+		return 0;
+	}
+
+	int FakeAudioDeviceManager::setAudioCaptureDeviceMute(bool mute) {
+		capture_mute_ = mute;
+		return 0;
+	}
+
+	int FakeAudioDeviceManager::getAudioCaptureDeviceMute(bool* mute) {
+		*mute = capture_mute_;
+		return 0;
+	}
+
+	int FakeAudioDeviceManager::getAudioPlaybackDevice(char device_id[bytertc::MAX_DEVICE_ID_LENGTH]) {
+		copyDeviceString(device_id, playback_device_id_);
+		return 0;
+	}
+
+	int FakeAudioDeviceManager::getAudioCaptureDevice(char device_id[bytertc::MAX_DEVICE_ID_LENGTH]) {
+		copyDeviceString(device_id, capture_device_id_);
+		return 0;
+	}
+
+	int FakeAudioDeviceManager::initAudioPlaybackDeviceForTest(const char deviceId[bytertc::MAX_DEVICE_ID_LENGTH]) {
+		return findDevice(playback_devices_, deviceId) < 0 ? -1 : 0;
+	}
+
+	int FakeAudioDeviceManager::initAudioCaptureDeviceForTest(const char deviceId[bytertc::MAX_DEVICE_ID_LENGTH]) {
+		return findDevice(capture_devices_, deviceId) < 0 ? -1 : 0;
+	}
+
+	int FakeAudioDeviceManager::startAudioPlaybackDeviceTest(const char* test_audio_file_path, int indication_interval) {
+		return startTestVolume(indication_interval);
+	}
+
+	int FakeAudioDeviceManager::stopAudioPlaybackDeviceTest() {
+		return stopTestVolume();
+	}
+
+	int FakeAudioDeviceManager::startAudioDeviceRecordTest(int indication_interval) {
+		return startTestVolume(indication_interval);
+	}
+
+	int FakeAudioDeviceManager::stopAudioDeviceRecordAndPlayTest() {
+		return stopTestVolume();
+	}
+
+	int FakeAudioDeviceManager::stopAudioDevicePlayTest() {
+		return stopTestVolume();
+	}
+
+	int FakeAudioDeviceManager::enableFilterSilentDevice(bool enable) {
+		return 0;
+	}
+
+	int FakeAudioDeviceManager::startTestVolume(int indication_interval) {
+		scheduler_.cancel(this);
+		scheduler_.postRepeating(this, indication_interval, [this]() {
+			// {zh} 锯齿形音量，便于界面观察
+			// {en} Saw-tooth volume, easy to spot in the UI
+			test_tick_ = (test_tick_ + 1) % 16;
+			handler_->onAudioPlaybackDeviceTestVolume(test_tick_ * 16);
+		});
+		return 0;
+	}
+
+	int FakeAudioDeviceManager::stopTestVolume() {
+		scheduler_.cancel(this);
+		return 0;
+	}
+
+	FakeVideoDeviceManager::FakeVideoDeviceManager()
+		: capture_devices_{ {"fake_camera_0", "Fake Camera"} }
+		, capture_device_id_(capture_devices_.front().id) {
+	}
+
+	bytertc::IVideoDeviceCollection* FakeVideoDeviceManager::enumerateVideoCaptureDevices() {
+		return new FakeVideoDeviceCollection(capture_devices_);
+	}
+
+	int FakeVideoDeviceManager::setVideoCaptureDevice(const char device_id[bytertc::MAX_DEVICE_ID_LENGTH]) {
+		if (findDevice(capture_devices_, device_id) < 0) {
+			return -1;
+		}
+		capture_device_id_ = device_id;
+		return 0;
+	}
+
+	int FakeVideoDeviceManager::getVideoCaptureDevice(char device_id[bytertc::MAX_DEVICE_ID_LENGTH]) {
+		copyDeviceString(device_id, capture_device_id_);
+		return 0;
+	}
+}
+}
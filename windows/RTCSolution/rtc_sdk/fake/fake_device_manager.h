@@ -0,0 +1,117 @@
+﻿#ifndef VRD_FAKE_DEVICE_MANAGER_H
+#define VRD_FAKE_DEVICE_MANAGER_H
+
+#include "bytertc_video_event_handler.h"
+#include "rtc/bytertc_audio_device_manager.h"
+#include "rtc/bytertc_video_device_manager.h"
+#include "fake_scheduler.h"
+#include <string>
+#include <vector>
+
+namespace vrd
+{
+namespace fake
+{
+	struct FakeDevice {
+		std::string id;
+		std::string name;
+	};
+
+	class FakeAudioDeviceCollection : public bytertc::IAudioDeviceCollection {
+	public:
+		explicit FakeAudioDeviceCollection(const std::vector<FakeDevice>& devices);
+
+		int getCount() override;
+		int getDevice(int index, char device_name[bytertc::MAX_DEVICE_ID_LENGTH],
+			char device_id[bytertc::MAX_DEVICE_ID_LENGTH]) override;
+		int getDevice(int index, bytertc::AudioDeviceInfo* audio_device_info) override;
+		void release() override;
+
+	private:
+		std::vector<FakeDevice> devices_;
+	};
+
+	class FakeVideoDeviceCollection : public bytertc::IVideoDeviceCollection {
+	public:
+		explicit FakeVideoDeviceCollection(const std::vector<FakeDevice>& devices);
+
+		int getCount() override;
+		int getDevice(int index, char device_name[bytertc::MAX_DEVICE_ID_LENGTH],
+			char device_id[bytertc::MAX_DEVICE_ID_LENGTH]) override;
+		int getDevice(int index, bytertc::VideoDeviceInfo* video_device_info) override;
+		void release() override;
+
+	private:
+		std::vector<FakeDevice> devices_;
+	};
+
+	/** {zh}
+	 * 一个麦克风和一个扬声器，设备测试时按间隔回调模拟音量
+	 */
+
+	/** {en}
+	* One microphone and one speaker, device tests report a simulated volume at the given interval
+	*/
+	class FakeAudioDeviceManager : public bytertc::IAudioDeviceManager {
+	public:
+		FakeAudioDeviceManager(Scheduler& scheduler, bytertc::IRTCVideoEventHandler* handler);
+		~FakeAudioDeviceManager();
+
+		bytertc::IAudioDeviceCollection* enumerateAudioPlaybackDevices() override;
+		bytertc::IAudioDeviceCollection* enumerateAudioCaptureDevices() override;
+		void followSystemPlaybackDevice(bool followed) override;
+		void followSystemCaptureDevice(bool followed) override;
+		int setAudioPlaybackDevice(const char device_id[bytertc::MAX_DEVICE_ID_LENGTH]) override;
+		int setAudioCaptureDevice(const char device_id[bytertc::MAX_DEVICE_ID_LENGTH]) override;
+		int setAudioPlaybackDeviceVolume(unsigned int volume) override;
+		int getAudioPlaybackDeviceVolume(unsigned int* volume) override;
+		int setAudioCaptureDeviceVolume(unsigned int volume) override;
+		int getAudioCaptureDeviceVolume(unsigned int* volume) override;
+		int setAudioPlaybackDeviceMute(bool mute) override;
+		int getAudioPlaybackDeviceMute(bool* mute) override;
+		int setAudioCaptureDeviceMute(bool mute) override;
+		int getAudioCaptureDeviceMute(bool* mute) override;
+		int getAudioPlaybackDevice(char device_id[bytertc::MAX_DEVICE_ID_LENGTH]) override;
+		int getAudioCaptureDevice(char device_id[bytertc::MAX_DEVICE_ID_LENGTH]) override;
+		int initAudioPlaybackDeviceForTest(const char deviceId[bytertc::MAX_DEVICE_ID_LENGTH]) override;
+		int initAudioCaptureDeviceForTest(const char deviceId[bytertc::MAX_DEVICE_ID_LENGTH]) override;
+		int startAudioPlaybackDeviceTest(const char* test_audio_file_path, int indication_interval) override;
+		int stopAudioPlaybackDeviceTest() override;
+		int startAudioDeviceRecordTest(int indication_interval) override;
+		int stopAudioDeviceRecordAndPlayTest() override;
+		int stopAudioDevicePlayTest() override;
+		int enableFilterSilentDevice(bool enable) override;
+
+	private:
+		int startTestVolume(int indication_interval);
+		int stopTestVolume();
+
+		Scheduler& scheduler_;
+		bytertc::IRTCVideoEventHandler* handler_;
+		std::vector<FakeDevice> capture_devices_;
+		std::vector<FakeDevice> playback_devices_;
+		std::string capture_device_id_;
+		std::string playback_device_id_;
+		unsigned int capture_volume_ = 100;
+		unsigned int playback_volume_ = 100;
+		bool capture_mute_ = false;
+		bool playback_mute_ = false;
+		int test_tick_ = 0;
+	};
+
+	class FakeVideoDeviceManager : public bytertc::IVideoDeviceManager {
+	public:
+		FakeVideoDeviceManager();
+
+		bytertc::IVideoDeviceCollection* enumerateVideoCaptureDevices() override;
+		int setVideoCaptureDevice(const char device_id[bytertc::MAX_DEVICE_ID_LENGTH]) override;
+		int getVideoCaptureDevice(char device_id[bytertc::MAX_DEVICE_ID_LENGTH]) override;
+
+	private:
+		std::vector<FakeDevice> capture_devices_;
+		std::string capture_device_id_;
+	};
+}
+}
+
+#endif // VRD_FAKE_DEVICE_MANAGER_H
@@ -0,0 +1,117 @@
+﻿#include "fake_rtc.h"
+#include "fake_audio_frame.h"
+#include "fake_rtc_video.h"
+#include "fake_video_frame.h"
+#include "bytertc_video.h"
+#include "rtc/bytertc_advance.h"
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+
+namespace vrd
+{
+namespace fake
+{
+	namespace {
+	int readEnv(const char* name, int fallback) {
+		auto value = std::getenv(name);
+		return value && *value ? std::atoi(value) : fallback;
+	}
+
+	std::mutex g_mutex;
+	bool g_scenario_set = false;
+	Scenario g_scenario;
+	FakeRTCVideo* g_engine = nullptr;
+	}  // namespace
+
+	Scenario Scenario::fromEnvironment() {
+		Scenario scenario;
+		scenario.remote_users = readEnv("VRD_FAKE_USERS", scenario.remote_users);
+		scenario.churn_interval_ms = readEnv("VRD_FAKE_CHURN_MS", scenario.churn_interval_ms);
+		scenario.stats_interval_ms = readEnv("VRD_FAKE_STATS_MS", scenario.stats_interval_ms);
+		scenario.volume_interval_ms = readEnv("VRD_FAKE_VOLUME_MS", scenario.volume_interval_ms);
+		scenario.speakers = readEnv("VRD_FAKE_SPEAKERS", scenario.speakers);
+		scenario.frame_rate = readEnv("VRD_FAKE_FPS", scenario.frame_rate);
+		scenario.latency_ms = readEnv("VRD_FAKE_LATENCY_MS", scenario.latency_ms);
+		scenario.seed = static_cast<uint32_t>(readEnv("VRD_FAKE_SEED", static_cast<int>(scenario.seed)));
+		auto size = std::getenv("VRD_FAKE_FRAME_SIZE");
+		int width = 0;
+		int height = 0;
+		if (size && std::sscanf(size, "%dx%d", &width, &height) == 2 && width > 0 && height > 0) {
+			scenario.frame_width = width;
+			scenario.frame_height = height;
+		}
+		return scenario;
+	}
+
+	void setScenario(const Scenario& scenario) {
+		std::lock_guard<std::mutex> lock(g_mutex);
+		g_scenario = scenario;
+		g_scenario_set = true;
+	}
+
+	const Scenario& scenario() {
+		std::lock_guard<std::mutex> lock(g_mutex);
+		if (!g_scenario_set) {
+			g_scenario = Scenario::fromEnvironment();
+			g_scenario_set = true;
+		}
+		return g_scenario;
+	}
+
+	ExternalMediaStats externalMediaStats() {
+		std::lock_guard<std::mutex> lock(g_mutex);
+		return g_engine ? g_engine->externalMediaStats() : ExternalMediaStats();
+	}
+}
+}
+
+/** {zh}
+ * 替身库导出的SDK全局函数，与 BytePlusRTC 同名，链接时二选一
+ */
+
+/** {en}
+* SDK global functions exported by the stand-in library under the BytePlusRTC names, link one or the other
+*/
+namespace bytertc
+{
+	IRTCVideo* createRTCVideo(const char* app_id, IRTCVideoEventHandler* event_handler, const char* parameters) {
+		std::lock_guard<std::mutex> lock(vrd::fake::g_mutex);
+		if (!vrd::fake::g_engine) {
+			vrd::fake::g_engine = new vrd::fake::FakeRTCVideo(app_id, event_handler);
+		}
+		return vrd::fake::g_engine;
+	}
+
+	void destroyRTCVideo() {
+		vrd::fake::FakeRTCVideo* engine = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(vrd::fake::g_mutex);
+			std::swap(engine, vrd::fake::g_engine);
+		}
+		delete engine;
+	}
+
+	const char* getErrorDescription(int code) {
+		return "fake engine error";
+	}
+
+	const char* getSDKVersion() {
+		return "fake-3.50";
+	}
+
+	int setEnv(Env env) {
+		return 0;
+	}
+
+	void setDeviceId(const char* device_id) {
+	}
+
+	IVideoFrame* buildVideoFrame(const VideoFrameBuilder& builder) {
+		return vrd::fake::FakeVideoFrame::wrap(builder);
+	}
+
+	IAudioFrame* buildAudioFrame(const AudioFrameBuilder& builder) {
+		return vrd::fake::FakeAudioFrame::build(builder);
+	}
+}
@@ -0,0 +1,74 @@
+﻿#ifndef VRD_FAKE_RTC_H
+#define VRD_FAKE_RTC_H
+
+#include <cstdint>
+
+namespace vrd
+{
+namespace fake
+{
+	/** {zh}
+	 * 替身RTC引擎的模拟场景，在 createRTCVideo 之前设置
+	 * 未调用 setScenario 时从环境变量读取：
+	 * VRD_FAKE_USERS, VRD_FAKE_CHURN_MS, VRD_FAKE_STATS_MS, VRD_FAKE_VOLUME_MS,
+	 * VRD_FAKE_SPEAKERS, VRD_FAKE_FPS, VRD_FAKE_FRAME_SIZE(如 320x180), VRD_FAKE_LATENCY_MS, VRD_FAKE_SEED
+	 */
+
+	/** {en}
+	* Simulated scenario of the stand-in RTC engine, set before createRTCVideo
+	* Read from environment variables when setScenario is not called:
+	* VRD_FAKE_USERS, VRD_FAKE_CHURN_MS, VRD_FAKE_STATS_MS, VRD_FAKE_VOLUME_MS,
+	* VRD_FAKE_SPEAKERS, VRD_FAKE_FPS, VRD_FAKE_FRAME_SIZE (e.g. 320x180), VRD_FAKE_LATENCY_MS, VRD_FAKE_SEED
+	*/
+	struct Scenario {
+		// {zh} 加入房间后出现的远端用户数
+		// {en} Number of remote users present after joining a room
+		int remote_users = 8;
+		// {zh} 每隔多久随机一个远端用户加入或离开，0为不变动
+		// {en} Interval at which a random remote user joins or leaves, 0 disables churn
+		int churn_interval_ms = 0;
+		// {zh} 音视频流统计回调间隔
+		// {en} Interval of the stream stats callbacks
+		int stats_interval_ms = 2000;
+		// {zh} 音量回调间隔，0为使用 enableAudioPropertiesReport 设置的间隔
+		// {en} Interval of the volume callbacks, 0 uses the one given to enableAudioPropertiesReport
+		int volume_interval_ms = 0;
+		// {zh} 同时说话的远端用户数，每3秒轮换
+		// {en} Number of remote users speaking at once, rotated every 3 seconds
+		int speakers = 2;
+		// {zh} 推送给视频渲染器的I420帧率和分辨率
+		// {en} Rate and resolution of the I420 frames pushed to video sinks
+		int frame_rate = 15;
+		int frame_width = 320;
+		int frame_height = 180;
+		// {zh} 登录、进房和RTS信令往返的模拟时延
+		// {en} Simulated latency of login, room join and RTS round trips
+		int latency_ms = 20;
+		uint32_t seed = 1;
+
+		static Scenario fromEnvironment();
+	};
+
+	void setScenario(const Scenario& scenario);
+	const Scenario& scenario();
+
+	/** {zh}
+	 * 经 pushExternalVideoFrame / pushExternalAudioFrame 推入的帧数，未切换到外部源时推入的计为 rejected
+	 */
+
+	/** {en}
+	* Frames pushed through pushExternalVideoFrame / pushExternalAudioFrame, pushes without the external source selected count as rejected
+	*/
+	struct ExternalMediaStats {
+		int64_t video_frames = 0;
+		int64_t audio_frames = 0;
+		int64_t rejected = 0;
+	};
+
+	// {zh} 引擎未创建时全为0
+	// {en} All zero when no engine exists
+	ExternalMediaStats externalMediaStats();
+}
+}
+
+#endif // VRD_FAKE_RTC_H
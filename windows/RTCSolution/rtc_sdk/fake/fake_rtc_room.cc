@@ -0,0 +1,495 @@
+﻿#include "fake_rtc_room.h"
+#include "fake_audio_frame.h"
+#include "fake_rtc_video.h"
+#include "fake_video_frame.h"
+#include <algorithm>
+#include <future>
+
+namespace vrd
+{
+namespace fake
+{
+	namespace {
+	constexpr int kSpeakerRotationMs = 3000;
+	constexpr int kVolumeWaitMs = 500;
+	constexpr int kAudioFrameMs = 10;
+	constexpr int kAudioSampleRate = 48000;
+	}  // namespace
+
+	FakeRTCRoom::FakeRTCRoom(FakeRTCVideo& engine, const char* room_id)
+		: engine_(engine)
+		, scenario_(scenario())
+		, room_id_(room_id ? room_id : "")
+		, random_(scenario_.seed) {
+	}
+
+	FakeRTCRoom::~FakeRTCRoom() {
+	}
+
+	void FakeRTCRoom::destroy() {
+		engine_.scheduler().cancel(this);
+		delete this;
+	}
+
+	void FakeRTCRoom::setUserVisibility(bool enable) {
+	}
+
+	void FakeRTCRoom::setRTCRoomEventHandler(bytertc::IRTCRoomEventHandler* room_event_handler) {
+		handler_ = room_event_handler;
+	}
+
+	int FakeRTCRoom::joinRoom(const char* token, const bytertc::UserInfo& user_info, const bytertc::RTCRoomConfig& config) {
+		std::string userId = user_info.uid ? user_info.uid : "";
+		auto autoSubscribeAudio = config.is_auto_subscribe_audio;
+		auto autoSubscribeVideo = config.is_auto_subscribe_video;
+		engine_.scheduler().postDelayed(this, scenario_.latency_ms, [this, userId, autoSubscribeAudio, autoSubscribeVideo]() {
+			local_user_id_ = userId;
+			auto_subscribe_audio_ = autoSubscribeAudio;
+			auto_subscribe_video_ = autoSubscribeVideo;
+			onJoined(scenario_.latency_ms);
+		});
+		return 0;
+	}
+
+	void FakeRTCRoom::leaveRoom() {
+		auto& scheduler = engine_.scheduler();
+		scheduler.cancel(this);
+		scheduler.post(this, [this]() {
+			if (!joined_) {
+				return;
+			}
+			joined_ = false;
+			users_.clear();
+			bytertc::RtcRoomStats stats = {};
+			stats.duration = static_cast<unsigned int>(std::chrono::duration_cast<std::chrono::seconds>(
+				std::chrono::steady_clock::now() - joined_at_).count());
+			if (auto handler = handler_.load()) {
+				handler->onLeaveRoom(stats);
+			}
+		});
+	}
+
+	void FakeRTCRoom::publishStream(bytertc::MediaStreamType type) {
+	}
+
+	void FakeRTCRoom::unpublishStream(bytertc::MediaStreamType type) {
+	}
+
+	void FakeRTCRoom::publishScreen(bytertc::MediaStreamType type) {
+	}
+
+	void FakeRTCRoom::unpublishScreen(bytertc::MediaStreamType type) {
+	}
+
+	int FakeRTCRoom::subscribeStream(const char* user_id, bytertc::MediaStreamType type) {
+		if (user_id && *user_id) {
+			setSubscription(user_id, type, true);
+		}
+		return 0;
+	}
+
+	int FakeRTCRoom::subscribeAllStreams(bytertc::MediaStreamType type) {
+		setSubscription(std::string(), type, true);
+		return 0;
+	}
+
+	int FakeRTCRoom::unsubscribeStream(const char* user_id, bytertc::MediaStreamType type) {
+		if (user_id && *user_id) {
+			setSubscription(user_id, type, false);
+		}
+		return 0;
+	}
+
+	int FakeRTCRoom::unsubscribeAllStreams(bytertc::MediaStreamType type) {
+		setSubscription(std::string(), type, false);
+		return 0;
+	}
+
+	int FakeRTCRoom::subscribeScreen(const char* user_id, bytertc::MediaStreamType type) {
+		return 0;
+	}
+
+	int FakeRTCRoom::unsubscribeScreen(const char* user_id, bytertc::MediaStreamType type) {
+		return 0;
+	}
+
+	int FakeRTCRoom::updateToken(const char* token) {
+		return 0;
+	}
+
+	int64_t FakeRTCRoom::sendUserMessage(const char* uid, const char* message, bytertc::MessageConfig config) {
+		return 0;
+	}
+
+	int64_t FakeRTCRoom::sendUserBinaryMessage(const char* uid, int length, const uint8_t* message, bytertc::MessageConfig config) {
+		return 0;
+	}
+
+	int64_t FakeRTCRoom::sendRoomMessage(const char* message) {
+		return 0;
+	}
+
+	int64_t FakeRTCRoom::sendRoomBinaryMessage(int size, const uint8_t* message) {
+		return 0;
+	}
+
+	int FakeRTCRoom::subscribeUserStream(const char* user_id, bytertc::StreamIndex stream_type, bytertc::SubscribeMediaType media_type, const bytertc::SubscribeVideoConfig& video_config) {
+		return 0;
+	}
+
+	int FakeRTCRoom::setRemoteVideoConfig(const char* user_id, const bytertc::RemoteVideoConfig& remote_video_config) {
+		return 0;
+	}
+
+	void FakeRTCRoom::enableSubscribeLocalStream(bool enable) {
+	}
+
+	void FakeRTCRoom::pauseAllSubscribedStream(bytertc::PauseResumeControlMediaType media_type) {
+	}
+
+	void FakeRTCRoom::resumeAllSubscribedStream(bytertc::PauseResumeControlMediaType media_type) {
+	}
+
+	void FakeRTCRoom::setMultiDeviceAVSync(const char* audio_user_id) {
+	}
+
+	void FakeRTCRoom::updateCloudRendering(const char* cloudrenderJsonString) {
+	}
+
+	void FakeRTCRoom::setCustomUserRole(const char* role) {
+	}
+
+	int FakeRTCRoom::startForwardStreamToRooms(const bytertc::ForwardStreamConfiguration& configuration) {
+		return 0;
+	}
+
+	int FakeRTCRoom::updateForwardStreamToRooms(const bytertc::ForwardStreamConfiguration& configuration) {
+		return 0;
+	}
+
+	void FakeRTCRoom::stopForwardStreamToRooms() {
+	}
+
+	void FakeRTCRoom::pauseForwardStreamToAllRooms() {
+	}
+
+	void FakeRTCRoom::resumeForwardStreamToAllRooms() {
+	}
+
+	bytertc::IRangeAudio* FakeRTCRoom::getRangeAudio() {
+		return nullptr;
+	}
+
+	bytertc::ISpatialAudio* FakeRTCRoom::getSpatialAudio() {
+		return nullptr;
+	}
+
+	void FakeRTCRoom::setRemoteRoomAudioPlaybackVolume(int volume) {
+	}
+
+	bytertc::IPanoramicVideo* FakeRTCRoom::getPanoramicVideo() {
+		return nullptr;
+	}
+
+	int FakeRTCRoom::setAudioSelectionConfig(bytertc::AudioSelectionPriority audio_selection_priority) {
+		return 0;
+	}
+
+	int64_t FakeRTCRoom::setRoomExtraInfo(const char* key, const char* value) {
+		return 0;
+	}
+
+	int FakeRTCRoom::startSubtitle(const bytertc::SubtitleConfig& subtitle_config) {
+		return 0;
+	}
+
+	int FakeRTCRoom::stopSubtitle() {
+		return 0;
+	}
+
+	void FakeRTCRoom::onJoined(int elapsed) {
+		joined_ = true;
+		joined_at_ = std::chrono::steady_clock::now();
+		if (auto handler = handler_.load()) {
+			auto extraInfo = "{\"elapsed\":" + std::to_string(elapsed) + ",\"join_type\":0}";
+			handler->onRoomStateChanged(room_id_.c_str(), local_user_id_.c_str(), 0, extraInfo.c_str());
+		}
+
+		users_.resize(static_cast<size_t>(std::max(scenario_.remote_users, 0)));
+		for (size_t i = 0; i < users_.size(); ++i) {
+			auto& user = users_[i];
+			user.user_id = "fake_user_" + std::to_string(i);
+			user.extra_info = "{\"user_name\":\"Fake User " + std::to_string(i) + "\"}";
+			addUser(user);
+		}
+
+		auto& scheduler = engine_.scheduler();
+		scheduler.postRepeating(this, scenario_.stats_interval_ms, [this]() { reportStats(); });
+		scheduler.postRepeating(this, scenario_.churn_interval_ms, [this]() { churn(); });
+		if (scenario_.frame_rate > 0) {
+			scheduler.postRepeating(this, 1000 / scenario_.frame_rate, [this]() { pushFrames(); });
+		}
+		scheduler.postRepeating(this, kAudioFrameMs, [this]() { pushAudio(); });
+		scheduleVolume();
+	}
+
+	void FakeRTCRoom::addUser(RemoteUser& user) {
+		user.present = true;
+		user.audio_subscribed = auto_subscribe_audio_;
+		user.video_subscribed = auto_subscribe_video_;
+		user.first_frame_sent = false;
+		if (auto handler = handler_.load()) {
+			bytertc::UserInfo info;
+			info.uid = user.user_id.c_str();
+			info.extra_info = user.extra_info.c_str();
+			handler->onUserJoined(info, 0);
+			handler->onUserPublishStream(user.user_id.c_str(), bytertc::kMediaStreamTypeBoth);
+		}
+		if (auto handler = engine_.handler()) {
+			handler->onUserStartAudioCapture(room_id_.c_str(), user.user_id.c_str());
+			handler->onUserStartVideoCapture(room_id_.c_str(), user.user_id.c_str());
+		}
+	}
+
+	void FakeRTCRoom::removeUser(RemoteUser& user, bytertc::UserOfflineReason reason) {
+		user.present = false;
+		if (auto handler = handler_.load()) {
+			handler->onUserUnpublishStream(user.user_id.c_str(), bytertc::kMediaStreamTypeBoth,
+				bytertc::kStreamRemoveReasonUnpublish);
+			handler->onUserLeave(user.user_id.c_str(), reason);
+		}
+	}
+
+	void FakeRTCRoom::reportStats() {
+		auto handler = handler_.load();
+		if (!handler) {
+			return;
+		}
+		std::uniform_int_distribution<int> jitter(0, 20);
+		for (auto& user : users_) {
+			if (!user.present) {
+				continue;
+			}
+			bytertc::RemoteStreamStats stats = {};
+			stats.uid = user.user_id.c_str();
+			stats.remote_tx_quality = bytertc::kNetworkQualityGood;
+			stats.remote_rx_quality = bytertc::kNetworkQualityGood;
+			stats.audio_stats.received_kbitrate = 30 + jitter(random_) / 4;
+			stats.audio_stats.rtt = 40 + jitter(random_);
+			stats.audio_stats.stats_interval = scenario_.stats_interval_ms;
+			stats.audio_stats.playout_sample_rate = 48000;
+			stats.audio_stats.num_channels = 1;
+			stats.video_stats.width = scenario_.frame_width;
+			stats.video_stats.height = scenario_.frame_height;
+			stats.video_stats.received_kbitrate = 300 + jitter(random_) * 5;
+			stats.video_stats.decoder_output_frame_rate = scenario_.frame_rate;
+			stats.video_stats.renderer_output_frame_rate = scenario_.frame_rate;
+			stats.video_stats.rtt = stats.audio_stats.rtt;
+			stats.video_stats.stats_interval = scenario_.stats_interval_ms;
+			stats.video_stats.video_loss_rate = jitter(random_) / 1000.0f;
+			handler->onRemoteStreamStats(stats);
+		}
+
+		bytertc::LocalStreamStats local = {};
+		local.local_tx_quality = bytertc::kNetworkQualityExcellent;
+		local.local_rx_quality = bytertc::kNetworkQualityExcellent;
+		handler->onLocalStreamStats(local);
+
+		bytertc::RtcRoomStats room = {};
+		room.user_count = static_cast<unsigned int>(presentCount() + 1);
+		room.rtt = 40 + jitter(random_);
+		room.duration = static_cast<unsigned int>(std::chrono::duration_cast<std::chrono::seconds>(
+			std::chrono::steady_clock::now() - joined_at_).count());
+		handler->onRoomStats(room);
+	}
+
+	void FakeRTCRoom::scheduleVolume() {
+		auto interval = scenario_.volume_interval_ms > 0 ? scenario_.volume_interval_ms : engine_.audioReportIntervalMs();
+		// {zh} 应用尚未开启音量回调时，稍后再检查间隔
+		// {en} Check the interval again later while the app has not enabled volume reports
+		if (interval <= 0) {
+			engine_.scheduler().postDelayed(this, kVolumeWaitMs, [this]() { scheduleVolume(); });
+			return;
+		}
+		engine_.scheduler().postDelayed(this, interval, [this]() {
+			reportVolume();
+			scheduleVolume();
+		});
+	}
+
+	void FakeRTCRoom::reportVolume() {
+		auto handler = engine_.handler();
+		if (!handler) {
+			return;
+		}
+		std::vector<bytertc::RemoteAudioPropertiesInfo> infos;
+		infos.reserve(users_.size());
+		for (auto& user : users_) {
+			if (!user.present) {
+				continue;
+			}
+			bytertc::RemoteAudioPropertiesInfo info;
+			info.stream_key.room_id = room_id_.c_str();
+			info.stream_key.user_id = user.user_id.c_str();
+			info.stream_key.stream_index = bytertc::kStreamIndexMain;
+			infos.push_back(info);
+		}
+
+		auto count = static_cast<int>(infos.size());
+		std::uniform_int_distribution<int> loud(120, 255);
+		std::uniform_int_distribution<int> quiet(0, 10);
+		int total = 0;
+		for (int i = 0; i < count; ++i) {
+			auto speaking = isSpeaking(i, count);
+			auto& properties = infos[i].audio_properties_info;
+			properties.linear_volume = speaking ? loud(random_) : quiet(random_);
+			properties.nonlinear_volume = properties.linear_volume;
+			properties.vad = speaking ? 1 : 0;
+			total = std::max(total, properties.linear_volume);
+		}
+		handler->onRemoteAudioPropertiesReport(infos.data(), count, total);
+	}
+
+	bool FakeRTCRoom::isSpeaking(int index, int count) const {
+		auto window = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+			std::chrono::steady_clock::now() - joined_at_).count() / kSpeakerRotationMs);
+		auto speakers = std::min(scenario_.speakers, count);
+		// {zh} 说话者为按窗口轮换的连续 speakers 个用户
+		// {en} The speakers are speakers consecutive users, rotating with the window
+		auto offset = (index - window * scenario_.speakers) % count;
+		return (offset < 0 ? offset + count : offset) < speakers;
+	}
+
+	void FakeRTCRoom::pushAudio() {
+		auto observer = engine_.audioFrameObserver(bytertc::AudioFrameCallbackMethod::kAudioFrameCallbackRemoteUser);
+		if (!observer) {
+			return;
+		}
+		audio_samples_.resize(kAudioSampleRate * kAudioFrameMs / 1000);
+		auto count = presentCount();
+		auto timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+		int index = 0;
+		for (size_t i = 0; i < users_.size(); ++i) {
+			auto& user = users_[i];
+			if (!user.present) {
+				continue;
+			}
+			auto speaking = isSpeaking(index++, count);
+			if (!user.audio_subscribed) {
+				continue;
+			}
+			FakeAudioFrame::synthesize(audio_samples_.data(), audio_samples_.size(), kAudioSampleRate,
+				audio_sample_index_, speaking, static_cast<uint32_t>(i + 1));
+			bytertc::AudioFrameBuilder builder;
+			builder.sample_rate = bytertc::kAudioSampleRate48000;
+			builder.channel = bytertc::kAudioChannelMono;
+			builder.timestamp_us = timestamp;
+			builder.data = reinterpret_cast<uint8_t*>(audio_samples_.data());
+			builder.data_size = static_cast<int64_t>(audio_samples_.size() * sizeof(int16_t));
+			builder.deep_copy = false;
+			bytertc::RemoteStreamKey key;
+			key.room_id = room_id_.c_str();
+			key.user_id = user.user_id.c_str();
+			key.stream_index = bytertc::kStreamIndexMain;
+			auto frame = FakeAudioFrame::build(builder);
+			observer->onRemoteUserAudioFrame(key, *frame);
+			frame->release();
+		}
+		audio_sample_index_ += audio_samples_.size();
+	}
+
+	void FakeRTCRoom::pushFrames() {
+		bytertc::IVideoFrame* frame = nullptr;
+		auto engineHandler = engine_.handler();
+		for (auto& user : users_) {
+			if (!user.present || !user.video_subscribed) {
+				continue;
+			}
+			// {zh} 同一时刻的远端帧共享一块像素缓冲
+			// {en} The remote frames of one tick share a single pixel buffer
+			if (!frame) {
+				auto timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+					std::chrono::steady_clock::now().time_since_epoch()).count();
+				frame = FakeVideoFrame::createI420(scenario_.frame_width, scenario_.frame_height,
+					timestamp, frame_index_++);
+			}
+			if (!user.first_frame_sent && engineHandler) {
+				user.first_frame_sent = true;
+				bytertc::RemoteStreamKey key;
+				key.room_id = room_id_.c_str();
+				key.user_id = user.user_id.c_str();
+				key.stream_index = bytertc::kStreamIndexMain;
+				bytertc::VideoFrameInfo info;
+				info.width = scenario_.frame_width;
+				info.height = scenario_.frame_height;
+				engineHandler->onFirstRemoteVideoFrameDecoded(key, info);
+			}
+			engine_.deliverRemoteFrame(room_id_, user.user_id, bytertc::kStreamIndexMain, frame->shallowCopy());
+		}
+		if (frame) {
+			frame->release();
+		}
+	}
+
+	void FakeRTCRoom::churn() {
+		if (users_.empty()) {
+			return;
+		}
+		auto& user = users_[random_() % users_.size()];
+		if (user.present) {
+			removeUser(user, bytertc::kUserOfflineReasonQuit);
+		}
+		else {
+			addUser(user);
+		}
+	}
+
+	void FakeRTCRoom::setSubscription(const std::string& user_id, bytertc::MediaStreamType type, bool subscribe) {
+		engine_.scheduler().post(this, [this, user_id, type, subscribe]() {
+			for (auto& user : users_) {
+				if (!user_id.empty() && user.user_id != user_id) {
+					continue;
+				}
+				if (subscribe) {
+					user.audio_subscribed = (type & bytertc::kMediaStreamTypeAudio) != 0;
+					user.video_subscribed = (type & bytertc::kMediaStreamTypeVideo) != 0;
+					continue;
+				}
+				if (type & bytertc::kMediaStreamTypeAudio) {
+					user.audio_subscribed = false;
+				}
+				if (type & bytertc::kMediaStreamTypeVideo) {
+					user.video_subscribed = false;
+				}
+			}
+		});
+	}
+
+	int FakeRTCRoom::subscribedMedia(const std::string& user_id) {
+		auto query = [this, user_id]() {
+			for (auto& user : users_) {
+				if (user.present && user.user_id == user_id) {
+					return (user.audio_subscribed ? bytertc::kMediaStreamTypeAudio : 0)
+						| (user.video_subscribed ? bytertc::kMediaStreamTypeVideo : 0);
+				}
+			}
+			return 0;
+		};
+		auto& scheduler = engine_.scheduler();
+		if (scheduler.isCurrentThread()) {
+			return query();
+		}
+		// {zh} 以局部对象为 owner，leaveRoom 取消本房间任务时不会丢掉这次查询
+		// {en} Owned by a local object so that leaveRoom cancelling this room's tasks does not drop the query
+		std::promise<int> result;
+		scheduler.post(&result, [&result, query]() { result.set_value(query()); });
+		return result.get_future().get();
+	}
+
+	int FakeRTCRoom::presentCount() const {
+		return static_cast<int>(std::count_if(users_.begin(), users_.end(),
+			[](const RemoteUser& user) { return user.present; }));
+	}
+}
+}
@@ -0,0 +1,138 @@
+﻿#ifndef VRD_FAKE_RTC_ROOM_H
+#define VRD_FAKE_RTC_ROOM_H
+
+#include "bytertc_room.h"
+#include "bytertc_room_event_handler.h"
+#include "fake_rtc.h"
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace vrd
+{
+namespace fake
+{
+	class FakeRTCVideo;
+
+	/** {zh}
+	 * IRTCRoom 的替身实现，按 Scenario 模拟远端用户
+	 * 1, 进房成功后 remote_users 个远端用户加入并发布音视频，按 churn_interval_ms 随机加入或离开
+	 * 2, 按 stats_interval_ms 回调流统计，按音量间隔回调远端音量，说话者每3秒轮换
+	 * 3, 已订阅视频的远端用户按帧率推送I420帧，首帧时回调 onFirstRemoteVideoFrameDecoded
+	 * 4, 开启远端音频帧回调后，每10毫秒为每个已订阅音频的远端用户回调一帧48kHz单声道PCM，说话者与音量回调一致
+	 * 5, 与SDK一致，subscribeStream/subscribeAllStreams 以给定媒体替换原有订阅，unsubscribe 只去掉给定的媒体
+	 * 远端用户状态只在 Scheduler 线程访问，应用线程的调用投递到该线程执行
+	 */
+
+	/** {en}
+	* Stand-in implementation of IRTCRoom, simulating remote users according to the Scenario
+	* 1, After the join succeeds, remote_users remote users join and publish audio and video, then one joins or leaves at random every churn_interval_ms
+	* 2, Stream stats are reported every stats_interval_ms and remote volumes at the volume interval, with speakers rotating every 3 seconds
+	* 3, Remote users whose video is subscribed get I420 frames at the frame rate, with onFirstRemoteVideoFrameDecoded on the first one
+	* 4, With remote audio frame callbacks on, every remote user with audio subscribed calls back a 48 kHz mono PCM frame every 10 ms,
+	*    with the same speakers as the volume report
+	* 5, As in the SDK, subscribeStream/subscribeAllStreams replace the subscription with the given media, unsubscribe only removes the given media
+	* Remote user state is only touched on the Scheduler thread, calls from app threads are posted to it
+	*/
+	class FakeRTCRoom final : public bytertc::IRTCRoom {
+	public:
+		FakeRTCRoom(FakeRTCVideo& engine, const char* room_id);
+
+		void destroy() override;
+		void setUserVisibility(bool enable) override;
+		void setRTCRoomEventHandler(bytertc::IRTCRoomEventHandler* room_event_handler) override;
+		int joinRoom(const char* token, const bytertc::UserInfo& user_info, const bytertc::RTCRoomConfig& config) override;
+		void leaveRoom() override;
+		int updateToken(const char* token) override;
+		int64_t sendUserMessage(const char* uid, const char* message, bytertc::MessageConfig config = bytertc::kMessageConfigReliableOrdered) override;
+		int64_t sendUserBinaryMessage(const char* uid, int length, const uint8_t* message, bytertc::MessageConfig config = bytertc::kMessageConfigReliableOrdered) override;
+		int64_t sendRoomMessage(const char* message) override;
+		int64_t sendRoomBinaryMessage(int size, const uint8_t* message) override;
+		void publishStream(bytertc::MediaStreamType type) override;
+		void unpublishStream(bytertc::MediaStreamType type) override;
+		void publishScreen(bytertc::MediaStreamType type) override;
+		void unpublishScreen(bytertc::MediaStreamType type) override;
+		int subscribeUserStream(const char* user_id, bytertc::StreamIndex stream_type, bytertc::SubscribeMediaType media_type, const bytertc::SubscribeVideoConfig& video_config) override;
+		int setRemoteVideoConfig(const char* user_id, const bytertc::RemoteVideoConfig& remote_video_config) override;
+		int subscribeStream(const char* user_id, bytertc::MediaStreamType type) override;
+		int subscribeAllStreams(bytertc::MediaStreamType type) override;
+		int unsubscribeStream(const char* user_id, bytertc::MediaStreamType type) override;
+		int unsubscribeAllStreams(bytertc::MediaStreamType type) override;
+		int subscribeScreen(const char* user_id, bytertc::MediaStreamType type) override;
+		int unsubscribeScreen(const char* user_id, bytertc::MediaStreamType type) override;
+		void enableSubscribeLocalStream(bool enable) override;
+		void pauseAllSubscribedStream(bytertc::PauseResumeControlMediaType media_type) override;
+		void resumeAllSubscribedStream(bytertc::PauseResumeControlMediaType media_type) override;
+		void setMultiDeviceAVSync(const char* audio_user_id) override;
+		void updateCloudRendering(const char* cloudrenderJsonString) override;
+		void setCustomUserRole(const char* role) override;
+		int startForwardStreamToRooms(const bytertc::ForwardStreamConfiguration& configuration) override;
+		int updateForwardStreamToRooms(const bytertc::ForwardStreamConfiguration& configuration) override;
+		void stopForwardStreamToRooms() override;
+		void pauseForwardStreamToAllRooms() override;
+		void resumeForwardStreamToAllRooms() override;
+		bytertc::IRangeAudio* getRangeAudio() override;
+		bytertc::ISpatialAudio* getSpatialAudio() override;
+		void setRemoteRoomAudioPlaybackVolume(int volume) override;
+		bytertc::IPanoramicVideo* getPanoramicVideo() override;
+		int setAudioSelectionConfig(bytertc::AudioSelectionPriority audio_selection_priority) override;
+		int64_t setRoomExtraInfo(const char* key, const char* value) override;
+		int startSubtitle(const bytertc::SubtitleConfig& subtitle_config) override;
+		int stopSubtitle() override;
+
+		// {zh} 远端用户主流当前订阅的媒体，MediaStreamType 的位组合，用户不在房间时为0；在之前投递的调用执行后返回
+		// {en} Media currently subscribed on a remote user's main stream as MediaStreamType bits, 0 when the user is not present;
+		// answered after the calls posted before it have run
+		int subscribedMedia(const std::string& user_id);
+
+	private:
+		struct RemoteUser {
+			std::string user_id;
+			std::string extra_info;
+			bool present = false;
+			bool audio_subscribed = false;
+			bool video_subscribed = false;
+			bool first_frame_sent = false;
+		};
+
+		~FakeRTCRoom();
+
+		void onJoined(int elapsed);
+		void addUser(RemoteUser& user);
+		void removeUser(RemoteUser& user, bytertc::UserOfflineReason reason);
+		void reportStats();
+		void reportVolume();
+		void scheduleVolume();
+		void pushFrames();
+		void pushAudio();
+		bool isSpeaking(int index, int count) const;
+		void churn();
+		// {zh} user_id 为空表示所有用户
+		// {en} An empty user_id means every user
+		void setSubscription(const std::string& user_id, bytertc::MediaStreamType type, bool subscribe);
+		int presentCount() const;
+
+		FakeRTCVideo& engine_;
+		const Scenario scenario_;
+		const std::string room_id_;
+		std::atomic<bytertc::IRTCRoomEventHandler*> handler_{ nullptr };
+
+		// {zh} 以下成员只在 Scheduler 线程访问
+		// {en} The members below are only touched on the Scheduler thread
+		std::string local_user_id_;
+		bool auto_subscribe_audio_ = true;
+		bool auto_subscribe_video_ = true;
+		bool joined_ = false;
+		std::vector<RemoteUser> users_;
+		std::mt19937 random_;
+		std::chrono::steady_clock::time_point joined_at_;
+		uint32_t frame_index_ = 0;
+		std::vector<int16_t> audio_samples_;
+		uint64_t audio_sample_index_ = 0;
+	};
+}
+}
+
+#endif // VRD_FAKE_RTC_ROOM_H
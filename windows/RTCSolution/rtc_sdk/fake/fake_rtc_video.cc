@@ -0,0 +1,928 @@
+﻿#include "fake_rtc_video.h"
+#include "fake_rtc.h"
+#include "fake_rtc_room.h"
+#include "fake_audio_frame.h"
+#include "fake_video_frame.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+namespace vrd
+{
+namespace fake
+{
+	namespace {
+	constexpr uint32_t kThumbnailColor = 0xFF3A6EA5;
+	constexpr int kThumbnailMaxWidth = 160;
+	constexpr int kThumbnailMaxHeight = 90;
+	const char* const kServerUserId = "server";
+
+	/** {zh}
+	 * 一个主显示器的屏幕共享源列表
+	 */
+
+	/** {en}
+	* Screen share source list holding one primary monitor
+	*/
+	class FakeScreenCaptureSourceList : public bytertc::IScreenCaptureSourceList {
+	public:
+		int32_t getCount() override {
+			return 1;
+		}
+
+		bytertc::ScreenCaptureSourceInfo getSourceInfo(int32_t index) override {
+			bytertc::ScreenCaptureSourceInfo info;
+			if (index != 0) {
+				return info;
+			}
+			info.type = bytertc::kScreenCaptureSourceTypeScreen;
+			info.source_id = reinterpret_cast<bytertc::view_t>(1);
+			info.source_name = "Fake Screen";
+			info.primaryMonitor = true;
+			info.region_rect.width = 1920;
+			info.region_rect.height = 1080;
+			return info;
+		}
+
+		void release() override {
+			delete this;
+		}
+	};
+
+	// {zh} 读取信令包顶层的字符串字段，嵌套在 content 字符串中的同名字段已被转义，不会匹配
+	// {en} Reads a top-level string field of an RTS envelope, same-named fields nested in the content string are escaped and do not match
+	std::string readStringField(const std::string& json, const char* key) {
+		auto pattern = std::string("\"") + key + "\":\"";
+		auto begin = json.find(pattern);
+		if (begin == std::string::npos) {
+			return std::string();
+		}
+		begin += pattern.size();
+		auto end = json.find('"', begin);
+		return end == std::string::npos ? std::string() : json.substr(begin, end - begin);
+	}
+	}  // namespace
+
+	FakeRTCVideo::FakeRTCVideo(const char* app_id, bytertc::IRTCVideoEventHandler* handler)
+		: scheduler_(new Scheduler())
+		, handler_(handler)
+		, audio_device_manager_(new FakeAudioDeviceManager(*scheduler_, handler))
+		, video_device_manager_(new FakeVideoDeviceManager()) {
+	}
+
+	FakeRTCVideo::~FakeRTCVideo() {
+		scheduler_->cancel(this);
+		scheduler_->cancel(&audio_capturing_);
+		scheduler_->cancel(&video_capturing_);
+		scheduler_->cancel(&audio_callbacks_);
+	}
+
+	Scheduler& FakeRTCVideo::scheduler() {
+		return *scheduler_;
+	}
+
+	bytertc::IRTCVideoEventHandler* FakeRTCVideo::handler() const {
+		return handler_;
+	}
+
+	int FakeRTCVideo::audioReportIntervalMs() const {
+		return audio_report_interval_ms_;
+	}
+
+	ExternalMediaStats FakeRTCVideo::externalMediaStats() const {
+		ExternalMediaStats stats;
+		stats.video_frames = external_video_frames_;
+		stats.audio_frames = external_audio_frames_;
+		stats.rejected = external_rejected_;
+		return stats;
+	}
+
+	bytertc::IAudioFrameObserver* FakeRTCVideo::audioFrameObserver(bytertc::AudioFrameCallbackMethod method) const {
+		auto bit = 1 << static_cast<int>(method);
+		return (audio_callbacks_ & bit) != 0 ? audio_observer_.load() : nullptr;
+	}
+
+	void FakeRTCVideo::deliverRemoteFrame(const std::string& room_id, const std::string& user_id,
+		bytertc::StreamIndex index, bytertc::IVideoFrame* frame) {
+		// {zh} 持锁回调，setRemoteVideoSink 返回后不会再回调旧的渲染器
+		// {en} Called with the lock held so a replaced sink gets no callback once setRemoteVideoSink returns
+		std::lock_guard<std::mutex> lock(sink_mutex_);
+		auto it = remote_sinks_.find(sinkKey(room_id, user_id, index));
+		if (it == remote_sinks_.end()) {
+			frame->release();
+			return;
+		}
+		it->second->onFrame(frame);
+	}
+
+	void FakeRTCVideo::startAudioCapture() {
+		audio_capturing_ = true;
+	}
+
+	void FakeRTCVideo::stopAudioCapture() {
+		audio_capturing_ = false;
+	}
+
+	void FakeRTCVideo::startVideoCapture() {
+		if (video_capturing_.exchange(true)) {
+			return;
+		}
+		const auto& config = scenario();
+		scheduler_->postDelayed(&video_capturing_, config.latency_ms, [this, config]() {
+			if (handler_) {
+				bytertc::VideoFrameInfo info;
+				info.width = config.frame_width;
+				info.height = config.frame_height;
+				handler_->onFirstLocalVideoFrameCaptured(bytertc::kStreamIndexMain, info);
+			}
+		});
+		if (config.frame_rate > 0) {
+			scheduler_->postRepeating(&video_capturing_, 1000 / config.frame_rate, [this]() { deliverLocalFrame(); });
+		}
+	}
+
+	void FakeRTCVideo::stopVideoCapture() {
+		scheduler_->cancel(&video_capturing_);
+		video_capturing_ = false;
+	}
+
+	void FakeRTCVideo::setLocalVideoSink(bytertc::StreamIndex index, bytertc::IVideoSink* video_sink, bytertc::IVideoSink::PixelFormat required_format) {
+		if (index != bytertc::kStreamIndexMain) {
+			return;
+		}
+		std::lock_guard<std::mutex> lock(sink_mutex_);
+		local_sink_ = video_sink;
+	}
+
+	void FakeRTCVideo::setRemoteVideoSink(bytertc::RemoteStreamKey stream_key, bytertc::IVideoSink* video_sink, bytertc::IVideoSink::PixelFormat required_format) {
+		auto key = sinkKey(stream_key.room_id ? stream_key.room_id : "",
+			stream_key.user_id ? stream_key.user_id : "", stream_key.stream_index);
+		std::lock_guard<std::mutex> lock(sink_mutex_);
+		if (video_sink) {
+			remote_sinks_[key] = video_sink;
+		}
+		else {
+			remote_sinks_.erase(key);
+		}
+	}
+
+	int FakeRTCVideo::startScreenVideoCapture(const bytertc::ScreenCaptureSourceInfo& source_info, const bytertc::ScreenCaptureParameters& capture_params) {
+		scheduler_->postDelayed(this, scenario().latency_ms, [this]() {
+			if (handler_) {
+				bytertc::VideoFrameInfo info;
+				info.width = 1920;
+				info.height = 1080;
+				handler_->onFirstLocalVideoFrameCaptured(bytertc::kStreamIndexScreen, info);
+			}
+		});
+		return 0;
+	}
+
+	void FakeRTCVideo::stopScreenVideoCapture() {
+	}
+
+	bytertc::IScreenCaptureSourceList* FakeRTCVideo::getScreenCaptureSourceList() {
+		return new FakeScreenCaptureSourceList();
+	}
+
+	bytertc::IVideoFrame* FakeRTCVideo::getThumbnail(bytertc::ScreenCaptureSourceType type, bytertc::view_t source_id, int max_width, int max_height) {
+		return FakeVideoFrame::createARGB(std::min(max_width, kThumbnailMaxWidth),
+			std::min(max_height, kThumbnailMaxHeight), kThumbnailColor);
+	}
+
+	bytertc::IVideoFrame* FakeRTCVideo::getWindowAppIcon(bytertc::view_t source_id, int max_width, int max_height) {
+		return FakeVideoFrame::createARGB(max_width, max_height, kThumbnailColor);
+	}
+
+	bytertc::IRTCRoom* FakeRTCVideo::createRTCRoom(const char* room_id) {
+		return new FakeRTCRoom(*this, room_id);
+	}
+
+	bytertc::IVideoDeviceManager* FakeRTCVideo::getVideoDeviceManager() {
+		return video_device_manager_.get();
+	}
+
+	bytertc::IAudioDeviceManager* FakeRTCVideo::getAudioDeviceManager() {
+		return audio_device_manager_.get();
+	}
+
+	int FakeRTCVideo::feedback(uint64_t type, const bytertc::ProblemFeedbackInfo* info) {
+		return 0;
+	}
+
+	int FakeRTCVideo::login(const char* token, const char* uid) {
+		std::string userId = uid ? uid : "";
+		auto latency = scenario().latency_ms;
+		scheduler_->postDelayed(this, latency, [this, userId, latency]() {
+			if (handler_) {
+				handler_->onLoginResult(userId.c_str(), 0, latency);
+			}
+		});
+		return 0;
+	}
+
+	void FakeRTCVideo::logout() {
+		scheduler_->post(this, [this]() {
+			if (handler_) {
+				handler_->onLogout();
+			}
+		});
+	}
+
+	void FakeRTCVideo::setServerParams(const char* signature, const char* url) {
+		scheduler_->postDelayed(this, scenario().latency_ms, [this]() {
+			if (handler_) {
+				handler_->onServerParamsSetResult(200);
+			}
+		});
+	}
+
+	int64_t FakeRTCVideo::sendServerMessage(const char* message) {
+		auto messageId = ++next_message_id_;
+		std::string content = message ? message : "";
+		scheduler_->postDelayed(this, scenario().latency_ms, [this, messageId, content]() {
+			answerServerMessage(messageId, content);
+		});
+		return messageId;
+	}
+
+	void FakeRTCVideo::enableAudioPropertiesReport(const bytertc::AudioPropertiesConfig& config) {
+		scheduler_->cancel(&audio_capturing_);
+		audio_report_interval_ms_ = config.interval;
+		scheduler_->postRepeating(&audio_capturing_, config.interval, [this]() { reportLocalAudio(); });
+	}
+
+	void FakeRTCVideo::setCaptureVolume(bytertc::StreamIndex index, int volume) {
+	}
+
+	void FakeRTCVideo::setPlaybackVolume(const int volume) {
+	}
+
+	void FakeRTCVideo::setEarMonitorMode(bytertc::EarMonitorMode mode) {
+	}
+
+	void FakeRTCVideo::setEarMonitorVolume(const int volume) {
+	}
+
+	void FakeRTCVideo::setBluetoothMode(bytertc::BluetoothMode mode) {
+	}
+
+	void FakeRTCVideo::setAudioScenario(bytertc::AudioScenarioType scenario) {
+	}
+
+	int FakeRTCVideo::setVoiceChangerType(bytertc::VoiceChangerType voice_changer) {
+		return 0;
+	}
+
+	int FakeRTCVideo::setVoiceReverbType(bytertc::VoiceReverbType voice_reverb) {
+		return 0;
+	}
+
+	int FakeRTCVideo::setLocalVoiceEqualization(bytertc::VoiceEqualizationConfig config) {
+		return 0;
+	}
+
+	int FakeRTCVideo::setLocalVoiceReverbParam(bytertc::VoiceReverbConfig param) {
+		return 0;
+	}
+
+	int FakeRTCVideo::enableLocalVoiceReverb(bool enable) {
+		return 0;
+	}
+
+	void FakeRTCVideo::setAudioProfile(bytertc::AudioProfileType audio_profile) {
+	}
+
+	void FakeRTCVideo::setAnsMode(bytertc::AnsMode ans_mode) {
+	}
+
+	int FakeRTCVideo::enableAGC(bool enable) {
+		return 0;
+	}
+
+	int FakeRTCVideo::setAudioSourceType(bytertc::AudioSourceType type) {
+		external_audio_ = type == bytertc::kAudioSourceTypeExternal;
+		return 0;
+	}
+
+	int FakeRTCVideo::setAudioRenderType(bytertc::AudioRenderType type) {
+		return 0;
+	}
+
+	// {zh} 帧归调用方所有，这里只取峰值作为本地音量
+	// {en} The frame stays owned by the caller, only its peak is taken as the local volume
+	int FakeRTCVideo::pushExternalAudioFrame(bytertc::IAudioFrame* audioFrame) {
+		if (!audioFrame) {
+			return bytertc::kReturnStatusParameterErr;
+		}
+		if (!external_audio_) {
+			++external_rejected_;
+			return bytertc::kReturnStatusWrongState;
+		}
+		++external_audio_frames_;
+		auto samples = reinterpret_cast<const int16_t*>(audioFrame->data());
+		auto count = audioFrame->dataSize() / static_cast<int>(sizeof(int16_t));
+		int peak = 0;
+		for (int i = 0; samples && i < count; ++i) {
+			peak = std::max(peak, std::abs(static_cast<int>(samples[i])));
+		}
+		external_audio_volume_ = peak * 255 / 32768;
+		if (auto observer = audioFrameObserver(bytertc::AudioFrameCallbackMethod::kAudioFrameCallbackRecord)) {
+			observer->onRecordAudioFrame(*audioFrame);
+		}
+		return bytertc::kReturnStatusSuccess;
+	}
+
+	int FakeRTCVideo::pullExternalAudioFrame(bytertc::IAudioFrame* audioFrame) {
+		return 0;
+	}
+
+	int FakeRTCVideo::setVideoCaptureConfig(const bytertc::VideoCaptureConfig& videoCaptureConfig) {
+		return 0;
+	}
+
+	void FakeRTCVideo::setVideoCaptureRotation(bytertc::VideoRotation rotation) {
+	}
+
+	void FakeRTCVideo::enableSimulcastMode(bool enabled) {
+	}
+
+	int FakeRTCVideo::setVideoEncoderConfig(const bytertc::VideoEncoderConfig& max_solution) {
+		return 0;
+	}
+
+	int FakeRTCVideo::setVideoEncoderConfig(const bytertc::VideoEncoderConfig& encoderConfig, const char* parameters) {
+		return 0;
+	}
+
+	int FakeRTCVideo::setVideoEncoderConfig(const bytertc::VideoEncoderConfig* channel_solutions, int solution_num) {
+		return 0;
+	}
+
+	int FakeRTCVideo::setScreenVideoEncoderConfig(const bytertc::ScreenVideoEncoderConfig& screen_solution) {
+		return 0;
+	}
+
+	int FakeRTCVideo::setVideoEncoderConfig(bytertc::StreamIndex index, const bytertc::VideoSolution* solutions, int solution_num) {
+		return 0;
+	}
+
+	int FakeRTCVideo::setLocalVideoCanvas(bytertc::StreamIndex index, const bytertc::VideoCanvas& canvas) {
+		return 0;
+	}
+
+	void FakeRTCVideo::updateLocalVideoCanvas(bytertc::StreamIndex index, const enum bytertc::RenderMode renderMode, const uint32_t backgroundColor) {
+	}
+
+	void FakeRTCVideo::setRemoteVideoCanvas(bytertc::RemoteStreamKey stream_key, const bytertc::VideoCanvas& canvas) {
+	}
+
+	void FakeRTCVideo::updateRemoteStreamVideoCanvas(bytertc::RemoteStreamKey stream_key, const enum bytertc::RenderMode renderMode, const uint32_t backgroundColor) {
+	}
+
+	void FakeRTCVideo::switchCamera(bytertc::CameraID camera_id) {
+	}
+
+	int FakeRTCVideo::pushScreenVideoFrame(bytertc::IVideoFrame* frame) {
+		return 0;
+	}
+
+	void FakeRTCVideo::setOriginalScreenVideoInfo(int originalCaptureWidth, int originalCaptureHeight) {
+	}
+
+	void FakeRTCVideo::updateScreenCaptureRegion(const bytertc::Rectangle& region_rect) {
+	}
+
+	void FakeRTCVideo::updateScreenCaptureHighlightConfig(const bytertc::HighlightConfig& highlight_config) {
+	}
+
+	void FakeRTCVideo::updateScreenCaptureMouseCursor(bytertc::MouseCursorCaptureState capture_mouse_cursor) {
+	}
+
+	void FakeRTCVideo::updateScreenCaptureFilterConfig(const bytertc::ScreenFilterConfig& filter_config) {
+	}
+
+	// {zh} 切换到外部源时停止内部采集
+	// {en} Switching to the external source stops the internal capture
+	void FakeRTCVideo::setVideoSourceType(bytertc::StreamIndex stream_index, bytertc::VideoSourceType type) {
+		if (stream_index != bytertc::kStreamIndexMain) {
+			return;
+		}
+		auto external = type == bytertc::kVideoSourceTypeExternal;
+		if (external) {
+			stopVideoCapture();
+		}
+		external_first_frame_ = false;
+		external_video_ = external;
+	}
+
+	// {zh} 引擎接管帧，交给本地视频渲染器或直接释放
+	// {en} The engine takes ownership of the frame, handing it to the local video sink or releasing it
+	int FakeRTCVideo::pushExternalVideoFrame(bytertc::IVideoFrame* frame) {
+		if (!frame) {
+			return bytertc::kReturnStatusParameterErr;
+		}
+		if (!external_video_) {
+			++external_rejected_;
+			frame->release();
+			return bytertc::kReturnStatusWrongState;
+		}
+		++external_video_frames_;
+		if (!external_first_frame_.exchange(true)) {
+			bytertc::VideoFrameInfo info;
+			info.width = frame->width();
+			info.height = frame->height();
+			scheduler_->postDelayed(this, 0, [this, info]() {
+				if (handler_) {
+					handler_->onFirstLocalVideoFrameCaptured(bytertc::kStreamIndexMain, info);
+				}
+			});
+		}
+		std::lock_guard<std::mutex> lock(sink_mutex_);
+		if (local_sink_) {
+			local_sink_->onFrame(frame);
+		}
+		else {
+			frame->release();
+		}
+		return bytertc::kReturnStatusSuccess;
+	}
+
+	int FakeRTCVideo::setAudioPlaybackDevice(bytertc::AudioPlaybackDevice device) {
+		return 0;
+	}
+
+	void FakeRTCVideo::setAudioRoute(bytertc::AudioRoute route) {
+	}
+
+	int FakeRTCVideo::setDefaultAudioRoute(bytertc::AudioRoute route) {
+		return 0;
+	}
+
+	bytertc::AudioRoute FakeRTCVideo::getAudioRoute() {
+		return bytertc::kAudioRouteSpeakerphone;
+	}
+
+	void FakeRTCVideo::setPublishFallbackOption(bytertc::PublishFallbackOption option) {
+	}
+
+	void FakeRTCVideo::setSubscribeFallbackOption(bytertc::SubscribeFallbackOption option) {
+	}
+
+	int FakeRTCVideo::setRemoteUserPriority(const char* room_id, const char* user_id, bytertc::RemoteUserPriority priority) {
+		return 0;
+	}
+
+	int FakeRTCVideo::setBusinessId(const char* business_id) {
+		return 0;
+	}
+
+	void FakeRTCVideo::setVideoRotationMode(bytertc::VideoRotationMode rotationMode) {
+	}
+
+	void FakeRTCVideo::setLocalVideoMirrorType(bytertc::MirrorType mirrorType) {
+	}
+
+	bytertc::IVideoEffect* FakeRTCVideo::getVideoEffectInterface() {
+		return nullptr;
+	}
+
+	int FakeRTCVideo::enableEffectBeauty(bool enable) {
+		return 0;
+	}
+
+	int FakeRTCVideo::setBeautyIntensity(bytertc::EffectBeautyMode beauty_mode, float intensity) {
+		return 0;
+	}
+
+	int FakeRTCVideo::setRemoteVideoSuperResolution(bytertc::RemoteStreamKey stream_key, bytertc::VideoSuperResolutionMode mode) {
+		return 0;
+	}
+
+	int FakeRTCVideo::setVideoDenoiser(bytertc::VideoDenoiseMode mode) {
+		return 0;
+	}
+
+	void FakeRTCVideo::setVideoOrientation(bytertc::VideoOrientation orientation) {
+	}
+
+	bytertc::ICameraControl* FakeRTCVideo::getCameraControl() {
+		return nullptr;
+	}
+
+	void FakeRTCVideo::setEncryptInfo(bytertc::EncryptType encrypt_type, const char* key, int key_size) {
+	}
+
+	void FakeRTCVideo::setCustomizeEncryptHandler(bytertc::IEncryptHandler* handler) {
+	}
+
+	void FakeRTCVideo::enableAudioFrameCallback(bytertc::AudioFrameCallbackMethod method, bytertc::AudioFormat format) {
+		auto bit = 1 << static_cast<int>(method);
+		if ((audio_callbacks_.fetch_or(bit) & bit) != 0) {
+			return;
+		}
+		if (method == bytertc::AudioFrameCallbackMethod::kAudioFrameCallbackRecord) {
+			scheduler_->postRepeating(&audio_callbacks_, 10, [this]() { deliverRecordFrame(); });
+		}
+	}
+
+	void FakeRTCVideo::disableAudioFrameCallback(bytertc::AudioFrameCallbackMethod method) {
+		auto bit = 1 << static_cast<int>(method);
+		audio_callbacks_.fetch_and(~bit);
+		if (method == bytertc::AudioFrameCallbackMethod::kAudioFrameCallbackRecord) {
+			scheduler_->cancel(&audio_callbacks_);
+		}
+	}
+
+	void FakeRTCVideo::registerAudioFrameObserver(bytertc::IAudioFrameObserver* observer) {
+		audio_observer_ = observer;
+	}
+
+	void FakeRTCVideo::registerLocalAudioProcessor(bytertc::IAudioProcessor* processor, bytertc::AudioFormat audioFormat) {
+	}
+
+	void FakeRTCVideo::registerAudioProcessor(bytertc::IAudioFrameProcessor* processor) {
+	}
+
+	void FakeRTCVideo::enableAudioProcessor(bytertc::AudioProcessorMethod method, bytertc::AudioFormat format) {
+	}
+
+	void FakeRTCVideo::disableAudioProcessor(bytertc::AudioProcessorMethod method) {
+	}
+
+	void FakeRTCVideo::registerVideoFrameObserver(bytertc::IVideoFrameObserver* observer) {
+	}
+
+	int FakeRTCVideo::registerLocalVideoProcessor(bytertc::IVideoProcessor* processor, bytertc::VideoPreprocessorConfig config) {
+		return 0;
+	}
+
+	void FakeRTCVideo::setVideoDigitalZoomConfig(bytertc::ZoomConfigType type, float size) {
+	}
+
+	void FakeRTCVideo::setVideoDigitalZoomControl(bytertc::ZoomDirectionType direction) {
+	}
+
+	void FakeRTCVideo::startVideoDigitalZoomControl(bytertc::ZoomDirectionType direction) {
+	}
+
+	void FakeRTCVideo::stopVideoDigitalZoomControl() {
+	}
+
+	void FakeRTCVideo::registerRemoteAudioFrameObserver(bytertc::IRemoteAudioFrameObserver* observer) {
+	}
+
+	int FakeRTCVideo::sendSEIMessage(bytertc::StreamIndex stream_index, const uint8_t* message, int length, int repeat_count) {
+		return 0;
+	}
+
+	int FakeRTCVideo::sendSEIMessage(bytertc::StreamIndex stream_index, const uint8_t* message, int length, int repeat_count, bytertc::SEICountPerFrame mode) {
+		return 0;
+	}
+
+	int FakeRTCVideo::startFileRecording(bytertc::StreamIndex type, bytertc::RecordingConfig config, bytertc::RecordingType recording_type) {
+		return 0;
+	}
+
+	void FakeRTCVideo::stopFileRecording(bytertc::StreamIndex type) {
+	}
+
+	int FakeRTCVideo::startAudioRecording(bytertc::AudioRecordingConfig& config) {
+		return 0;
+	}
+
+	int FakeRTCVideo::stopAudioRecording() {
+		return 0;
+	}
+
+	void FakeRTCVideo::enableExternalSoundCard(bool enable) {
+	}
+
+	void FakeRTCVideo::setRuntimeParameters(const char * json_string) {
+	}
+
+	void FakeRTCVideo::startASR(const bytertc::RTCASRConfig& asr_config, bytertc::IRTCASREngineEventHandler* handler) {
+	}
+
+	void FakeRTCVideo::stopASR() {
+	}
+
+	bytertc::IAudioMixingManager* FakeRTCVideo::getAudioMixingManager() {
+		return nullptr;
+	}
+
+	void FakeRTCVideo::updateLoginToken(const char* token) {
+	}
+
+	void FakeRTCVideo::getPeerOnlineStatus(const char* peer_user_id) {
+	}
+
+	int64_t FakeRTCVideo::sendUserMessageOutsideRoom(const char* uid, const char* message, bytertc::MessageConfig config) {
+		return 0;
+	}
+
+	int64_t FakeRTCVideo::sendUserBinaryMessageOutsideRoom(const char* uid, int length, const uint8_t* message, bytertc::MessageConfig config) {
+		return 0;
+	}
+
+	int64_t FakeRTCVideo::sendServerBinaryMessage(int length, const uint8_t* message) {
+		return 0;
+	}
+
+	bytertc::NetworkDetectionStartReturn FakeRTCVideo::startNetworkDetection(bool is_test_uplink, int expected_uplink_bitrate, bool is_test_downlink, int expected_downlink_biterate) {
+		return bytertc::kNetworkDetectionStartReturnSuccess;
+	}
+
+	void FakeRTCVideo::stopNetworkDetection() {
+	}
+
+	void FakeRTCVideo::setScreenAudioSourceType(bytertc::AudioSourceType source_type) {
+	}
+
+	void FakeRTCVideo::setScreenAudioStreamIndex(bytertc::StreamIndex index) {
+	}
+
+	void FakeRTCVideo::setScreenAudioChannel(bytertc::AudioChannel channel) {
+	}
+
+	void FakeRTCVideo::startScreenAudioCapture() {
+	}
+
+	void FakeRTCVideo::startScreenAudioCapture(const char device_id[bytertc::MAX_DEVICE_ID_LENGTH]) {
+	}
+
+	void FakeRTCVideo::stopScreenAudioCapture() {
+	}
+
+	int FakeRTCVideo::pushScreenAudioFrame(bytertc::IAudioFrame* frame) {
+		return 0;
+	}
+
+	void FakeRTCVideo::setAudioAlignmentProperty(const bytertc::RemoteStreamKey& streamKey, bytertc::AudioAlignmentMode mode) {
+	}
+
+	void FakeRTCVideo::setExtensionConfig(const char* group_id) {
+	}
+
+	void FakeRTCVideo::sendScreenCaptureExtensionMessage(const char* message, size_t size) {
+	}
+
+	void FakeRTCVideo::startScreenCapture(bytertc::ScreenMediaType type, const char* bundle_id) {
+	}
+
+	void FakeRTCVideo::startScreenCapture(bytertc::ScreenMediaType type, void* context) {
+	}
+
+	void FakeRTCVideo::stopScreenCapture() {
+	}
+
+	void FakeRTCVideo::startLiveTranscoding(const char* task_id, bytertc::ITranscoderParam* param, bytertc::ITranscoderObserver* observer) {
+	}
+
+	void FakeRTCVideo::stopLiveTranscoding(const char* task_id) {
+	}
+
+	void FakeRTCVideo::updateLiveTranscoding(const char* task_id, bytertc::ITranscoderParam* param) {
+	}
+
+	int FakeRTCVideo::startPushMixedStreamToCDN(const char* task_id, bytertc::IMixedStreamConfig* config, bytertc::IMixedStreamObserver* observer) {
+		return 0;
+	}
+
+	int FakeRTCVideo::updatePushMixedStreamToCDN(const char* task_id, bytertc::IMixedStreamConfig* config) {
+		return 0;
+	}
+
+	void FakeRTCVideo::startPushSingleStreamToCDN(const char* task_id, bytertc::PushSingleStreamParam& param, bytertc::IPushSingleStreamToCDNObserver* observer) {
+	}
+
+	void FakeRTCVideo::stopPushStreamToCDN(const char* task_id) {
+	}
+
+	int FakeRTCVideo::startPushPublicStream(const char* public_stream_id, bytertc::IPublicStreamParam* param) {
+		return 0;
+	}
+
+	int FakeRTCVideo::stopPushPublicStream(const char* public_stream_id) {
+		return 0;
+	}
+
+	int FakeRTCVideo::updatePublicStreamParam(const char* public_stream_id, bytertc::IPublicStreamParam* param) {
+		return 0;
+	}
+
+	void FakeRTCVideo::updateScreenCapture(bytertc::ScreenMediaType type) {
+	}
+
+	int FakeRTCVideo::setRemoteAudioPlaybackVolume(const char* room_id, const char* user_id, int volume) {
+		return 0;
+	}
+
+	void FakeRTCVideo::enableVocalInstrumentBalance(bool enable) {
+	}
+
+	void FakeRTCVideo::enablePlaybackDucking(bool enable) {
+	}
+
+	void FakeRTCVideo::registerLocalEncodedVideoFrameObserver(bytertc::ILocalEncodedVideoFrameObserver* observer) {
+	}
+
+	void FakeRTCVideo::registerRemoteEncodedVideoFrameObserver(bytertc::IRemoteEncodedVideoFrameObserver* observer) {
+	}
+
+	void FakeRTCVideo::setExternalVideoEncoderEventHandler(bytertc::IExternalVideoEncoderEventHandler* encoder_handler) {
+	}
+
+	int FakeRTCVideo::pushExternalEncodedVideoFrame(bytertc::StreamIndex index, int video_index, bytertc::IEncodedVideoFrame* video_stream) {
+		return 0;
+	}
+
+	void FakeRTCVideo::setVideoDecoderConfig(bytertc::RemoteStreamKey key, bytertc::VideoDecoderConfig config) {
+	}
+
+	void FakeRTCVideo::requestRemoteVideoKeyFrame(const bytertc::RemoteStreamKey& stream_info) {
+	}
+
+	int FakeRTCVideo::sendStreamSyncInfo(const uint8_t* data, int32_t length, const bytertc::StreamSycnInfoConfig& config) {
+		return 0;
+	}
+
+	void FakeRTCVideo::setLocalVoicePitch(int pitch) {
+	}
+
+	void FakeRTCVideo::muteAudioPlayback(bytertc::MuteState mute_state) {
+	}
+
+	int FakeRTCVideo::startPlayPublicStream(const char* public_stream_id) {
+		return 0;
+	}
+
+	int FakeRTCVideo::stopPlayPublicStream(const char* public_stream_id) {
+		return 0;
+	}
+
+	int FakeRTCVideo::setPublicStreamVideoCanvas(const char* public_stream_id, const bytertc::VideoCanvas& canvas) {
+		return 0;
+	}
+
+	int FakeRTCVideo::setPublicStreamVideoSink(const char* public_stream_id, bytertc::IVideoSink* video_sink, bytertc::IVideoSink::PixelFormat format) {
+		return 0;
+	}
+
+	int FakeRTCVideo::setPublicStreamAudioPlaybackVolume(const char* public_stream_id, int volume) {
+		return 0;
+	}
+
+	void FakeRTCVideo::setVideoWatermark(bytertc::StreamIndex streamIndex, const char* image_path, bytertc::RTCWatermarkConfig config) {
+	}
+
+	void FakeRTCVideo::clearVideoWatermark(bytertc::StreamIndex streamIndex) {
+	}
+
+	long FakeRTCVideo::takeLocalSnapshot(const bytertc::StreamIndex streamIndex, bytertc::ISnapshotResultCallback* callback) {
+		return 0;
+	}
+
+	long FakeRTCVideo::takeRemoteSnapshot(const bytertc::RemoteStreamKey streamKey, bytertc::ISnapshotResultCallback* callback) {
+		return 0;
+	}
+
+	int FakeRTCVideo::setDummyCaptureImagePath(const char* file_path) {
+		return 0;
+	}
+
+	void FakeRTCVideo::startCloudProxy(const bytertc::CloudProxyConfiguration& configuration) {
+	}
+
+	void FakeRTCVideo::stopCloudProxy() {
+	}
+
+	int FakeRTCVideo::startEchoTest(bytertc::EchoTestConfig echo_test_config, unsigned int play_delay_time) {
+		return 0;
+	}
+
+	int FakeRTCVideo::stopEchoTest() {
+		return 0;
+	}
+
+	bytertc::ISingScoringManager* FakeRTCVideo::getSingScoringManager() {
+		return nullptr;
+	}
+
+	bytertc::NetworkTimeInfo FakeRTCVideo::getNetworkTimeInfo() {
+		return bytertc::NetworkTimeInfo(0);
+	}
+
+	int FakeRTCVideo::invokeExperimentalAPI(const char* param) {
+		return 0;
+	}
+
+	bytertc::IKTVManager* FakeRTCVideo::getKTVManager() {
+		return nullptr;
+	}
+
+	int FakeRTCVideo::startHardwareEchoDetection(const char* test_audio_file_path) {
+		return 0;
+	}
+
+	int FakeRTCVideo::stopHardwareEchoDetection() {
+		return 0;
+	}
+
+	void FakeRTCVideo::setCellularEnhancement(const bytertc::MediaTypeEnhancementConfig& config) {
+	}
+
+	int FakeRTCVideo::setLocalProxy(const bytertc::LocalProxyConfiguration* configurations, int configuration_num) {
+		return 0;
+	}
+
+	void FakeRTCVideo::reportLocalAudio() {
+		if (!handler_) {
+			return;
+		}
+		bytertc::LocalAudioPropertiesInfo info;
+		info.stream_index = bytertc::kStreamIndexMain;
+		if (external_audio_) {
+			info.audio_properties_info.linear_volume = external_audio_volume_;
+			info.audio_properties_info.nonlinear_volume = external_audio_volume_;
+			info.audio_properties_info.vad = external_audio_volume_ > 0 ? 1 : 0;
+		}
+		else if (audio_capturing_) {
+			local_volume_tick_ = (local_volume_tick_ + 1) % 32;
+			info.audio_properties_info.linear_volume = local_volume_tick_ < 16 ? local_volume_tick_ * 8 : 0;
+			info.audio_properties_info.nonlinear_volume = info.audio_properties_info.linear_volume;
+			info.audio_properties_info.vad = local_volume_tick_ < 16 ? 1 : 0;
+		}
+		handler_->onLocalAudioPropertiesReport(&info, 1);
+	}
+
+	void FakeRTCVideo::deliverRecordFrame() {
+		auto observer = audioFrameObserver(bytertc::AudioFrameCallbackMethod::kAudioFrameCallbackRecord);
+		if (!observer || external_audio_ || !audio_capturing_) {
+			return;
+		}
+		const int kSampleRate = 48000;
+		record_samples_.resize(kSampleRate / 100);
+		// {zh} 每3.2秒中前1.6秒在说话
+		// {en} Speaking for the first 1.6 s of every 3.2 s
+		auto speaking = record_sample_index_ % (kSampleRate * 32 / 10) < static_cast<uint64_t>(kSampleRate * 16 / 10);
+		FakeAudioFrame::synthesize(record_samples_.data(), record_samples_.size(), kSampleRate, record_sample_index_,
+			speaking, 0);
+		record_sample_index_ += record_samples_.size();
+
+		bytertc::AudioFrameBuilder builder;
+		builder.sample_rate = bytertc::kAudioSampleRate48000;
+		builder.channel = bytertc::kAudioChannelMono;
+		builder.timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+		builder.data = reinterpret_cast<uint8_t*>(record_samples_.data());
+		builder.data_size = static_cast<int64_t>(record_samples_.size() * sizeof(int16_t));
+		builder.deep_copy = false;
+		auto frame = FakeAudioFrame::build(builder);
+		observer->onRecordAudioFrame(*frame);
+		frame->release();
+	}
+
+	void FakeRTCVideo::deliverLocalFrame() {
+		std::lock_guard<std::mutex> lock(sink_mutex_);
+		if (!local_sink_) {
+			return;
+		}
+		const auto& config = scenario();
+		auto timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+		local_sink_->onFrame(FakeVideoFrame::createI420(config.frame_width, config.frame_height,
+			timestamp, local_frame_index_++));
+	}
+
+	/** {zh}
+	* 模拟业务服务器：确认消息已送达，再以200回复该请求，response 带上进房所需的字段
+	*/
+
+	/** {en}
+	* Simulated business server: acknowledges the message, then answers the request with 200, the response carrying the fields a room join needs
+	*/
+	void FakeRTCVideo::answerServerMessage(int64_t message_id, const std::string& message) {
+		if (!handler_) {
+			return;
+		}
+		bytertc::ServerACKMsg ack = {};
+		handler_->onServerMessageSendResult(message_id, bytertc::kUserMessageSendResultSuccess, ack);
+
+		auto requestId = readStringField(message, "request_id");
+		if (requestId.empty()) {
+			return;
+		}
+		auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::system_clock::now().time_since_epoch()).count();
+		auto reply = "{\"message_type\":\"return\",\"request_id\":\"" + requestId
+			+ "\",\"code\":200,\"message\":\"ok\",\"timestamp\":" + std::to_string(timestamp)
+			+ ",\"response\":{\"rtc_token\":\"fake_rtc_token\",\"duration\":0}}";
+		handler_->onUserMessageReceivedOutsideRoom(kServerUserId, reply.c_str());
+	}
+
+	std::string FakeRTCVideo::sinkKey(const std::string& room_id, const std::string& user_id, bytertc::StreamIndex index) {
+		return room_id + '/' + user_id + '/' + std::to_string(static_cast<int>(index));
+	}
+}
+}
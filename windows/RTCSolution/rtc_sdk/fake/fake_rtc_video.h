@@ -0,0 +1,270 @@
+﻿#ifndef VRD_FAKE_RTC_VIDEO_H
+#define VRD_FAKE_RTC_VIDEO_H
+
+#include "bytertc_video.h"
+#include "bytertc_video_event_handler.h"
+#include "fake_device_manager.h"
+#include "fake_rtc.h"
+#include "fake_scheduler.h"
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace vrd
+{
+namespace fake
+{
+	/** {zh}
+	 * IRTCVideo 的替身实现，不采集、不编解码、不联网
+	 * 1, login、setServerParams 和 sendServerMessage 经模拟时延后回调成功，RTS请求由本地模拟服务端回复200
+	 * 2, 开启采集后按帧率向本地视频渲染器推送I420测试帧，按 enableAudioPropertiesReport 的间隔回调本地音量
+	 * 3, 远端用户、流统计和远端帧由 FakeRTCRoom 模拟，所有回调都在 Scheduler 线程发出
+	 * 4, 外部视频源推入的帧交给本地视频渲染器；外部音频源时本地音量取自推入的PCM
+	 * 5, 开启音频帧回调后，本地采集每10毫秒回调一帧合成的48kHz单声道PCM（外部音频源时回调推入的帧），远端用户的帧由 FakeRTCRoom 回调
+	 */
+
+	/** {en}
+	* Stand-in implementation of IRTCVideo without capture, codecs or networking
+	* 1, login, setServerParams and sendServerMessage succeed after a simulated latency, RTS requests are answered with 200 by a local fake server
+	* 2, Once capture starts, I420 test frames go to the local video sink at the frame rate and the local volume is reported at the enableAudioPropertiesReport interval
+	* 3, Remote users, stream stats and remote frames are simulated by FakeRTCRoom, every callback is issued on the Scheduler thread
+	* 4, With an external video source, pushed frames go to the local video sink; with an external audio source, the local volume follows the pushed PCM
+	* 5, With audio frame callbacks on, local capture calls back a synthesized 48 kHz mono PCM frame every 10 ms (the pushed frames with an external audio source),
+	*    remote users' frames are called back by FakeRTCRoom
+	*/
+	class FakeRTCVideo final : public bytertc::IRTCVideo {
+	public:
+		FakeRTCVideo(const char* app_id, bytertc::IRTCVideoEventHandler* handler);
+		~FakeRTCVideo();
+
+		Scheduler& scheduler();
+		bytertc::IRTCVideoEventHandler* handler() const;
+		int audioReportIntervalMs() const;
+		ExternalMediaStats externalMediaStats() const;
+		// {zh} 该类音频帧回调已开启时返回观察者，否则为空
+		// {en} Returns the observer when that kind of audio frame callback is enabled, null otherwise
+		bytertc::IAudioFrameObserver* audioFrameObserver(bytertc::AudioFrameCallbackMethod method) const;
+		// {zh} 交给已设置的远端视频渲染器，渲染器负责释放该帧；未设置渲染器时直接释放
+		// {en} Hands the frame to the remote video sink set for the stream, the sink releases it; released right away when no sink is set
+		void deliverRemoteFrame(const std::string& room_id, const std::string& user_id,
+			bytertc::StreamIndex index, bytertc::IVideoFrame* frame);
+
+		void setCaptureVolume(bytertc::StreamIndex index, int volume) override;
+		void setPlaybackVolume(const int volume) override;
+		void setEarMonitorMode(bytertc::EarMonitorMode mode) override;
+		void setEarMonitorVolume(const int volume) override;
+		void setBluetoothMode(bytertc::BluetoothMode mode) override;
+		void startAudioCapture() override;
+		void stopAudioCapture() override;
+		void setAudioScenario(bytertc::AudioScenarioType scenario) override;
+		int setVoiceChangerType(bytertc::VoiceChangerType voice_changer) override;
+		int setVoiceReverbType(bytertc::VoiceReverbType voice_reverb) override;
+		int setLocalVoiceEqualization(bytertc::VoiceEqualizationConfig config) override;
+		int setLocalVoiceReverbParam(bytertc::VoiceReverbConfig param) override;
+		int enableLocalVoiceReverb(bool enable) override;
+		void setAudioProfile(bytertc::AudioProfileType audio_profile) override;
+		void setAnsMode(bytertc::AnsMode ans_mode) override;
+		int enableAGC(bool enable) override;
+		int setAudioSourceType(bytertc::AudioSourceType type) override;
+		int setAudioRenderType(bytertc::AudioRenderType type) override;
+		int pushExternalAudioFrame(bytertc::IAudioFrame* audioFrame) override;
+		int pullExternalAudioFrame(bytertc::IAudioFrame* audioFrame) override;
+		void startVideoCapture() override;
+		void stopVideoCapture() override;
+		int setVideoCaptureConfig(const bytertc::VideoCaptureConfig& videoCaptureConfig) override;
+		void setVideoCaptureRotation(bytertc::VideoRotation rotation) override;
+		void enableSimulcastMode(bool enabled) override;
+		int setVideoEncoderConfig(const bytertc::VideoEncoderConfig& max_solution) override;
+		int setVideoEncoderConfig(const bytertc::VideoEncoderConfig& encoderConfig, const char* parameters) override;
+		int setVideoEncoderConfig(const bytertc::VideoEncoderConfig* channel_solutions, int solution_num) override;
+		int setScreenVideoEncoderConfig(const bytertc::ScreenVideoEncoderConfig& screen_solution) override;
+		int setVideoEncoderConfig(bytertc::StreamIndex index, const bytertc::VideoSolution* solutions, int solution_num) override;
+		int setLocalVideoCanvas(bytertc::StreamIndex index, const bytertc::VideoCanvas& canvas) override;
+		void updateLocalVideoCanvas(bytertc::StreamIndex index, const enum bytertc::RenderMode renderMode, const uint32_t backgroundColor) override;
+		void setRemoteVideoCanvas(bytertc::RemoteStreamKey stream_key, const bytertc::VideoCanvas& canvas) override;
+		void updateRemoteStreamVideoCanvas(bytertc::RemoteStreamKey stream_key, const enum bytertc::RenderMode renderMode, const uint32_t backgroundColor) override;
+		void setLocalVideoSink(bytertc::StreamIndex index, bytertc::IVideoSink* video_sink, bytertc::IVideoSink::PixelFormat required_format) override;
+		void setRemoteVideoSink(bytertc::RemoteStreamKey stream_key, bytertc::IVideoSink* video_sink, bytertc::IVideoSink::PixelFormat required_format) override;
+		void switchCamera(bytertc::CameraID camera_id) override;
+		int pushScreenVideoFrame(bytertc::IVideoFrame* frame) override;
+		void setOriginalScreenVideoInfo(int originalCaptureWidth, int originalCaptureHeight) override;
+		void updateScreenCaptureRegion(const bytertc::Rectangle& region_rect) override;
+		int startScreenVideoCapture(const bytertc::ScreenCaptureSourceInfo& source_info, const bytertc::ScreenCaptureParameters& capture_params) override;
+		void stopScreenVideoCapture() override;
+		void updateScreenCaptureHighlightConfig(const bytertc::HighlightConfig& highlight_config) override;
+		void updateScreenCaptureMouseCursor(bytertc::MouseCursorCaptureState capture_mouse_cursor) override;
+		void updateScreenCaptureFilterConfig(const bytertc::ScreenFilterConfig& filter_config) override;
+		bytertc::IScreenCaptureSourceList* getScreenCaptureSourceList() override;
+		bytertc::IVideoFrame* getThumbnail(bytertc::ScreenCaptureSourceType type, bytertc::view_t source_id, int max_width, int max_height) override;
+		bytertc::IVideoFrame* getWindowAppIcon(bytertc::view_t source_id, int max_width = 100, int max_height = 100) override;
+		void setVideoSourceType(bytertc::StreamIndex stream_index, bytertc::VideoSourceType type) override;
+		int pushExternalVideoFrame(bytertc::IVideoFrame* frame) override;
+		int setAudioPlaybackDevice(bytertc::AudioPlaybackDevice device) override;
+		void setAudioRoute(bytertc::AudioRoute route) override;
+		int setDefaultAudioRoute(bytertc::AudioRoute route) override;
+		bytertc::AudioRoute getAudioRoute() override;
+		bytertc::IRTCRoom* createRTCRoom(const char* room_id) override;
+		void setPublishFallbackOption(bytertc::PublishFallbackOption option) override;
+		void setSubscribeFallbackOption(bytertc::SubscribeFallbackOption option) override;
+		int setRemoteUserPriority(const char* room_id, const char* user_id, bytertc::RemoteUserPriority priority) override;
+		int setBusinessId(const char* business_id) override;
+		void setVideoRotationMode(bytertc::VideoRotationMode rotationMode) override;
+		void setLocalVideoMirrorType(bytertc::MirrorType mirrorType) override;
+		bytertc::IVideoEffect* getVideoEffectInterface() override;
+		int enableEffectBeauty(bool enable) override;
+		int setBeautyIntensity(bytertc::EffectBeautyMode beauty_mode, float intensity) override;
+		int setRemoteVideoSuperResolution(bytertc::RemoteStreamKey stream_key, bytertc::VideoSuperResolutionMode mode) override;
+		int setVideoDenoiser(bytertc::VideoDenoiseMode mode) override;
+		void setVideoOrientation(bytertc::VideoOrientation orientation) override;
+		bytertc::ICameraControl* getCameraControl() override;
+		void setEncryptInfo(bytertc::EncryptType encrypt_type, const char* key, int key_size) override;
+		void setCustomizeEncryptHandler(bytertc::IEncryptHandler* handler) override;
+		void enableAudioFrameCallback(bytertc::AudioFrameCallbackMethod method, bytertc::AudioFormat format) override;
+		void disableAudioFrameCallback(bytertc::AudioFrameCallbackMethod method) override;
+		void registerAudioFrameObserver(bytertc::IAudioFrameObserver* observer) override;
+		void registerLocalAudioProcessor(bytertc::IAudioProcessor* processor, bytertc::AudioFormat audioFormat) override;
+		void registerAudioProcessor(bytertc::IAudioFrameProcessor* processor) override;
+		void enableAudioProcessor(bytertc::AudioProcessorMethod method, bytertc::AudioFormat format) override;
+		void disableAudioProcessor(bytertc::AudioProcessorMethod method) override;
+		void registerVideoFrameObserver(bytertc::IVideoFrameObserver* observer) override;
+		int registerLocalVideoProcessor(bytertc::IVideoProcessor* processor, bytertc::VideoPreprocessorConfig config) override;
+		void setVideoDigitalZoomConfig(bytertc::ZoomConfigType type, float size) override;
+		void setVideoDigitalZoomControl(bytertc::ZoomDirectionType direction) override;
+		void startVideoDigitalZoomControl(bytertc::ZoomDirectionType direction) override;
+		void stopVideoDigitalZoomControl() override;
+		void registerRemoteAudioFrameObserver(bytertc::IRemoteAudioFrameObserver* observer) override;
+		int sendSEIMessage(bytertc::StreamIndex stream_index, const uint8_t* message, int length, int repeat_count) override;
+		int sendSEIMessage(bytertc::StreamIndex stream_index, const uint8_t* message, int length, int repeat_count, bytertc::SEICountPerFrame mode) override;
+		bytertc::IVideoDeviceManager* getVideoDeviceManager() override;
+		bytertc::IAudioDeviceManager* getAudioDeviceManager() override;
+		int startFileRecording(bytertc::StreamIndex type, bytertc::RecordingConfig config, bytertc::RecordingType recording_type) override;
+		void stopFileRecording(bytertc::StreamIndex type) override;
+		int startAudioRecording(bytertc::AudioRecordingConfig& config) override;
+		int stopAudioRecording() override;
+		void enableExternalSoundCard(bool enable) override;
+		void setRuntimeParameters(const char * json_string) override;
+		void startASR(const bytertc::RTCASRConfig& asr_config, bytertc::IRTCASREngineEventHandler* handler) override;
+		void stopASR() override;
+		int feedback(uint64_t type, const bytertc::ProblemFeedbackInfo* info) override;
+		bytertc::IAudioMixingManager* getAudioMixingManager() override;
+		int login(const char* token, const char* uid) override;
+		void logout() override;
+		void updateLoginToken(const char* token) override;
+		void setServerParams(const char* signature, const char* url) override;
+		void getPeerOnlineStatus(const char* peer_user_id) override;
+		int64_t sendUserMessageOutsideRoom(const char* uid, const char* message, bytertc::MessageConfig config = bytertc::kMessageConfigReliableOrdered) override;
+		int64_t sendUserBinaryMessageOutsideRoom(const char* uid, int length, const uint8_t* message, bytertc::MessageConfig config = bytertc::kMessageConfigReliableOrdered) override;
+		int64_t sendServerMessage(const char* message) override;
+		int64_t sendServerBinaryMessage(int length, const uint8_t* message) override;
+		bytertc::NetworkDetectionStartReturn startNetworkDetection(bool is_test_uplink, int expected_uplink_bitrate, bool is_test_downlink, int expected_downlink_biterate) override;
+		void stopNetworkDetection() override;
+		void setScreenAudioSourceType(bytertc::AudioSourceType source_type) override;
+		void setScreenAudioStreamIndex(bytertc::StreamIndex index) override;
+		void setScreenAudioChannel(bytertc::AudioChannel channel) override;
+		void startScreenAudioCapture() override;
+		void startScreenAudioCapture(const char device_id[bytertc::MAX_DEVICE_ID_LENGTH]) override;
+		void stopScreenAudioCapture() override;
+		int pushScreenAudioFrame(bytertc::IAudioFrame* frame) override;
+		void setAudioAlignmentProperty(const bytertc::RemoteStreamKey& streamKey, bytertc::AudioAlignmentMode mode) override;
+		void setExtensionConfig(const char* group_id) override;
+		void sendScreenCaptureExtensionMessage(const char* message, size_t size) override;
+		void startScreenCapture(bytertc::ScreenMediaType type, const char* bundle_id) override;
+		void startScreenCapture(bytertc::ScreenMediaType type, void* context) override;
+		void stopScreenCapture() override;
+		void startLiveTranscoding(const char* task_id, bytertc::ITranscoderParam* param, bytertc::ITranscoderObserver* observer) override;
+		void stopLiveTranscoding(const char* task_id) override;
+		void updateLiveTranscoding(const char* task_id, bytertc::ITranscoderParam* param) override;
+		int startPushMixedStreamToCDN(const char* task_id, bytertc::IMixedStreamConfig* config, bytertc::IMixedStreamObserver* observer) override;
+		int updatePushMixedStreamToCDN(const char* task_id, bytertc::IMixedStreamConfig* config) override;
+		void startPushSingleStreamToCDN(const char* task_id, bytertc::PushSingleStreamParam& param, bytertc::IPushSingleStreamToCDNObserver* observer) override;
+		void stopPushStreamToCDN(const char* task_id) override;
+		int startPushPublicStream(const char* public_stream_id, bytertc::IPublicStreamParam* param) override;
+		int stopPushPublicStream(const char* public_stream_id) override;
+		int updatePublicStreamParam(const char* public_stream_id, bytertc::IPublicStreamParam* param) override;
+		void updateScreenCapture(bytertc::ScreenMediaType type) override;
+		void enableAudioPropertiesReport(const bytertc::AudioPropertiesConfig& config) override;
+		int setRemoteAudioPlaybackVolume(const char* room_id, const char* user_id, int volume) override;
+		void enableVocalInstrumentBalance(bool enable) override;
+		void enablePlaybackDucking(bool enable) override;
+		void registerLocalEncodedVideoFrameObserver(bytertc::ILocalEncodedVideoFrameObserver* observer) override;
+		void registerRemoteEncodedVideoFrameObserver(bytertc::IRemoteEncodedVideoFrameObserver* observer) override;
+		void setExternalVideoEncoderEventHandler(bytertc::IExternalVideoEncoderEventHandler* encoder_handler) override;
+		int pushExternalEncodedVideoFrame(bytertc::StreamIndex index, int video_index, bytertc::IEncodedVideoFrame* video_stream) override;
+		void setVideoDecoderConfig(bytertc::RemoteStreamKey key, bytertc::VideoDecoderConfig config) override;
+		void requestRemoteVideoKeyFrame(const bytertc::RemoteStreamKey& stream_info) override;
+		int sendStreamSyncInfo(const uint8_t* data, int32_t length, const bytertc::StreamSycnInfoConfig& config) override;
+		void setLocalVoicePitch(int pitch) override;
+		void muteAudioPlayback(bytertc::MuteState mute_state) override;
+		int startPlayPublicStream(const char* public_stream_id) override;
+		int stopPlayPublicStream(const char* public_stream_id) override;
+		int setPublicStreamVideoCanvas(const char* public_stream_id, const bytertc::VideoCanvas& canvas) override;
+		int setPublicStreamVideoSink(const char* public_stream_id, bytertc::IVideoSink* video_sink, bytertc::IVideoSink::PixelFormat format) override;
+		int setPublicStreamAudioPlaybackVolume(const char* public_stream_id, int volume) override;
+		void setVideoWatermark(bytertc::StreamIndex streamIndex, const char* image_path, bytertc::RTCWatermarkConfig config) override;
+		void clearVideoWatermark(bytertc::StreamIndex streamIndex) override;
+		long takeLocalSnapshot(const bytertc::StreamIndex streamIndex, bytertc::ISnapshotResultCallback* callback) override;
+		long takeRemoteSnapshot(const bytertc::RemoteStreamKey streamKey, bytertc::ISnapshotResultCallback* callback) override;
+		int setDummyCaptureImagePath(const char* file_path) override;
+		void startCloudProxy(const bytertc::CloudProxyConfiguration& configuration) override;
+		void stopCloudProxy() override;
+		int startEchoTest(bytertc::EchoTestConfig echo_test_config, unsigned int play_delay_time) override;
+		int stopEchoTest() override;
+		bytertc::ISingScoringManager* getSingScoringManager() override;
+		bytertc::NetworkTimeInfo getNetworkTimeInfo() override;
+		int invokeExperimentalAPI(const char* param) override;
+		bytertc::IKTVManager* getKTVManager() override;
+		int startHardwareEchoDetection(const char* test_audio_file_path) override;
+		int stopHardwareEchoDetection() override;
+		void setCellularEnhancement(const bytertc::MediaTypeEnhancementConfig& config) override;
+		int setLocalProxy(const bytertc::LocalProxyConfiguration* configurations, int configuration_num) override;
+
+	private:
+		void reportLocalAudio();
+		void deliverRecordFrame();
+		void deliverLocalFrame();
+		void answerServerMessage(int64_t message_id, const std::string& message);
+		static std::string sinkKey(const std::string& room_id, const std::string& user_id, bytertc::StreamIndex index);
+
+		// {zh} 最先构造、最后析构，设备管理器析构时仍需取消其任务
+		// {en} Constructed first and destroyed last, the device managers still cancel their tasks on destruction
+		std::unique_ptr<Scheduler> scheduler_;
+		bytertc::IRTCVideoEventHandler* handler_;
+		std::unique_ptr<FakeAudioDeviceManager> audio_device_manager_;
+		std::unique_ptr<FakeVideoDeviceManager> video_device_manager_;
+
+		std::mutex sink_mutex_;
+		std::map<std::string, bytertc::IVideoSink*> remote_sinks_;
+		bytertc::IVideoSink* local_sink_ = nullptr;
+
+		// {zh} 本地音量和本地视频帧的定时任务分别以这两个成员的地址作为 Scheduler 的 owner
+		// {en} The local volume and local frame tasks use the addresses of these two members as their Scheduler owner
+		std::atomic<bool> audio_capturing_{ false };
+		std::atomic<bool> video_capturing_{ false };
+		std::atomic<int> audio_report_interval_ms_{ 0 };
+		std::atomic<int64_t> next_message_id_{ 0 };
+		uint32_t local_frame_index_ = 0;
+		int local_volume_tick_ = 0;
+
+		// {zh} 外部源状态可在任意线程读写
+		// {en} External source state may be read and written on any thread
+		std::atomic<bool> external_video_{ false };
+		std::atomic<bool> external_audio_{ false };
+		std::atomic<bool> external_first_frame_{ false };
+		std::atomic<int> external_audio_volume_{ 0 };
+		std::atomic<int64_t> external_video_frames_{ 0 };
+		std::atomic<int64_t> external_audio_frames_{ 0 };
+		std::atomic<int64_t> external_rejected_{ 0 };
+
+		// {zh} 音频帧回调按方法位开启；本地采集帧的定时任务以 audio_callbacks_ 的地址作为 owner
+		// {en} Audio frame callbacks are enabled per method bit; the local capture frame task uses the address of audio_callbacks_ as its owner
+		std::atomic<bytertc::IAudioFrameObserver*> audio_observer_{ nullptr };
+		std::atomic<int> audio_callbacks_{ 0 };
+		std::vector<int16_t> record_samples_;
+		uint64_t record_sample_index_ = 0;
+	};
+}
+}
+
+#endif // VRD_FAKE_RTC_VIDEO_H
@@ -0,0 +1,109 @@
+﻿#include "fake_scheduler.h"
+
+namespace vrd
+{
+namespace fake
+{
+	Scheduler::Scheduler() {
+		thread_ = std::thread([this]() { run(); });
+	}
+
+	Scheduler::~Scheduler() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stopped_ = true;
+			tasks_.clear();
+		}
+		cv_.notify_all();
+		if (thread_.joinable()) {
+			thread_.join();
+		}
+	}
+
+	void Scheduler::post(const void* owner, std::function<void(void)>&& task) {
+		postDelayed(owner, 0, std::move(task));
+	}
+
+	void Scheduler::postDelayed(const void* owner, int delay_ms, std::function<void(void)>&& task) {
+		Task entry;
+		entry.owner = owner;
+		entry.fn = std::move(task);
+		schedule(Clock::now() + std::chrono::milliseconds(delay_ms), std::move(entry));
+	}
+
+	void Scheduler::postRepeating(const void* owner, int interval_ms, std::function<void(void)>&& task) {
+		if (interval_ms <= 0) {
+			return;
+		}
+		Task entry;
+		entry.owner = owner;
+		entry.interval_ms = interval_ms;
+		entry.fn = std::move(task);
+		schedule(Clock::now() + std::chrono::milliseconds(interval_ms), std::move(entry));
+	}
+
+	void Scheduler::cancel(const void* owner) {
+		std::unique_lock<std::mutex> lock(mutex_);
+		for (auto it = tasks_.begin(); it != tasks_.end();) {
+			if (it->second.owner == owner) {
+				it = tasks_.erase(it);
+			}
+			else {
+				++it;
+			}
+		}
+		if (running_owner_ == owner) {
+			running_cancelled_ = true;
+		}
+		if (isCurrentThread()) {
+			return;
+		}
+		idle_cv_.wait(lock, [this, owner]() { return running_owner_ != owner; });
+	}
+
+	bool Scheduler::isCurrentThread() const {
+		return std::this_thread::get_id() == thread_.get_id();
+	}
+
+	void Scheduler::schedule(Clock::time_point due, Task&& task) {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (stopped_) {
+				return;
+			}
+			tasks_.emplace(Key(due, next_seq_++), std::move(task));
+		}
+		cv_.notify_one();
+	}
+
+	void Scheduler::run() {
+		std::unique_lock<std::mutex> lock(mutex_);
+		while (!stopped_) {
+			if (tasks_.empty()) {
+				cv_.wait(lock);
+				continue;
+			}
+			auto due = tasks_.begin()->first.first;
+			if (Clock::now() < due) {
+				cv_.wait_until(lock, due);
+				continue;
+			}
+			auto task = std::move(tasks_.begin()->second);
+			tasks_.erase(tasks_.begin());
+			running_owner_ = task.owner;
+			lock.unlock();
+			task.fn();
+			lock.lock();
+			// {zh} 运行期间未被取消的重复任务按名义时间重新排队
+			// {en} A repeating task not cancelled while it ran is queued again at its nominal time
+			if (task.interval_ms > 0 && !running_cancelled_ && !stopped_) {
+				auto next = due + std::chrono::milliseconds(task.interval_ms);
+				tasks_.emplace(Key(next, next_seq_++), std::move(task));
+			}
+			running_owner_ = nullptr;
+			running_cancelled_ = false;
+			idle_cv_.notify_all();
+		}
+	}
+}
+}
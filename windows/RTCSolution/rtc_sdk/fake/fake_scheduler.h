@@ -0,0 +1,67 @@
+﻿#ifndef VRD_FAKE_SCHEDULER_H
+#define VRD_FAKE_SCHEDULER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace vrd
+{
+namespace fake
+{
+	/** {zh}
+	 * 替身引擎的回调线程，按到期时间执行任务，所有SDK回调都在该线程发出
+	 * 任务以 owner 分组，owner 销毁前调用 cancel 取消其余下任务
+	 */
+
+	/** {en}
+	* Callback thread of the stand-in engine, runs tasks in due-time order; every SDK callback is issued from it
+	* Tasks are grouped by owner, an owner calls cancel before it is destroyed to drop its remaining tasks
+	*/
+	class Scheduler {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		Scheduler();
+		~Scheduler();
+
+		void post(const void* owner, std::function<void(void)>&& task);
+		void postDelayed(const void* owner, int delay_ms, std::function<void(void)>&& task);
+		// {zh} 以固定间隔重复执行，直到 cancel；按名义时间累加，不随执行耗时漂移
+		// {en} Runs at a fixed interval until cancel; accumulates from the nominal time so it does not drift with run time
+		void postRepeating(const void* owner, int interval_ms, std::function<void(void)>&& task);
+		// {zh} 取消 owner 的全部任务，并等待其正在执行的任务结束
+		// {en} Drops all tasks of owner and waits for a running one of it to finish
+		void cancel(const void* owner);
+		bool isCurrentThread() const;
+
+	private:
+		struct Task {
+			const void* owner = nullptr;
+			int interval_ms = 0;
+			std::function<void(void)> fn;
+		};
+		using Key = std::pair<Clock::time_point, uint64_t>;
+
+		void schedule(Clock::time_point due, Task&& task);
+		void run();
+
+		std::mutex mutex_;
+		std::condition_variable cv_;
+		std::condition_variable idle_cv_;
+		std::map<Key, Task> tasks_;
+		uint64_t next_seq_ = 0;
+		const void* running_owner_ = nullptr;
+		bool running_cancelled_ = false;
+		bool stopped_ = false;
+		std::thread thread_;
+	};
+}
+}
+
+#endif // VRD_FAKE_SCHEDULER_H
@@ -0,0 +1,178 @@
+﻿#include "fake_video_frame.h"
+#include <cstring>
+
+namespace vrd
+{
+namespace fake
+{
+	FakeVideoFrame::Buffer::~Buffer() {
+		if (storage.empty() && builder.memory_deleter) {
+			builder.memory_deleter(&builder);
+		}
+	}
+
+	FakeVideoFrame::FakeVideoFrame(std::shared_ptr<Buffer> buffer)
+		: buffer_(std::move(buffer)) {
+	}
+
+	FakeVideoFrame* FakeVideoFrame::createI420(int width, int height, int64_t timestamp_us, uint32_t frame_index) {
+		auto buffer = std::make_shared<Buffer>();
+		auto chroma_width = (width + 1) / 2;
+		auto chroma_height = (height + 1) / 2;
+		auto luma_size = static_cast<size_t>(width) * height;
+		auto chroma_size = static_cast<size_t>(chroma_width) * chroma_height;
+		buffer->storage.resize(luma_size + chroma_size * 2);
+
+		auto y = buffer->storage.data();
+		for (int row = 0; row < height; ++row) {
+			auto line = y + static_cast<size_t>(row) * width;
+			for (int col = 0; col < width; ++col) {
+				line[col] = static_cast<uint8_t>(col + row + frame_index * 4);
+			}
+		}
+		memset(y + luma_size, 128 + static_cast<int>(frame_index % 32), chroma_size);
+		memset(y + luma_size + chroma_size, 128, chroma_size);
+
+		auto& builder = buffer->builder;
+		builder.pixel_fmt = bytertc::kVideoPixelFormatI420;
+		builder.width = width;
+		builder.height = height;
+		builder.timestamp_us = timestamp_us;
+		builder.data[0] = y;
+		builder.data[1] = y + luma_size;
+		builder.data[2] = y + luma_size + chroma_size;
+		builder.linesize[0] = width;
+		builder.linesize[1] = chroma_width;
+		builder.linesize[2] = chroma_width;
+		builder.size = static_cast<int>(buffer->storage.size());
+		return new FakeVideoFrame(std::move(buffer));
+	}
+
+	FakeVideoFrame* FakeVideoFrame::createARGB(int width, int height, uint32_t color) {
+		auto buffer = std::make_shared<Buffer>();
+		buffer->storage.resize(static_cast<size_t>(width) * height * 4);
+		auto pixels = reinterpret_cast<uint32_t*>(buffer->storage.data());
+		for (size_t i = 0; i < static_cast<size_t>(width) * height; ++i) {
+			pixels[i] = color;
+		}
+
+		auto& builder = buffer->builder;
+		builder.pixel_fmt = bytertc::kVideoPixelFormatARGB;
+		builder.width = width;
+		builder.height = height;
+		builder.data[0] = buffer->storage.data();
+		builder.linesize[0] = width * 4;
+		builder.size = static_cast<int>(buffer->storage.size());
+		return new FakeVideoFrame(std::move(buffer));
+	}
+
+	FakeVideoFrame* FakeVideoFrame::wrap(const bytertc::VideoFrameBuilder& builder) {
+		auto buffer = std::make_shared<Buffer>();
+		buffer->builder = builder;
+		return new FakeVideoFrame(std::move(buffer));
+	}
+
+	bytertc::VideoFrameType FakeVideoFrame::frameType() const {
+		return buffer_->builder.frame_type;
+	}
+
+	bytertc::VideoPixelFormat FakeVideoFrame::pixelFormat() const {
+		return buffer_->builder.pixel_fmt;
+	}
+
+	bytertc::VideoContentType FakeVideoFrame::videoContentType() const {
+		return bytertc::kVideoContentTypeNormalFrame;
+	}
+
+	int64_t FakeVideoFrame::timestampUs() const {
+		return buffer_->builder.timestamp_us;
+	}
+
+	int FakeVideoFrame::width() const {
+		return buffer_->builder.width;
+	}
+
+	int FakeVideoFrame::height() const {
+		return buffer_->builder.height;
+	}
+
+	bytertc::VideoRotation FakeVideoFrame::rotation() const {
+		return buffer_->builder.rotation;
+	}
+
+	bool FakeVideoFrame::flip() const {
+		return buffer_->builder.flip;
+	}
+
+	bytertc::ColorSpace FakeVideoFrame::colorSpace() const {
+		return buffer_->builder.color_space;
+	}
+
+	int FakeVideoFrame::numberOfPlanes() const {
+		int planes = 0;
+		while (planes < ByteRTCNumDataPointers && buffer_->builder.data[planes]) {
+			++planes;
+		}
+		return planes;
+	}
+
+	uint8_t* FakeVideoFrame::getPlaneData(int plane_index) {
+		if (plane_index < 0 || plane_index >= ByteRTCNumDataPointers) {
+			return nullptr;
+		}
+		return buffer_->builder.data[plane_index];
+	}
+
+	int FakeVideoFrame::getPlaneStride(int plane_index) {
+		if (plane_index < 0 || plane_index >= ByteRTCNumDataPointers) {
+			return 0;
+		}
+		return buffer_->builder.linesize[plane_index];
+	}
+
+	uint8_t* FakeVideoFrame::getExtraDataInfo(int& size) const {
+		size = buffer_->builder.extra_data_size;
+		return buffer_->builder.extra_data;
+	}
+
+	uint8_t* FakeVideoFrame::getSupplementaryInfo(int& size) const {
+		size = buffer_->builder.supplementary_info_size;
+		return buffer_->builder.supplementary_info;
+	}
+
+	void* FakeVideoFrame::getHwaccelBuffer() {
+		return buffer_->builder.hwaccel_buffer;
+	}
+
+	void* FakeVideoFrame::getHwaccelContext() {
+		return buffer_->builder.hwaccel_context;
+	}
+
+	void FakeVideoFrame::getTexMatrix(float matrix[16]) {
+		memcpy(matrix, buffer_->builder.tex_matrix, sizeof(buffer_->builder.tex_matrix));
+	}
+
+	uint32_t FakeVideoFrame::getTextureId() {
+		return buffer_->builder.texture_id;
+	}
+
+	bytertc::IVideoFrame* FakeVideoFrame::shallowCopy() {
+		return new FakeVideoFrame(buffer_);
+	}
+
+	void FakeVideoFrame::release() {
+		delete this;
+	}
+
+	void FakeVideoFrame::toI420() {
+	}
+
+	bytertc::CameraID FakeVideoFrame::getCameraId() const {
+		return bytertc::kCameraIDInvalid;
+	}
+
+	bytertc::FovVideoTileInfo FakeVideoFrame::getFovTile() {
+		return bytertc::FovVideoTileInfo();
+	}
+}
+}
@@ -0,0 +1,67 @@
+﻿#ifndef VRD_FAKE_VIDEO_FRAME_H
+#define VRD_FAKE_VIDEO_FRAME_H
+
+#include "rtc/bytertc_video_frame.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace vrd
+{
+namespace fake
+{
+	/** {zh}
+	 * 内存视频帧，shallowCopy 共享同一块像素缓冲，最后一个帧释放时回收缓冲
+	 */
+
+	/** {en}
+	* In-memory video frame, shallowCopy shares one pixel buffer which is freed with the last frame
+	*/
+	class FakeVideoFrame final : public bytertc::IVideoFrame {
+	public:
+		// {zh} 生成I420测试图案，亮度渐变随 frame_index 平移
+		// {en} Generates an I420 test pattern whose luma gradient shifts with frame_index
+		static FakeVideoFrame* createI420(int width, int height, int64_t timestamp_us, uint32_t frame_index);
+		static FakeVideoFrame* createARGB(int width, int height, uint32_t color);
+		static FakeVideoFrame* wrap(const bytertc::VideoFrameBuilder& builder);
+
+		bytertc::VideoFrameType frameType() const override;
+		bytertc::VideoPixelFormat pixelFormat() const override;
+		bytertc::VideoContentType videoContentType() const override;
+		int64_t timestampUs() const override;
+		int width() const override;
+		int height() const override;
+		bytertc::VideoRotation rotation() const override;
+		bool flip() const override;
+		bytertc::ColorSpace colorSpace() const override;
+		int numberOfPlanes() const override;
+		uint8_t* getPlaneData(int plane_index) override;
+		int getPlaneStride(int plane_index) override;
+		uint8_t* getExtraDataInfo(int& size) const override;
+		uint8_t* getSupplementaryInfo(int& size) const override;
+		void* getHwaccelBuffer() override;
+		void* getHwaccelContext() override;
+		void getTexMatrix(float matrix[16]) override;
+		uint32_t getTextureId() override;
+		bytertc::IVideoFrame* shallowCopy() override;
+		void release() override;
+		void toI420() override;
+		bytertc::CameraID getCameraId() const override;
+		bytertc::FovVideoTileInfo getFovTile() override;
+
+	private:
+		struct Buffer {
+			bytertc::VideoFrameBuilder builder;
+			std::vector<uint8_t> storage;
+			~Buffer();
+		};
+
+		explicit FakeVideoFrame(std::shared_ptr<Buffer> buffer);
+		~FakeVideoFrame() override = default;
+
+		std::shared_ptr<Buffer> buffer_;
+	};
+}
+}
+
+#endif // VRD_FAKE_VIDEO_FRAME_H
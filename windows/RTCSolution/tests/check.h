@@ -0,0 +1,32 @@
+﻿#ifndef VRD_TESTS_CHECK_H
+#define VRD_TESTS_CHECK_H
+
+#include <cstdio>
+
+/** {zh}
+ * 单元测试用的最小断言，失败时打印位置并计数，main 以失败数作为返回值
+ */
+
+/** {en}
+* Minimal assertion for the unit tests, a failure prints its location and is counted, main returns the count
+*/
+namespace vrd
+{
+namespace test
+{
+	inline int& failures() {
+		static int count = 0;
+		return count;
+	}
+}
+}
+
+#define VRD_CHECK(X) \
+	do { \
+		if (!(X)) { \
+			std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #X); \
+			++vrd::test::failures(); \
+		} \
+	} while (0)
+
+#endif // VRD_TESTS_CHECK_H
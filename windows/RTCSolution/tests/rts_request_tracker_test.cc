@@ -0,0 +1,111 @@
+﻿#include <string>
+#include <vector>
+
+#include "core/rts_request_tracker.h"
+#include "tests/check.h"
+
+namespace
+{
+	using vrd::RtsRequestTracker;
+
+	RtsRequestTracker::Request request(const char* event_name) {
+		RtsRequestTracker::Request r;
+		r.event_name = event_name;
+		return r;
+	}
+
+	std::vector<std::string> expire(RtsRequestTracker& tracker, int64_t now_ms) {
+		std::vector<std::string> due;
+		tracker.expire(now_ms, due);
+		return due;
+	}
+
+	// {zh} 截止时间落在一个刻度中间：刻度内提前推进游标不能让它推迟一整圈
+	// {en} A deadline in the middle of a tick: advancing the cursor earlier in that tick must not push it a full revolution
+	void deadlineMidTick() {
+		RtsRequestTracker tracker(100, 256);
+		RtsRequestTracker::Policy policy;
+		policy.timeout_ms = 150;
+		tracker.setDefaultPolicy(policy);
+		tracker.add("r1", request("joinRoom"), 0);
+
+		VRD_CHECK(expire(tracker, 120).empty());
+		VRD_CHECK(expire(tracker, 149).empty());
+		// {zh} 最迟在截止时间所在刻度结束时到期
+		// {en} Due no later than the end of the tick holding the deadline
+		auto due = expire(tracker, 200);
+		VRD_CHECK(due.size() == 1 && due[0] == "r1");
+		RtsRequestTracker::Request out;
+		VRD_CHECK(tracker.fail("r1", out));
+		VRD_CHECK(expire(tracker, 400).empty());
+	}
+
+	void retryRearmsDeadline() {
+		RtsRequestTracker tracker(100, 8);
+		RtsRequestTracker::Policy policy;
+		policy.timeout_ms = 250;
+		policy.max_retries = 1;
+		tracker.setDefaultPolicy(policy);
+		tracker.add("r1", request("getUsers"), 30);
+
+		VRD_CHECK(expire(tracker, 279).empty());
+		auto due = expire(tracker, 300);
+		VRD_CHECK(due.size() == 1);
+		tracker.retry("r1", 300);
+		// {zh} 旧截止时间留下的记录不再触发
+		// {en} The entry left by the old deadline no longer fires
+		VRD_CHECK(expire(tracker, 540).empty());
+		VRD_CHECK(expire(tracker, 600).size() == 1);
+		VRD_CHECK(tracker.stats().at("getUsers").retries == 1);
+	}
+
+	// {zh} 超过一圈的截止时间在经过的轮次中保留
+	// {en} A deadline beyond one revolution is kept through the revolutions passed over
+	void deadlineBeyondRevolution() {
+		RtsRequestTracker tracker(100, 4);
+		RtsRequestTracker::Policy policy;
+		policy.timeout_ms = 1050;
+		tracker.setDefaultPolicy(policy);
+		tracker.add("r1", request("heartbeat"), 0);
+		for (int64_t now = 100; now < 1050; now += 100) {
+			VRD_CHECK(expire(tracker, now).empty());
+		}
+		VRD_CHECK(expire(tracker, 1100).size() == 1);
+	}
+
+	void completeRecordsRtt() {
+		RtsRequestTracker tracker;
+		tracker.add("r1", request("leaveRoom"), 1000);
+		RtsRequestTracker::Request out;
+		VRD_CHECK(tracker.complete("r1", 1040, out));
+		VRD_CHECK(!tracker.complete("r1", 1050, out));
+		VRD_CHECK(tracker.inFlight() == 0);
+		VRD_CHECK(tracker.stats().at("leaveRoom").rtt.max_ms == 40);
+		VRD_CHECK(expire(tracker, 20000).empty());
+	}
+
+	// {zh} 登出时取出所有在途请求，之后不再到期
+	// {en} Logout takes every request in flight, none of them expires afterwards
+	void takeAllClears() {
+		RtsRequestTracker tracker;
+		tracker.add("r1", request("joinRoom"), 0);
+		tracker.add("r2", request("leaveRoom"), 0);
+		tracker.bindMessage(7, "r1");
+		std::vector<std::pair<std::string, RtsRequestTracker::Request>> taken;
+		tracker.takeAll(taken);
+		VRD_CHECK(taken.size() == 2);
+		VRD_CHECK(tracker.inFlight() == 0);
+		std::string requestId;
+		VRD_CHECK(!tracker.takeMessage(7, requestId));
+		VRD_CHECK(expire(tracker, 60000).empty());
+	}
+}
+
+int main() {
+	deadlineMidTick();
+	retryRearmsDeadline();
+	deadlineBeyondRevolution();
+	completeRecordsRtt();
+	takeAllClears();
+	return vrd::test::failures();
+}
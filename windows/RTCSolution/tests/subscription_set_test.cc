@@ -0,0 +1,149 @@
+﻿#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/subscription_set.h"
+#include "fake_rtc.h"
+#include "fake_rtc_room.h"
+#include "fake_rtc_video.h"
+#include "tests/check.h"
+
+namespace
+{
+	using vrd::fake::FakeRTCRoom;
+
+	const int kUsers = 3;
+	const int kAudio = bytertc::kMediaStreamTypeAudio;
+	const int kVideo = bytertc::kMediaStreamTypeVideo;
+	const int kBoth = bytertc::kMediaStreamTypeBoth;
+
+	std::string userId(int i) {
+		return "fake_user_" + std::to_string(i);
+	}
+
+	/** {zh}
+	 * 加入一个替身房间，远端用户出现后按自动订阅记入订阅表
+	 */
+
+	/** {en}
+	* Joins a stand-in room and records its remote users in the subscription table once present, as auto subscribe does
+	*/
+	class Room
+	{
+	public:
+		Room() : engine_("test", nullptr) {
+			room_ = static_cast<FakeRTCRoom*>(engine_.createRTCRoom("call_123456"));
+			bytertc::UserInfo info;
+			info.uid = "local_user";
+			room_->joinRoom("", info, bytertc::RTCRoomConfig());
+			auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+			while (room_->subscribedMedia(userId(kUsers - 1)) == 0 && std::chrono::steady_clock::now() < deadline) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			for (int i = 0; i < kUsers; ++i) {
+				set_.onPublished(userId(i), false, bytertc::kMediaStreamTypeBoth);
+			}
+		}
+
+		~Room() {
+			room_->destroy();
+		}
+
+		int setVideo(int user, bool video) {
+			auto subscription = set_.desired(userId(user), false);
+			subscription.video = video;
+			set_.setDesired(subscription);
+			return set_.apply(room_);
+		}
+
+		int setAllVideo(bool video) {
+			for (int i = 0; i < kUsers; ++i) {
+				auto subscription = set_.desired(userId(i), false);
+				subscription.video = video;
+				set_.setDesired(subscription);
+			}
+			return set_.apply(room_);
+		}
+
+		int setAudio(int user, bool audio) {
+			auto subscription = set_.desired(userId(user), false);
+			subscription.audio = audio;
+			set_.setDesired(subscription);
+			return set_.apply(room_);
+		}
+
+		int media(int user) {
+			return room_->subscribedMedia(userId(user));
+		}
+
+	private:
+		vrd::fake::FakeRTCVideo engine_;
+		FakeRTCRoom* room_ = nullptr;
+		vrd::SubscriptionSet set_;
+	};
+
+	void autoSubscribed() {
+		Room room;
+		for (int i = 0; i < kUsers; ++i) {
+			VRD_CHECK(room.media(i) == kBoth);
+		}
+	}
+
+	// {zh} 全部隐藏再恢复视频，音频一直保持订阅
+	// {en} Hiding every video and restoring it keeps audio subscribed throughout
+	void toggleAllVideoKeepsAudio() {
+		Room room;
+		VRD_CHECK(room.setAllVideo(false) == 1);
+		for (int i = 0; i < kUsers; ++i) {
+			VRD_CHECK(room.media(i) == kAudio);
+		}
+		VRD_CHECK(room.setAllVideo(true) == 1);
+		for (int i = 0; i < kUsers; ++i) {
+			VRD_CHECK(room.media(i) == kBoth);
+		}
+	}
+
+	// {zh} 单个用户的视频关掉再打开，音频一直保持订阅，其他用户不受影响
+	// {en} Turning one user's video off and on keeps its audio subscribed and leaves the other users alone
+	void toggleOneVideoKeepsAudio() {
+		Room room;
+		VRD_CHECK(room.setVideo(1, false) == 1);
+		VRD_CHECK(room.media(1) == kAudio);
+		VRD_CHECK(room.setVideo(1, true) == 1);
+		for (int i = 0; i < kUsers; ++i) {
+			VRD_CHECK(room.media(i) == kBoth);
+		}
+	}
+
+	// {zh} 期望不一致时不能用全量订阅，每个用户按各自完整的期望状态订阅
+	// {en} With differing desired states there is no room-wide subscribe, each user is subscribed with its own full state
+	void mixedDesiredState() {
+		Room room;
+		VRD_CHECK(room.setAudio(0, false) == 1);
+		VRD_CHECK(room.media(0) == kVideo);
+		VRD_CHECK(room.setAllVideo(false) == 1);
+		VRD_CHECK(room.media(0) == 0);
+		VRD_CHECK(room.media(1) == kAudio);
+		VRD_CHECK(room.setAllVideo(true) == kUsers);
+		VRD_CHECK(room.media(0) == kVideo);
+		for (int i = 1; i < kUsers; ++i) {
+			VRD_CHECK(room.media(i) == kBoth);
+		}
+	}
+}
+
+int main() {
+	vrd::fake::Scenario scenario;
+	scenario.remote_users = kUsers;
+	scenario.frame_rate = 0;
+	scenario.latency_ms = 1;
+	vrd::fake::setScenario(scenario);
+
+	autoSubscribed();
+	toggleAllVideoKeepsAudio();
+	toggleOneVideoKeepsAudio();
+	mixedDesiredState();
+	return vrd::test::failures();
+}
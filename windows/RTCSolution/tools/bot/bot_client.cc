@@ -0,0 +1,499 @@
+﻿#include <QCoreApplication>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTimer>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/rtc_engine_wrap.h"
+#include "core/session_base.h"
+#include "fake_rtc.h"
+#include "tools/bot/frame_pacer.h"
+#include "tools/bot/media_clip.h"
+
+/** {zh}
+ * 无界面推流机器人：一个进程内多个机器人各自经RTS申请令牌、创建自己的RTC房间并以独立用户进房，
+ * 通过外部视频源推送 Y4M（或测试图案）的I420帧，通过外部音频源推送 WAV（或正弦音）的10毫秒PCM，
+ * 所有机器人的推帧由一个节拍线程按帧率驱动
+ * 外部源是引擎级设置，真实SDK每个进程只有一个引擎，所有机器人推的帧进入同一条本地流；
+ * 因此一进程多机器人面向替身引擎，用真实SDK时每个进程只运行一个机器人（--bots 1）
+ */
+
+/** {en}
+* Headless publisher bots: every bot in the process requests a token over RTS, creates its own RTC room and joins
+* as its own user, pushes I420 frames from a Y4M file (or a test pattern) through the external video source and
+* 10 ms PCM from a WAV file (or a sine tone) through the external audio source,
+* with one pacing thread driving the pushes of all bots at their frame rates
+* External sources are engine-wide and the real SDK has one engine per process, so every bot's frames would feed the
+* same local stream; many bots per process therefore targets the stand-in engine, run one bot per process (--bots 1)
+* with the real SDK
+*/
+namespace
+{
+    using vrd::bot::AudioClip;
+    using vrd::bot::FramePacer;
+    using vrd::bot::VideoClip;
+
+    const char* const kBotAppId = "bot";
+    const int kLeaveGraceMs = 500;
+
+    struct Options {
+        int bots = 16;
+        QString room = "call_bot_load";
+        int duration_s = 60;
+        int stagger_ms = 50;
+        QString y4m;
+        int max_frames = 300;
+        QString wav;
+        // {zh} 没有 Y4M 文件时测试图案的尺寸和帧率
+        // {en} Size and rate of the test pattern when no Y4M file is given
+        int width = 320;
+        int height = 180;
+        int fps = 15;
+        int spin_us = 300;
+        bool subscribe = false;
+        QString out;
+    };
+
+    void usage() {
+        fprintf(stderr, "usage: bot_client [--bots n] [--room id] [--duration seconds] [--stagger ms]\n"
+            "                  [--y4m file] [--max-frames n] [--wav file]\n"
+            "                  [--width n] [--height n] [--fps n] [--spin-us n] [--subscribe 0|1] [--out report.json]\n");
+    }
+
+    bool parseOptions(const QStringList& args, Options& options) {
+        for (int i = 1; i < args.size(); ++i) {
+            if (i + 1 >= args.size()) {
+                return false;
+            }
+            auto& name = args[i];
+            auto& value = args[++i];
+            bool ok = true;
+            if (name == "--bots") {
+                options.bots = value.toInt(&ok);
+            } else if (name == "--room") {
+                options.room = value;
+            } else if (name == "--duration") {
+                options.duration_s = value.toInt(&ok);
+            } else if (name == "--stagger") {
+                options.stagger_ms = value.toInt(&ok);
+            } else if (name == "--y4m") {
+                options.y4m = value;
+            } else if (name == "--max-frames") {
+                options.max_frames = value.toInt(&ok);
+            } else if (name == "--wav") {
+                options.wav = value;
+            } else if (name == "--width") {
+                options.width = value.toInt(&ok);
+            } else if (name == "--height") {
+                options.height = value.toInt(&ok);
+            } else if (name == "--fps") {
+                options.fps = value.toInt(&ok);
+            } else if (name == "--spin-us") {
+                options.spin_us = value.toInt(&ok);
+            } else if (name == "--subscribe") {
+                options.subscribe = value.toInt(&ok) != 0;
+            } else if (name == "--out") {
+                options.out = value;
+            } else {
+                return false;
+            }
+            if (!ok) {
+                return false;
+            }
+        }
+        return options.bots > 0 && options.duration_s > 0 && options.fps > 0
+            && options.width > 0 && options.height > 0 && options.max_frames > 0;
+    }
+
+    void quietMessageHandler(QtMsgType type, const QMessageLogContext& context, const QString& message) {
+        if (type == QtDebugMsg) {
+            return;
+        }
+        fprintf(stderr, "%s\n", qPrintable(message));
+    }
+
+    double percentile(std::vector<double> values, double p) {
+        if (values.empty()) {
+            return 0;
+        }
+        std::sort(values.begin(), values.end());
+        auto rank = static_cast<size_t>(std::ceil(p * values.size()));
+        return values[std::min(values.size(), std::max<size_t>(rank, 1)) - 1];
+    }
+
+    /** {zh}
+     * 引用共享片段内存推帧，不复制像素；片段须在引擎销毁后才释放
+     */
+
+    /** {en}
+    * Pushes frames referencing the shared clip memory without copying pixels; the clip must outlive the engine
+    */
+    class VideoStream : public FramePacer::Stream {
+    public:
+        VideoStream(std::shared_ptr<const VideoClip> clip, int first_frame)
+            : clip_(std::move(clip)), next_(first_frame % clip_->frameCount()) {}
+
+        void onDue(int64_t due_us) override {
+            auto& clip = *clip_;
+            auto y = const_cast<uint8_t*>(clip.frame(next_));
+            next_ = (next_ + 1) % clip.frameCount();
+            auto luma = static_cast<size_t>(clip.width) * clip.height;
+            auto chroma = (clip.frameSize() - luma) / 2;
+
+            bytertc::VideoFrameBuilder builder;
+            builder.pixel_fmt = bytertc::kVideoPixelFormatI420;
+            builder.width = clip.width;
+            builder.height = clip.height;
+            builder.timestamp_us = due_us;
+            builder.data[0] = y;
+            builder.data[1] = y + luma;
+            builder.data[2] = y + luma + chroma;
+            builder.linesize[0] = clip.width;
+            builder.linesize[1] = (clip.width + 1) / 2;
+            builder.linesize[2] = (clip.width + 1) / 2;
+            builder.size = static_cast<int>(clip.frameSize());
+            // {zh} 视频帧由SDK接管
+            // {en} The SDK takes over video frames
+            if (RtcEngineWrap::instance().pushExternalVideoFrame(bytertc::buildVideoFrame(builder)) == 0) {
+                ++pushed;
+            } else {
+                ++failed;
+            }
+        }
+
+        std::atomic<int64_t> pushed{ 0 };
+        std::atomic<int64_t> failed{ 0 };
+
+    private:
+        std::shared_ptr<const VideoClip> clip_;
+        int next_;
+    };
+
+    class AudioStream : public FramePacer::Stream {
+    public:
+        AudioStream(std::shared_ptr<const AudioClip> clip, size_t first_sample)
+            : clip_(std::move(clip)), wrap_(clip_->samplesPer10Ms()) {
+            position_ = first_sample % clip_->samples.size();
+            position_ -= position_ % clip_->channels;
+        }
+
+        void onDue(int64_t due_us) override {
+            auto& samples = clip_->samples;
+            auto count = static_cast<size_t>(clip_->samplesPer10Ms());
+            const int16_t* data = samples.data() + position_;
+            // {zh} 跨越片段末尾时拼接到临时缓冲
+            // {en} Stitched into a scratch buffer when crossing the end of the clip
+            if (position_ + count > samples.size()) {
+                auto head = samples.size() - position_;
+                std::copy(samples.begin() + position_, samples.end(), wrap_.begin());
+                std::copy(samples.begin(), samples.begin() + (count - head), wrap_.begin() + head);
+                data = wrap_.data();
+            }
+            position_ = (position_ + count) % samples.size();
+
+            bytertc::AudioFrameBuilder builder;
+            builder.sample_rate = static_cast<bytertc::AudioSampleRate>(clip_->sample_rate);
+            builder.channel = static_cast<bytertc::AudioChannel>(clip_->channels);
+            builder.timestamp_us = due_us;
+            builder.data = reinterpret_cast<uint8_t*>(const_cast<int16_t*>(data));
+            builder.data_size = static_cast<int64_t>(count * sizeof(int16_t));
+            builder.deep_copy = false;
+            // {zh} 音频帧推入后仍由调用方释放
+            // {en} Audio frames are still released by the caller after the push
+            auto frame = bytertc::buildAudioFrame(builder);
+            if (RtcEngineWrap::instance().pushExternalAudioFrame(frame) == 0) {
+                ++pushed;
+            } else {
+                ++failed;
+            }
+            frame->release();
+        }
+
+        std::atomic<int64_t> pushed{ 0 };
+        std::atomic<int64_t> failed{ 0 };
+
+    private:
+        std::shared_ptr<const AudioClip> clip_;
+        std::vector<int16_t> wrap_;
+        size_t position_ = 0;
+    };
+
+    /** {zh}
+     * 一个机器人：RTS申请令牌 -> 创建房间并进房 -> 进房成功后把音视频流交给节拍线程 -> 离房
+     * join/leave 在主线程调用，房间回调在SDK线程
+     */
+
+    /** {en}
+    * One bot: token over RTS -> create the room and join -> hand its streams to the pacing thread once joined -> leave
+    * join/leave run on the main thread, room callbacks arrive on the SDK thread
+    */
+    class Bot : public bytertc::IRTCRoomEventHandler {
+    public:
+        Bot(int index, const Options& options, std::shared_ptr<const VideoClip> video,
+            std::shared_ptr<const AudioClip> audio, FramePacer& pacer)
+            : index_(index)
+            , user_id_("bot_" + std::to_string(QCoreApplication::applicationPid()) + "_" + std::to_string(index))
+            , room_id_(options.room.toStdString())
+            , subscribe_(options.subscribe)
+            , pacer_(pacer)
+            , video_period_num_(1000000LL * video->fps_den)
+            , video_period_den_(video->fps_num)
+            // {zh} 各机器人从片段的不同位置开始，避免所有流内容相同
+            // {en} Bots start at different points of the clips so their streams differ
+            , video_(video, index * 7)
+            , audio_(audio, static_cast<size_t>(index) * audio->sample_rate / 10 * audio->channels) {}
+
+        ~Bot() {
+            stopStreams();
+            room_.reset();
+        }
+
+        void join() {
+            join_requested_us_ = FramePacer::nowUs();
+            auto base = VRD_FUNC_GET_COMPONET(vrd::SessionBase);
+            QJsonObject req;
+            req["login_token"] = QString::fromStdString(base->_token());
+            req["user_id"] = QString::fromStdString(user_id_);
+            req["room_id"] = QString::fromStdString(room_id_);
+            base->_emitMessage("videocallJoinRoom", req, [this](const QJsonObject& rsp) {
+                auto code = rsp["code"].toInt();
+                if (code != 200) {
+                    error_ = code;
+                    return;
+                }
+                auto token = rsp["response"].toObject()["rtc_token"].toString().toStdString();
+                enterRoom(token);
+            });
+        }
+
+        void leave() {
+            stopStreams();
+            if (!room_) {
+                return;
+            }
+            room_->leaveRoom();
+            auto base = VRD_FUNC_GET_COMPONET(vrd::SessionBase);
+            QJsonObject req;
+            req["login_token"] = QString::fromStdString(base->_token());
+            req["user_id"] = QString::fromStdString(user_id_);
+            req["room_id"] = QString::fromStdString(room_id_);
+            base->_emitMessage("videocallLeaveRoom", req);
+        }
+
+        bool joined() const { return joined_us_ > 0; }
+        double joinMs() const { return joined() ? (joined_us_ - join_requested_us_) / 1000.0 : 0; }
+        int error() const { return error_; }
+        const VideoStream& video() const { return video_; }
+        const AudioStream& audio() const { return audio_; }
+
+    private:
+        void enterRoom(const std::string& token) {
+            auto& engine = RtcEngineWrap::instance().getRtcEngine();
+            if (!engine) {
+                error_ = -1;
+                return;
+            }
+            room_ = std::shared_ptr<bytertc::IRTCRoom>(engine->createRTCRoom(room_id_.c_str()),
+                [](bytertc::IRTCRoom* room) { room->destroy(); });
+            room_->setRTCRoomEventHandler(this);
+            bytertc::UserInfo user;
+            user.uid = user_id_.c_str();
+            user.extra_info = "{\"bot\":true}";
+            bytertc::RTCRoomConfig config;
+            config.is_auto_publish = true;
+            config.is_auto_subscribe_audio = subscribe_;
+            config.is_auto_subscribe_video = subscribe_;
+            auto result = room_->joinRoom(token.c_str(), user, config);
+            if (result != 0) {
+                error_ = result;
+            }
+        }
+
+        void onRoomStateChanged(const char* room_id, const char* uid, int state, const char* extra_info) override {
+            if (state != 0) {
+                error_ = state;
+                return;
+            }
+            int64_t expected = 0;
+            auto now = FramePacer::nowUs();
+            if (!joined_us_.compare_exchange_strong(expected, now)) {
+                return;
+            }
+            // {zh} 首帧稍后开始，各机器人错开半个周期以内
+            // {en} The first frames start shortly after, offset per bot by up to half a period
+            auto offset = (index_ * 997) % (video_period_num_ / video_period_den_ / 2 + 1);
+            pacer_.add(&video_, video_period_num_, video_period_den_, now + 1000 + offset);
+            pacer_.add(&audio_, 10000, 1, now + 1000 + offset % 5000);
+            streaming_ = true;
+        }
+
+        void stopStreams() {
+            if (streaming_.exchange(false)) {
+                pacer_.remove(&video_);
+                pacer_.remove(&audio_);
+            }
+        }
+
+        const int index_;
+        const std::string user_id_;
+        const std::string room_id_;
+        const bool subscribe_;
+        FramePacer& pacer_;
+        const int64_t video_period_num_;
+        const int64_t video_period_den_;
+        VideoStream video_;
+        AudioStream audio_;
+        std::shared_ptr<bytertc::IRTCRoom> room_;
+        std::atomic<int64_t> join_requested_us_{ 0 };
+        std::atomic<int64_t> joined_us_{ 0 };
+        std::atomic<int> error_{ 0 };
+        std::atomic<bool> streaming_{ false };
+    };
+
+    bool loadClips(const Options& options, std::shared_ptr<const VideoClip>& video,
+        std::shared_ptr<const AudioClip>& audio) {
+        std::string error;
+        video = options.y4m.isEmpty()
+            ? vrd::bot::makeTestPattern(options.width, options.height, options.fps)
+            : vrd::bot::loadY4m(options.y4m.toStdString(), options.max_frames, error);
+        if (!video) {
+            fprintf(stderr, "%s\n", error.c_str());
+            return false;
+        }
+        audio = options.wav.isEmpty()
+            ? vrd::bot::makeTone(48000, 440)
+            : vrd::bot::loadWav(options.wav.toStdString(), error);
+        if (!audio) {
+            fprintf(stderr, "%s\n", error.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    int report(const Options& options, const std::vector<std::unique_ptr<Bot>>& bots,
+        const FramePacer::Stats& pacing, const vrd::fake::ExternalMediaStats& engine) {
+        std::vector<double> join_ms;
+        int64_t video_pushed = 0;
+        int64_t audio_pushed = 0;
+        int64_t failed = 0;
+        for (auto& bot : bots) {
+            if (bot->joined()) {
+                join_ms.push_back(bot->joinMs());
+            }
+            video_pushed += bot->video().pushed;
+            audio_pushed += bot->audio().pushed;
+            failed += bot->video().failed + bot->audio().failed;
+        }
+        auto joined = static_cast<int>(join_ms.size());
+
+        printf("bots joined     %d of %d\n", joined, options.bots);
+        printf("join ms         p50 %.1f  p90 %.1f  p99 %.1f  max %.1f\n", percentile(join_ms, 0.5),
+            percentile(join_ms, 0.9), percentile(join_ms, 0.99), percentile(join_ms, 1.0));
+        printf("frames pushed   video %lld  audio %lld  failed %lld\n", static_cast<long long>(video_pushed),
+            static_cast<long long>(audio_pushed), static_cast<long long>(failed));
+        printf("pacing late us  p50 %lld  p99 %lld  max %lld  skipped %lld\n",
+            static_cast<long long>(pacing.latePercentileUs(0.5)), static_cast<long long>(pacing.latePercentileUs(0.99)),
+            static_cast<long long>(pacing.max_late_us), static_cast<long long>(pacing.skipped));
+        printf("engine received video %lld  audio %lld  rejected %lld\n", static_cast<long long>(engine.video_frames),
+            static_cast<long long>(engine.audio_frames), static_cast<long long>(engine.rejected));
+
+        if (!options.out.isEmpty()) {
+            QJsonObject join;
+            join["p50_ms"] = percentile(join_ms, 0.5);
+            join["p90_ms"] = percentile(join_ms, 0.9);
+            join["p99_ms"] = percentile(join_ms, 0.99);
+            join["max_ms"] = percentile(join_ms, 1.0);
+            QJsonObject frames;
+            frames["video"] = static_cast<double>(video_pushed);
+            frames["audio"] = static_cast<double>(audio_pushed);
+            frames["failed"] = static_cast<double>(failed);
+            QJsonObject pacer;
+            pacer["ticks"] = static_cast<double>(pacing.ticks);
+            pacer["late_p50_us"] = static_cast<double>(pacing.latePercentileUs(0.5));
+            pacer["late_p99_us"] = static_cast<double>(pacing.latePercentileUs(0.99));
+            pacer["late_max_us"] = static_cast<double>(pacing.max_late_us);
+            pacer["skipped"] = static_cast<double>(pacing.skipped);
+            QJsonObject received;
+            received["video"] = static_cast<double>(engine.video_frames);
+            received["audio"] = static_cast<double>(engine.audio_frames);
+            received["rejected"] = static_cast<double>(engine.rejected);
+            QJsonObject result;
+            result["bots"] = options.bots;
+            result["joined"] = joined;
+            result["join"] = join;
+            result["frames"] = frames;
+            result["pacing"] = pacer;
+            result["engine"] = received;
+            QFile file(options.out);
+            if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+                fprintf(stderr, "cannot write %s\n", qPrintable(options.out));
+                return 2;
+            }
+            file.write(QJsonDocument(result).toJson());
+        }
+        return joined == options.bots && failed == 0 ? 0 : 1;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    // {zh} 机器人只推流，默认不在每个机器人房间里模拟远端用户
+    // {en} Bots only publish, so by default no remote users are simulated in each bot's room
+    if (qEnvironmentVariableIsEmpty("VRD_FAKE_USERS")) {
+        qputenv("VRD_FAKE_USERS", "0");
+    }
+    QCoreApplication app(argc, argv);
+    qInstallMessageHandler(quietMessageHandler);
+
+    Options options;
+    if (!parseOptions(app.arguments(), options)) {
+        usage();
+        return 2;
+    }
+    std::shared_ptr<const VideoClip> video;
+    std::shared_ptr<const AudioClip> audio;
+    if (!loadClips(options, video, audio)) {
+        return 2;
+    }
+
+    vrd::SessionBase::registerThis();
+    RtcEngineWrap::instance().createEngine(kBotAppId);
+    auto base = VRD_FUNC_GET_COMPONET(vrd::SessionBase);
+    base->setUserId("bot_" + std::to_string(QCoreApplication::applicationPid()));
+    base->setToken("bot_login_token");
+    // {zh} 跳过业务服务器参数设置，请求直接发给替身引擎
+    // {en} Skip the business server params round trip, requests go straight to the stand-in engine
+    base->onServerParamsSetResult(200);
+    RtcEngineWrap::instance().setVideoSourceType(bytertc::kStreamIndexMain, bytertc::kVideoSourceTypeExternal);
+    RtcEngineWrap::instance().setAudioSourceType(bytertc::kAudioSourceTypeExternal);
+
+    FramePacer pacer(options.spin_us);
+    pacer.start();
+    std::vector<std::unique_ptr<Bot>> bots;
+    for (int i = 0; i < options.bots; ++i) {
+        bots.emplace_back(new Bot(i, options, video, audio, pacer));
+        auto bot = bots.back().get();
+        QTimer::singleShot(i * options.stagger_ms, [bot] { bot->join(); });
+    }
+    QTimer::singleShot(options.bots * options.stagger_ms + options.duration_s * 1000, [&] {
+        for (auto& bot : bots) {
+            bot->leave();
+        }
+        QTimer::singleShot(kLeaveGraceMs, &app, &QCoreApplication::quit);
+    });
+    app.exec();
+
+    pacer.stop();
+    auto pacing = pacer.stats();
+    auto engine = vrd::fake::externalMediaStats();
+    auto exit_code = report(options, bots, pacing, engine);
+    bots.clear();
+    RtcEngineWrap::instance().destroyEngine();
+    return exit_code;
+}
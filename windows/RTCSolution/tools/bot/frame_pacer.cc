@@ -0,0 +1,149 @@
+﻿#include "frame_pacer.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace vrd {
+namespace bot {
+
+int64_t FramePacer::Stats::latePercentileUs(double p) const {
+    int64_t total = 0;
+    for (auto count : late_buckets) {
+        total += count;
+    }
+    if (total == 0) {
+        return 0;
+    }
+    auto rank = static_cast<int64_t>(p * total);
+    int64_t seen = 0;
+    for (size_t i = 0; i < late_buckets.size(); ++i) {
+        seen += late_buckets[i];
+        if (seen > rank) {
+            return static_cast<int64_t>(i + 1) * kBucketUs;
+        }
+    }
+    return max_late_us;
+}
+
+FramePacer::FramePacer(int spin_us) : spin_us_(spin_us) {}
+
+FramePacer::~FramePacer() {
+    stop();
+}
+
+int64_t FramePacer::nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t FramePacer::dueOf(const Entry& entry) {
+    return entry.first_due_us + entry.index * entry.period_num / entry.period_den;
+}
+
+void FramePacer::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    thread_ = std::thread([this] { run(); });
+}
+
+void FramePacer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    cv_.notify_all();
+    thread_.join();
+}
+
+void FramePacer::add(Stream* stream, int64_t period_num, int64_t period_den, int64_t first_due_us) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Entry entry{ stream, first_due_us, period_num, period_den, 0, first_due_us };
+        heap_.push_back(entry);
+        std::push_heap(heap_.begin(), heap_.end(), Later());
+    }
+    cv_.notify_all();
+}
+
+void FramePacer::remove(Stream* stream) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = std::remove_if(heap_.begin(), heap_.end(),
+        [stream](const Entry& entry) { return entry.stream == stream; });
+    if (it != heap_.end()) {
+        heap_.erase(it, heap_.end());
+        std::make_heap(heap_.begin(), heap_.end(), Later());
+    }
+    if (current_ == stream) {
+        current_removed_ = true;
+        // {zh} 在该流的 onDue 中调用时不能等待自己返回，节拍线程回来后不会再安排它
+        // {en} Called from the stream's own onDue it cannot wait for itself, the pacing thread drops it on return
+        if (std::this_thread::get_id() != thread_.get_id()) {
+            cv_.wait(lock, [this, stream] { return current_ != stream; });
+        }
+    }
+}
+
+FramePacer::Stats FramePacer::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void FramePacer::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        if (heap_.empty()) {
+            cv_.wait(lock);
+            continue;
+        }
+        auto wait_us = heap_.front().due_us - spin_us_ - nowUs();
+        if (wait_us > 0) {
+            // {zh} 期间有流加入或移除时重新选取最早的截止时间
+            // {en} Re-pick the earliest deadline if streams are added or removed meanwhile
+            cv_.wait_for(lock, std::chrono::microseconds(wait_us));
+            continue;
+        }
+        std::pop_heap(heap_.begin(), heap_.end(), Later());
+        auto entry = heap_.back();
+        heap_.pop_back();
+        current_ = entry.stream;
+        current_removed_ = false;
+        lock.unlock();
+
+        while (nowUs() < entry.due_us) {
+            std::this_thread::yield();
+        }
+        auto late_us = nowUs() - entry.due_us;
+        entry.stream->onDue(entry.due_us);
+
+        lock.lock();
+        current_ = nullptr;
+        ++stats_.ticks;
+        stats_.max_late_us = std::max(stats_.max_late_us, late_us);
+        auto bucket = std::min<size_t>(static_cast<size_t>(late_us / Stats::kBucketUs), stats_.late_buckets.size() - 1);
+        ++stats_.late_buckets[bucket];
+        if (current_removed_) {
+            cv_.notify_all();
+            continue;
+        }
+        ++entry.index;
+        entry.due_us = dueOf(entry);
+        auto now = nowUs();
+        if (now - entry.due_us > 2 * entry.period_num / entry.period_den) {
+            auto behind = (now - entry.first_due_us) * entry.period_den / entry.period_num;
+            stats_.skipped += behind - entry.index;
+            entry.index = behind;
+            entry.due_us = dueOf(entry);
+        }
+        heap_.push_back(entry);
+        std::push_heap(heap_.begin(), heap_.end(), Later());
+    }
+}
+
+}  // namespace bot
+}  // namespace vrd
@@ -0,0 +1,93 @@
+﻿#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vrd {
+namespace bot {
+
+/** {zh}
+ * 所有机器人共用的推帧节拍线程
+ * 1, 每路流按绝对时间表 first_due + n * 周期 触发，周期为分数微秒（如 1000000*1001/30000），不累积漂移
+ * 2, 睡到截止时间前 spin_us 微秒，再让出CPU自旋到截止时间，减少唤醒抖动
+ * 3, 落后超过两个周期时跳到当前时刻，跳过的帧计入 skipped，不补推
+ * onDue 在节拍线程调用，应尽快返回；remove 返回后不会再调用该流，也可以在该流自己的 onDue 中调用
+ */
+
+/** {en}
+* Frame pacing thread shared by all bots
+* 1, Every stream fires on an absolute schedule first_due + n * period, with fractional microsecond periods
+*    (such as 1000000*1001/30000), so no drift accumulates
+* 2, Sleeps until spin_us microseconds before the deadline, then spins with yields up to it to cut wake-up jitter
+* 3, A stream more than two periods behind jumps to the present, the frames in between count as skipped and are not pushed
+* onDue runs on the pacing thread and should return quickly; a stream is never called again once remove returns,
+* and remove may also be called from the stream's own onDue
+*/
+class FramePacer {
+public:
+    class Stream {
+    public:
+        virtual ~Stream() = default;
+        virtual void onDue(int64_t due_us) = 0;
+    };
+
+    struct Stats {
+        int64_t ticks = 0;
+        int64_t skipped = 0;
+        int64_t max_late_us = 0;
+        // {zh} 触发时刻晚于截止时间的分布，每桶50微秒，最后一桶为溢出
+        // {en} Distribution of how late ticks fire past their deadline, 50 us per bucket with the last one for overflow
+        static const int kBucketUs = 50;
+        std::array<int64_t, 200> late_buckets{};
+
+        int64_t latePercentileUs(double p) const;
+    };
+
+    explicit FramePacer(int spin_us = 300);
+    ~FramePacer();
+
+    void start();
+    void stop();
+    // {zh} 周期为 period_num / period_den 微秒
+    // {en} The period is period_num / period_den microseconds
+    void add(Stream* stream, int64_t period_num, int64_t period_den, int64_t first_due_us);
+    void remove(Stream* stream);
+    Stats stats() const;
+
+    static int64_t nowUs();
+
+private:
+    struct Entry {
+        Stream* stream;
+        int64_t first_due_us;
+        int64_t period_num;
+        int64_t period_den;
+        int64_t index;
+        int64_t due_us;
+    };
+    struct Later {
+        bool operator()(const Entry& a, const Entry& b) const { return a.due_us > b.due_us; }
+    };
+
+    void run();
+    static int64_t dueOf(const Entry& entry);
+
+    const int spin_us_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::thread thread_;
+    bool running_ = false;
+    std::vector<Entry> heap_;
+    // {zh} 正在节拍线程上执行 onDue 的流，remove 需等待其返回
+    // {en} The stream whose onDue is running on the pacing thread, remove waits for it to return
+    Stream* current_ = nullptr;
+    bool current_removed_ = false;
+    Stats stats_;
+};
+
+}  // namespace bot
+}  // namespace vrd
@@ -0,0 +1,245 @@
+﻿#include "media_clip.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+namespace vrd {
+namespace bot {
+
+namespace {
+const int kMaxY4mHeader = 1024;
+
+struct File {
+    explicit File(const std::string& path) : handle(std::fopen(path.c_str(), "rb")) {}
+    ~File() {
+        if (handle) {
+            std::fclose(handle);
+        }
+    }
+    FILE* handle;
+};
+
+// {zh} 读取到换行为止，不含换行；超长或到达文件末尾返回 false
+// {en} Reads up to the newline, excluding it; returns false when overlong or at the end of the file
+bool readLine(FILE* file, std::string& line) {
+    line.clear();
+    int c = 0;
+    while ((c = std::fgetc(file)) != EOF) {
+        if (c == '\n') {
+            return true;
+        }
+        if (line.size() >= kMaxY4mHeader) {
+            return false;
+        }
+        line.push_back(static_cast<char>(c));
+    }
+    return false;
+}
+
+uint32_t readLe32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint16_t readLe16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+bool supportedSampleRate(int rate) {
+    return rate == 8000 || rate == 16000 || rate == 32000 || rate == 44100 || rate == 48000;
+}
+}  // namespace
+
+size_t VideoClip::frameSize() const {
+    auto chroma = static_cast<size_t>((width + 1) / 2) * ((height + 1) / 2);
+    return static_cast<size_t>(width) * height + chroma * 2;
+}
+
+int VideoClip::frameCount() const {
+    auto size = frameSize();
+    return size == 0 ? 0 : static_cast<int>(data.size() / size);
+}
+
+const uint8_t* VideoClip::frame(int index) const {
+    return data.data() + frameSize() * static_cast<size_t>(index);
+}
+
+int AudioClip::samplesPer10Ms() const {
+    return sample_rate / 100 * channels;
+}
+
+/** {zh}
+ * YUV4MPEG2 头为一行空格分隔的参数：W宽 H高 F帧率分子:分母 C色度采样，每帧以 FRAME 行开头
+ */
+
+/** {en}
+* The YUV4MPEG2 header is one line of space separated parameters: W width, H height, F rate num:den, C chroma,
+* and every frame starts with a FRAME line
+*/
+std::shared_ptr<const VideoClip> loadY4m(const std::string& path, int max_frames, std::string& error) {
+    File file(path);
+    if (!file.handle) {
+        error = "cannot open " + path;
+        return nullptr;
+    }
+    std::string line;
+    if (!readLine(file.handle, line) || line.compare(0, 9, "YUV4MPEG2") != 0) {
+        error = path + " is not a Y4M file";
+        return nullptr;
+    }
+    auto clip = std::make_shared<VideoClip>();
+    std::istringstream header(line.substr(9));
+    std::string token;
+    while (header >> token) {
+        auto value = token.substr(1);
+        switch (token[0]) {
+        case 'W':
+            clip->width = std::atoi(value.c_str());
+            break;
+        case 'H':
+            clip->height = std::atoi(value.c_str());
+            break;
+        case 'F':
+            if (std::sscanf(value.c_str(), "%d:%d", &clip->fps_num, &clip->fps_den) != 2) {
+                clip->fps_num = 0;
+            }
+            break;
+        case 'C':
+            if (value.compare(0, 3, "420") != 0) {
+                error = "unsupported Y4M chroma " + value + ", only 4:2:0 is supported";
+                return nullptr;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    if (clip->width <= 0 || clip->height <= 0 || clip->fps_num <= 0 || clip->fps_den <= 0) {
+        error = "bad Y4M header in " + path;
+        return nullptr;
+    }
+
+    auto frame_size = clip->frameSize();
+    while (clip->frameCount() < max_frames) {
+        if (!readLine(file.handle, line)) {
+            break;
+        }
+        if (line.compare(0, 5, "FRAME") != 0) {
+            error = "bad Y4M frame marker in " + path;
+            return nullptr;
+        }
+        auto offset = clip->data.size();
+        clip->data.resize(offset + frame_size);
+        if (std::fread(clip->data.data() + offset, 1, frame_size, file.handle) != frame_size) {
+            clip->data.resize(offset);
+            break;
+        }
+    }
+    if (clip->frameCount() == 0) {
+        error = "no frames in " + path;
+        return nullptr;
+    }
+    return clip;
+}
+
+/** {zh}
+ * 按RIFF块解析，跳过 fmt 和 data 以外的块；WAVE_FORMAT_EXTENSIBLE 只按位深判断
+ */
+
+/** {en}
+* Parsed chunk by chunk, skipping chunks other than fmt and data; WAVE_FORMAT_EXTENSIBLE is judged by bit depth only
+*/
+std::shared_ptr<const AudioClip> loadWav(const std::string& path, std::string& error) {
+    File file(path);
+    if (!file.handle) {
+        error = "cannot open " + path;
+        return nullptr;
+    }
+    uint8_t riff[12];
+    if (std::fread(riff, 1, sizeof(riff), file.handle) != sizeof(riff)
+        || std::memcmp(riff, "RIFF", 4) != 0 || std::memcmp(riff + 8, "WAVE", 4) != 0) {
+        error = path + " is not a WAV file";
+        return nullptr;
+    }
+    auto clip = std::make_shared<AudioClip>();
+    bool has_format = false;
+    uint8_t chunk[8];
+    while (std::fread(chunk, 1, sizeof(chunk), file.handle) == sizeof(chunk)) {
+        auto size = readLe32(chunk + 4);
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+            uint8_t format[16];
+            if (std::fread(format, 1, sizeof(format), file.handle) != sizeof(format)) {
+                break;
+            }
+            auto tag = readLe16(format);
+            clip->channels = readLe16(format + 2);
+            clip->sample_rate = static_cast<int>(readLe32(format + 4));
+            auto bits = readLe16(format + 14);
+            if ((tag != 1 && tag != 0xFFFE) || bits != 16) {
+                error = "only 16-bit PCM WAV is supported";
+                return nullptr;
+            }
+            if (clip->channels < 1 || clip->channels > 2 || !supportedSampleRate(clip->sample_rate)) {
+                error = "unsupported WAV channels or sample rate";
+                return nullptr;
+            }
+            has_format = true;
+            size -= sizeof(format);
+        }
+        else if (std::memcmp(chunk, "data", 4) == 0 && has_format) {
+            clip->samples.resize(size / sizeof(int16_t));
+            auto read = std::fread(clip->samples.data(), sizeof(int16_t), clip->samples.size(), file.handle);
+            clip->samples.resize(read - read % clip->channels);
+            break;
+        }
+        // {zh} 块按偶数字节对齐
+        // {en} Chunks are padded to an even size
+        if (std::fseek(file.handle, static_cast<long>(size + (size & 1)), SEEK_CUR) != 0) {
+            break;
+        }
+    }
+    if (clip->samples.size() < static_cast<size_t>(clip->samplesPer10Ms())) {
+        error = "no PCM data in " + path;
+        return nullptr;
+    }
+    return clip;
+}
+
+std::shared_ptr<const VideoClip> makeTestPattern(int width, int height, int fps) {
+    auto clip = std::make_shared<VideoClip>();
+    clip->width = width;
+    clip->height = height;
+    clip->fps_num = fps;
+    clip->fps_den = 1;
+    auto luma = static_cast<size_t>(width) * height;
+    auto chroma = (clip->frameSize() - luma) / 2;
+    clip->data.resize(clip->frameSize() * fps);
+    for (int i = 0; i < fps; ++i) {
+        auto y = clip->data.data() + clip->frameSize() * i;
+        for (int row = 0; row < height; ++row) {
+            for (int col = 0; col < width; ++col) {
+                y[static_cast<size_t>(row) * width + col] = static_cast<uint8_t>(col + row + i * 255 / fps);
+            }
+        }
+        memset(y + luma, 128 + i * 64 / fps, chroma);
+        memset(y + luma + chroma, 128, chroma);
+    }
+    return clip;
+}
+
+std::shared_ptr<const AudioClip> makeTone(int sample_rate, double frequency) {
+    const double kPi = 3.14159265358979323846;
+    auto clip = std::make_shared<AudioClip>();
+    clip->sample_rate = sample_rate;
+    clip->channels = 1;
+    clip->samples.resize(sample_rate);
+    for (int i = 0; i < sample_rate; ++i) {
+        clip->samples[i] = static_cast<int16_t>(8000 * std::sin(2 * kPi * frequency * i / sample_rate));
+    }
+    return clip;
+}
+
+}  // namespace bot
+}  // namespace vrd
@@ -0,0 +1,64 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace vrd {
+namespace bot {
+
+/** {zh}
+ * 机器人推流用的I420视频片段，所有帧连续存放，供多个机器人共享只读使用
+ */
+
+/** {en}
+* I420 video clip pushed by bots, frames stored back to back and shared read-only by many bots
+*/
+struct VideoClip {
+    int width = 0;
+    int height = 0;
+    // {zh} 帧率为 fps_num / fps_den
+    // {en} The frame rate is fps_num / fps_den
+    int fps_num = 15;
+    int fps_den = 1;
+    std::vector<uint8_t> data;
+
+    size_t frameSize() const;
+    int frameCount() const;
+    const uint8_t* frame(int index) const;
+};
+
+/** {zh}
+ * 机器人推流用的PCM16交错音频片段
+ */
+
+/** {en}
+* Interleaved PCM16 audio clip pushed by bots
+*/
+struct AudioClip {
+    int sample_rate = 48000;
+    int channels = 1;
+    std::vector<int16_t> samples;
+
+    // {zh} 10毫秒的交错采样数，SDK要求外部音频按10毫秒推送
+    // {en} Interleaved samples in 10 ms, the SDK expects external audio in 10 ms frames
+    int samplesPer10Ms() const;
+};
+
+// {zh} 只支持4:2:0色度采样，最多读取 max_frames 帧；失败时返回空并在 error 中说明
+// {en} Only 4:2:0 chroma is supported and at most max_frames frames are read; returns null with a reason in error on failure
+std::shared_ptr<const VideoClip> loadY4m(const std::string& path, int max_frames, std::string& error);
+// {zh} 只支持16位PCM，1或2声道，采样率为8k/16k/32k/44.1k/48k
+// {en} Only 16-bit PCM with 1 or 2 channels at 8k/16k/32k/44.1k/48k
+std::shared_ptr<const AudioClip> loadWav(const std::string& path, std::string& error);
+
+// {zh} 生成一秒的移动渐变图案，在没有 Y4M 文件时使用
+// {en} Generates one second of a moving gradient, used when no Y4M file is given
+std::shared_ptr<const VideoClip> makeTestPattern(int width, int height, int fps);
+// {zh} 生成一秒的正弦音，在没有 WAV 文件时使用
+// {en} Generates one second of a sine tone, used when no WAV file is given
+std::shared_ptr<const AudioClip> makeTone(int sample_rate, double frequency);
+
+}  // namespace bot
+}  // namespace vrd
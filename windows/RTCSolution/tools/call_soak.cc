@@ -0,0 +1,407 @@
+﻿#include <QApplication>
+#include <QDebug>
+#include <QDialog>
+#include <QTimer>
+#include <QToolButton>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#if defined(__GLIBC__) || defined(_WIN32)
+#include <malloc.h>
+#endif
+
+#include "core/resource_sampler.h"
+#include "core/rtc_engine_wrap.h"
+#include "core/session_base.h"
+#include "core/timer_wheel.h"
+#include "videocall/core/data_mgr.h"
+#include "videocall/core/videocall_manager.h"
+#include "videocall/core/videocall_rtc_wrap.h"
+#include "videocall/core/videocall_session.h"
+#include "videocall/feature/videocall_realtime_data.h"
+
+/** {zh}
+ * 统计本进程经 operator new 的存活分配数和字节数
+ * Linux 上共享库（含Qt）的 new 也会解析到这里；Windows 上只覆盖本程序和静态链接的代码，DLL内的分配看常驻内存
+ */
+
+/** {en}
+* Live allocation count and bytes through operator new in this process
+* On Linux, new in shared libraries (Qt included) resolves here too; on Windows only this program and statically linked code
+* are covered, allocations inside DLLs show up in resident memory
+*/
+namespace
+{
+    std::atomic<int64_t> g_live_allocations(0);
+    std::atomic<int64_t> g_live_bytes(0);
+
+    size_t usableSize(void* ptr) {
+#if defined(__GLIBC__)
+        return malloc_usable_size(ptr);
+#elif defined(_WIN32)
+        return _msize(ptr);
+#else
+        (void)ptr;
+        return 0;
+#endif
+    }
+
+    void* countedAlloc(size_t size) {
+        auto ptr = std::malloc(size == 0 ? 1 : size);
+        if (ptr) {
+            g_live_allocations.fetch_add(1, std::memory_order_relaxed);
+            g_live_bytes.fetch_add(static_cast<int64_t>(usableSize(ptr)), std::memory_order_relaxed);
+        }
+        return ptr;
+    }
+
+    void countedFree(void* ptr) {
+        if (ptr) {
+            g_live_allocations.fetch_sub(1, std::memory_order_relaxed);
+            g_live_bytes.fetch_sub(static_cast<int64_t>(usableSize(ptr)), std::memory_order_relaxed);
+            std::free(ptr);
+        }
+    }
+}
+
+void* operator new(size_t size) {
+    auto ptr = countedAlloc(size);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    countedFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    countedFree(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    countedFree(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    countedFree(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    countedFree(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    countedFree(ptr);
+}
+
+namespace
+{
+    const char* const kRoomId = "call_soak";
+    const char* const kUserId = "soak_user";
+
+    struct Options {
+        int duration_s = 3600;
+        int interval_s = 5;
+        int action_interval_ms = 2000;
+        int warmup_s = -1;
+        QString out;
+        // {zh} 每小时允许的增长量
+        // {en} Allowed growth per hour
+        double rss_mb = 32.0;
+        double heap_mb = 16.0;
+        double heap_allocations = 20000.0;
+        double objects = 100.0;
+        double objects_per_class = 50.0;
+        double threads = 1.0;
+        double handles = 30.0;
+    };
+
+    void quietMessageHandler(QtMsgType type, const QMessageLogContext& context, const QString& message) {
+        if (type == QtDebugMsg) {
+            return;
+        }
+        fprintf(stderr, "%s\n", qPrintable(message));
+    }
+
+    void usage() {
+        fprintf(stderr, "usage: call_soak [--duration seconds] [--interval seconds] [--action-interval ms]\n"
+            "                 [--warmup seconds] [--out report.json]\n"
+            "                 [--rss-mb n] [--heap-mb n] [--heap-allocations n] [--qobjects n]\n"
+            "                 [--qobjects-per-class n] [--threads n] [--handles n]\n"
+            "thresholds are allowed growth per hour\n");
+    }
+
+    bool parseOptions(const QStringList& args, Options& options) {
+        for (int i = 1; i < args.size(); ++i) {
+            if (i + 1 >= args.size()) {
+                return false;
+            }
+            auto& name = args[i];
+            auto& value = args[++i];
+            bool ok = true;
+            if (name == "--duration") {
+                options.duration_s = value.toInt(&ok);
+            } else if (name == "--interval") {
+                options.interval_s = value.toInt(&ok);
+            } else if (name == "--action-interval") {
+                options.action_interval_ms = value.toInt(&ok);
+            } else if (name == "--warmup") {
+                options.warmup_s = value.toInt(&ok);
+            } else if (name == "--out") {
+                options.out = value;
+            } else if (name == "--rss-mb") {
+                options.rss_mb = value.toDouble(&ok);
+            } else if (name == "--heap-mb") {
+                options.heap_mb = value.toDouble(&ok);
+            } else if (name == "--heap-allocations") {
+                options.heap_allocations = value.toDouble(&ok);
+            } else if (name == "--qobjects") {
+                options.objects = value.toDouble(&ok);
+            } else if (name == "--qobjects-per-class") {
+                options.objects_per_class = value.toDouble(&ok);
+            } else if (name == "--threads") {
+                options.threads = value.toDouble(&ok);
+            } else if (name == "--handles") {
+                options.handles = value.toDouble(&ok);
+            } else {
+                return false;
+            }
+            if (!ok) {
+                return false;
+            }
+        }
+        if (options.warmup_s < 0) {
+            options.warmup_s = std::max(30, options.duration_s / 10);
+        }
+        return options.duration_s > 0 && options.interval_s > 0 && options.action_interval_ms > 0;
+    }
+
+    void addGauges(vrd::ResourceSampler& sampler) {
+        sampler.addGauge("heap.allocations", [] {
+            return static_cast<double>(g_live_allocations.load(std::memory_order_relaxed));
+        });
+        sampler.addGauge("heap.bytes", [] {
+            return static_cast<double>(g_live_bytes.load(std::memory_order_relaxed));
+        });
+#if defined(__GLIBC__)
+#if __GLIBC_PREREQ(2, 33)
+        // {zh} 包含直接调用 malloc 的分配，例如Qt容器和SDK
+        // {en} Includes allocations that call malloc directly, such as Qt containers and the SDK
+        sampler.addGauge("heap.malloc_bytes", [] {
+            return static_cast<double>(mallinfo2().uordblks);
+        });
+#endif
+#endif
+        // {zh} 以下为子系统指标，出现增长时会列为可能的来源
+        // {en} Subsystem gauges below, listed as likely sources when they grow
+        sampler.addSubsystemGauge("rts.in_flight_requests", [] {
+            return static_cast<double>(VRD_FUNC_GET_COMPONET(vrd::SessionBase)->inFlightRequests());
+        });
+        sampler.addSubsystemGauge("timer_wheel.pending", [] {
+            return static_cast<double>(vrd::TimerWheel::instance().pending());
+        });
+        sampler.addSubsystemGauge("videocall.users", [] {
+            return static_cast<double>(videocall::DataMgr::instance().ref_users().size());
+        });
+        sampler.addSubsystemGauge("videocall.remote_stream_infos", [] {
+            return static_cast<double>(videocall::DataMgr::instance().ref_remote_stream_infos().size());
+        });
+        sampler.addSubsystemGauge("videocall.video_widgets", [] {
+            return static_cast<double>(videocall::VideoCallManager::getVideoList().size());
+        });
+    }
+
+    void setThresholds(vrd::ResourceSampler& sampler, const Options& options) {
+        sampler.setThreshold(vrd::ResourceSampler::kRss, options.rss_mb * 1024 * 1024);
+        sampler.setThreshold("heap.allocations", options.heap_allocations);
+        sampler.setThreshold("heap.bytes", options.heap_mb * 1024 * 1024);
+        sampler.setThreshold("heap.malloc_bytes", options.heap_mb * 1024 * 1024);
+        sampler.setThreshold(vrd::ResourceSampler::kObjects, options.objects);
+        sampler.setThreshold(vrd::ResourceSampler::kObjectPrefix, options.objects_per_class);
+        sampler.setThreshold(vrd::ResourceSampler::kThreads, options.threads);
+        sampler.setThreshold(vrd::ResourceSampler::kHandles, options.handles);
+        // {zh} 子系统指标应保持平稳，远端人数随替身引擎的进出波动，留出余量
+        // {en} Subsystem gauges should stay flat; remote counts move with the stand-in engine's churn, so leave headroom
+        sampler.setThreshold("rts.", 10);
+        sampler.setThreshold("timer_wheel.", 10);
+        sampler.setThreshold("videocall.", 10);
+    }
+
+    // {zh} 模态对话框由 exec 打开，排在其后的定时器会在对话框的事件循环里关闭它
+    // {en} Modal dialogs open through exec, a timer queued behind closes them from inside the dialog's event loop
+    void rejectModalLater() {
+        QTimer::singleShot(200, [] {
+            if (auto dialog = qobject_cast<QDialog*>(QApplication::activeModalWidget())) {
+                dialog->reject();
+            }
+        });
+    }
+
+    void click(const char* name) {
+        auto page = videocall::VideoCallManager::currentWidget();
+        auto button = page ? page->findChild<QToolButton*>(name) : nullptr;
+        if (button) {
+            button->click();
+        }
+    }
+
+    /** {zh}
+     * 按固定顺序轮流执行用户操作，每次操作后页面应回到原状态，长时间循环下任何残留都会表现为增长
+     */
+
+    /** {en}
+    * User actions in a fixed rotation; each leaves the page as it found it, so anything left behind shows up as growth over the run
+    */
+    void runAction(int step) {
+        switch (step % 8) {
+        case 0:
+        case 1:
+            click("micBtn");
+            break;
+        case 2:
+        case 3:
+            click("cameraBtn");
+            break;
+        case 4:
+            click("beautyBtn");
+            click("beautyBtn");
+            break;
+        case 5: {
+            click("dataBtn");
+            auto page = videocall::VideoCallManager::currentWidget();
+            if (auto data = page ? page->findChild<VideoCallData*>() : nullptr) {
+                data->hide();
+            }
+            break;
+        }
+        case 6:
+            rejectModalLater();
+            click("settingBtn");
+            break;
+        case 7:
+            vrd::VideoCallSession::instance().userReconnect([](int code) {
+                if (code != 200) {
+                    qWarning() << "reconnect failed:" << code;
+                }
+            });
+            break;
+        }
+    }
+}
+
+/** {zh}
+ * 长时间通话浸泡测试：无界面地以替身引擎进房，周期性执行用户操作并采样资源，结束时按增长斜率判定是否泄漏
+ * 用法: call_soak [--duration 秒] [--interval 秒] [--warmup 秒] [--out 报告JSON] [阈值...]
+ * 有泄漏时返回1，参数错误返回2，进房失败返回3
+ */
+
+/** {en}
+* Long-call soak: joins headlessly against the stand-in engine, runs user actions periodically while sampling resources,
+* and judges leaks by growth slope at the end
+* Usage: call_soak [--duration seconds] [--interval seconds] [--warmup seconds] [--out report JSON] [thresholds...]
+* Returns 1 on a leak, 2 on bad arguments and 3 when the join fails
+*/
+int main(int argc, char* argv[]) {
+    vrd::ResourceSampler::installObjectCensus();
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    // {zh} 默认让远端用户持续进出，覆盖视频块的创建和回收
+    // {en} Keep remote users coming and going by default so video tile setup and teardown is covered
+    if (qEnvironmentVariableIsEmpty("VRD_FAKE_CHURN_MS")) {
+        qputenv("VRD_FAKE_CHURN_MS", "3000");
+    }
+    QApplication app(argc, argv);
+    qInstallMessageHandler(quietMessageHandler);
+
+    Options options;
+    if (!parseOptions(app.arguments(), options)) {
+        usage();
+        return 2;
+    }
+
+    vrd::SessionBase::registerThis();
+    RtcEngineWrap::instance().createEngine("soak");
+    auto base = VRD_FUNC_GET_COMPONET(vrd::SessionBase);
+    base->setUserId(kUserId);
+    base->setToken("soak_login_token");
+    // {zh} 跳过业务服务器参数设置，请求直接发给替身引擎
+    // {en} Skip the business server params round trip, requests go straight to the stand-in engine
+    base->onServerParamsSetResult(200);
+
+    VideoCallRtcEngineWrap::init();
+    videocall::VideoCallManager::init();
+    videocall::DataMgr::instance().setUserID(kUserId);
+    videocall::DataMgr::instance().setUserName("soak user");
+
+    vrd::ResourceSampler sampler;
+    addGauges(sampler);
+    setThresholds(sampler, options);
+
+    QTimer sample_timer;
+    QObject::connect(&sample_timer, &QTimer::timeout, [&sampler] { sampler.sample(); });
+    QTimer action_timer;
+    int step = 0;
+    QObject::connect(&action_timer, &QTimer::timeout, [&step] { runAction(step++); });
+
+    int exit_code = 0;
+    // {zh} 与登录页相同的进房流程
+    // {en} The same join flow as the login page
+    vrd::VideoCallSession::instance().joinCallTask(kUserId, kRoomId)
+        .then([&](const int&) {
+            vrd::VideoCallSession::instance().setRoomId(videocall::DataMgr::instance().room_id());
+            videocall::VideoCallManager::initRoom();
+            VideoCallRtcEngineWrap::login(videocall::DataMgr::instance().room_id(),
+                videocall::DataMgr::instance().user_id(), videocall::DataMgr::instance().token());
+            VideoCallRtcEngineWrap::muteLocalVideo(false);
+            VideoCallRtcEngineWrap::enableLocalVideo(true);
+            VideoCallRtcEngineWrap::muteLocalAudio(false);
+            VideoCallRtcEngineWrap::enableLocalAudio(true);
+            sampler.sample();
+            sample_timer.start(options.interval_s * 1000);
+            action_timer.start(options.action_interval_ms);
+            QTimer::singleShot(options.duration_s * 1000, &app, &QApplication::quit);
+        })
+        .always([&](const vrd::TaskResult<vrd::TaskVoid>& result) {
+            if (!result.ok()) {
+                fprintf(stderr, "join failed: %d\n", result.code);
+                exit_code = 3;
+                QTimer::singleShot(0, &app, &QApplication::quit);
+            }
+        });
+    app.exec();
+    sample_timer.stop();
+    action_timer.stop();
+
+    if (exit_code == 0) {
+        sampler.sample();
+        auto report = sampler.analyze(static_cast<int64_t>(options.warmup_s) * 1000);
+        sampler.logReport(report);
+        if (!options.out.isEmpty() && !sampler.writeReport(options.out, report)) {
+            fprintf(stderr, "failed to write %s\n", qPrintable(options.out));
+        }
+        exit_code = report.passed ? 0 : 1;
+    }
+
+    VideoCallRtcEngineWrap::logout();
+    RtcEngineWrap::instance().destroyEngine();
+    qInstallMessageHandler(nullptr);
+    return exit_code;
+}
@@ -0,0 +1,338 @@
+﻿#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalSocket>
+#include <QProcess>
+#include <QTimer>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/** {zh}
+ * 压测启动器：启动N个应用实例，经本地控制服务（--control-socket）让每个实例进入同一房间，
+ * 统计进房和首帧耗时的分布
+ * 实例需已保存登录信息，启动后直接停在场景选择页
+ */
+
+/** {en}
+* Load-test launcher: starts N app instances, drives each into the same room through the local control server
+* (--control-socket) and reports the time-to-join and time-to-first-frame distributions
+* Instances need a saved login so that they start on the scene selection page
+*/
+namespace
+{
+    // {zh} 控制服务推送的里程碑事件，数值为相对 join 请求的毫秒数
+    // {en} Milestone events pushed by the control server, valued in milliseconds since the join request
+    const char* const kMilestones[] = {
+        "join_accepted",
+        "rtc_room_joined",
+        "first_local_video_frame",
+        "first_remote_video_frame",
+    };
+    const int kMilestoneCount = sizeof(kMilestones) / sizeof(kMilestones[0]);
+    const int kRetryMs = 500;
+
+    struct Options {
+        QString app;
+        int instances = 4;
+        QString room = "load_test";
+        QString prefix = "vrd_ctl";
+        int stagger_ms = 200;
+        int timeout_s = 60;
+        int hold_s = 5;
+        QString out;
+    };
+
+    struct Instance {
+        int index = 0;
+        QString name;
+        std::unique_ptr<QProcess> process;
+        std::unique_ptr<QLocalSocket> socket;
+        int next_id = 1;
+        // {zh} 请求ID到命令名
+        // {en} Request id to command name
+        std::map<int, std::string> pending;
+        bool joined = false;
+        int last_code = 0;
+        double milestones[kMilestoneCount] = {};
+    };
+
+    void usage() {
+        fprintf(stderr, "usage: control_launcher --app <path> [--instances n] [--room id] [--prefix name]\n"
+            "                        [--stagger ms] [--timeout seconds] [--hold seconds] [--out report.json]\n");
+    }
+
+    bool parseOptions(const QStringList& args, Options& options) {
+        for (int i = 1; i < args.size(); ++i) {
+            if (i + 1 >= args.size()) {
+                return false;
+            }
+            auto& name = args[i];
+            auto& value = args[++i];
+            bool ok = true;
+            if (name == "--app") {
+                options.app = value;
+            } else if (name == "--instances") {
+                options.instances = value.toInt(&ok);
+            } else if (name == "--room") {
+                options.room = value;
+            } else if (name == "--prefix") {
+                options.prefix = value;
+            } else if (name == "--stagger") {
+                options.stagger_ms = value.toInt(&ok);
+            } else if (name == "--timeout") {
+                options.timeout_s = value.toInt(&ok);
+            } else if (name == "--hold") {
+                options.hold_s = value.toInt(&ok);
+            } else if (name == "--out") {
+                options.out = value;
+            } else {
+                return false;
+            }
+            if (!ok) {
+                return false;
+            }
+        }
+        return !options.app.isEmpty() && options.instances > 0;
+    }
+
+    double percentile(const std::vector<double>& sorted, double p) {
+        if (sorted.empty()) {
+            return 0;
+        }
+        auto rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+        return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+    }
+
+    /** {zh}
+     * 驱动所有实例：连接 -> open_scene -> join，失败（场景未就绪）时稍后重试
+     * 所有实例收到远端首帧或超时后离房并结束进程
+     */
+
+    /** {en}
+    * Drives every instance: connect -> open_scene -> join, retried later while the scene is not ready
+    * Once every instance has a first remote frame or the timeout hits, instances leave and their processes end
+    */
+    class Launcher {
+    public:
+        explicit Launcher(const Options& options) : options_(options) {}
+
+        void start() {
+            for (int i = 0; i < options_.instances; ++i) {
+                instances_.emplace_back(new Instance);
+                auto instance = instances_.back().get();
+                instance->index = i;
+                instance->name = QString("%1_%2").arg(options_.prefix).arg(i);
+                QTimer::singleShot(i * options_.stagger_ms, [this, instance] { launch(instance); });
+            }
+            QTimer::singleShot(options_.timeout_s * 1000, [this] { finish(); });
+        }
+
+        int report() const {
+            QJsonObject result;
+            result["instances"] = options_.instances;
+            int complete = 0;
+            for (auto& instance : instances_) {
+                if (instance->milestones[kMilestoneCount - 1] > 0) {
+                    ++complete;
+                }
+            }
+            result["complete"] = complete;
+
+            printf("%-26s %6s %8s %8s %8s %8s\n", "milestone (ms since join)", "n", "p50", "p90", "p99", "max");
+            QJsonObject milestones;
+            for (int m = 0; m < kMilestoneCount; ++m) {
+                std::vector<double> values;
+                for (auto& instance : instances_) {
+                    if (instance->milestones[m] > 0) {
+                        values.push_back(instance->milestones[m]);
+                    }
+                }
+                std::sort(values.begin(), values.end());
+                QJsonObject item;
+                item["n"] = static_cast<int>(values.size());
+                item["p50"] = percentile(values, 0.5);
+                item["p90"] = percentile(values, 0.9);
+                item["p99"] = percentile(values, 0.99);
+                item["max"] = values.empty() ? 0.0 : values.back();
+                milestones[kMilestones[m]] = item;
+                printf("%-26s %6d %8.0f %8.0f %8.0f %8.0f\n", kMilestones[m], static_cast<int>(values.size()),
+                    item["p50"].toDouble(), item["p90"].toDouble(), item["p99"].toDouble(), item["max"].toDouble());
+            }
+            result["milestones"] = milestones;
+
+            QJsonArray failures;
+            for (auto& instance : instances_) {
+                if (instance->milestones[kMilestoneCount - 1] <= 0) {
+                    QJsonObject item;
+                    item["index"] = instance->index;
+                    item["joined"] = instance->joined;
+                    item["last_code"] = instance->last_code;
+                    failures.append(item);
+                }
+            }
+            result["incomplete"] = failures;
+            printf("%d of %d instances reached the first remote frame\n", complete, options_.instances);
+
+            if (!options_.out.isEmpty()) {
+                QFile file(options_.out);
+                if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+                    fprintf(stderr, "cannot write %s\n", qPrintable(options_.out));
+                    return 2;
+                }
+                file.write(QJsonDocument(result).toJson());
+            }
+            return complete == options_.instances ? 0 : 1;
+        }
+
+    private:
+        void launch(Instance* instance) {
+            if (finishing_) {
+                return;
+            }
+            instance->process.reset(new QProcess);
+            instance->process->setStandardOutputFile(QProcess::nullDevice());
+            instance->process->setStandardErrorFile(QProcess::nullDevice());
+            instance->process->start(options_.app, QStringList() << ("--control-socket=" + instance->name));
+
+            instance->socket.reset(new QLocalSocket);
+            auto socket = instance->socket.get();
+            QObject::connect(socket, &QLocalSocket::connected, [this, instance] { request(instance, "open_scene"); });
+            QObject::connect(socket, &QLocalSocket::readyRead, [this, instance] { onReadyRead(instance); });
+            // {zh} 应用启动完成前连接会失败，稍后重试
+            // {en} Connecting fails until the app has started, retry later
+            QObject::connect(socket, static_cast<void (QLocalSocket::*)(QLocalSocket::LocalSocketError)>(
+                &QLocalSocket::error), [this, instance](QLocalSocket::LocalSocketError) {
+                    QTimer::singleShot(kRetryMs, [this, instance] { connectInstance(instance); });
+                });
+            connectInstance(instance);
+        }
+
+        void connectInstance(Instance* instance) {
+            if (finishing_ || instance->socket->state() != QLocalSocket::UnconnectedState) {
+                return;
+            }
+            instance->socket->connectToServer(instance->name);
+        }
+
+        void request(Instance* instance, const char* cmd, const QJsonObject& args = QJsonObject()) {
+            QJsonObject message;
+            message["id"] = instance->next_id++;
+            message["cmd"] = cmd;
+            message["args"] = args;
+            auto line = QJsonDocument(message).toJson(QJsonDocument::Compact);
+            line.append('\n');
+            instance->pending[message["id"].toInt()] = cmd;
+            instance->socket->write(line);
+        }
+
+        void join(Instance* instance) {
+            QJsonObject args;
+            args["room_id"] = options_.room;
+            args["user_name"] = QString("load %1").arg(instance->index);
+            request(instance, "join", args);
+        }
+
+        void onReadyRead(Instance* instance) {
+            while (instance->socket->canReadLine()) {
+                auto message = QJsonDocument::fromJson(instance->socket->readLine()).object();
+                if (message.contains("event")) {
+                    onEvent(instance, message["event"].toString(), message["data"].toObject());
+                } else if (message.contains("id")) {
+                    auto id = message["id"].toInt();
+                    auto cmd = instance->pending[id];
+                    instance->pending.erase(id);
+                    onReply(instance, cmd, message["code"].toInt());
+                }
+            }
+        }
+
+        void onReply(Instance* instance, const std::string& cmd, int code) {
+            instance->last_code = code;
+            if (cmd == "open_scene") {
+                // {zh} 已在场景内时 open_scene 返回不可用，直接尝试进房
+                // {en} open_scene is unavailable when already inside the scene, just try to join
+                join(instance);
+            } else if (cmd == "join") {
+                if (code == 0) {
+                    instance->joined = true;
+                } else if (!finishing_) {
+                    QTimer::singleShot(kRetryMs, [this, instance] { request(instance, "open_scene"); });
+                }
+            }
+        }
+
+        void onEvent(Instance* instance, const QString& event, const QJsonObject& data) {
+            for (int m = 0; m < kMilestoneCount; ++m) {
+                if (event == kMilestones[m] && instance->milestones[m] <= 0) {
+                    // {zh} 取应用内的耗时，不受控制通道延迟影响
+                    // {en} Use the in-app duration, unaffected by control channel latency
+                    instance->milestones[m] = std::max(data["since_join_ms"].toDouble(), 1.0);
+                }
+            }
+            if (allComplete()) {
+                QTimer::singleShot(options_.hold_s * 1000, [this] { finish(); });
+            }
+        }
+
+        bool allComplete() const {
+            for (auto& instance : instances_) {
+                if (instance->milestones[kMilestoneCount - 1] <= 0) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void finish() {
+            if (finishing_) {
+                return;
+            }
+            finishing_ = true;
+            for (auto& instance : instances_) {
+                if (instance->socket && instance->socket->state() == QLocalSocket::ConnectedState && instance->joined) {
+                    request(instance.get(), "leave");
+                    instance->socket->flush();
+                }
+            }
+            // {zh} 给离房请求留出时间，然后结束所有实例
+            // {en} Leave time for the leave requests, then end every instance
+            QTimer::singleShot(2000, [this] {
+                for (auto& instance : instances_) {
+                    if (instance->process) {
+                        instance->process->terminate();
+                        if (!instance->process->waitForFinished(3000)) {
+                            instance->process->kill();
+                            instance->process->waitForFinished(1000);
+                        }
+                    }
+                }
+                QCoreApplication::quit();
+            });
+        }
+
+        Options options_;
+        std::vector<std::unique_ptr<Instance>> instances_;
+        bool finishing_ = false;
+    };
+}
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    Options options;
+    if (!parseOptions(app.arguments(), options)) {
+        usage();
+        return 2;
+    }
+
+    Launcher launcher(options);
+    launcher.start();
+    app.exec();
+    return launcher.report();
+}
@@ -0,0 +1,265 @@
+#include "video_visibility_tracker.h"
+
+#include <QEvent>
+#include <QTimer>
+#include <QWidget>
+
+#include "videocall/core/videocall_rtc_wrap.h"
+#include "videocall/core/videocall_video_widget.h"
+
+namespace videocall {
+
+VideoVisibilityTracker& VideoVisibilityTracker::instance() {
+    static VideoVisibilityTracker tracker;
+    return tracker;
+}
+
+void VideoVisibilityTracker::track(VideoCallVideoWidget* widget) {
+    if (!widget || tiles_.count(widget)) {
+        return;
+    }
+    tiles_[widget] = TileState();
+    widget->installEventFilter(this);
+    connect(widget, &QObject::destroyed, this, [this, widget] {
+        auto iter = tiles_.find(widget);
+        if (iter != tiles_.end()) {
+            releaseOwner(widget, iter->second);
+            tiles_.erase(iter);
+        }
+    });
+}
+
+void VideoVisibilityTracker::watchWindow(QWidget* window) {
+    if (window_ == window) {
+        return;
+    }
+    if (window_) {
+        window_->removeEventFilter(this);
+    }
+    window_ = window;
+    if (window_) {
+        window_->installEventFilter(this);
+    }
+}
+
+void VideoVisibilityTracker::bind(VideoCallVideoWidget* widget, const Binding& binding) {
+    track(widget);
+    auto& state = tiles_[widget];
+    auto view = widget->getWinID();
+    auto key = bindingKey(binding);
+    bool same_binding = state.bound && bindingKey(state.binding) == key
+        && state.binding.render_mode == binding.render_mode && state.view == view;
+    // {zh} 绑定未变化时不重复设置画布，避免每次刷新页面都调用SDK
+    // {en} Skip the SDK call when nothing changed, so page refreshes do not rebind canvases
+    if (same_binding && owners_[key] == widget) {
+        if (!state.attached) {
+            scheduleRefresh();
+        }
+        return;
+    }
+
+    if (state.attached && bindingKey(state.binding) != key
+        && owners_[bindingKey(state.binding)] == widget) {
+        setCanvas(state.binding, nullptr);
+    }
+    releaseOwner(widget, state);
+
+    // {zh} 该流的画布被其他渲染块持有时，由本渲染块接管
+    // {en} When another block holds this stream's canvas, this block takes it over
+    auto owner = owners_.find(key);
+    if (owner != owners_.end() && owner->second != widget) {
+        auto& prev = tiles_[owner->second];
+        prev.bound = false;
+        prev.attached = false;
+        prev.suspended = false;
+    }
+    owners_[key] = widget;
+
+    state.binding = binding;
+    state.view = view;
+    state.bound = true;
+    state.attached = false;
+    state.suspended = false;
+
+    if (isEffectivelyVisible(widget)) {
+        attach(widget, state);
+    }
+    else {
+        scheduleRefresh();
+    }
+}
+
+void VideoVisibilityTracker::unbind(VideoCallVideoWidget* widget) {
+    auto iter = tiles_.find(widget);
+    if (iter == tiles_.end() || !iter->second.bound) {
+        return;
+    }
+    auto& state = iter->second;
+    if (state.attached) {
+        detach(state);
+    }
+    releaseOwner(widget, state);
+    state = TileState();
+}
+
+void VideoVisibilityTracker::reset() {
+    for (auto& tile : tiles_) {
+        tile.second = TileState();
+    }
+    owners_.clear();
+    if (video_paused_) {
+        VideoCallRtcEngineWrap::pauseSubscribedVideo(false);
+        video_paused_ = false;
+    }
+}
+
+void VideoVisibilityTracker::refresh() {
+    refresh_pending_ = false;
+    for (auto& tile : tiles_) {
+        auto& state = tile.second;
+        if (!state.bound) {
+            continue;
+        }
+        bool visible = isEffectivelyVisible(tile.first);
+        if (visible && !state.attached) {
+            attach(tile.first, state);
+        }
+        else if (!visible && state.attached) {
+            detach(state);
+        }
+    }
+}
+
+bool VideoVisibilityTracker::isSuspended(VideoCallVideoWidget* widget) const {
+    auto iter = tiles_.find(widget);
+    return iter != tiles_.end() && iter->second.bound && !iter->second.attached;
+}
+
+void VideoVisibilityTracker::setPauseVideoWhenMinimized(bool enabled) {
+    pause_video_when_minimized_ = enabled;
+    if (!enabled && video_paused_) {
+        VideoCallRtcEngineWrap::pauseSubscribedVideo(false);
+        video_paused_ = false;
+    }
+}
+
+bool VideoVisibilityTracker::pauseVideoWhenMinimized() const {
+    return pause_video_when_minimized_;
+}
+
+bool VideoVisibilityTracker::eventFilter(QObject* watched, QEvent* e) {
+    switch (e->type()) {
+    case QEvent::Show:
+    case QEvent::Hide:
+    case QEvent::Move:
+    case QEvent::Resize:
+    case QEvent::ParentChange:
+        scheduleRefresh();
+        break;
+    case QEvent::WindowStateChange:
+        if (watched == window_) {
+            onWindowStateChanged();
+        }
+        scheduleRefresh();
+        break;
+    default:
+        break;
+    }
+    return QObject::eventFilter(watched, e);
+}
+
+/** {zh}
+ * 合并同一轮事件循环内的多次可见性变化，网格重排时只计算一次
+ */
+
+/** {en}
+* Coalesce visibility changes within one event loop pass, so a grid rebuild is evaluated once
+*/
+void VideoVisibilityTracker::scheduleRefresh() {
+    if (refresh_pending_) {
+        return;
+    }
+    refresh_pending_ = true;
+    QTimer::singleShot(0, this, [this] { refresh(); });
+}
+
+bool VideoVisibilityTracker::isEffectivelyVisible(VideoCallVideoWidget* widget) const {
+    if (!widget->isVisible()) {
+        return false;
+    }
+    auto window = widget->window();
+    if (!window || window->isMinimized()) {
+        return false;
+    }
+    return !widget->visibleRegion().isEmpty();
+}
+
+void VideoVisibilityTracker::attach(VideoCallVideoWidget* widget, TileState& state) {
+    state.view = widget->getWinID();
+    setCanvas(state.binding, state.view);
+    if (state.suspended && !state.binding.is_local) {
+        VideoCallRtcEngineWrap::requestRemoteVideoKeyFrame(
+            state.binding.user_id, state.binding.stream_index);
+    }
+    state.attached = true;
+    state.suspended = false;
+}
+
+void VideoVisibilityTracker::detach(TileState& state) {
+    setCanvas(state.binding, nullptr);
+    state.attached = false;
+    state.suspended = true;
+}
+
+void VideoVisibilityTracker::releaseOwner(VideoCallVideoWidget* widget, const TileState& state) {
+    if (!state.bound) {
+        return;
+    }
+    auto owner = owners_.find(bindingKey(state.binding));
+    if (owner != owners_.end() && owner->second == widget) {
+        owners_.erase(owner);
+    }
+}
+
+void VideoVisibilityTracker::onWindowStateChanged() {
+    if (!pause_video_when_minimized_ || !window_) {
+        return;
+    }
+    bool minimized = window_->isMinimized();
+    if (minimized == video_paused_) {
+        return;
+    }
+    VideoCallRtcEngineWrap::pauseSubscribedVideo(minimized);
+    video_paused_ = minimized;
+    if (minimized) {
+        return;
+    }
+    // {zh} 恢复接收后，为仍绑定着画布的远端流请求关键帧
+    // {en} After resuming, request key frames for remote streams whose canvas stayed attached
+    for (auto& tile : tiles_) {
+        const auto& state = tile.second;
+        if (state.attached && !state.binding.is_local) {
+            VideoCallRtcEngineWrap::requestRemoteVideoKeyFrame(
+                state.binding.user_id, state.binding.stream_index);
+        }
+    }
+}
+
+void VideoVisibilityTracker::setCanvas(const Binding& binding, void* view) {
+    if (binding.is_local) {
+        VideoCallRtcEngineWrap::setupLocalView(view, binding.render_mode, binding.user_id);
+    }
+    else if (binding.stream_index == bytertc::kStreamIndexScreen) {
+        VideoCallRtcEngineWrap::setRemoteScreenView(binding.user_id, view);
+    }
+    else {
+        VideoCallRtcEngineWrap::setupRemoteView(view, binding.render_mode, binding.user_id);
+    }
+}
+
+std::string VideoVisibilityTracker::bindingKey(const Binding& binding) {
+    return (binding.is_local ? std::string("local") : binding.user_id)
+        + ":" + std::to_string(static_cast<int>(binding.stream_index));
+}
+
+}  // namespace videocall
@@ -0,0 +1,88 @@
+#pragma once
+#include <QObject>
+#include <QPointer>
+#include <map>
+#include <string>
+
+#include "core/rtc_engine_wrap.h"
+
+class VideoCallVideoWidget;
+
+namespace videocall {
+
+/** {zh}
+ * 视频渲染块可见性跟踪类
+ * 1, 渲染块被隐藏、所在窗口最小化或被完全遮挡时，解绑SDK渲染画布
+ * 2, 渲染块再次可见时重新绑定画布，并请求远端关键帧以便快速恢复画面
+ * 3, 可选：主窗口最小化期间暂停接收所有远端视频流
+ */
+
+/** {en}
+* Visibility tracker for video rendering blocks
+* 1, Detach the SDK canvas when a block is hidden, its window is minimized or it is fully covered
+* 2, Reattach the canvas when the block becomes visible again, and request a remote key frame so the picture resumes quickly
+* 3, Optionally pause all subscribed remote video while the main window is minimized
+*/
+class VideoVisibilityTracker : public QObject {
+    Q_OBJECT
+
+public:
+    struct Binding {
+        std::string user_id;
+        bytertc::StreamIndex stream_index = bytertc::kStreamIndexMain;
+        bytertc::RenderMode render_mode = bytertc::kRenderModeHidden;
+        bool is_local = false;
+    };
+
+    static VideoVisibilityTracker& instance();
+
+    void track(VideoCallVideoWidget* widget);
+    void watchWindow(QWidget* window);
+    void bind(VideoCallVideoWidget* widget, const Binding& binding);
+    void unbind(VideoCallVideoWidget* widget);
+    void reset();
+    void refresh();
+    bool isSuspended(VideoCallVideoWidget* widget) const;
+
+    void setPauseVideoWhenMinimized(bool enabled);
+    bool pauseVideoWhenMinimized() const;
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* e) override;
+
+private:
+    struct TileState {
+        Binding binding;
+        void* view = nullptr;
+        bool bound = false;
+        bool attached = false;
+        // {zh} 是否由本类解绑过画布，恢复时需要请求关键帧
+        // {en} Whether the canvas was detached by this class, a key frame is requested on resume
+        bool suspended = false;
+    };
+
+    VideoVisibilityTracker() = default;
+    ~VideoVisibilityTracker() = default;
+
+    void scheduleRefresh();
+    bool isEffectivelyVisible(VideoCallVideoWidget* widget) const;
+    void attach(VideoCallVideoWidget* widget, TileState& state);
+    void detach(TileState& state);
+    void releaseOwner(VideoCallVideoWidget* widget, const TileState& state);
+    void onWindowStateChanged();
+    static void setCanvas(const Binding& binding, void* view);
+    static std::string bindingKey(const Binding& binding);
+
+    // {zh} 渲染块状态集合，关键字为渲染块
+    // {en} Rendering block states, keyed by the block
+    std::map<VideoCallVideoWidget*, TileState> tiles_;
+    // {zh} 画布归属集合，关键字为流标识，值为当前持有该流画布的渲染块
+    // {en} Canvas owners, keyed by stream, the value is the block currently holding that stream's canvas
+    std::map<std::string, VideoCallVideoWidget*> owners_;
+    QPointer<QWidget> window_;
+    bool refresh_pending_ = false;
+    bool pause_video_when_minimized_ = true;
+    bool video_paused_ = false;
+};
+
+}  // namespace videocall
@@ -0,0 +1,249 @@
+#include "videocall_control.h"
+
+#include <QJsonObject>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "core/control_server.h"
+#include "core/rtc_engine_wrap.h"
+#include "videocall/core/data_mgr.h"
+#include "videocall/core/videocall_manager.h"
+#include "videocall/core/videocall_rtc_wrap.h"
+#include "videocall/feature/videocall_main_page.h"
+
+namespace videocall {
+
+namespace {
+using vrd::ControlServer;
+
+const char* const kRoomPrefix = "call_";
+
+/** {zh}
+ * 由 join 命令开启记录，每个里程碑只记第一次，时间为系统时间毫秒
+ */
+
+/** {en}
+* Armed by the join command, each milestone keeps its first occurrence in wall-clock milliseconds
+*/
+struct Milestones {
+    bool armed = false;
+    int64_t join_requested = 0;
+    int64_t join_accepted = 0;
+    int64_t rtc_room_joined = 0;
+    int64_t first_local_video_frame = 0;
+    int64_t first_remote_video_frame = 0;
+};
+
+Milestones& milestones() {
+    static Milestones instance;
+    return instance;
+}
+
+void mark(int64_t Milestones::*milestone, const char* event) {
+    auto& m = milestones();
+    if (!m.armed || m.*milestone != 0) {
+        return;
+    }
+    m.*milestone = ControlServer::nowMs();
+    QJsonObject data;
+    data["room_id"] = QString::fromStdString(DataMgr::instance().room_id());
+    data["since_join_ms"] = static_cast<double>(m.*milestone - m.join_requested);
+    ControlServer::instance().publish(event, data);
+}
+
+QJsonObject message(const char* text) {
+    QJsonObject result;
+    result["message"] = text;
+    return result;
+}
+
+bool inCall() {
+    return !DataMgr::instance().ref_users().empty();
+}
+
+void join(const QJsonObject& args, const ControlServer::Reply& reply) {
+    auto room_id = args["room_id"].toString().toStdString();
+    if (room_id.empty()) {
+        reply(ControlServer::kErrorBadRequest, message("missing room_id"));
+        return;
+    }
+    // {zh} 场景未打开时还没有用户ID
+    // {en} There is no user id until the scene is open
+    if (DataMgr::instance().user_id().empty() || inCall()) {
+        reply(ControlServer::kErrorUnavailable, message("scene not open or already in a call"));
+        return;
+    }
+    if (room_id.compare(0, strlen(kRoomPrefix), kRoomPrefix) != 0) {
+        room_id = kRoomPrefix + room_id;
+    }
+    auto user_name = args["user_name"].toString().toStdString();
+    if (user_name.empty()) {
+        user_name = DataMgr::instance().user_name();
+    }
+
+    auto& m = milestones();
+    m = Milestones();
+    m.armed = true;
+    m.join_requested = ControlServer::nowMs();
+    VideoCallManager::joinRoom(user_name, room_id)
+        .always([reply](const vrd::TaskResult<vrd::TaskVoid>& result) {
+            if (!result.ok()) {
+                milestones().armed = false;
+                reply(result.code, QJsonObject());
+                return;
+            }
+            mark(&Milestones::join_accepted, "join_accepted");
+            QJsonObject data;
+            data["room_id"] = QString::fromStdString(DataMgr::instance().room_id());
+            data["join_ms"] = static_cast<double>(milestones().join_accepted - milestones().join_requested);
+            reply(0, data);
+        });
+}
+
+void leave(const QJsonObject&, const ControlServer::Reply& reply) {
+    if (!inCall()) {
+        reply(ControlServer::kErrorUnavailable, message("not in a call"));
+        return;
+    }
+    milestones().armed = false;
+    VideoCallManager::leaveRoom().always([reply](const vrd::TaskResult<vrd::TaskVoid>&) {
+        reply(0, QJsonObject());
+    });
+}
+
+void muteAudio(const QJsonObject& args, const ControlServer::Reply& reply) {
+    auto mute = args["mute"].toBool(true);
+    if (VideoCallManager::setLocalAudioMuted(mute) != 0) {
+        reply(ControlServer::kErrorUnavailable, message("no microphone"));
+        return;
+    }
+    reply(0, QJsonObject());
+}
+
+void muteVideo(const QJsonObject& args, const ControlServer::Reply& reply) {
+    auto mute = args["mute"].toBool(true);
+    if (VideoCallManager::setLocalVideoMuted(mute) != 0) {
+        reply(ControlServer::kErrorUnavailable, message("no camera"));
+        return;
+    }
+    reply(0, QJsonObject());
+}
+
+void startScreenShare(const QJsonObject& args, const ControlServer::Reply& reply) {
+    if (!inCall() || DataMgr::instance().share_screen()) {
+        reply(ControlServer::kErrorUnavailable, message("not in a call or already sharing"));
+        return;
+    }
+    auto type = args["window"].toBool(false) ? SnapshotAttr::kWindow : SnapshotAttr::kScreen;
+    auto index = args["index"].toInt(0);
+    std::vector<SnapshotAttr> sources;
+    VideoCallRtcEngineWrap::getShareList(sources);
+    const SnapshotAttr* source = nullptr;
+    for (auto& attr : sources) {
+        if (attr.type == type && index-- == 0) {
+            source = &attr;
+            break;
+        }
+    }
+    if (source == nullptr) {
+        reply(ControlServer::kErrorBadRequest, message("no such share source"));
+        return;
+    }
+    VideoCallManager::startScreenShare(*source)
+        .always([reply](const vrd::TaskResult<vrd::TaskVoid>& result) {
+            if (!result.ok()) {
+                reply(result.code, QJsonObject());
+                return;
+            }
+            VideoCallManager::enterShareMode();
+            reply(0, QJsonObject());
+        });
+}
+
+void stopScreenShare(const QJsonObject&, const ControlServer::Reply& reply) {
+    if (!DataMgr::instance().share_screen()) {
+        reply(ControlServer::kErrorUnavailable, message("not sharing"));
+        return;
+    }
+    VideoCallManager::stopScreen();
+    reply(0, QJsonObject());
+}
+
+void viewMode(const QJsonObject& args, const ControlServer::Reply& reply) {
+    auto mode = args["mode"].toString();
+    int page = -1;
+    if (mode == "normal") {
+        page = VideoCallMainPage::kNormalPage;
+    }
+    else if (mode == "focus") {
+        page = VideoCallMainPage::kFocusPage;
+    }
+    if (page < 0) {
+        reply(ControlServer::kErrorBadRequest, message("mode is normal or focus"));
+        return;
+    }
+    if (VideoCallManager::setViewMode(page) != 0) {
+        reply(ControlServer::kErrorUnavailable, message("not in a call"));
+        return;
+    }
+    reply(0, QJsonObject());
+}
+
+QJsonObject metrics() {
+    auto& data = DataMgr::instance();
+    QJsonObject result;
+    result["in_call"] = inCall();
+    result["room_id"] = QString::fromStdString(data.room_id());
+    result["users"] = static_cast<int>(data.ref_users().size());
+    result["remote_streams"] = static_cast<int>(data.ref_remote_stream_infos().size());
+    result["mute_audio"] = data.mute_audio();
+    result["mute_video"] = data.mute_video();
+    result["share_screen"] = data.share_screen();
+    auto mode = inCall() ? VideoCallManager::viewMode() : -1;
+    result["view_mode"] = mode == VideoCallMainPage::kFocusPage ? "focus"
+        : mode == VideoCallMainPage::kNormalPage ? "normal" : "none";
+
+    // {zh} 未到达的里程碑不输出
+    // {en} Milestones not reached yet are left out
+    auto& m = milestones();
+    QJsonObject since_join;
+    auto add = [&](const char* name, int64_t at) {
+        if (m.join_requested != 0 && at != 0) {
+            since_join[name] = static_cast<double>(at - m.join_requested);
+        }
+    };
+    add("join_accepted", m.join_accepted);
+    add("rtc_room_joined", m.rtc_room_joined);
+    add("first_local_video_frame", m.first_local_video_frame);
+    add("first_remote_video_frame", m.first_remote_video_frame);
+    result["since_join_ms"] = since_join;
+    return result;
+}
+}  // namespace
+
+void VideoCallControl::init() {
+    auto& server = ControlServer::instance();
+    server.addCommand("join", join);
+    server.addCommand("leave", leave);
+    server.addCommand("mute_audio", muteAudio);
+    server.addCommand("mute_video", muteVideo);
+    server.addCommand("start_screen_share", startScreenShare);
+    server.addCommand("stop_screen_share", stopScreenShare);
+    server.addCommand("view_mode", viewMode);
+    server.addMetrics("videocall", metrics);
+
+    auto context = &VideoCallManager::instance();
+    QObject::connect(&VideoCallRtcEngineWrap::instance(), &VideoCallRtcEngineWrap::sigOnRoomStateChanged, context,
+        [](std::string, std::string uid, int state, std::string) {
+            if (state == 0 && uid == DataMgr::instance().user_id()) {
+                mark(&Milestones::rtc_room_joined, "rtc_room_joined");
+            }
+        });
+    QObject::connect(&RtcEngineWrap::instance(), &RtcEngineWrap::sigOnFirstLocalVideoFrameCaptured, context,
+        [] { mark(&Milestones::first_local_video_frame, "first_local_video_frame"); });
+    QObject::connect(&RtcEngineWrap::instance(), &RtcEngineWrap::sigOnFirstRemoteVideoFrameDecoded, context,
+        [] { mark(&Milestones::first_remote_video_frame, "first_remote_video_frame"); });
+}
+
+}  // namespace videocall
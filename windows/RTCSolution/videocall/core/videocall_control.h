@@ -0,0 +1,26 @@
+#pragma once
+
+namespace videocall {
+
+/** {zh}
+ * 音视频通话场景的自动化控制命令，注册到 vrd::ControlServer，映射到界面使用的同一组业务入口
+ * join {"room_id","user_name"}、leave、mute_audio/mute_video {"mute"}、
+ * start_screen_share {"index","window"}、stop_screen_share、view_mode {"mode":"normal"|"focus"}
+ * join 之后依次推送 join_accepted、rtc_room_joined、first_local_video_frame、first_remote_video_frame 事件，
+ * metrics 的 videocall 部分给出这些里程碑相对 join 请求的耗时
+ */
+
+/** {en}
+* Automation control commands of the video call scene, registered with vrd::ControlServer and mapped onto
+* the same entry points the UI uses
+* join {"room_id","user_name"}, leave, mute_audio/mute_video {"mute"},
+* start_screen_share {"index","window"}, stop_screen_share, view_mode {"mode":"normal"|"focus"}
+* After a join, join_accepted, rtc_room_joined, first_local_video_frame and first_remote_video_frame events are pushed,
+* and the videocall part of metrics reports those milestones relative to the join request
+*/
+class VideoCallControl {
+public:
+    static void init();
+};
+
+}  // namespace videocall
@@ -11,11 +11,14 @@
 #include <QScreen>
 #include <QTranslator>
 #include <QApplication>
+#include <QElapsedTimer>
 
 #include "core/util_tip.h"
 #include "videocall/core/videocall_session.h"
 #include "videocall/core/videocall_notify.h"
 #include "videocall/core/data_mgr.h"
+#include "videocall/core/video_visibility_tracker.h"
+#include "videocall/core/videocall_control.h"
 #include "videocall/feature/share_button_bar.h"
 #include "videocall/feature/videocall_share_widget.h"
 #include "videocall/feature/videocall_quit_dlg.h"
@@ -24,6 +27,52 @@
 #include "videocall/feature/videocall_login.h"
 #include "videocall/feature/videocall_main_page.h"
 
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+namespace {
+
+/** {zh}
+ * 页面构建耗时与内存增量统计，析构时输出日志
+ */
+
+/** {en}
+* Measure build time and memory growth of a page, logged on destruction
+*/
+class PageBuildProbe {
+public:
+    explicit PageBuildProbe(const char* name) : name_(name), memory_(workingSet()) {
+        timer_.start();
+    }
+    ~PageBuildProbe() {
+        qDebug() << "videocall page built:" << name_
+            << "time(ms):" << timer_.elapsed()
+            << "memory(KB):" << (workingSet() - memory_) / 1024;
+    }
+
+private:
+    static qint64 workingSet() {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters;
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+            return static_cast<qint64>(counters.WorkingSetSize);
+        }
+#endif
+        return 0;
+    }
+
+    const char* name_;
+    qint64 memory_;
+    QElapsedTimer timer_;
+};
+
+}  // namespace
+
 namespace videocall {
 VideoCallManager& VideoCallManager::instance() {
   static VideoCallManager mgr;
@@ -32,12 +81,7 @@ VideoCallManager& VideoCallManager::instance() {
 
 void VideoCallManager::init() {
     initTranslations();
-	instance().login_widget_ =
-		std::unique_ptr<VideoCallLoginWidget>(new VideoCallLoginWidget);
-
-	QObject::connect(instance().login_widget_.get(),
-		&VideoCallLoginWidget::sigClose,
-		[=] { emit instance().sigReturnMainPage(); });
+    VideoCallControl::init();
 
     QObject::connect(&VideoCallRtcEngineWrap::instance(),
                     &VideoCallRtcEngineWrap::sigUpdateAudio, []() {
@@ -51,11 +95,14 @@ void VideoCallManager::init() {
                             iter->is_mic_on = !videocall::DataMgr::instance().mute_audio();
                         }
 
-                        instance().main_page_->setMicState(
-                            !videocall::DataMgr::instance().mute_audio());
-
-                        instance().login_widget_->setMicState(
-                            !videocall::DataMgr::instance().mute_audio());
+                        if (instance().main_page_) {
+                            instance().main_page_->setMicState(
+                                !videocall::DataMgr::instance().mute_audio());
+                        }
+                        if (instance().login_widget_) {
+                            instance().login_widget_->setMicState(
+                                !videocall::DataMgr::instance().mute_audio());
+                        }
                         if (instance().share_button_bar_ 
                             && instance().share_button_bar_->isVisible()) {
                             instance().share_button_bar_->setMicState(
@@ -75,10 +122,14 @@ void VideoCallManager::init() {
                             iter->is_camera_on = !videocall::DataMgr::instance().mute_video();
                         }
 
-                        instance().main_page_->setCameraState(
-                            !videocall::DataMgr::instance().mute_video());
-                        instance().login_widget_->setCameraState(
-                            !videocall::DataMgr::instance().mute_video());
+                        if (instance().main_page_) {
+                            instance().main_page_->setCameraState(
+                                !videocall::DataMgr::instance().mute_video());
+                        }
+                        if (instance().login_widget_) {
+                            instance().login_widget_->setCameraState(
+                                !videocall::DataMgr::instance().mute_video());
+                        }
 
                         if (instance().share_button_bar_
                             && instance().share_button_bar_->isVisible()) {
@@ -104,7 +155,7 @@ void VideoCallManager::init() {
                 [](const AudioVolumeInfoWrap& l, const AudioVolumeInfoWrap& r) {
                     return l.volume > r.volume;
                 });
-            auto users = videocall::DataMgr::instance().ref_users();
+            auto& users = videocall::DataMgr::instance().ref_users();
             for (auto& speacker : total_speakers) {
                 auto iter = std::find_if(users.begin(), users.end(),
                     [speacker](const User& user) {
@@ -114,12 +165,22 @@ void VideoCallManager::init() {
                     iter->audio_volume = speacker.volume;
                 }
             }
-            if (total_speakers.size() > 0 && total_speakers[0].volume > 5) {
-                DataMgr::instance().setHighLight(total_speakers[0].uid);
+            // {zh} 高亮最响且有人声的用户；SDK音量回调未开启VAD时只看音量
+            // {en} Highlight the loudest user with voice; with VAD off in the SDK volume report only volume counts
+            auto speaker = std::find_if(total_speakers.begin(), total_speakers.end(),
+                [](const AudioVolumeInfoWrap& info) {
+                    return info.vad != 0;
+                });
+            std::string high_light;
+            if (speaker != total_speakers.end() && speaker->volume > 5) {
+                high_light = speaker->uid;
             }
-            else {
-                DataMgr::instance().setHighLight("");
+            // {zh} 电平更新频繁，只有高亮变化时才刷新画面
+            // {en} Level updates are frequent, so the view is only refreshed when the highlight changes
+            if (high_light == DataMgr::instance().high_light()) {
+                return;
             }
+            DataMgr::instance().setHighLight(high_light);
 
             ForwardEvent::PostEvent(&VideoCallManager::instance(), [] {
                 updateData();
@@ -136,7 +197,7 @@ void VideoCallManager::init() {
 				auto joinType = infoJsonObj["join_type"].toInt();
 				if (state == 0 && joinType == 1) {
 					vrd::VideoCallSession::instance().userReconnect([=](int code) {
-						if (code == 422 || code == 419 || code == 404) {
+						if ((code == 422 || code == 419 || code == 404) && instance().main_page_) {
 							instance().main_page_->froceClose();
 						}
 					});
@@ -151,7 +212,7 @@ void VideoCallManager::init() {
             auto& users = videocall::DataMgr::instance().ref_users();
             for (size_t i = 0; i < users.size(); i++) {
                 if (users[i].user_id == uid) {
-                    VideoCallManager::instance().main_page_->changeViewMode(
+                    mainPage()->changeViewMode(
                         isSharing ? VideoCallMainPage::kFocusPage : VideoCallMainPage::kNormalPage);
                     users[i].is_sharing = isSharing;
                     auto r = videocall::DataMgr::instance().room();
@@ -163,8 +224,57 @@ void VideoCallManager::init() {
             }
         });
 
+    QObject::connect(&VideoCallRtcEngineWrap::instance(),
+        &VideoCallRtcEngineWrap::sigUpdateInfo,
+        [=](const std::string& uid ) { 
+            if (instance().data_page_) {
+                instance().data_page_->updateData(uid);
+            }
+        });
+
+    QObject::connect(&VideoCallRtcEngineWrap::instance(),
+        &VideoCallRtcEngineWrap::sigUpdateMainPageData, &instance(),
+        []{
+            instance().updateData();
+        },Qt::QueuedConnection);
+}
+
+/** {zh}
+ * 登录页在首次显示时创建
+ */
+
+/** {en}
+* The login page is created the first time it is shown
+*/
+VideoCallLoginWidget* VideoCallManager::loginWidget() {
+    if (instance().login_widget_) {
+        return instance().login_widget_.get();
+    }
+    PageBuildProbe probe("login");
+	instance().login_widget_ =
+		std::unique_ptr<VideoCallLoginWidget>(new VideoCallLoginWidget);
+
+	QObject::connect(instance().login_widget_.get(),
+		&VideoCallLoginWidget::sigClose,
+		[=] { emit instance().sigReturnMainPage(); });
+    return instance().login_widget_.get();
+}
+
+/** {zh}
+ * 通话主页在首次进房时创建
+ */
+
+/** {en}
+* The call main page is created when the first call is entered
+*/
+VideoCallMainPage* VideoCallManager::mainPage() {
+    if (instance().main_page_) {
+        return instance().main_page_.get();
+    }
+    PageBuildProbe probe("main_page");
     instance().main_page_ = std::unique_ptr<VideoCallMainPage>(new VideoCallMainPage);
-    QObject::connect(instance().main_page_.get(), &VideoCallMainPage::sigClose, [=] {
+    auto page = instance().main_page_.get();
+    QObject::connect(page, &VideoCallMainPage::sigClose, [=] {
         VideoCallNotify::instance().offAll();
         if (videocall::DataMgr::instance().room().screen_shared_uid ==
             videocall::DataMgr::instance().user_id()) {
@@ -178,50 +288,51 @@ void VideoCallManager::init() {
             video->setParent(nullptr);
         }
         instance().getScreenVideo()->setParent(nullptr);
+        VideoVisibilityTracker::instance().reset();
 
         videocall::DataMgr::instance().setUsers(std::vector<User>());
         VideoCallRtcEngineWrap::instance().logout();
         showLogin();
     });
 
-    QObject::connect(&VideoCallRtcEngineWrap::instance(),
-        &VideoCallRtcEngineWrap::sigUpdateInfo,
-        [=](const std::string& uid ) { 
-            if (instance().data_page_) {
-                instance().data_page_->updateData(uid);
-            }
-        });
-
-    QObject::connect(&VideoCallRtcEngineWrap::instance(),
-        &VideoCallRtcEngineWrap::sigUpdateMainPageData, &instance(),
-        []{
-            instance().updateData();
-        },Qt::QueuedConnection);
-
-	instance().screen_widget_ = std::make_shared<VideoCallVideoWidget>();
-	instance().videos_.resize(kMaxShowWidgetNum);
-	for (int i = 0; i < kMaxShowWidgetNum; i++) {
-		instance().videos_[i] = std::make_shared<VideoCallVideoWidget>();
-	}
-
-    QObject::connect(instance().main_page_.get(),
+    QObject::connect(page,
         &VideoCallMainPage::sigShareButtonClicked, 
         [=]{
             showShareWidget();
         });
 
 
-    QObject::connect(instance().main_page_.get(),
-        &VideoCallMainPage::sigCameraEnabled,
-        [=](bool is_enabled) { getCurrentVideo()->setHasVideo(is_enabled); });
-
-    QObject::connect(instance().main_page_.get(),
+    QObject::connect(page,
 		&VideoCallMainPage::sigVideoCallSetting,
 		[=] { showSetting(); });
 
-    QObject::connect(instance().main_page_.get(),
+    QObject::connect(page,
         &VideoCallMainPage::sigRealTimeDataClicked,
         [=] { showRealTimeData(instance().main_page_.get()); });
+
+    VideoVisibilityTracker::instance().watchWindow(page);
+    return page;
+}
+
+/** {zh}
+ * 视频渲染块在首次使用时创建
+ */
+
+/** {en}
+* Video rendering blocks are created on first use
+*/
+void VideoCallManager::ensureVideoWidgets() {
+    if (instance().screen_widget_) {
+        return;
+    }
+    PageBuildProbe probe("video_widgets");
+	instance().screen_widget_ = std::make_shared<VideoCallVideoWidget>();
+	instance().videos_.resize(kMaxShowWidgetNum);
+	for (int i = 0; i < kMaxShowWidgetNum; i++) {
+		instance().videos_[i] = std::make_shared<VideoCallVideoWidget>();
+		VideoVisibilityTracker::instance().track(instance().videos_[i].get());
+	}
+	VideoVisibilityTracker::instance().track(instance().screen_widget_.get());
 }
 
 /** {zh}
@@ -242,8 +353,9 @@ void VideoCallManager::initTranslations() {
 }
 
 void VideoCallManager::showLogin(QWidget* parent) {
-    instance().login_widget_->show();
-    instance().current_widget_ = instance().login_widget_.get();
+    auto login = loginWidget();
+    login->show();
+    instance().current_widget_ = login;
 }
 
 void VideoCallManager::showTips(QWidget* parent) {
@@ -277,9 +389,7 @@ void VideoCallManager::showRealTimeData(QWidget* parent /*= nullptr*/) {
 void VideoCallManager::showShareWidget(QWidget* parent) {
     auto dlg = std::unique_ptr<VideoCallShareWidget>(new VideoCallShareWidget(parent));
     if (dlg->exec() == QDialog::Accepted) {
-        videocall::DataMgr::instance().setShareScreen(true);
-        hideRoom();
-        showShareControlBar();
+        enterShareMode();
     }
 }
 
@@ -324,9 +434,11 @@ int VideoCallManager::showCallExpDlg(QWidget* parent) {
 }
 
 void VideoCallManager::setLocalVideoWidget(const User& user, int idx) {
-    VideoCallRtcEngineWrap::setupLocalView(
-        videocall::VideoCallManager::getVideoList()[idx]->getWinID(),
-        bytertc::RenderMode::kRenderModeHidden, "local");
+    VideoVisibilityTracker::Binding binding;
+    binding.user_id = "local";
+    binding.is_local = true;
+    VideoVisibilityTracker::instance().bind(
+        videocall::VideoCallManager::getVideoList()[idx].get(), binding);
 
     auto isLocalCameraOn = !videocall::DataMgr::instance().mute_video();
     videocall::VideoCallManager::getVideoList()[idx]->setUserName(QObject::tr("xxx(me)").arg(QString::fromStdString(user.user_name)));
@@ -338,9 +450,10 @@ void VideoCallManager::setLocalVideoWidget(const User& user, int idx) {
 }
 
 void VideoCallManager::setRemoteVideoWidget(const User& user, int idx) {
-    VideoCallRtcEngineWrap::setupRemoteView(
-        videocall::VideoCallManager::getVideoList()[idx]->getWinID(),
-        bytertc::RenderMode::kRenderModeHidden, user.user_id);
+    VideoVisibilityTracker::Binding binding;
+    binding.user_id = user.user_id;
+    VideoVisibilityTracker::instance().bind(
+        videocall::VideoCallManager::getVideoList()[idx].get(), binding);
     videocall::VideoCallManager::getVideoList()[idx]->setUserName(
         user.user_name.c_str());
     videocall::VideoCallManager::getVideoList()[idx]->setShare(user.is_sharing);
@@ -356,7 +469,11 @@ void VideoCallManager::setRemoteScreenVideoWidget(const User& user) {
     SubscribeConfig config;
     config.is_screen = true;
     config.sub_video = true;
-    VideoCallRtcEngineWrap::setRemoteScreenView(user.user_id, video->getWinID());
+    VideoVisibilityTracker::Binding binding;
+    binding.user_id = user.user_id;
+    binding.stream_index = bytertc::kStreamIndexScreen;
+    binding.render_mode = bytertc::kRenderModeFit;
+    VideoVisibilityTracker::instance().bind(video.get(), binding);
     video->setUserName(QObject::tr("xxx's_screen_sharing").arg(QString::fromStdString(user.user_name)));
     video->setShare(user.is_sharing);
     video->setHasVideo(user.is_sharing);
@@ -371,18 +488,19 @@ void VideoCallManager::setRemoteScreenVideoWidget(const User& user) {
 
 void VideoCallManager::initRoom() {
     videoCallNotify();
-    instance().main_page_->init();
+    mainPage()->init();
     showRoom();
     updateData();
 }
 
 void VideoCallManager::showRoom() {
-    instance().main_page_->show();
-    instance().main_page_->setCameraState(
+    auto page = mainPage();
+    page->show();
+    page->setCameraState(
         !videocall::DataMgr::instance().mute_video());
-    instance().main_page_->setMicState(
+    page->setMicState(
         !videocall::DataMgr::instance().mute_audio());
-    instance().current_widget_ = instance().main_page_.get();
+    instance().current_widget_ = page;
     
     auto cur_share_uid = videocall::DataMgr::instance().room().screen_shared_uid;
     if (!cur_share_uid.empty() 
@@ -403,10 +521,13 @@ QWidget* VideoCallManager::currentWidget() {
 }
 
 void VideoCallManager::hideRoom() { 
-    instance().main_page_->hide();
+    if (instance().main_page_) {
+        instance().main_page_->hide();
+    }
 }
 
 std::vector<std::shared_ptr<VideoCallVideoWidget>> VideoCallManager::getVideoList() {
+    ensureVideoWidgets();
     return instance().videos_;
 }
 
@@ -414,7 +535,7 @@ std::shared_ptr<VideoCallVideoWidget> VideoCallManager::getCurrentVideo() {
     int i = 0;
     for (auto& user : videocall::DataMgr::instance().users()) {
         if (user.user_id == videocall::DataMgr::instance().user_id()) {
-            return instance().videos_[i];
+            return getVideoList()[i];
         }
         i++;
     }
@@ -422,11 +543,12 @@ std::shared_ptr<VideoCallVideoWidget> VideoCallManager::getCurrentVideo() {
 }
 
 std::shared_ptr<VideoCallVideoWidget> VideoCallManager::getScreenVideo() {
+    ensureVideoWidgets();
     return instance().screen_widget_;
 }
 
 void VideoCallManager::updateData() {
-    if (instance().updating) {
+    if (instance().updating || !instance().main_page_) {
         return;
     }
     instance().updating = true;
@@ -436,7 +558,9 @@ void VideoCallManager::updateData() {
 
 void VideoCallManager::videoCallNotify() {
     VideoCallNotify::instance().onCallEnd([](int) {
-        instance().main_page_->froceClose();
+        if (instance().main_page_) {
+            instance().main_page_->froceClose();
+        }
         vrd::util::showToastInfo(QObject::tr("minutes_meeting").toStdString());
     });
 }
@@ -456,6 +580,117 @@ void VideoCallManager::stopScreen() {
     VideoCallRtcEngineWrap::instance().stopScreenCapture();
 }
 
+/** {zh}
+ * 进房流程：先清除可能在其他房间的同一用户，无论结果如何都继续进房，成功后进入通话页并加入RTC房间
+ */
+
+/** {en}
+* Join flow: clear the same user possibly left in another room, join whatever the result,
+* then enter the call page and join the RTC room once the server accepts
+*/
+vrd::Task<vrd::TaskVoid> VideoCallManager::joinRoom(const std::string& user_name, const std::string& room_id) {
+    videocall::DataMgr::instance().setUserName(user_name);
+    auto userId = videocall::DataMgr::instance().user_id();
+    return vrd::VideoCallSession::instance().cleanUserTask(userId)
+        .always([userId, room_id](const vrd::TaskResult<int>&) {
+            return vrd::VideoCallSession::instance().joinCallTask(userId, room_id);
+        })
+        .then([](const int&) {
+            vrd::VideoCallSession::instance().setRoomId(videocall::DataMgr::instance().room_id());
+            if (instance().login_widget_) {
+                instance().login_widget_->hide();
+            }
+            initRoom();
+            VideoCallRtcEngineWrap::login(
+                videocall::DataMgr::instance().room_id(),
+                videocall::DataMgr::instance().user_id(),
+                videocall::DataMgr::instance().token());
+            // {zh} 适配无摄像头权限进房后移动端头像画面初始化失败
+            // {en} Solve the issue that the avatar of the mobile app fails to initialize after entering the room without camera permission
+            VideoCallRtcEngineWrap::muteLocalVideo(videocall::DataMgr::instance().mute_video());
+            VideoCallRtcEngineWrap::enableLocalVideo(!videocall::DataMgr::instance().mute_video());
+            VideoCallRtcEngineWrap::muteLocalAudio(videocall::DataMgr::instance().mute_audio());
+            VideoCallRtcEngineWrap::enableLocalAudio(!videocall::DataMgr::instance().mute_audio());
+        });
+}
+
+// {zh} 与结束通话对话框一致，无论服务端结果如何都关闭通话页
+// {en} As with the end call dialog, the call page closes whatever the server answers
+vrd::Task<vrd::TaskVoid> VideoCallManager::leaveRoom() {
+    return vrd::VideoCallSession::instance().leaveCallTask()
+        .always([](const vrd::TaskResult<int>&) {
+            if (instance().main_page_) {
+                instance().main_page_->froceClose();
+            }
+        });
+}
+
+int VideoCallManager::setLocalAudioMuted(bool mute) {
+    if (!mute && !VideoCallRtcEngineWrap::canCaptureAudio()) {
+        return -1;
+    }
+    if (instance().main_page_) {
+        instance().main_page_->setMicState(!mute);
+    }
+    VideoCallRtcEngineWrap::muteLocalAudio(mute);
+    VideoCallRtcEngineWrap::enableLocalAudio(!mute);
+    videocall::DataMgr::instance().setMuteAudio(mute);
+    return 0;
+}
+
+int VideoCallManager::setLocalVideoMuted(bool mute) {
+    if (!mute) {
+        if (!VideoCallRtcEngineWrap::hasVideoCaptureDevice()) {
+            return -1;
+        }
+    }
+    if (instance().main_page_) {
+        instance().main_page_->setCameraState(!mute);
+    }
+    VideoCallRtcEngineWrap::muteLocalVideo(mute);
+    VideoCallRtcEngineWrap::enableLocalVideo(!mute);
+    videocall::DataMgr::instance().setMuteVideo(mute);
+    if (instance().main_page_) {
+        getCurrentVideo()->setHasVideo(!mute);
+    }
+    return 0;
+}
+
+vrd::Task<vrd::TaskVoid> VideoCallManager::startScreenShare(const SnapshotAttr& attr) {
+    return vrd::VideoCallSession::instance().startScreenShareTask()
+        .then([attr](const int&) {
+            auto r = videocall::DataMgr::instance().room();
+            r.screen_shared_uid = videocall::DataMgr::instance().user_id();
+            videocall::DataMgr::instance().setRoom(std::move(r));
+            if (attr.type == SnapshotAttr::kWindow) {
+                VideoCallRtcEngineWrap::instance().startScreenCaptureByWindowId(attr.source_id);
+            }
+            else {
+                std::vector<void*> excluded;
+                VideoCallRtcEngineWrap::instance().startScreenCapture(attr.source_id, excluded);
+            }
+            VideoCallRtcEngineWrap::instance().startScreenAudioCapture();
+        });
+}
+
+void VideoCallManager::enterShareMode() {
+    videocall::DataMgr::instance().setShareScreen(true);
+    hideRoom();
+    showShareControlBar();
+}
+
+int VideoCallManager::setViewMode(int mode) {
+    if (!instance().main_page_ || !instance().main_page_->isVisible()) {
+        return -1;
+    }
+    instance().main_page_->changeViewMode(mode);
+    return 0;
+}
+
+int VideoCallManager::viewMode() {
+    return instance().main_page_ ? instance().main_page_->viewMode() : -1;
+}
+
 void VideoCallManager::customEvent(QEvent* e) {
     if (e->type() == QEvent::User) {
         auto user_event = static_cast<ForwardEvent*>(e);
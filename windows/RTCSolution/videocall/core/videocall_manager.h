@@ -6,6 +6,7 @@
 #include <QPointer>
 
 #include <memory>
+#include "core/async_task.h"
 #include "videocall/core/videocall_rtc_wrap.h"
 #include "videocall/core/videocall_model.h"
 #include "videocall/core/videocall_video_widget.h"
@@ -64,9 +65,29 @@ public:
     static void videoCallNotify();
     static void stopScreen();
 
+    // {zh} 界面操作与自动化控制共用的业务入口
+    // {en} Entry points shared by the UI and the automation control commands
+    static vrd::Task<vrd::TaskVoid> joinRoom(const std::string& user_name, const std::string& room_id);
+    static vrd::Task<vrd::TaskVoid> leaveRoom();
+    // {zh} 打开麦克风或摄像头时没有可用设备返回-1
+    // {en} Returns -1 when turning the microphone or camera on without a usable device
+    static int setLocalAudioMuted(bool mute);
+    static int setLocalVideoMuted(bool mute);
+    static vrd::Task<vrd::TaskVoid> startScreenShare(const SnapshotAttr& attr);
+    static void enterShareMode();
+    // {zh} 不在通话中返回-1
+    // {en} Returns -1 outside a call
+    static int setViewMode(int mode);
+    static int viewMode();
+
 protected:
     void customEvent(QEvent*) override;
 
+private:
+    static VideoCallLoginWidget* loginWidget();
+    static VideoCallMainPage* mainPage();
+    static void ensureVideoWidgets();
+
 signals:
     void sigReturnMainPage();
 
@@ -5,6 +5,9 @@
 #include <QJsonArray>
 #include <algorithm>
 
+#include "core/audio_level_meter.h"
+#include "core/device_registry.h"
+#include "core/microphone_probe.h"
 #include "core/util_tip.h"
 #include "videocall/core/data_mgr.h"
 
@@ -27,7 +30,12 @@ int VideoCallRtcEngineWrap::init() {
 
 	enableLocalAudio(true);
 	enableLocalVideo(true);
-	setAudioVolumeIndicate(1000);
+	// {zh} 说话者高亮优先使用本地音频分析（约50毫秒更新），未启用时退回SDK每秒一次的音量回调
+	// {en} Speaker highlight prefers the local audio analysis (about 50 ms updates), falling back to the SDK's
+	// {en} once-a-second volume report when it is disabled
+	if (!vrd::AudioLevelMeter::instance().start()) {
+		setAudioVolumeIndicate(1000);
+	}
 
 	QObject::connect(&RtcEngineWrap::instance(), &RtcEngineWrap::sigOnRoomStateChanged,
 		&instance(), &VideoCallRtcEngineWrap::sigOnRoomStateChanged);
@@ -85,22 +93,14 @@ int VideoCallRtcEngineWrap::init() {
 		});
 
     QObject::connect(
-        &RtcEngineWrap::instance(), &RtcEngineWrap::sigOnVideoDeviceStateChanged,
+        &vrd::DeviceRegistry::instance(), &vrd::DeviceRegistry::sigDeviceChanged,
         &engine_wrap,
-        [=](std::string device_id, bytertc::RTCVideoDeviceType type,
-            bytertc::MediaDeviceState state, bytertc::MediaDeviceError error) {
-                if (type == bytertc::kRTCVideoDeviceTypeCaptureDevice) {
-                    instance().onVideoStateChanged(device_id, state, error);
+        [=](const vrd::DeviceChange& change) {
+                if (change.device_type == RtcDeviceTypeVideoCapture) {
+                    instance().onVideoStateChanged(change);
                 }
-        });
-
-    QObject::connect(
-        &RtcEngineWrap::instance(), &RtcEngineWrap::sigOnAudioDeviceStateChanged,
-        &engine_wrap,
-        [=](std::string device_id, bytertc::RTCAudioDeviceType type,
-            bytertc::MediaDeviceState state, bytertc::MediaDeviceError error) {
-                if (type == bytertc::kRTCAudioDeviceTypeCaptureDevice) {
-                    instance().onAudioStateChanged(device_id, state, error);
+                else if (change.device_type == RtcDeviceTypeAudioRecord) {
+                    instance().onAudioStateChanged(change);
                 }
         });
 
@@ -120,6 +120,15 @@ int VideoCallRtcEngineWrap::init() {
             emit instance().sigOnAudioVolumeUpdate();
         });
 
+    QObject::connect(
+        &RtcEngineWrap::instance(), &RtcEngineWrap::sigOnAudioLevelIndication,
+        &engine_wrap,
+        [=](std::vector<AudioVolumeInfoWrap> local, std::vector<AudioVolumeInfoWrap> remote) {
+            videocall::DataMgr::instance().setLocalVolumes(std::move(local));
+            videocall::DataMgr::instance().setRemoteVolumes(std::move(remote));
+            emit instance().sigOnAudioVolumeUpdate();
+        });
+
 	
 
 	QObject::connect(&RtcEngineWrap::instance(), &RtcEngineWrap::sigOnLocalStreamStats,
@@ -167,7 +176,9 @@ int VideoCallRtcEngineWrap::init() {
 }
 
 int VideoCallRtcEngineWrap::unInit() {
+	vrd::AudioLevelMeter::instance().stop();
 	QObject::disconnect(&RtcEngineWrap::instance(), nullptr, &instance(), nullptr);
+	QObject::disconnect(&vrd::DeviceRegistry::instance(), nullptr, &instance(), nullptr);
 	RtcEngineWrap::instance().resetDevices();
 	return 0;
 }
@@ -186,6 +197,28 @@ int VideoCallRtcEngineWrap::setupRemoteView(void* view, bytertc::RenderMode mode
         uid, bytertc::StreamIndex::kStreamIndexMain, mode, view);
 }
 
+int VideoCallRtcEngineWrap::requestRemoteVideoKeyFrame(const std::string& uid,
+                                                      bytertc::StreamIndex index) {
+    return RtcEngineWrap::instance().requestRemoteVideoKeyFrame(uid, index);
+}
+
+int VideoCallRtcEngineWrap::pauseSubscribedVideo(bool paused) {
+    return paused ? RtcEngineWrap::instance().pauseAllSubscribedStream(
+                        bytertc::kRTCPauseResumeControlMediaTypeVideo)
+                  : RtcEngineWrap::instance().resumeAllSubscribedStream(
+                        bytertc::kRTCPauseResumeControlMediaTypeVideo);
+}
+
+int VideoCallRtcEngineWrap::applySubscriptions(
+        const std::vector<vrd::StreamSubscription>& subscriptions) {
+    return RtcEngineWrap::instance().applySubscriptions(subscriptions);
+}
+
+vrd::StreamSubscription VideoCallRtcEngineWrap::desiredSubscription(
+        const std::string& uid, bool is_screen) {
+    return RtcEngineWrap::instance().desiredSubscription(uid, is_screen);
+}
+
 int VideoCallRtcEngineWrap::startPreview() {
     auto& engine_wrap = instance();
     return RtcEngineWrap::instance().startPreview();
@@ -312,6 +345,14 @@ int VideoCallRtcEngineWrap::getVideoCaptureDevice(std::string& guid) {
 	return RtcEngineWrap::instance().getVideoCaptureDevice(guid);
 }
 
+bool VideoCallRtcEngineWrap::hasVideoCaptureDevice() {
+	return vrd::DeviceRegistry::instance().count(RtcDeviceTypeVideoCapture) > 0;
+}
+
+bool VideoCallRtcEngineWrap::hasAudioInputDevice() {
+	return vrd::DeviceRegistry::instance().count(RtcDeviceTypeAudioRecord) > 0;
+}
+
 int VideoCallRtcEngineWrap::setRemoteScreenView(const std::string& uid,
                                               void* view) {
     return RtcEngineWrap::instance().setRemoteVideoCanvas(
@@ -351,8 +392,19 @@ QPixmap VideoCallRtcEngineWrap::getThumbnail(SnapshotAttr::SnapshotType type,
                                          max_height);
 }
 
-bool VideoCallRtcEngineWrap::audioRecordDevicesTest() {
-    return RtcEngineWrap::instance().audioReocrdDeviceTest();
+QImage VideoCallRtcEngineWrap::getThumbnailImage(SnapshotAttr::SnapshotType type,
+                                               void* source_id, int max_width,
+                                               int max_height) {
+	return RtcEngineWrap::instance().getThumbnailImage(type, source_id, max_width,
+                                              max_height);
+}
+
+bool VideoCallRtcEngineWrap::canCaptureAudio() {
+    auto& probe = vrd::MicrophoneProbe::instance();
+    if (probe.capability() == vrd::MicrophoneProbe::kUnknown) {
+        probe.probe();
+    }
+    return probe.capability() == vrd::MicrophoneProbe::kCapable;
 }
 
 void VideoCallRtcEngineWrap::setBasicBeauty(bool enabled) {
@@ -368,13 +420,10 @@ int VideoCallRtcEngineWrap::feedBack(const std::string& str) {
 	return 0; 
 }
 
-void VideoCallRtcEngineWrap::onVideoStateChanged(std::string device_id,
-    bytertc::MediaDeviceState device_state, bytertc::MediaDeviceError error) {
-	std::vector<RtcDevice> devices;
-	VideoCallRtcEngineWrap::getVideoCaptureDevices(devices);
-	if ((devices.empty() || error == bytertc::kMediaDeviceErrorDeviceNoPermission)
+void VideoCallRtcEngineWrap::onVideoStateChanged(const vrd::DeviceChange& change) {
+	if ((!hasVideoCaptureDevice() || change.error == bytertc::kMediaDeviceErrorDeviceNoPermission)
 		&& !videocall::DataMgr::instance().mute_video()) {
-		if (error == bytertc::kMediaDeviceErrorDeviceNoPermission) {
+		if (change.error == bytertc::kMediaDeviceErrorDeviceNoPermission) {
 			vrd::util::showToastInfo(QObject::tr("no_camera_permission").toStdString());
 		}
 		videocall::DataMgr::instance().setMuteVideo(true);
@@ -386,16 +435,16 @@ void VideoCallRtcEngineWrap::onVideoStateChanged(std::string device_id,
 			videocall::DataMgr::instance().mute_video());
 	}
 
-	switch (device_state) {
+	switch (change.kind) {
 		// {zh} 插入一个新的设备
 		// {en} Insert a new device
-		case bytertc::kMediaDeviceStateAdded:
+		case vrd::DeviceChange::kAdded:
 			vrd::util::showToastInfo(QObject::tr("new_camera_plugin").toStdString());
 			emit instance().sigUpdateVideoDevices();
 			break;
 		// {zh} 拔出设备
 		// {en} Pull out the device
-		case bytertc::kMediaDeviceStateRemoved:
+		case vrd::DeviceChange::kRemoved:
 			vrd::util::showToastInfo(QObject::tr("camera_unplugged").toStdString());
 			emit instance().sigUpdateVideoDevices();
 			VideoCallRtcEngineWrap::setVideoCaptureDevice(RtcEngineWrap::instance().getCurrentVideoCaptureDeviceIndex());
@@ -405,11 +454,8 @@ void VideoCallRtcEngineWrap::onVideoStateChanged(std::string device_id,
 	}
 }
 
-void VideoCallRtcEngineWrap::onAudioStateChanged(std::string device_id,
-    bytertc::MediaDeviceState device_state, bytertc::MediaDeviceError error) {
-    std::vector<RtcDevice> devices;
-    VideoCallRtcEngineWrap::getAudioInputDevices(devices);
-    if ((devices.empty()) && !videocall::DataMgr::instance().mute_audio()) {
+void VideoCallRtcEngineWrap::onAudioStateChanged(const vrd::DeviceChange& change) {
+    if (!hasAudioInputDevice() && !videocall::DataMgr::instance().mute_audio()) {
         videocall::DataMgr::instance().setMuteAudio(true);
         VideoCallRtcEngineWrap::muteLocalAudio(true);
         emit instance().sigUpdateAudio();
@@ -419,20 +465,20 @@ void VideoCallRtcEngineWrap::onAudioStateChanged(std::string device_id,
             videocall::DataMgr::instance().mute_audio());
     }
 
-	switch (device_state) {
+	switch (change.kind) {
 	// {zh} 插入一个新的设备
 	// {en} Insert a new device
-	case bytertc::kMediaDeviceStateAdded:  
+	case vrd::DeviceChange::kAdded:
 		vrd::util::showToastInfo(QObject::tr("new_mic_plugin").toStdString());
 		emit instance().sigUpdateAudioDevices();
 		break;
 	// {zh} 拔出设备
 	// {en} Pull out the device
-	case bytertc::kMediaDeviceStateRemoved:
+	case vrd::DeviceChange::kRemoved:
 	{
 		std::string curDeviceStr;
 		VideoCallRtcEngineWrap::getAudioInputDevice(curDeviceStr);
-		if (strcmp(curDeviceStr.c_str(), device_id.c_str()) == 0)
+		if (curDeviceStr == change.device_id)
 		{
 			RtcEngineWrap::instance().followSystemCaptureDevice(true);
 		}
@@ -440,14 +486,17 @@ void VideoCallRtcEngineWrap::onAudioStateChanged(std::string device_id,
         emit instance().sigUpdateAudioDevices();
 		break;
 	}
-    case bytertc::kMediaDeviceStateRuntimeError:
+    case vrd::DeviceChange::kStateChanged:
     {
+        if (change.state != bytertc::kMediaDeviceStateRuntimeError) {
+            break;
+        }
         std::string curDeviceStr;
         VideoCallRtcEngineWrap::getAudioInputDevice(curDeviceStr);
-        if (strcmp(curDeviceStr.c_str(), device_id.c_str()) == 0 && !videocall::DataMgr::instance().mute_audio()){
-            if (error == bytertc::kMediaDeviceErrorDeviceNoPermission 
-                || error == bytertc::kMediaDeviceErrorDeviceFailure
-                || error == bytertc::kMediaDeviceErrorDeviceBusy) {
+        if (curDeviceStr == change.device_id && !videocall::DataMgr::instance().mute_audio()){
+            if (change.error == bytertc::kMediaDeviceErrorDeviceNoPermission 
+                || change.error == bytertc::kMediaDeviceErrorDeviceFailure
+                || change.error == bytertc::kMediaDeviceErrorDeviceBusy) {
                 vrd::util::showToastInfo(QObject::tr("no_microphone_permission").toStdString());
                 videocall::DataMgr::instance().setMuteAudio(true);
                 VideoCallRtcEngineWrap::muteLocalAudio(true);
@@ -464,11 +513,7 @@ void VideoCallRtcEngineWrap::onAudioStateChanged(std::string device_id,
 void VideoCallRtcEngineWrap::onUserJoinedVideoCall(UserInfoWrap user_info, int elapsed) {
 	videocall::User newUser;
 	newUser.user_id = user_info.uid;
-
-    auto infoArray = QByteArray(user_info.extra_info.data(), 
-		static_cast<int>(user_info.extra_info.size()));
-    auto infoJsonObj = QJsonDocument::fromJson(infoArray).object();
-	newUser.user_name = std::string(infoJsonObj["user_name"].toString().toUtf8());
+	newUser.user_name = user_info.user_name;
 	if (newUser.user_name == "") newUser.user_name = user_info.uid;
 
     auto& users = videocall::DataMgr::instance().ref_users();
@@ -483,7 +528,7 @@ void VideoCallRtcEngineWrap::onUserJoinedVideoCall(UserInfoWrap user_info, int e
 	auto& remoteStreamInfos = videocall::DataMgr::instance().ref_remote_stream_infos();
 	videocall::StreamInfo info;
 	info.user_id = user_info.uid;
-	info.user_name = std::string(infoJsonObj["user_name"].toString().toUtf8());
+	info.user_name = user_info.user_name;
 	remoteStreamInfos.push_back(info);
 	emit sigUpdateMainPageData();
 }
@@ -5,6 +5,10 @@
 #include "core/rtc_engine_wrap.h"
 #include "videocall/core/videocall_model.h"
 
+namespace vrd {
+struct DeviceChange;
+}
+
 /** {zh}
  * 本场景内的需要用到的RTC接口和回调的封装类
  */
@@ -23,6 +27,13 @@ public:
 		const std::string& uid);
 	static int setupRemoteView(void* view, bytertc::RenderMode mode,
 		const std::string& uid);
+	static int requestRemoteVideoKeyFrame(const std::string& uid,
+		bytertc::StreamIndex index);
+	static int pauseSubscribedVideo(bool paused);
+	// {zh} 一次应用多路流的订阅变化，见 RtcEngineWrap::applySubscriptions
+	// {en} Applies the subscription changes of many streams at once, see RtcEngineWrap::applySubscriptions
+	static int applySubscriptions(const std::vector<vrd::StreamSubscription>& subscriptions);
+	static vrd::StreamSubscription desiredSubscription(const std::string& uid, bool is_screen);
 	static int startPreview();
 	static int stopPreview();
 	static int enableLocalAudio(bool enable);
@@ -54,6 +65,11 @@ public:
 	static int setVideoCaptureDevice(int index);
 	static int getVideoCaptureDevice(std::string& guid);
 
+	// {zh} 从设备表读取，不重新枚举
+	// {en} Read from the device registry without enumerating
+	static bool hasVideoCaptureDevice();
+	static bool hasAudioInputDevice();
+
 	static int setRemoteScreenView(const std::string& uid, void* view);
 	static int startScreenCapture(void* source_id,
 		const std::vector<void*>& excluded);
@@ -65,15 +81,17 @@ public:
 	static int getShareList(std::vector<SnapshotAttr>& list);
 	static QPixmap getThumbnail(SnapshotAttr::SnapshotType type, void* source_id,
 		int max_width, int max_height);
-	static bool audioRecordDevicesTest();
+	static QImage getThumbnailImage(SnapshotAttr::SnapshotType type, void* source_id,
+		int max_width, int max_height);
+	// {zh} 从麦克风探测的缓存立即返回；结果未知时按不可用处理并补发一次探测
+	// {en} Answers at once from the microphone probe cache; an unknown result counts as unavailable and triggers a probe
+	static bool canCaptureAudio();
 	static void setBasicBeauty(bool enabled);
 	static int feedBack(const std::string& str);
 
 public:
-    void onVideoStateChanged(std::string device_id,
-        bytertc::MediaDeviceState device_state, bytertc::MediaDeviceError error);
-    void onAudioStateChanged(std::string device_id,
-        bytertc::MediaDeviceState device_state, bytertc::MediaDeviceError error);
+    void onVideoStateChanged(const vrd::DeviceChange& change);
+    void onAudioStateChanged(const vrd::DeviceChange& change);
     void onUserJoinedVideoCall(UserInfoWrap user_info, int elapsed);
     void onUserLeaveVideoCall(std::string uid, bytertc::UserOfflineReason reason);
     void onUserCameraStatusChange(std::string uid, bool enabled);
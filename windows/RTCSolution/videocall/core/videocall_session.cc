@@ -1,8 +1,9 @@
 ﻿#include "videocall_session.h"
-#include "core/Application.h"
+#include "core/application.h"
 #include "feature/data_mgr.h"
 #include "core/util_tip.h"
 #include "videocall/core/data_mgr.h"
+#include "videocall/core/videocall_rtc_wrap.h"
 #include "logger.h"
 
 #include <QJsonObject>
@@ -13,6 +14,19 @@
 
 namespace vrd {
 
+namespace {
+std::function<void(int)> settleWithCode(Task<int> task) {
+    return [task](int code) mutable {
+        if (code == 200) {
+            task.resolve(code);
+        }
+        else {
+            task.reject(code);
+        }
+    };
+}
+}  // namespace
+
 VideoCallSession& VideoCallSession::instance() {
 	static VideoCallSession video_session;
 	return video_session;
@@ -39,23 +53,50 @@ void VideoCallSession::changeUserName(CSTRING_REF_PARAM name,
 	base_->changeUserName(name, std::move(callback));
 }
 
-void VideoCallSession::initSceneConfig(std::function<void(void)>&& callback) {
+void VideoCallSession::initSceneConfig(std::function<void(void)>&& callback,
+    std::function<void(void)>&& devicesReady) {
+    // {zh} 记录首帧耗时，便于对比进入流程的优化效果
+    // {en} Log first-frame times so entry flow changes can be compared
+    QObject::disconnect(first_local_frame_);
+    QObject::disconnect(first_remote_frame_);
+    first_local_frame_ = QObject::connect(&RtcEngineWrap::instance(), &RtcEngineWrap::sigOnFirstLocalVideoFrameCaptured,
+        &VideoCallRtcEngineWrap::instance(), [this]() {
+            QObject::disconnect(first_local_frame_);
+            base_->markEntry("first_local_video_frame");
+        });
+    first_remote_frame_ = QObject::connect(&RtcEngineWrap::instance(), &RtcEngineWrap::sigOnFirstRemoteVideoFrameDecoded,
+        &VideoCallRtcEngineWrap::instance(), [this]() {
+            QObject::disconnect(first_remote_frame_);
+            base_->markEntry("first_remote_video_frame");
+        });
+
     base_->connectRTS("videocall", [this, callback]() {
         auto res_info = vrd::DataMgr::instance().rts_info();
         videocall::DataMgr::instance().setAppID(res_info.app_id);
         if (callback) {
             callback();
         }
+    }, [devicesReady](EntryPipeline& pipeline) {
+        if (!devicesReady) {
+            return;
+        }
+        pipeline.add("init_devices", { SessionBase::kEntryStepEngineReady }, [devicesReady](EntryPipeline::Done done) {
+            devicesReady();
+            done(0);
+        });
     });
 }
 
 void VideoCallSession::exitScene() {
+    QObject::disconnect(first_local_frame_);
+    QObject::disconnect(first_remote_frame_);
 	base_->disconnectRTS();
 }
 
 void VideoCallSession::joinCall( const std::string& userId,
                                  const std::string& roomId, 
                                  std::function<void(int)>&& callback) {
+	base_->markEntry("join_requested");
 	QJsonObject req;
 	req["login_token"] = QString::fromStdString(base_->_token());
 	req["user_id"] = QString::fromStdString(userId);
@@ -81,7 +122,7 @@ void VideoCallSession::joinCall( const std::string& userId,
 
         videocall::VideoCallRoom room;
         room.room_id = roomId;
-        auto& response = rsp["response"].toObject();
+        auto response = rsp["response"].toObject();
         room.duration = response["duration"].toDouble();
         videocall::DataMgr::instance().setRoom(std::move(room));
         auto token = std::string(response["rtc_token"].toString().toUtf8());
@@ -161,7 +202,7 @@ void VideoCallSession::userReconnect(std::function<void(int)> callback) {
 	base_->_emitMessage("videocallReconnect", req, [=](const QJsonObject& rsp) {
 		int code = rsp["code"].toInt();
 		if (code == 200) {
-            auto& response = rsp["response"].toObject();
+            auto response = rsp["response"].toObject();
             auto token = std::string(response["rtc_token"].toString().toUtf8());
             videocall::DataMgr::instance().setToken(token);
 		}
@@ -185,6 +226,42 @@ void VideoCallSession::cleanUser(const std::string& userId,
     });
 }
 
+Task<int> VideoCallSession::joinCallTask(const std::string& userId, const std::string& roomId) {
+    Task<int> task;
+    joinCall(userId, roomId, settleWithCode(task));
+    return task;
+}
+
+Task<int> VideoCallSession::leaveCallTask() {
+    Task<int> task;
+    leaveCall(settleWithCode(task));
+    return task;
+}
+
+Task<int> VideoCallSession::startScreenShareTask() {
+    Task<int> task;
+    startScreenShare(settleWithCode(task));
+    return task;
+}
+
+Task<int> VideoCallSession::stopScreenShareTask() {
+    Task<int> task;
+    stopScreenShare(settleWithCode(task));
+    return task;
+}
+
+Task<int> VideoCallSession::userReconnectTask() {
+    Task<int> task;
+    userReconnect(settleWithCode(task));
+    return task;
+}
+
+Task<int> VideoCallSession::cleanUserTask(const std::string& userId) {
+    Task<int> task;
+    cleanUser(userId, settleWithCode(task));
+    return task;
+}
+
 void VideoCallSession::onCallEnd(std::function<void(int)>&& callback) {
 	base_->_onNotify("videocallOnCloseRoom", [=](const QJsonObject& data) {
         auto roomId = std::string(data["room_id"].toString().toUtf8());
@@ -198,6 +275,11 @@ void VideoCallSession::onCallEnd(std::function<void(int)>&& callback) {
 VideoCallSession::VideoCallSession() {
   base_ = vrd::Application::getSingleton().getComponent(
       VRD_UTIL_GET_COMPONENT_PARAM(vrd::SessionBase));
+  // {zh} 退出类请求是幂等的，超时后可以安全重发
+  // {en} Exit-type requests are idempotent, so they are safe to resend after a timeout
+  base_->setRequestPolicy("videocallLeaveRoom", 5000, 2);
+  base_->setRequestPolicy("videocallEndShareScreen", 5000, 2);
+  base_->setRequestPolicy("videocallClearUser", 5000, 2);
 }
 
 }  // namespace vrd
@@ -3,6 +3,7 @@
 #include <memory>
 #include <vector>
 
+#include "core/async_task.h"
 #include "core/session_base.h"
 #include "videocall_model.h"
 
@@ -28,7 +29,10 @@ public:
     // {en} ----------------------------------interface----------------------------------
     void changeUserName(CSTRING_REF_PARAM name, CallBackFunction&& callback);
 
-    void initSceneConfig(std::function<void(void)>&& callback);
+    // {zh} devicesReady 在引擎就绪后调用，与RTS登录并行；callback 在RTS连接完成后调用
+    // {en} devicesReady runs once the engine is ready, alongside the RTS login; callback runs once RTS is connected
+    void initSceneConfig(std::function<void(void)>&& callback,
+        std::function<void(void)>&& devicesReady = nullptr);
     void exitScene();
 
     void joinCall(const std::string& userId,
@@ -40,6 +44,15 @@ public:
     void userReconnect(std::function<void(int)> callback);
     void cleanUser(const std::string& userId, std::function<void(int)> callback);
 
+    // {zh} 以任务形式提供的接口，服务端返回200时成功，否则以返回码失败
+    // {en} Task-based interfaces, they succeed when the server returns 200 and fail with the returned code otherwise
+    Task<int> joinCallTask(const std::string& userId, const std::string& roomId);
+    Task<int> leaveCallTask();
+    Task<int> startScreenShareTask();
+    Task<int> stopScreenShareTask();
+    Task<int> userReconnectTask();
+    Task<int> cleanUserTask(const std::string& userId);
+
     // {zh} ----------------------------------通知----------------------------------
     // {en} ----------------------------------notify----------------------------------
     void onCallEnd(std::function<void(int)>&& callback);
@@ -50,6 +63,8 @@ private:
 
 private:
     std::shared_ptr<SessionBase> base_;
+    QMetaObject::Connection first_local_frame_;
+    QMetaObject::Connection first_remote_frame_;
 };
 
 }  // namespace vrd
\ No newline at end of file
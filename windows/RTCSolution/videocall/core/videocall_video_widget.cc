@@ -6,6 +6,10 @@
 
 #include "videocall_video_widget.h"
 
+#include <QStyle>
+#include <map>
+#include <utility>
+
 struct VideoWidgetInfo {
   int user_logo_font_size;
   int font_size;
@@ -13,12 +17,71 @@ struct VideoWidgetInfo {
   int user_logo_height;
 };
 
+namespace {
+
+/** {zh}
+ * 渲染块装饰样式表，高亮与头像尺寸通过动态属性切换，所有渲染块共用
+ */
+
+/** {en}
+* Decoration stylesheet shared by all rendering blocks, highlight and avatar size are switched by dynamic properties
+*/
+const QString& decorationStyleSheet() {
+    static const QString style_sheet = QStringLiteral(
+        "#HasVideoWidget{border:none;}\n"
+        "#HasVideoWidget[highlight=\"true\"]{border:2px solid #23C343;}\n"
+        "#HasVideoView{background:#272e3B;}\n"
+        "#NoVideoWidget{background:#272E3B;"
+        "font-family: \"Microsoft YaHei\";font-size: 12px;border:none;}\n"
+        "#NoVideoWidget[highlight=\"true\"]{border:2px solid #23C343;}\n"
+        "#VideoInfoContent, #VideoInfoContent QLabel{"
+        "font-family: \"Microsoft YaHei\";font-size: 12px;border:none;}\n"
+        "#UserLogo{border-radius:20px; background:#4E5969;border:none;"
+        "font-family: 'Inter';font-weight: 500;font-size: 16px;}\n"
+        "#UserLogo[logoSize=\"medium\"]{border-radius:40px;font-size: 32px;}\n"
+        "#UserLogo[logoSize=\"large\"]{border-radius:80px;font-size: 64px;}\n");
+    return style_sheet;
+}
+
+/** {zh}
+ * 按设备像素比缓存已栅格化的状态图标，避免每次刷新都解码资源
+ */
+
+/** {en}
+* Cache rasterized state icons per device pixel ratio, so refreshes do not decode resources again
+*/
+const QPixmap& decorationPixmap(const char* path, qreal dpr) {
+    static std::map<std::pair<QString, qreal>, QPixmap> cache;
+    auto key = std::make_pair(QString::fromLatin1(path), dpr);
+    auto iter = cache.find(key);
+    if (iter == cache.end()) {
+        QIcon icon(key.first);
+        QPixmap pixmap = icon.pixmap(icon.actualSize(QSize(16, 16)) * dpr);
+        pixmap.setDevicePixelRatio(dpr);
+        iter = cache.emplace(key, pixmap).first;
+    }
+    return iter->second;
+}
+
+void setDecorationProperty(QWidget* widget, const char* name, const QVariant& value) {
+    if (widget->property(name) == value) {
+        return;
+    }
+    widget->setProperty(name, value);
+    widget->style()->unpolish(widget);
+    widget->style()->polish(widget);
+}
+
+}  // namespace
+
 VideoCallVideoWidget::HasVideoWidget::HasVideoWidget(QWidget* parent /*= nullptr*/) 
     : QWidget(parent) {
     this->setObjectName("HasVideoWidget");
     video_ = new QWidget(this);
+    video_->setObjectName("HasVideoView");
     
     info_content_ = new QWidget(this);
+    info_content_->setObjectName("VideoInfoContent");
     lbl_share_logo_ = new QLabel(info_content_);
     lbl_user_name_ = new QLabel(info_content_);
     lbl_mic_state_ = new QLabel(info_content_);
@@ -33,11 +96,6 @@ VideoCallVideoWidget::HasVideoWidget::HasVideoWidget(QWidget* parent /*= nullptr
     lbl_user_name_->setVisible(false);
     lbl_share_logo_->setVisible(false);
     info_content_->setLayout(hbox_layout);
-
-    info_content_->setStyleSheet(
-        "font-family: \"Microsoft YaHei\";\n"
-        "font-size: 12px;\n");
-    video_->setStyleSheet("background:#272e3B;");
     setShare(false);
 }
 
@@ -64,31 +122,33 @@ void VideoCallVideoWidget::HasVideoWidget::showVideo() {
 }
 
 void VideoCallVideoWidget::HasVideoWidget::setHighLight(bool enabled) {
-    if (enabled) {
-        setStyleSheet("#HasVideoWidget{border:2px solid #23C343;}");
-    }
-    else {
-        setStyleSheet("#HasVideoWidget{border:none}");
-    }
+    setDecorationProperty(this, "highlight", enabled);
 }
 
 void VideoCallVideoWidget::HasVideoWidget::setShare(bool enabled) {
+    auto dpr = devicePixelRatioF();
+    if (share_state_ == static_cast<int>(enabled) && share_dpr_ == dpr) {
+        return;
+    }
+    share_state_ = enabled;
+    share_dpr_ = dpr;
     lbl_share_logo_->setVisible(enabled);
-
-    QIcon shareIcon = QIcon(":img/videocall_share_checked");
-    QPixmap m_pic = shareIcon.pixmap(shareIcon.actualSize(QSize(16, 16)));
-    lbl_share_logo_->setPixmap(m_pic);
+    lbl_share_logo_->setPixmap(decorationPixmap(":img/videocall_share_checked", dpr));
     info_content_->resize(info_content_->layout()->sizeHint());
     info_content_->move(2,
             height() - info_content_->height() - 2);
 }
 
 void VideoCallVideoWidget::HasVideoWidget::setMic(bool enabled) {
+    auto dpr = devicePixelRatioF();
+    if (mic_state_ == static_cast<int>(enabled) && mic_dpr_ == dpr) {
+        return;
+    }
+    mic_state_ = enabled;
+    mic_dpr_ = dpr;
     lbl_mic_state_->setVisible(true);
-
-    QIcon micIcon = QIcon(enabled ? ":img/videocall_mic_on" : ":img/videocall_mic_off");
-    QPixmap m_pic = micIcon.pixmap(micIcon.actualSize(QSize(16, 16)));
-    lbl_mic_state_->setPixmap(m_pic);
+    lbl_mic_state_->setPixmap(decorationPixmap(
+        enabled ? ":img/videocall_mic_on" : ":img/videocall_mic_off", dpr));
     info_content_->resize(info_content_->layout()->sizeHint());
     info_content_->move(2,
         height() - info_content_->height() - 2);
@@ -108,10 +168,6 @@ void VideoCallVideoWidget::HasVideoWidget::moveEvent(QMoveEvent*) {}
 VideoCallVideoWidget::NoVideoWidget::NoVideoWidget(QWidget* parent /*= nullptr*/) 
     : QWidget(parent) {
     this->setObjectName("NoVideoWidget");
-    setStyleSheet(
-        "#NoVideoWidget{background:#272E3B;"
-        "font-family: \"Microsoft YaHei\";\n"
-        "font-size: 12px;}\n");
 
     auto p = new QVBoxLayout();
     p->setContentsMargins(0, 0, 0, 0);
@@ -123,16 +179,17 @@ VideoCallVideoWidget::NoVideoWidget::NoVideoWidget(QWidget* parent /*= nullptr*/
     logo_layout->setContentsMargins(0, 0, 0, 0);
     logo_layout->setSpacing(0);
     lbl_user_logo_ = new QLabel(this);
+    lbl_user_logo_->setObjectName("UserLogo");
+    lbl_user_logo_->setProperty("logoSize", QStringLiteral("small"));
     lbl_user_logo_->setFixedSize(40, 40);
     logo_layout->addWidget(lbl_user_logo_);
     lbl_user_logo_->setAlignment(Qt::AlignCenter);
-    lbl_user_logo_->setStyleSheet(
-        "border-radius:20px; background:#4E5969;border: 2px solid #4080FF;");
     p->addItem(logo_layout);
     p->addItem(
         new QSpacerItem(1, 1, QSizePolicy::Expanding, QSizePolicy::Expanding));
 
     info_content_ = new QWidget(this);
+    info_content_->setObjectName("VideoInfoContent");
     lbl_share_logo_ = new QLabel(info_content_);
     lbl_user_name_ = new QLabel(info_content_);
     lbl_mic_state_ = new QLabel(info_content_);
@@ -147,72 +204,67 @@ VideoCallVideoWidget::NoVideoWidget::NoVideoWidget(QWidget* parent /*= nullptr*/
     lbl_user_name_->setVisible(false);
     lbl_share_logo_->setVisible(false);
     info_content_->setLayout(hbox_layout);
-
-    info_content_->setStyleSheet(
-        "font-family: \"Microsoft YaHei\";\n"
-        "font-size: 12px;\n"
-        "border:none;");
 }
 
 void VideoCallVideoWidget::NoVideoWidget::setUserLogoSize() {
+    int logo_size = 40;
+    QString size_name = QStringLiteral("small");
     if (this->width() > 600 && this->height() > 600) {
-        lbl_user_logo_->setFixedSize(160,160);
-        lbl_user_logo_->setStyleSheet(
-            "border-radius:80px; background:#4E5969;border:none;"
-            "font-family: 'Inter';font-weight: 500;font-size: 64px; ");
+        logo_size = 160;
+        size_name = QStringLiteral("large");
     }
     else if (this->width() > 350 && this->height() > 200) {
-        lbl_user_logo_->setFixedSize(80, 80);
-        lbl_user_logo_->setStyleSheet(
-            "border-radius:40px; background:#4E5969;border:none;"
-            "font-family: 'Inter';font-weight: 500;font-size: 32px; ");
+        logo_size = 80;
+        size_name = QStringLiteral("medium");
     }
-    else {
-        lbl_user_logo_->setFixedSize(40, 40);
-        lbl_user_logo_->setStyleSheet(
-            "border-radius:20px; background:#4E5969;border:none;"
-            "font-family: 'Inter';font-weight: 500;font-size: 16px; ");
+    if (lbl_user_logo_->width() != logo_size) {
+        lbl_user_logo_->setFixedSize(logo_size, logo_size);
     }
+    setDecorationProperty(lbl_user_logo_, "logoSize", size_name);
 }
 
 void VideoCallVideoWidget::NoVideoWidget::setUserName(const QString& str) {
     lbl_user_name_->setText(str);
     lbl_user_logo_->setText(str.left(1).toUpper());
     lbl_user_name_->setVisible(true);
+    // {zh} setShare/setMic 状态未变时不再重排，名字变化需在这里自行调整宽度
+    // {en} setShare/setMic skip the relayout when unchanged, so a new name has to resize the bar here
+    info_content_->resize(info_content_->layout()->sizeHint());
+    info_content_->move(2,
+        height() - info_content_->height() - 2);
 }
 
 void VideoCallVideoWidget::NoVideoWidget::setShare(bool enabled) {
+    auto dpr = devicePixelRatioF();
+    if (share_state_ == static_cast<int>(enabled) && share_dpr_ == dpr) {
+        return;
+    }
+    share_state_ = enabled;
+    share_dpr_ = dpr;
     lbl_share_logo_->setVisible(enabled);
-
-    QIcon shareIcon = QIcon(":img/videocall_share_checked");
-    QPixmap m_pic = shareIcon.pixmap(shareIcon.actualSize(QSize(16, 16)));
-    lbl_share_logo_->setPixmap(m_pic);
+    lbl_share_logo_->setPixmap(decorationPixmap(":img/videocall_share_checked", dpr));
     info_content_->resize(info_content_->layout()->sizeHint());
     info_content_->move(2,
         height() - info_content_->height() - 2);
 }
 
 void VideoCallVideoWidget::NoVideoWidget::setMic(bool enabled) {
+    auto dpr = devicePixelRatioF();
+    if (mic_state_ == static_cast<int>(enabled) && mic_dpr_ == dpr) {
+        return;
+    }
+    mic_state_ = enabled;
+    mic_dpr_ = dpr;
     lbl_mic_state_->setVisible(true);
-    QIcon micIcon = QIcon(enabled ? ":img/videocall_mic_on" : ":img/videocall_mic_off");
-    QPixmap m_pic = micIcon.pixmap(micIcon.actualSize(QSize(16, 16)));
-    lbl_mic_state_->setPixmap(m_pic);
+    lbl_mic_state_->setPixmap(decorationPixmap(
+        enabled ? ":img/videocall_mic_on" : ":img/videocall_mic_off", dpr));
     info_content_->resize(info_content_->layout()->sizeHint());
     info_content_->move(2,
         height() - info_content_->height() - 2);
 }
 
 void VideoCallVideoWidget::NoVideoWidget::setHighLight(bool enabled) {
-    if (enabled) {
-        setStyleSheet("#NoVideoWidget{background:#272E3B;"
-            "font-family: \"Microsoft YaHei\";font-size: 12px;\n"
-            "border:2px solid #23C343;}");
-    }
-    else {
-        setStyleSheet("#NoVideoWidget{background:#272E3B;"
-            "font-family: \"Microsoft YaHei\";font-size: 12px;\n"
-            "border:none;}");
-    }
+    setDecorationProperty(this, "highlight", enabled);
 }
 
 void VideoCallVideoWidget::NoVideoWidget::resizeEvent(QResizeEvent* e) {
@@ -226,6 +278,7 @@ void VideoCallVideoWidget::NoVideoWidget::showEvent(QShowEvent*) {
 
 VideoCallVideoWidget::VideoCallVideoWidget(QWidget* parent)
     : QWidget(parent){
+    setStyleSheet(decorationStyleSheet());
     setLayout(new QHBoxLayout());
     layout()->setContentsMargins(0, 0, 0, 0);
     layout()->setSpacing(0);
@@ -56,6 +56,12 @@ private:
     QLabel* lbl_share_logo_;
     QLabel* lbl_user_name_;
     QLabel* lbl_mic_state_;
+    // {zh} 上次设置的状态，-1表示未设置，状态与像素比不变时不刷新图标
+    // {en} Last applied state, -1 means unset, icons are not refreshed while state and pixel ratio are unchanged
+    int share_state_ = -1;
+    int mic_state_ = -1;
+    qreal share_dpr_ = 0;
+    qreal mic_dpr_ = 0;
 };
 
 class NoVideoWidget : public QWidget {
@@ -78,6 +84,10 @@ private:
     QLabel* lbl_user_name_;
     QLabel* lbl_mic_state_;
     QWidget* info_content_;
+    int share_state_ = -1;
+    int mic_state_ = -1;
+    qreal share_dpr_ = 0;
+    qreal mic_dpr_ = 0;
 };
 
 };
@@ -1,25 +1,34 @@
 #include "focus_video_view.h"
 #include "ui_focus_video_view.h"
 
+#include <QLabel>
 #include <QPainter>
 #include <QScrollBar>
 #include <QStyleOption>
 #include <QTimer>
+#include <QHideEvent>
 #include <QWheelEvent>
+#include <algorithm>
 
 #include "videocall/core/videocall_manager.h"
+#include "videocall/core/videocall_rtc_wrap.h"
+#include "videocall/core/data_mgr.h"
+
+namespace {
+constexpr int kStripSpacing = 8;
+}  // namespace
 
 FocusVideoView::FocusVideoView(QWidget *parent)
     : QWidget(parent)
     , ui(new Ui::FocusVideoView) {
 
     ui->setupUi(this);
-    ui->video_list->setLayout(new QVBoxLayout);
-    ui->video_list->layout()->setContentsMargins(0, 0, 0, 0);
-    ui->video_list->layout()->setSpacing(8);
     ui->big_view->setLayout(new QHBoxLayout);
     ui->big_view->layout()->setContentsMargins(0, 0, 0, 0);
     ui->big_view->layout()->setSpacing(0);
+    ui->scrollArea->viewport()->installEventFilter(this);
+    connect(ui->scrollArea->verticalScrollBar(), &QScrollBar::valueChanged,
+        this, [this] { layoutStrip(); });
 }
 
 FocusVideoView::~FocusVideoView() { 
@@ -28,30 +37,128 @@ FocusVideoView::~FocusVideoView() {
 
 void FocusVideoView::init() {
     auto list = videocall::VideoCallManager::getVideoList();
-    auto lay = ui->video_list->layout();
-    for (int i = 0; i < list.size(); i++) {
-        lay->removeWidget(list[i].get());
-        list[i]->hide();
+    for (auto& w : list) {
+        if (w && w->parentWidget() == ui->video_list) {
+            w->hide();
+        }
+    }
+    for (auto holder : placeholders_) {
+        holder->hide();
     }
     cnt_ = 0;
 }
 
 void FocusVideoView::showWidget(int cnt) {
+    auto screen = videocall::VideoCallManager::getScreenVideo();
+    if (screen->parentWidget() != ui->big_view) {
+        ui->big_view->layout()->addWidget(screen.get());
+    }
+    cnt_ = cnt;
+    layoutStrip();
+}
+
+/** {zh}
+ * 按滚动位置排布右侧列表：可视区域上下各预取一个渲染块高度，
+ * 范围内使用真实渲染块，范围外使用占位块并取消视频订阅
+ */
+
+/** {en}
+* Lay out the strip for the current scroll position: one block height is prefetched above and below the viewport,
+* blocks inside that range are live, the rest become placeholders and have their video unsubscribed
+*/
+void FocusVideoView::layoutStrip() {
     auto list = videocall::VideoCallManager::getVideoList();
-    auto lay = ui->video_list->layout();
-    for (int i = cnt; i < cnt_; i++) {
-        list[i]->hide();
+    auto users = videocall::DataMgr::instance().users();
+    auto viewport = ui->scrollArea->viewport();
+    const int width = viewport->width();
+    const int height = width / 16 * 9;
+    const int cnt = std::min<int>(cnt_, static_cast<int>(list.size()));
+    const int total = cnt > 0 ? cnt * height + (cnt - 1) * kStripSpacing : 0;
+    if (ui->video_list->minimumHeight() != total) {
+        ui->video_list->setMinimumHeight(total);
     }
-    auto width = ui->scrollArea->width();
-    ui->big_view->layout()->addWidget(
-        videocall::VideoCallManager::getScreenVideo().get());
-    for (int i = 0; i < cnt; i++) {
-        lay->addWidget(list[i].get());
-        list[i]->setFixedSize(width, width / 16 * 9);
-        list[i]->show();
+    // {zh} 不足一屏时居中显示
+    // {en} Center the strip when it is shorter than the viewport
+    const int top = std::max(0, (viewport->height() - total) / 2);
+    const int scroll = ui->scrollArea->verticalScrollBar()->value();
+    const int live_top = scroll - height;
+    const int live_bottom = scroll + viewport->height() + height;
+
+    // {zh} 所有远端用户的视频订阅汇总后一次应用，未变化的用户不产生SDK调用；只改视频，音频和分层沿用已记录的期望状态
+    // {en} Video subscriptions of every remote user are applied in one batch, unchanged users cost no SDK call;
+    // only video changes, audio and the layer keep the tracked desired state
+    std::vector<vrd::StreamSubscription> subscriptions;
+    ui->video_list->setUpdatesEnabled(false);
+    for (int i = 0; i < static_cast<int>(list.size()); i++) {
+        auto& w = list[i];
+        const QRect rect(0, top + i * (height + kStripSpacing), width, height);
+        const bool in_strip = i < cnt;
+        const bool live = in_strip && rect.bottom() >= live_top && rect.top() <= live_bottom;
+        const bool remote = in_strip && i < static_cast<int>(users.size())
+            && users[i].user_id != videocall::DataMgr::instance().user_id();
+
+        // {zh} 焦点页或窗口隐藏时 isVisible 总为false，用 isHidden 判断磁贴自身的状态
+        // {en} isVisible is always false while the focus page or window is hidden, isHidden checks the tile itself
+        if (live && w) {
+            if (w->parentWidget() != ui->video_list) {
+                w->setParent(ui->video_list);
+            }
+            if (w->size() != rect.size()) {
+                w->setFixedSize(rect.size());
+            }
+            if (w->pos() != rect.topLeft()) {
+                w->move(rect.topLeft());
+            }
+            w->show();
+        }
+        else if (w && w->parentWidget() == ui->video_list && !w->isHidden()) {
+            w->hide();
+        }
+
+        if (in_strip && !live) {
+            auto holder = placeholder(i);
+            holder->setText(i < static_cast<int>(users.size())
+                ? QString::fromStdString(users[i].user_name) : QString());
+            holder->setGeometry(rect);
+            holder->show();
+        }
+        else if (i < static_cast<int>(placeholders_.size())) {
+            placeholders_[i]->hide();
+        }
+
+        if (remote) {
+            auto subscription = VideoCallRtcEngineWrap::desiredSubscription(users[i].user_id, false);
+            subscription.video = live;
+            subscriptions.push_back(subscription);
+        }
     }
-    cnt_ = cnt;
-    ui->video_list->layout()->setAlignment(Qt::AlignCenter);
+    ui->video_list->setUpdatesEnabled(true);
+    VideoCallRtcEngineWrap::applySubscriptions(subscriptions);
+}
+
+QLabel* FocusVideoView::placeholder(int index) {
+    while (static_cast<int>(placeholders_.size()) <= index) {
+        auto holder = new QLabel(ui->video_list);
+        holder->setAlignment(Qt::AlignCenter);
+        holder->setStyleSheet(
+            "background:#272E3B; color:#86909C;"
+            "font-family: \"Microsoft YaHei\";font-size: 12px;");
+        holder->hide();
+        placeholders_.push_back(holder);
+    }
+    return placeholders_[index];
+}
+
+void FocusVideoView::resubscribeAll() {
+    std::vector<vrd::StreamSubscription> subscriptions;
+    for (auto& user : videocall::DataMgr::instance().users()) {
+        if (user.user_id != videocall::DataMgr::instance().user_id()) {
+            auto subscription = VideoCallRtcEngineWrap::desiredSubscription(user.user_id, false);
+            subscription.video = true;
+            subscriptions.push_back(subscription);
+        }
+    }
+    VideoCallRtcEngineWrap::applySubscriptions(subscriptions);
 }
 
 void FocusVideoView::wheelEvent(QWheelEvent *e) {
@@ -62,6 +169,21 @@ void FocusVideoView::wheelEvent(QWheelEvent *e) {
     e->accept();
 }
 
+void FocusVideoView::hideEvent(QHideEvent *e) {
+    // {zh} 离开焦点模式时恢复所有用户的视频订阅，窗口最小化不算离开
+    // {en} Restore every user's video subscription when leaving focus mode, minimizing the window does not count
+    if (!e->spontaneous()) {
+        resubscribeAll();
+    }
+}
+
+bool FocusVideoView::eventFilter(QObject *watched, QEvent *e) {
+    if (watched == ui->scrollArea->viewport() && e->type() == QEvent::Resize) {
+        layoutStrip();
+    }
+    return QWidget::eventFilter(watched, e);
+}
+
 void FocusVideoView::paintEvent(QPaintEvent *e) {
     QStyleOption opt;
     opt.init(this);
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <QWidget>
+#include <vector>
 
 class QHBoxLayout;
+class QLabel;
 class QSpacerItem;
 
 namespace Ui {
@@ -11,11 +13,15 @@ class FocusVideoView;
 
 /** {zh}
  * 包括共享内容的视频渲染区域类，左边是共享内容，右边是竖着排列的用户视频
+ * 右侧列表只为可视区域及预取范围内的用户保留渲染块，其余用户显示占位块，
+ * 既不绑定画布也不订阅视频
  */
 
 /** {en}
 * The video rendering area class including shared content, 
 * the left side is the shared content, and the right side is the user's video arranged vertically
+* The right strip only keeps rendering blocks for users inside the viewport plus a prefetch margin,
+* the other users get placeholders with neither a canvas nor a video subscription
 */
 class FocusVideoView : public QWidget {
   Q_OBJECT
@@ -29,8 +35,16 @@ class FocusVideoView : public QWidget {
 
  protected:
   void paintEvent(QPaintEvent *) override;
+  void hideEvent(QHideEvent *) override;
+  bool eventFilter(QObject *watched, QEvent *e) override;
+
+ private:
+  void layoutStrip();
+  QLabel* placeholder(int index);
+  void resubscribeAll();
 
  private:
   Ui::FocusVideoView* ui;
   int cnt_ = 0;
+  std::vector<QLabel*> placeholders_;
 };
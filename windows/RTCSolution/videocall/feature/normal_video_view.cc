@@ -4,11 +4,17 @@
 #include <QPainter>
 #include <QStyleOption>
 #include <QTimer>
-#include <QGridLayout>
 #include <QButtonGroup>
+#include <algorithm>
 
 #include "videocall/core/videocall_manager.h"
 
+namespace {
+constexpr int kTilesPerPage = 4;
+constexpr int kTileMargin = 8;
+constexpr int kTileSpacing = 8;
+}  // namespace
+
 NormalVideoView::NormalVideoView(QWidget *parent)
     : QWidget(parent)
     , ui(new Ui::NormalVideoView) {
@@ -19,6 +25,7 @@ NormalVideoView::NormalVideoView(QWidget *parent)
     group->addButton(ui->page3);
 
     ui->pageControlWidget->hide();
+    ui->videoArea->installEventFilter(this);
     QObject::connect(ui->page1, &QPushButton::clicked, this, [this] {showWidgetWithIndex(0); });
     QObject::connect(ui->page2, &QPushButton::clicked, this, [this] {showWidgetWithIndex(4); });
     QObject::connect(ui->page3, &QPushButton::clicked, this, [this] {showWidgetWithIndex(8); });
@@ -37,120 +44,138 @@ void NormalVideoView::showWidget(int cnt, bool forceUpdated) {
     }
 
     cnt_ = cnt;
-    auto lay = ui->gridLayout;
-    auto list = videocall::VideoCallManager::getVideoList();
-    for (auto w : list) {
-        if (w) {
-            w->setMaximumSize(16777215, 16777215);
-        }
-    }
-
-    if (cnt <= 4) {
+    if (cnt <= kTilesPerPage) {
         ui->pageControlWidget->hide();
         first_video_index_ = 0;
-
-        QLayoutItem* childItem;
-        while ((childItem = lay->takeAt(0)) != 0) {
-            if (auto widget = dynamic_cast<VideoCallVideoWidget*>(childItem->widget())) {
-                lay->removeWidget(widget);
-                widget->setVideoUpdateEnabled(true);
-                widget->hide();
-            }
-            else {
-                childItem->widget()->hide();
-                delete childItem;
-            }
-        }
     }
-
-    switch (cnt) {
-    case 1:
-        lay->setContentsMargins(0, 0, 0, 0);
-        lay->addWidget(list[0].get(), 0, 0);
-        list[0]->show();
-        list[0]->setVideoUpdateEnabled(false);
-        break;
-    case 2:
-        lay->setContentsMargins(8, 8, 8, 8);
-        lay->addWidget(list[0].get(), 0, 0);
-        lay->addWidget(list[1].get(), 0, 1);
-        list[0]->show();
-        list[1]->show();
-        list[0]->setVideoUpdateEnabled(false);
-        list[1]->setVideoUpdateEnabled(false);
-        break;
-    case 3:
-    case 4:
-        for (int i = 0; i < cnt; i++) {
-            lay->addWidget(list[i].get(), i / 2, i % 2);
-            list[i]->show();
-            list[i]->setVideoUpdateEnabled(false);
-        }
-        break;
-    default:
+    else {
         ui->pageControlWidget->show();
-        if (cnt < 9) {
-            ui->page1->show();
-            ui->page2->show();
-            ui->page3->hide();
+        ui->page3->setVisible(cnt > 2 * kTilesPerPage);
+        // {zh} 人数减少导致当前页为空时，回到最后一页
+        // {en} Fall back to the last page when fewer users leave the current page empty
+        if (first_video_index_ >= cnt) {
+            first_video_index_ = (cnt - 1) / kTilesPerPage * kTilesPerPage;
         }
-        else if (cnt <= 12) {
-            ui->page1->show();
-            ui->page2->show();
-            ui->page3->show();
-        }
-        showWidgetWithIndex(first_video_index_);
-        break;
+        QPushButton* pages[] = { ui->page1, ui->page2, ui->page3 };
+        pages[first_video_index_ / kTilesPerPage]->setChecked(true);
     }
+    layoutTiles();
 }
 
 void NormalVideoView::showWidgetWithIndex(int firstIndex) {
-    auto lay = ui->gridLayout;
-    auto list = videocall::VideoCallManager::getVideoList();
+    first_video_index_ = firstIndex;
+    layoutTiles();
+}
 
-    QLayoutItem* childItem;
-    while ((childItem = lay->takeAt(0)) != 0) {
-        if (auto widget = dynamic_cast<VideoCallVideoWidget*>(childItem->widget())) {
-            lay->removeWidget(widget);
-            widget->setVideoUpdateEnabled(true);
-            widget->hide();
-        }
-        else {
-            childItem->widget()->hide();
-            delete childItem;
+void NormalVideoView::init() {
+    auto list = videocall::VideoCallManager::getVideoList();
+    for (auto& w : list) {
+        if (w && w->parentWidget() == ui->videoArea) {
+            w->hide();
         }
     }
+    cnt_ = 0;
+    first_video_index_ = 0;
+    ui->page1->setChecked(true);
+}
+
+/** {zh}
+ * 计算一屏内渲染块的位置：1人铺满无边距，2人左右并排，3到4人为2x2网格，
+ * 不足4人的页按4格排布，空位留白
+ */
+
+/** {en}
+* Compute block rectangles for one screen: 1 user fills the area without margins, 2 users side by side,
+* 3 to 4 users in a 2x2 grid, a page with fewer than 4 users keeps the 2x2 cells and leaves the rest empty
+*/
+std::vector<QRect> NormalVideoView::computeTileRects(int cnt, const QSize& area) {
+    std::vector<QRect> rects;
+    if (cnt <= 0 || area.isEmpty()) {
+        return rects;
+    }
+    if (cnt == 1) {
+        rects.emplace_back(QPoint(0, 0), area);
+        return rects;
+    }
+    const int rows = cnt == 2 ? 1 : 2;
+    const int cols = 2;
+    const int inner_w = area.width() - 2 * kTileMargin - (cols - 1) * kTileSpacing;
+    const int inner_h = area.height() - 2 * kTileMargin - (rows - 1) * kTileSpacing;
+    // {zh} 余数像素分给靠前的行列，保证网格铺满区域
+    // {en} Leftover pixels go to the leading rows and columns so the grid fills the area
+    auto cellOffset = [](int total, int parts, int i) {
+        return total / parts * i + std::min(i, total % parts);
+    };
+    for (int i = 0; i < std::min(cnt, rows * cols); i++) {
+        int row = i / cols;
+        int col = i % cols;
+        int x = cellOffset(inner_w, cols, col);
+        int y = cellOffset(inner_h, rows, row);
+        int w = cellOffset(inner_w, cols, col + 1) - x;
+        int h = cellOffset(inner_h, rows, row + 1) - y;
+        rects.emplace_back(kTileMargin + x + col * kTileSpacing,
+            kTileMargin + y + row * kTileSpacing, std::max(w, 0), std::max(h, 0));
+    }
+    return rects;
+}
+
+/** {zh}
+ * 按计算结果一次性更新渲染块：仍可见的渲染块只调整位置，不会被隐藏或重新挂载
+ */
 
-    auto index = firstIndex;
-    for (int i = 0; i < 4; i++) {
-        if (index < cnt_) {
-            lay->addWidget(list[index].get(), i / 2, i % 2);
-            list[index]->show();
-            list[index]->setVideoUpdateEnabled(false);
+/** {en}
+* Apply the computed rectangles in one batch: blocks that stay visible are only moved, never hidden or reattached
+*/
+void NormalVideoView::layoutTiles() {
+    auto area = ui->videoArea;
+    auto list = videocall::VideoCallManager::getVideoList();
+    int page_cnt = cnt_ <= kTilesPerPage ? cnt_ : kTilesPerPage;
+    int first = cnt_ <= kTilesPerPage ? 0 : first_video_index_;
+    auto rects = computeTileRects(page_cnt, area->size());
+
+    area->setUpdatesEnabled(false);
+    for (int i = 0; i < static_cast<int>(list.size()); i++) {
+        auto& w = list[i];
+        if (!w) {
+            continue;
+        }
+        int slot = i - first;
+        bool visible = slot >= 0 && slot < page_cnt && i < cnt_
+            && slot < static_cast<int>(rects.size());
+        // {zh} 用 isHidden 判断磁贴自身的状态，页面或窗口隐藏时 isVisible 总为false
+        // {en} isHidden checks the tile's own state, isVisible is always false while the page or window is hidden
+        if (!visible) {
+            if (w->parentWidget() == area && !w->isHidden()) {
+                w->setVideoUpdateEnabled(true);
+                w->hide();
+            }
+            continue;
         }
-        else {
-            // {zh} 空的widget，仅占位置
-            // {en} Empty widget, only takes up space
-            auto placeHolder = new QWidget(this);
-            placeHolder->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
-            lay->addWidget(placeHolder, i / 2, i % 2);
-            placeHolder->show();
+        if (w->parentWidget() != area) {
+            w->setParent(area);
+        }
+        if (w->minimumSize() != QSize(0, 0)) {
+            w->setMinimumSize(0, 0);
+        }
+        if (w->maximumSize() != QSize(QWIDGETSIZE_MAX, QWIDGETSIZE_MAX)) {
+            w->setMaximumSize(QWIDGETSIZE_MAX, QWIDGETSIZE_MAX);
+        }
+        if (w->geometry() != rects[slot]) {
+            w->setGeometry(rects[slot]);
+        }
+        if (w->isHidden()) {
+            w->show();
+            w->setVideoUpdateEnabled(false);
         }
-        index++;
     }
-    first_video_index_ = firstIndex;
+    area->setUpdatesEnabled(true);
 }
 
-void NormalVideoView::init() {
-    auto list = videocall::VideoCallManager::getVideoList();
-    auto lay = ui->gridLayout;
-    for (int i = first_video_index_; i < first_video_index_ + 4; i++) {
-        lay->removeWidget(list[i].get());
-        list[i]->hide();
+bool NormalVideoView::eventFilter(QObject* watched, QEvent* e) {
+    if (watched == ui->videoArea && e->type() == QEvent::Resize) {
+        layoutTiles();
     }
-    cnt_ = 0;
-    first_video_index_ = 0;
-    ui->page1->setChecked(true);
+    return QWidget::eventFilter(watched, e);
 }
 
 void NormalVideoView::paintEvent(QPaintEvent *e) {
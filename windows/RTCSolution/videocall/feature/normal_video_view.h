@@ -1,19 +1,23 @@
 #pragma once
 
 #include "videocall/core/videocall_model.h"
+#include <QRect>
 #include <QWidget>
+#include <vector>
 
 namespace Ui {
 class NormalVideoView;
 }
 
 /** {zh}
-* 视频渲染区域类，以网格布局排布的用户视频，一屏最多4个视频，多余4个可翻页
+* 视频渲染区域类，以网格排布的用户视频，一屏最多4个视频，多余4个可翻页
+* 渲染块位置由人数与区域尺寸直接计算，只移动位置发生变化的渲染块
 */
 
 /** {en}
-* Video rendering area class, user videos arranged in a grid layout, 
+* Video rendering area class, user videos arranged in a grid, 
 * a maximum of 4 videos on one screen, and pages can be turned if there are more than 4
+* Block rectangles are computed from the count and area size, only blocks whose rectangle changed are moved
 */
 
 class NormalVideoView : public QWidget {
@@ -25,8 +29,15 @@ public:
     void showWidget(int cnt, bool forceUpdated = false);
     void showWidgetWithIndex(int firstIndex);
     void init();
+
+    static std::vector<QRect> computeTileRects(int cnt, const QSize& area);
+
 protected:
     void paintEvent(QPaintEvent* event);
+    bool eventFilter(QObject* watched, QEvent* e) override;
+
+private:
+    void layoutTiles();
 
 private:
     Ui::NormalVideoView* ui;
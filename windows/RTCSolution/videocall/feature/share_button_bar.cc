@@ -129,7 +129,7 @@ void ShareButtonBar::initConnections() {
     connect(ui->btn_mic, &QPushButton::clicked, this, [=] {
         auto mute = videocall::DataMgr::instance().mute_audio();
         if (mute) {
-            if (!VideoCallRtcEngineWrap::audioRecordDevicesTest()) {
+            if (!VideoCallRtcEngineWrap::canCaptureAudio()) {
                 vrd::util::showToastInfo(QObject::tr("microphone_permission_disabled").toStdString());
                 return;
             }
@@ -143,9 +143,7 @@ void ShareButtonBar::initConnections() {
     connect(ui->btn_camera, &QPushButton::clicked, this, [=] {
         auto mute = videocall::DataMgr::instance().mute_video();
         if (mute) {
-            std::vector<RtcDevice> devices;
-            VideoCallRtcEngineWrap::getVideoCaptureDevices(devices);
-            if (devices.empty()) {
+            if (!VideoCallRtcEngineWrap::hasVideoCaptureDevice()) {
                 vrd::util::showToastInfo(QObject::tr("camera_permission_disabled").toStdString());
                 return;
             }
@@ -179,20 +177,18 @@ void ShareButtonBar::initCameraOption() {
 
         std::vector<RtcDevice> camera_devices;
         VideoCallRtcEngineWrap::getVideoCaptureDevices(camera_devices);
-        int idx = 0;
         int currentIndex = RtcEngineWrap::instance().getCurrentVideoCaptureDeviceIndex();
         for (auto& dc : camera_devices) {
             auto radioBtn = new QRadioButton(dc.name.c_str());
             radioBtn->setCheckable(true);
-            connect(radioBtn, &QRadioButton::clicked, [idx, radioBtn, this]() {
+            connect(radioBtn, &QRadioButton::clicked, [idx = dc.index, radioBtn, this]() {
                 radioBtn->setChecked(true);
                 VideoCallRtcEngineWrap::setVideoCaptureDevice(idx);
                 });
-            if (currentIndex == idx) {
+            if (currentIndex == dc.index) {
                 radioBtn->setChecked(true);
             }
             layout->addWidget(radioBtn);
-            idx++;
         }
 
         optionWidget->setLayout(layout);
@@ -240,19 +236,17 @@ void ShareButtonBar::initMicOption() {
 
         std::vector<RtcDevice> audio_input_devices;
         VideoCallRtcEngineWrap::getAudioInputDevices(audio_input_devices);
-        int idx = 0;
         int currentIndex = RtcEngineWrap::instance().getCurrentAudioInputDeviceIndex();
         for (auto& dc : audio_input_devices) {
             auto radioBtn = new QRadioButton(dc.name.c_str());
-            connect(radioBtn, &QRadioButton::clicked, [idx, radioBtn, this]() {
+            connect(radioBtn, &QRadioButton::clicked, [idx = dc.index, radioBtn, this]() {
                 radioBtn->setChecked(true);
                 VideoCallRtcEngineWrap::setAudioInputDevice(idx);
                 });
-            if (currentIndex == idx) {
+            if (currentIndex == dc.index) {
                 radioBtn->setChecked(true);
             }
             layout->addWidget(radioBtn);
-            idx++;
         }
 
         optionWidget->setLayout(layout);
@@ -298,9 +292,6 @@ void ShareButtonBar::initShareOption() {
         layout->setContentsMargins(16, 12, 16, 12);
         layout->setSpacing(8);
 
-        std::vector<RtcDevice> audio_input_devices;
-        VideoCallRtcEngineWrap::getAudioInputDevices(audio_input_devices);
-
         auto radioBtn1 = new QRadioButton(QObject::tr("clarity_priority"));
         connect(radioBtn1, &QRadioButton::clicked, []() {
             videocall::VideoConfiger screen;
@@ -1,7 +1,10 @@
 ﻿#include "videocall_login.h"
+#ifdef _WIN32
 #include <Windows.h>
+#endif
 #include <QTimer>
 
+#include "core/microphone_probe.h"
 #include "core/util_tip.h"
 #include "core/component/toast.h"
 #include "videocall/core/data_mgr.h"
@@ -36,8 +39,8 @@ void VideoCallLoginWidget::setCameraState(bool on) {
     ui.cameraLabel->setText(on ? tr("camera_enabled") : tr("camera_disabled"));
 }
 
-void VideoCallLoginWidget::showEvent(QShowEvent*) {
-    if (!VideoCallRtcEngineWrap::audioRecordDevicesTest()) {
+void VideoCallLoginWidget::applyMicCapability(int capability) {
+    if (capability != vrd::MicrophoneProbe::kCapable) {
         vrd::util::showToastInfo(QObject::tr("microphone_permission_disabled").toStdString());
     }
     else {
@@ -46,10 +49,18 @@ void VideoCallLoginWidget::showEvent(QShowEvent*) {
         setMicState(true);
         videocall::DataMgr::instance().setMuteAudio(false);
     }
+}
+
+void VideoCallLoginWidget::showEvent(QShowEvent*) {
+    // {zh} 启动时的麦克风探测可能还没有结果，等结果出来再决定是否打开麦克风
+    // {en} The startup microphone probe may not have answered yet, decide on the microphone once it does
+    auto capability = vrd::MicrophoneProbe::instance().capability();
+    wait_mic_probe_ = capability == vrd::MicrophoneProbe::kUnknown;
+    if (!wait_mic_probe_) {
+        applyMicCapability(capability);
+    }
 
-    std::vector<RtcDevice> devices;
-    VideoCallRtcEngineWrap::getVideoCaptureDevices(devices);
-    if (devices.empty()) {
+    if (!VideoCallRtcEngineWrap::hasVideoCaptureDevice()) {
         vrd::util::showToastInfo(QObject::tr("camera_permission_disabled").toStdString());
     }
     else {
@@ -91,42 +102,29 @@ void VideoCallLoginWidget::initConnections() {
         [=] {
             if (login_) return;
             login_ = true;
-            videocall::DataMgr::instance().setUserName(std::string(ui.edt_user_name->text().toUtf8()));
-            // {zh} 清除可能在其他房间的相同用户
-            // {en} Clear the same user who may be in another room
-            vrd::VideoCallSession::instance().cleanUser(videocall::DataMgr::instance().user_id(), 
-                [=](int code) {
-                    auto roomId = QString("call_").append(ui.edt_room_id->text());
-                    vrd::VideoCallSession::instance().joinCall(
-                        videocall::DataMgr::instance().user_id(),
-                        roomId.toStdString(), [=](int code) {
-                            if (code == 200) {
-                                vrd::VideoCallSession::instance().setRoomId(videocall::DataMgr::instance().room_id());
-                                hide();
-                                videocall::VideoCallManager::initRoom();
-                                VideoCallRtcEngineWrap::login(
-                                    videocall::DataMgr::instance().room_id(),
-                                    videocall::DataMgr::instance().user_id(),
-                                    videocall::DataMgr::instance().token());
-                                // {zh} 适配无摄像头权限进房后移动端头像画面初始化失败
-                                // {en} Solve the issue that the avatar of the mobile app fails to initialize after entering the room without camera permission
-                                VideoCallRtcEngineWrap::muteLocalVideo(videocall::DataMgr::instance().mute_video());
-                                VideoCallRtcEngineWrap::enableLocalVideo(!videocall::DataMgr::instance().mute_video());
-                                VideoCallRtcEngineWrap::muteLocalAudio(videocall::DataMgr::instance().mute_audio());
-                                VideoCallRtcEngineWrap::enableLocalAudio(!videocall::DataMgr::instance().mute_audio());
-                            }
-                            login_ = false;
-                        });
+            auto userName = std::string(ui.edt_user_name->text().toUtf8());
+            auto roomId = QString("call_").append(ui.edt_room_id->text()).toStdString();
+            videocall::VideoCallManager::joinRoom(userName, roomId)
+                .always([=](const vrd::TaskResult<vrd::TaskVoid>&) {
+                    login_ = false;
                 });
         });
 
+    connect(&vrd::MicrophoneProbe::instance(), &vrd::MicrophoneProbe::sigCapabilityChanged,
+        this, [=](int capability) {
+            if (wait_mic_probe_ && capability != vrd::MicrophoneProbe::kUnknown) {
+                wait_mic_probe_ = false;
+                applyMicCapability(capability);
+            }
+        });
+
     connect(ui.micBtn, &QPushButton::clicked,
         this, [=] {
-            if (!VideoCallRtcEngineWrap::audioRecordDevicesTest()) {
+            bool enabled = !videocall::DataMgr::instance().mute_audio();
+            if (!enabled && !VideoCallRtcEngineWrap::canCaptureAudio()) {
                 vrd::util::showToastInfo(QObject::tr("microphone_permission_disabled").toStdString());
                 return;
             }
-            bool enabled = !videocall::DataMgr::instance().mute_audio();
             if (!VideoCallRtcEngineWrap::muteLocalAudio(enabled)) {
                 setMicState(!enabled);
                 videocall::DataMgr::instance().setMuteAudio(enabled);
@@ -135,9 +133,7 @@ void VideoCallLoginWidget::initConnections() {
 
     connect(ui.cameraBtn, &QPushButton::clicked,
         this, [=] {
-            std::vector<RtcDevice> devices;
-            VideoCallRtcEngineWrap::getVideoCaptureDevices(devices);
-            if (devices.empty()) {
+            if (!VideoCallRtcEngineWrap::hasVideoCaptureDevice()) {
                 vrd::util::showToastInfo(QObject::tr("camera_permission_disabled").toStdString());
                 return;
             }
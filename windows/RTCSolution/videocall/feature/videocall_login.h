@@ -27,9 +27,11 @@ private:
     void initConnections();
     void validateUserId(QString str);
     void validateRoomId(QString str);
+    void applyMicCapability(int capability);
 
 private:
     bool login_ = false;
+    bool wait_mic_probe_ = false;
     bool user_name_error_{ false };
     bool room_id_error_{ false };
     Ui::VideoCallLoginWidget ui;
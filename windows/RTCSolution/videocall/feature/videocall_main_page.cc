@@ -3,19 +3,22 @@
 
 #include <QCloseEvent>
 #include <QDateTime>
-#include <QTimer>
 #include <QDialog>
 #include <QPointer>
 #include <QIcon>
 #include <QToolButton>
 #include <QRadioButton>
 #include <QPushButton>
+#include <QButtonGroup>
+#include <QVBoxLayout>
+#include <QShortcut>
 
 #include <algorithm>
 
 #include "videocall/core/popup_arrow_widget.h"
 #include "videocall/core/videocall_video_widget.h"
 #include "core/util_tip.h"
+#include "core/trace_event.h"
 #include "videocall/core/videocall_rtc_wrap.h"
 #include "videocall/core/videocall_manager.h"
 #include "videocall/core/data_mgr.h"
@@ -47,6 +50,7 @@ VideoCallMainPage::~VideoCallMainPage() {
 }
 
 void VideoCallMainPage::updateVideoWidget() {
+    VRD_TRACE_SCOPE("layout", "updateVideoWidget");
     auto vec = videocall::DataMgr::instance().users();
     for (size_t i = 0; i < vec.size(); i++) {
         if (vec[i].user_id == videocall::DataMgr::instance().user_id()) {
@@ -61,12 +65,10 @@ void VideoCallMainPage::updateVideoWidget() {
 
 void VideoCallMainPage::showWidget(int cnt) {
     if (current_page_ == kNormalPage) {
-        static_cast<NormalVideoView*>(ui->stackedWidget->widget(current_page_))
-            ->showWidget(cnt);
+        normalView()->showWidget(cnt);
     }
     else {
-        static_cast<FocusVideoView*>(ui->stackedWidget->widget(current_page_))
-            ->showWidget(cnt);
+        focusView()->showWidget(cnt);
     }
 }
 
@@ -89,10 +91,17 @@ void VideoCallMainPage::init() {
         ui->lbl_room_id->setText(roomId.c_str());
     }
     ui->lbl_time->setText("00:00");
-    main_timer_->start(1000);
+    main_timer_.start(1000, [=] {
+        tick_count_++;
+        auto time =
+            QString::asprintf("%02lld:%02lld", tick_count_ / 60, tick_count_ % 60);
+        ui->lbl_time->setText(time);
+    });
 
-    static_cast<FocusVideoView*>(ui->stackedWidget->widget(VideoCallMainPage::kFocusPage))->init();
-    static_cast<NormalVideoView*>(ui->stackedWidget->widget(VideoCallMainPage::kNormalPage))->init();
+    if (ui->stackedWidget->count() > kFocusPage) {
+        focusView()->init();
+    }
+    normalView()->init();
     changeViewMode(0);
     froce_close_ = false;
 }
@@ -115,12 +124,14 @@ void VideoCallMainPage::setBasicBeauty(bool enabled) {
 }
 
 void VideoCallMainPage::changeViewMode(int mode) {
+    if (mode == kFocusPage) {
+        focusView();
+    }
     ui->stackedWidget->setCurrentIndex(mode);
     current_page_ = mode;
     updateVideoWidget();
     if (current_page_ == kNormalPage) {
-        static_cast<NormalVideoView*>(ui->stackedWidget->widget(current_page_))
-            ->showWidget(videocall::DataMgr::instance().users().size(), true);
+        normalView()->showWidget(videocall::DataMgr::instance().users().size(), true);
     }
 }
 
@@ -140,16 +151,14 @@ void VideoCallMainPage::closeEvent(QCloseEvent *e) {
         return;
     }
 
-    main_timer_->stop();
+    main_timer_.stop();
     emit sigClose();
 }
 
 void VideoCallMainPage::initUi() {
     tick_count_ = 0;
     ui->stackedWidget->addWidget(new NormalVideoView(this));
-    ui->stackedWidget->addWidget(new FocusVideoView(this));
     ui->stackedWidget->setContentsMargins(0, 0, 0, 0);
-    main_timer_ = new QTimer(this);
 
     initCameraOption();
     initMicOption();
@@ -168,15 +177,21 @@ void VideoCallMainPage::setDefaultProfiles() {
 }
 
 void VideoCallMainPage::initConnections() {
-    connect(main_timer_, &QTimer::timeout, this, [=] {
-        tick_count_++;
-        auto time =
-            QString::asprintf("%02lld:%02lld", tick_count_ / 60, tick_count_ % 60);
-        ui->lbl_time->setText(time);
-    });
-
     connect(ui->endCallBtn, &QToolButton::clicked, this, &QWidget::close);
 
+    // {zh} Ctrl+Shift+F12 开始或停止耗时追踪，停止时写入日志目录
+    // {en} Ctrl+Shift+F12 starts or stops tracing, the trace is written into the log directory on stop
+    auto traceShortcut = new QShortcut(QKeySequence("Ctrl+Shift+F12"), this);
+    connect(traceShortcut, &QShortcut::activated, this, [] {
+        auto& tracer = vrd::Tracer::instance();
+        if (vrd::Tracer::enabled()) {
+            tracer.stop();
+        }
+        else {
+            tracer.start();
+        }
+    });
+
     connect(ui->shareBtn, &QToolButton::clicked, this, [=] {
         auto cur_share_uid =
             videocall::DataMgr::instance().room().screen_shared_uid;
@@ -198,34 +213,16 @@ void VideoCallMainPage::initConnections() {
 
     connect(ui->micBtn, &QToolButton::clicked, this, [=] {
         auto mute = videocall::DataMgr::instance().mute_audio();
-        if (mute) {
-            if (!VideoCallRtcEngineWrap::audioRecordDevicesTest()) {
-                vrd::util::showToastInfo(QObject::tr("microphone_permission_disabled").toStdString());
-                return;
-            }
+        if (videocall::VideoCallManager::setLocalAudioMuted(!mute) != 0) {
+            vrd::util::showToastInfo(QObject::tr("microphone_permission_disabled").toStdString());
         }
-        setMicState(mute);
-        VideoCallRtcEngineWrap::muteLocalAudio(!mute);
-        VideoCallRtcEngineWrap::enableLocalAudio(mute);
-        videocall::DataMgr::instance().setMuteAudio(!mute);
     });
 
     connect(ui->cameraBtn, &QToolButton::clicked, this, [=] {
         auto mute = videocall::DataMgr::instance().mute_video();
-        if (mute) {
-            std::vector<RtcDevice> devices;
-            VideoCallRtcEngineWrap::getVideoCaptureDevices(devices);
-            if (devices.empty()) {
-                vrd::util::showToastInfo(QObject::tr("camera_permission_disabled").toStdString());
-                return;
-            }
+        if (videocall::VideoCallManager::setLocalVideoMuted(!mute) != 0) {
+            vrd::util::showToastInfo(QObject::tr("camera_permission_disabled").toStdString());
         }
-
-        setCameraState(mute);
-        VideoCallRtcEngineWrap::muteLocalVideo(!mute);
-        VideoCallRtcEngineWrap::enableLocalVideo(mute);
-        videocall::DataMgr::instance().setMuteVideo(!mute);
-        emit sigCameraEnabled(mute);
     });
 
     connect(ui->beautyBtn, &QToolButton::clicked, this, [=]() {
@@ -233,6 +230,89 @@ void VideoCallMainPage::initConnections() {
     });
 }
 
+NormalVideoView* VideoCallMainPage::normalView() {
+    return static_cast<NormalVideoView*>(ui->stackedWidget->widget(kNormalPage));
+}
+
+/** {zh}
+ * 焦点视图仅在有人共享时使用，首次切换时创建
+ */
+
+/** {en}
+* The focus view is only used while someone shares, so it is created on the first switch
+*/
+FocusVideoView* VideoCallMainPage::focusView() {
+    if (ui->stackedWidget->count() <= kFocusPage) {
+        ui->stackedWidget->addWidget(new FocusVideoView(this));
+    }
+    return static_cast<FocusVideoView*>(ui->stackedWidget->widget(kFocusPage));
+}
+
+/** {zh}
+ * 显示选项弹窗，弹窗与单选按钮在多次点击间复用，只更新文字与选中状态
+ */
+
+/** {en}
+* Show an option popup, the popup and its radio buttons are reused across clicks, only text and checked state are updated
+*/
+void VideoCallMainPage::showOptionPopup(OptionPopup& option, QPushButton* option_btn,
+    QWidget* owner_btn, const QStringList& items, int current,
+    std::function<void(int)> on_selected) {
+    if (!option.popup) {
+        option.popup = new PopupArrowWidget(option_btn);
+        option.popup->setAttribute(Qt::WA_DeleteOnClose, false);
+        option.popup->setArrowPosition(PopupArrowWidget::ArrowPosition::bottom);
+        option.options = new QWidget(option.popup);
+        option.options->setStyleSheet(radioBtnQss);
+        QVBoxLayout* layout = new QVBoxLayout(option.options);
+        layout->setContentsMargins(16, 12, 16, 12);
+        layout->setSpacing(8);
+        option.group = new QButtonGroup(option.options);
+        option.popup->addCustomWidget(option.options);
+
+        connect(option.popup, &PopupArrowWidget::widgetVisiblilityChanged,
+            [option_btn, owner_btn](bool isVisibled) {
+                option_btn->setIcon(isVisibled
+                    ? QIcon(":img/videocall_up_arrow") : QIcon(":img/videocall_down_arrow"));
+                owner_btn->update();
+            });
+    }
+    option.on_selected = std::move(on_selected);
+
+    auto buttons = option.group->buttons();
+    // {zh} 临时关闭互斥，以便当前项不存在时全部取消选中
+    // {en} Drop exclusivity briefly so every button can be unchecked when the current item is missing
+    option.group->setExclusive(false);
+    for (int i = 0; i < items.size(); i++) {
+        QAbstractButton* radioBtn = option.group->button(i);
+        if (!radioBtn) {
+            radioBtn = new QRadioButton(option.options);
+            option.options->layout()->addWidget(radioBtn);
+            option.group->addButton(radioBtn, i);
+            auto opt = &option;
+            connect(radioBtn, &QRadioButton::clicked, [opt, i]() {
+                if (opt->on_selected) {
+                    opt->on_selected(i);
+                }
+            });
+        }
+        radioBtn->setText(items[i]);
+        radioBtn->setChecked(i == current);
+        radioBtn->show();
+    }
+    for (int i = items.size(); i < buttons.size(); i++) {
+        if (auto radioBtn = option.group->button(i)) {
+            radioBtn->setChecked(false);
+            radioBtn->hide();
+        }
+    }
+    option.group->setExclusive(true);
+
+    option.popup->adjustSize();
+    option.popup->show();
+    option.popup->setPopupPosition();
+}
+
 void VideoCallMainPage::initCameraOption() {
     // {zh} 摄像头选项按钮
     // {en} camera option button
@@ -245,53 +325,31 @@ void VideoCallMainPage::initCameraOption() {
     camera_option_btn->show();
 
     connect(camera_option_btn, &QPushButton::clicked, [this, camera_option_btn]() {
-        auto camera_option_popup = new PopupArrowWidget(camera_option_btn);
-        auto optionWidget = new QWidget(camera_option_popup);
-        optionWidget->setStyleSheet(radioBtnQss);
-        QVBoxLayout* layout = new QVBoxLayout(optionWidget);
-        layout->setContentsMargins(16, 12, 16, 12);
-        layout->setSpacing(8);
-
         std::vector<RtcDevice> camera_devices;
         VideoCallRtcEngineWrap::getVideoCaptureDevices(camera_devices);
-        int currentIndex = RtcEngineWrap::instance().getCurrentVideoCaptureDeviceIndex();
-        int idx = 0;
+        // {zh} 弹窗按行号回调，换算成设备的稳定序号
+        // {en} The popup reports row numbers, map them to the devices' stable indices
+        QStringList names;
+        std::vector<int> indices;
+        int current = -1;
+        auto current_index = RtcEngineWrap::instance().getCurrentVideoCaptureDeviceIndex();
         for (auto& dc : camera_devices) {
-            auto radioBtn = new QRadioButton(dc.name.c_str());
-            radioBtn->setCheckable(true);
-            connect(radioBtn, &QRadioButton::clicked, [idx, radioBtn, this]() {
-                radioBtn->setChecked(true);
-                VideoCallRtcEngineWrap::setVideoCaptureDevice(idx);
-                });
-
-            if (currentIndex == idx) {
-                radioBtn->setChecked(true);
+            if (dc.index == current_index) {
+                current = names.size();
             }
-            layout->addWidget(radioBtn);
-            idx++;
+            names << QString::fromStdString(dc.name);
+            indices.push_back(dc.index);
         }
+        showOptionPopup(camera_option_, camera_option_btn, ui->cameraBtn, names, current,
+            [indices](int idx) { VideoCallRtcEngineWrap::setVideoCaptureDevice(indices[idx]); });
+    });
 
-        optionWidget->setLayout(layout);
-        camera_option_popup->addCustomWidget(optionWidget);
-
-        connect(&VideoCallRtcEngineWrap::instance(), &VideoCallRtcEngineWrap::sigUpdateVideoDevices,
-            camera_option_popup, [camera_option_popup]() {
-                if (camera_option_popup && camera_option_popup->isVisible()) {
-                    camera_option_popup->setParent(nullptr);
-                    camera_option_popup->close();
-                }
-        });
-
-        connect(camera_option_popup, &PopupArrowWidget::widgetVisiblilityChanged,
-            [this, camera_option_btn](bool isVisibled) {
-                camera_option_btn->setIcon(isVisibled
-                    ? QIcon(":img/videocall_up_arrow") : QIcon(":img/videocall_down_arrow"));
-                ui->cameraBtn->update();
+    connect(&VideoCallRtcEngineWrap::instance(), &VideoCallRtcEngineWrap::sigUpdateVideoDevices,
+        this, [this]() {
+            if (camera_option_.popup && camera_option_.popup->isVisible()) {
+                camera_option_.popup->close();
+            }
         });
-        camera_option_popup->setArrowPosition(PopupArrowWidget::ArrowPosition::bottom);
-        camera_option_popup->show();
-        camera_option_popup->setPopupPosition();
-    });
 }
 
 void VideoCallMainPage::initMicOption() {
@@ -300,60 +358,37 @@ void VideoCallMainPage::initMicOption() {
     auto audio_option_btn = new QPushButton(ui->micBtn);
     audio_option_btn->setFixedSize(QSize(16, 16));
     audio_option_btn->setIconSize(QSize(12, 12));
-    audio_option_btn->setCheckable(false);
     audio_option_btn->setStyleSheet(optionBtnQss);
     audio_option_btn->setIcon(QIcon(":img/videocall_down_arrow"));
     audio_option_btn->move(QPoint(ui->micBtn->width() - 25, 8));
     audio_option_btn->show();
 
     connect(audio_option_btn, &QPushButton::clicked, [this, audio_option_btn]() {
-        auto audio_option_popup = new PopupArrowWidget(audio_option_btn);
-        auto optionWidget = new QWidget(audio_option_popup);
-        optionWidget->setStyleSheet(radioBtnQss);
-        QVBoxLayout* layout = new QVBoxLayout(this);
-        layout->setContentsMargins(16, 12, 16, 12);
-        layout->setSpacing(8);
-
         std::vector<RtcDevice> audio_input_devices;
         VideoCallRtcEngineWrap::getAudioInputDevices(audio_input_devices);
-        int currentIndex = RtcEngineWrap::instance().getCurrentAudioInputDeviceIndex();
-        int idx = 0;
+        // {zh} 弹窗按行号回调，换算成设备的稳定序号
+        // {en} The popup reports row numbers, map them to the devices' stable indices
+        QStringList names;
+        std::vector<int> indices;
+        int current = -1;
+        auto current_index = RtcEngineWrap::instance().getCurrentAudioInputDeviceIndex();
         for (auto& dc : audio_input_devices) {
-            auto radioBtn = new QRadioButton(dc.name.c_str());
-            connect(radioBtn, &QRadioButton::clicked, [idx, radioBtn, this]() {
-                radioBtn->setChecked(true);
-                VideoCallRtcEngineWrap::setAudioInputDevice(idx);
-            });
-
-            if (currentIndex == idx) {
-                radioBtn->setChecked(true);
+            if (dc.index == current_index) {
+                current = names.size();
             }
-            layout->addWidget(radioBtn);
-            idx++;
+            names << QString::fromStdString(dc.name);
+            indices.push_back(dc.index);
         }
-
-        optionWidget->setLayout(layout);
-        audio_option_popup->addCustomWidget(optionWidget);
-        audio_option_popup->setArrowPosition(PopupArrowWidget::ArrowPosition::bottom);
-
-        connect(&VideoCallRtcEngineWrap::instance(), &VideoCallRtcEngineWrap::sigUpdateAudioDevices,
-            audio_option_popup, [audio_option_popup]() {
-                if (audio_option_popup && audio_option_popup->isVisible()) {
-                    audio_option_popup->setParent(nullptr);
-                    audio_option_popup->close();
-                }
-            });
-        
-        connect(audio_option_popup, &PopupArrowWidget::widgetVisiblilityChanged,
-            [this, audio_option_btn](bool isVisibled) {
-                audio_option_btn->setIcon(isVisibled
-                    ? QIcon(":img/videocall_up_arrow") : QIcon(":img/videocall_down_arrow"));
-                ui->micBtn->update();
-            });
-
-        audio_option_popup->show();
-        audio_option_popup->setPopupPosition();
+        showOptionPopup(mic_option_, audio_option_btn, ui->micBtn, names, current,
+            [indices](int idx) { VideoCallRtcEngineWrap::setAudioInputDevice(indices[idx]); });
     });
+
+    connect(&VideoCallRtcEngineWrap::instance(), &VideoCallRtcEngineWrap::sigUpdateAudioDevices,
+        this, [this]() {
+            if (mic_option_.popup && mic_option_.popup->isVisible()) {
+                mic_option_.popup->close();
+            }
+        });
 }
 
 void VideoCallMainPage::initShareOption() {
@@ -368,48 +403,16 @@ void VideoCallMainPage::initShareOption() {
     share_option_btn->show();
 
     connect(share_option_btn, &QPushButton::clicked, [this, share_option_btn]() {
-        auto share_option_popup = new PopupArrowWidget(share_option_btn);
-        auto optionWidget = new QWidget(share_option_popup);
-        optionWidget->setStyleSheet(radioBtnQss);
-        QVBoxLayout* layout = new QVBoxLayout(this);
-        layout->setContentsMargins(16, 12, 16, 12);
-        layout->setSpacing(8);
-
-        auto radioBtn1 = new QRadioButton(QObject::tr("clarity_priority"));
-        connect(radioBtn1, &QRadioButton::clicked, []() {
-            videocall::VideoConfiger screen;
-            screen.resolution = videocall::VideoResolution{ 1280, 720 };
-            VideoCallRtcEngineWrap::setScreenProfiles(screen);
-            videocall::DataMgr::instance().setShareQualityIndex(0);
-            });
-        if (videocall::DataMgr::instance().share_quality_index() == 0) {
-            radioBtn1->setChecked(true);
-        }
-        layout->addWidget(radioBtn1);
-
-        auto radioBtn2 = new QRadioButton(QObject::tr("fluency_priority"));
-        connect(radioBtn2, &QRadioButton::clicked, []() {
-            videocall::VideoConfiger screen;
-            screen.resolution = videocall::VideoResolution{ 640, 360 };
-            VideoCallRtcEngineWrap::setScreenProfiles(screen);
-            videocall::DataMgr::instance().setShareQualityIndex(1);
-            });
-        if (videocall::DataMgr::instance().share_quality_index() == 1) {
-            radioBtn2->setChecked(true);
-        }
-        layout->addWidget(radioBtn2);
-
-        optionWidget->setLayout(layout);
-        share_option_popup->addCustomWidget(optionWidget);
-        share_option_popup->setArrowPosition(PopupArrowWidget::ArrowPosition::bottom);
-        share_option_popup->show();
-        share_option_popup->setPopupPosition();
-
-        connect(share_option_popup, &PopupArrowWidget::widgetVisiblilityChanged,
-            [this, share_option_btn](bool isVisibled) {
-                share_option_btn->setIcon(isVisibled
-                    ? QIcon(":img/videocall_up_arrow") : QIcon(":img/videocall_down_arrow"));
-                ui->shareBtn->update();
+        QStringList names;
+        names << QObject::tr("clarity_priority") << QObject::tr("fluency_priority");
+        showOptionPopup(share_option_, share_option_btn, ui->shareBtn, names,
+            videocall::DataMgr::instance().share_quality_index(),
+            [](int idx) {
+                videocall::VideoConfiger screen;
+                screen.resolution = idx == 0 ? videocall::VideoResolution{ 1280, 720 }
+                    : videocall::VideoResolution{ 640, 360 };
+                VideoCallRtcEngineWrap::setScreenProfiles(screen);
+                videocall::DataMgr::instance().setShareQualityIndex(idx);
             });
     });
 }
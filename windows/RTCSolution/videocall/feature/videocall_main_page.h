@@ -1,6 +1,16 @@
 #pragma once
 
+#include <QPointer>
+#include <QStringList>
 #include <QWidget>
+#include <functional>
+#include "core/timer_helper.h"
+
+class QButtonGroup;
+class QPushButton;
+class PopupArrowWidget;
+class NormalVideoView;
+class FocusVideoView;
 
 namespace Ui {
 	class VideoCallMainPage;
@@ -37,7 +47,6 @@ public:
 
 signals:
 	void sigClose();
-	void sigCameraEnabled(bool mute);
 	void sigShareButtonClicked();
 	void sigVideoCallSetting();
 	void sigRealTimeDataClicked();
@@ -46,18 +55,35 @@ protected:
 	void closeEvent(QCloseEvent*) override;
 
 private:
+	// {zh} 可复用的选项弹窗
+	// {en} Reusable option popup
+	struct OptionPopup {
+		QPointer<PopupArrowWidget> popup;
+		QWidget* options = nullptr;
+		QButtonGroup* group = nullptr;
+		std::function<void(int)> on_selected;
+	};
+
 	void initUi();
 	void setDefaultProfiles();
 	void initConnections();
 	void initCameraOption();
 	void initMicOption();
 	void initShareOption();
+	void showOptionPopup(OptionPopup& option, QPushButton* option_btn,
+		QWidget* owner_btn, const QStringList& items, int current,
+		std::function<void(int)> on_selected);
+	NormalVideoView* normalView();
+	FocusVideoView* focusView();
 
 	Ui::VideoCallMainPage* ui;
 	int current_page_ = kNormalPage;
-	QTimer* main_timer_;
+	vrd::TimerHelper main_timer_;
 	int64_t tick_count_;
 	bool froce_close_ = false;
 	bool show_ = false;
 	bool beauty_enabled_ = false;
+	OptionPopup camera_option_;
+	OptionPopup mic_option_;
+	OptionPopup share_option_;
 };
@@ -4,6 +4,9 @@
 #include "videocall/feature/realtime_data_unit.h"
 #include "videocall/core/videocall_rtc_wrap.h"
 #include "videocall/core/data_mgr.h"
+#include "core/stall_watchdog.h"
+
+#include <QLabel>
 
 
 VideoCallData::VideoCallData(QWidget* parent)
@@ -13,6 +16,11 @@ VideoCallData::VideoCallData(QWidget* parent)
     ui->btn_confirm->setText(QObject::tr("ok"));
     ui->btn_cancel->setText(QObject::tr("cancel"));
     ui->content_widget->layout()->setAlignment(Qt::AlignTop);
+    // {zh} 主线程事件循环延迟和卡顿统计，悬停显示耗时最多的事件处理函数
+    // {en} Main-thread event-loop latency and stall stats, hovering shows the most expensive event handlers
+    lbl_main_thread_ = new QLabel(this);
+    lbl_main_thread_->setContentsMargins(24, 4, 24, 4);
+    ui->verticalLayout_5->insertWidget(ui->verticalLayout_5->indexOf(ui->confirmWidget), lbl_main_thread_);
     QObject::connect(ui->audioButton, &QRadioButton::clicked, this, [this]() {
         mIsVideoInfo = false;
         updateData();
@@ -59,11 +67,12 @@ void VideoCallData::initView() {
         m_infos[info.user_id] = remoteInfoWidget;
         ui->content_widget->layout()->addWidget(remoteInfoWidget);
     }
+    updateMainThreadStats();
 }
 
 void VideoCallData::updateData(const std::string& uid) {
     if (this->isVisible() && m_infos.contains(uid)) {
-        auto remoteStreamInfos = videocall::DataMgr::instance().remote_stream_infos();
+        const auto& remoteStreamInfos = videocall::DataMgr::instance().ref_remote_stream_infos();
         auto iter = std::find_if(remoteStreamInfos.begin(), 
             remoteStreamInfos.end(), [uid](const videocall::StreamInfo& streamInfo) {
             return streamInfo.user_id == uid;
@@ -75,6 +84,7 @@ void VideoCallData::updateData(const std::string& uid) {
         if (uid == videocall::DataMgr::instance().user_id()) {
             auto localInfo = videocall::DataMgr::instance().local_stream_info();
             m_infos[localInfo.user_id]->updateInfo(localInfo, mIsVideoInfo);
+            updateMainThreadStats();
         }
     }
 }
@@ -92,6 +102,34 @@ void VideoCallData::updateData() {
     }
 }
 
+void VideoCallData::updateMainThreadStats() {
+    auto& watchdog = vrd::StallWatchdog::instance();
+    const auto& latency = watchdog.latency();
+    auto handlers = watchdog.topHandlers(10);
+    uint64_t overBudget = 0;
+    QStringList lines;
+    for (const auto& handler : handlers) {
+        overBudget += handler.over_budget;
+        lines << QString("%1: %2 x %3us, max %4ms, over budget %5")
+            .arg(QString::fromStdString(handler.name))
+            .arg(handler.count)
+            .arg(handler.count ? handler.total_us / static_cast<int64_t>(handler.count) : 0)
+            .arg(handler.max_us / 1000)
+            .arg(handler.over_budget);
+    }
+    auto lastStall = watchdog.lastStall();
+    if (lastStall.duration_ms > 0) {
+        lines << QString("last stall %1ms: %2").arg(lastStall.duration_ms)
+            .arg(QString::fromStdString(lastStall.handler));
+    }
+    lbl_main_thread_->setText(tr("main_thread_stats")
+        .arg(latency.percentile(0.5))
+        .arg(latency.percentile(0.99))
+        .arg(watchdog.stalls())
+        .arg(overBudget));
+    lbl_main_thread_->setToolTip(lines.join("\n"));
+}
+
 VideoCallData::~VideoCallData() { 
     delete ui; 
 }
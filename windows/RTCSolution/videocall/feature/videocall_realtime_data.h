@@ -5,6 +5,7 @@
 #include "videocall/core/videocall_model.h"
 
 class realTimeDataUnit;
+class QLabel;
 
 namespace Ui {
     class VideoCallData;
@@ -33,7 +34,10 @@ public slots:
     void onCancel();
 
 private:
+    void updateMainThreadStats();
+
     Ui::VideoCallData* ui;
+    QLabel* lbl_main_thread_{ nullptr };
     QMap<std::string, realTimeDataUnit* > m_infos;
     bool mIsVideoInfo{ true };
 };
@@ -7,8 +7,10 @@
 #include "videocall/core/videocall_session.h"
 #include "videocall/core/data_mgr.h"
 #include "core/component/share_view_wnd.h"
+#include "core/task_pool.h"
 
 #include <QDebug>
+#include <QPointer>
 
 VideoCallShareWidget::VideoCallShareWidget(QWidget* parent)
         : QDialog(parent), ui(new Ui::VideoCallShareWidget) {
@@ -19,51 +21,26 @@ VideoCallShareWidget::VideoCallShareWidget(QWidget* parent)
     ui->window_views->setMinimumWidth(width());
     updateData();
     connect(ui->btn_close, &QPushButton::clicked, this, [=] { this->reject(); });
-    connect(ui->screen_views, &ShareViewContainer::sigItemPressed, this,
-        [=](SnapshotAttr attr) {
-            if (!canStartSharing()) {
-                return;
-            }
-            vrd::VideoCallSession::instance().startScreenShare([=](int code) {
-                if (code != 200) {
-                    auto errorMsg = QString::fromUtf8("sharing error:") + QString::number(code);
+    auto share = [=](SnapshotAttr attr) {
+        if (!canStartSharing()) {
+            return;
+        }
+        QPointer<VideoCallShareWidget> self(this);
+        videocall::VideoCallManager::startScreenShare(attr)
+            .always([self](const vrd::TaskResult<vrd::TaskVoid>& result) {
+                if (!result.ok()) {
+                    auto errorMsg = QString::fromUtf8("sharing error:") + QString::number(result.code);
                     qDebug() << errorMsg;
                     vrd::util::showToastInfo(QObject::tr("somebody_is_sharing_screen").toStdString());
                     return;
                 }
-                auto r = videocall::DataMgr::instance().room();
-                r.screen_shared_uid = videocall::DataMgr::instance().user_id();
-                videocall::DataMgr::instance().setRoom(std::move(r));
-                std::vector<void*> excluded;
-                VideoCallRtcEngineWrap::instance().startScreenCapture(
-                    attr.source_id, excluded);
-                VideoCallRtcEngineWrap::instance().startScreenAudioCapture();
-                this->accept();
-            });
-
-        });
-
-    connect(ui->window_views, &ShareViewContainer::sigItemPressed, this,
-        [=](SnapshotAttr attr) {
-            if (!canStartSharing()) {
-                return;
-            }
-            vrd::VideoCallSession::instance().startScreenShare([=](int code) {
-                if (code != 200) {
-                    auto errorMsg = QString::fromUtf8("sharing error:") + QString::number(code);
-                    qDebug() << errorMsg;
-                    vrd::util::showToastInfo(QObject::tr("somebody_is_sharing_screen").toStdString());
-                    return;
+                if (self) {
+                    self->accept();
                 }
-                auto r = videocall::DataMgr::instance().room();
-                r.screen_shared_uid = videocall::DataMgr::instance().user_id();
-                videocall::DataMgr::instance().setRoom(std::move(r));
-                VideoCallRtcEngineWrap::instance().startScreenCaptureByWindowId(
-                    attr.source_id);
-                VideoCallRtcEngineWrap::instance().startScreenAudioCapture();
-                this->accept();
-                });
-        });
+            });
+    };
+    connect(ui->screen_views, &ShareViewContainer::sigItemPressed, this, share);
+    connect(ui->window_views, &ShareViewContainer::sigItemPressed, this, share);
 }
 
 VideoCallShareWidget::~VideoCallShareWidget() { 
@@ -75,17 +52,23 @@ void VideoCallShareWidget::updateData() {
     VideoCallRtcEngineWrap::getShareList(vec);
     ui->screen_views->clear();
     ui->window_views->clear();
+    auto generation = ++generation_;
+    int screenIndex = 0;
+    int windowIndex = 0;
     for (auto& attr : vec) {
-        if (attr.type == SnapshotAttr::kScreen) {
-            ui->screen_views->addItem(attr,
-                std::move(VideoCallRtcEngineWrap::getThumbnail(
-                    attr.type, attr.source_id, 160, 90)));
-        }
-        else {
-            ui->window_views->addItem(attr,
-                std::move(VideoCallRtcEngineWrap::getThumbnail(
-                    attr.type, attr.source_id, 160, 90)));
-        }
+        auto view = attr.type == SnapshotAttr::kScreen ? ui->screen_views : ui->window_views;
+        auto index = attr.type == SnapshotAttr::kScreen ? screenIndex++ : windowIndex++;
+        view->addItem(attr, QPixmap());
+        // {zh} 缩略图在线程池中抓取和转换，完成后再填入
+        // {en} Thumbnails are captured and converted on the task pool and filled in when ready
+        vrd::TaskPool::instance().submitThen(this, [attr]() {
+            return VideoCallRtcEngineWrap::getThumbnailImage(attr.type, attr.source_id, 160, 90);
+        }, [this, generation, view, index](QImage image) {
+            if (generation != generation_) {
+                return;
+            }
+            view->setItemPixmap(index, QPixmap::fromImage(image));
+        });
     }
 }
 
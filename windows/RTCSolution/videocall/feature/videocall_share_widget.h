@@ -27,5 +27,8 @@ private:
     void initTranslations();
 
     Ui::VideoCallShareWidget *ui;
+    // {zh} 每次 updateData 递增，丢弃上一批列表的缩略图
+    // {en} Bumped by every updateData so thumbnails of an earlier list are dropped
+    int generation_ = 0;
 };
 
@@ -359,5 +359,9 @@
 		<source>audio</source>
 		<translation>Audio</translation>
 	</message>
+	<message>
+		<source>main_thread_stats</source>
+		<translation>Main thread latency p50 %1ms, p99 %2ms, stalls %3, over budget %4</translation>
+	</message>
 </context>
 </TS>
\ No newline at end of file
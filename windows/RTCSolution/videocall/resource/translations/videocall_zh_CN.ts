@@ -359,5 +359,9 @@
 		<source>audio</source>
 		<translation>音频</translation>
 	</message>
+	<message>
+		<source>main_thread_stats</source>
+		<translation>主线程延迟 p50 %1ms，p99 %2ms，卡顿 %3 次，超预算 %4 次</translation>
+	</message>
 </context>
 </TS>
\ No newline at end of file
@@ -42,7 +42,10 @@ void VideoCallModule::open() {
     videocall::DataMgr::instance().setUserName(vrd::DataMgr::instance().user_name());
     videocall::DataMgr::instance().setUserID(vrd::DataMgr::instance().user_id());
 
-    vrd::VideoCallSession::instance().initSceneConfig([]() {
+    // {zh} 设备初始化和登录页在引擎就绪后即开始，不等待RTS登录；期间发出的请求会在连接完成后发送
+    // {en} Device init and the login page start once the engine is ready without waiting for the RTS login;
+    // requests issued meanwhile are sent once the connection completes
+    vrd::VideoCallSession::instance().initSceneConfig(nullptr, []() {
         VideoCallRtcEngineWrap::init();
         videocall::VideoCallManager::showLogin();
         videocall::VideoCallManager::showTips();